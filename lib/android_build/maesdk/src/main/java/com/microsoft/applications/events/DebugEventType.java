@@ -32,6 +32,8 @@ public enum DebugEventType {
   EVT_DROPPED(0x03000000L),
   /// <summary>Event(s) filtered.</summary>
   EVT_FILTERED(0x03000001L),
+  /// <summary>Ingestion queue overflow.</summary>
+  EVT_INGESTION_OVERFLOW(0x03000002L),
 
   /// <summary>Event(s) sent.</summary>
   EVT_SENT(0x04000000L),
@@ -82,6 +84,8 @@ public enum DebugEventType {
   EVT_STORAGE_FULL(0x0E000000L),
   /// <summary>Storage failed.</summary>
   EVT_STORAGE_FAILED(0x0E000001L),
+  /// <summary>Storage trimmed to its size limit.</summary>
+  EVT_STORAGE_TRIMMED(0x0E000002L),
 
   /// <summary>Ticket Expired</summary>
   EVT_TICKET_EXPIRED(0x0F000000L),
@@ -8,16 +8,33 @@
 #include "pal/PAL.hpp"
 #include "utils/StringUtils.hpp"
 
+#include <algorithm>
+
 namespace MAT_NS_BEGIN
 {
 
+    namespace
+    {
+        // Generations are drawn from one process-wide sequence, so that a change anywhere
+        // in a chain of contexts always yields a generation newer than any cached snapshot.
+        uint64_t nextGeneration()
+        {
+            static std::atomic<uint64_t> generation(0);
+            return ++generation;
+        }
+    }
+
     ContextFieldsProvider::ContextFieldsProvider()
         : ContextFieldsProvider(nullptr)
     {
     }
 
     ContextFieldsProvider::ContextFieldsProvider(ContextFieldsProvider* parent)
-        : m_parent(parent)
+        : m_parent(parent),
+          m_generation(nextGeneration()),
+          m_fieldsExposed(false),
+          m_snapshotGeneration(0),
+          m_snapshotCommonOnly(false)
     {
         if (!m_parent)
         {
@@ -26,6 +43,10 @@ namespace MAT_NS_BEGIN
     }
 
     ContextFieldsProvider::ContextFieldsProvider(ContextFieldsProvider const& copy)
+        : m_generation(nextGeneration()),
+          m_fieldsExposed(false),
+          m_snapshotGeneration(0),
+          m_snapshotCommonOnly(false)
     {
         m_parent = copy.m_parent;
         m_commonContextFields = copy.m_commonContextFields;
@@ -41,17 +62,136 @@ namespace MAT_NS_BEGIN
         m_customContextFields = copy.m_customContextFields;
         m_commonContextEventToConfigIds = copy.m_commonContextEventToConfigIds;
         m_ticketsMap = copy.m_ticketsMap;
+        bumpGeneration();
         return *this;
     }
 
+    uint64_t ContextFieldsProvider::GetGeneration() const
+    {
+        uint64_t generation = m_generation.load();
+        if (m_parent)
+        {
+            generation = (std::max)(generation, m_parent->GetGeneration());
+        }
+        return generation;
+    }
+
+    void ContextFieldsProvider::bumpGeneration()
+    {
+        m_generation = nextGeneration();
+    }
+
+    bool ContextFieldsProvider::hasExposedFields() const
+    {
+        return m_fieldsExposed || ((m_parent != nullptr) && m_parent->hasExposedFields());
+    }
+
+    bool ContextFieldsProvider::canUseSnapshot(::CsProtocol::Record const& record)
+    {
+        // The snapshot replaces whole ext* structs, so it only applies to records
+        // which have none of their own yet. Anything else takes the field by field path.
+        return record.extApp.empty() && record.extDevice.empty() && record.extOs.empty() &&
+            record.extUser.empty() && record.extLoc.empty() && record.extNet.empty() &&
+            record.extProtocol.empty() && record.extM365a.empty() && (record.data.size() <= 1);
+    }
+
     void ContextFieldsProvider::writeToRecord(::CsProtocol::Record& record, bool commonOnly)
     {
-        // Append parent scope context variables if not detached from parent
+        // Fields changed through GetCommonFields() / GetCustomFields() do not bump the
+        // generation, a snapshot of such a context could miss them
+        if (!canUseSnapshot(record) || hasExposedFields())
+        {
+            // Append parent scope context variables if not detached from parent
+            if (m_parent)
+            {
+                m_parent->writeToRecord(record);
+            }
+            LOCKGUARD(m_lock);
+            writeFieldsToRecord(record, commonOnly);
+            return;
+        }
+
+        {
+            LOCKGUARD(m_lock);
+            refreshSnapshot(commonOnly);
+
+            record.extApp = m_snapshot.extApp;
+            record.extDevice = m_snapshot.extDevice;
+            record.extOs = m_snapshot.extOs;
+            record.extUser = m_snapshot.extUser;
+            record.extLoc = m_snapshot.extLoc;
+            record.extNet = m_snapshot.extNet;
+            record.extProtocol = m_snapshot.extProtocol;
+            record.extM365a = m_snapshot.extM365a;
+            if (record.data.empty())
+            {
+                record.data = m_snapshot.data;
+            }
+            else
+            {
+                for (auto const& field : m_snapshot.data[0].properties)
+                {
+                    record.data[0].properties[field.first] = field.second;
+                }
+            }
+        }
+
+        // The snapshot carries the common experiment ids, ECS may override them per event name
+        std::string experimentIds;
+        if (!record.name.empty() && getEventExperimentIds(record.name, experimentIds))
+        {
+            record.extApp[0].expId = experimentIds;
+        }
+        LOG_TRACE("Record=%p decorated with SemanticContext=%p snapshot", &record, this);
+    }
+
+    void ContextFieldsProvider::refreshSnapshot(bool commonOnly)
+    {
+        uint64_t generation = GetGeneration();
+        if (generation == m_snapshotGeneration && commonOnly == m_snapshotCommonOnly)
+        {
+            return;
+        }
+
+        ::CsProtocol::Record snapshot;
         if (m_parent)
         {
-            m_parent->writeToRecord(record);
+            m_parent->writeToRecord(snapshot);
+        }
+        writeFieldsToRecord(snapshot, commonOnly);
+
+        m_snapshot = std::move(snapshot);
+        m_snapshotGeneration = generation;
+        m_snapshotCommonOnly = commonOnly;
+    }
+
+    bool ContextFieldsProvider::getEventExperimentIds(std::string const& eventName, std::string& experimentIds)
+    {
+        {
+            LOCKGUARD(m_lock);
+            auto iter = m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTIDS);
+            if (iter != m_commonContextFields.end())
+            {
+                std::string value = iter->second.as_string;
+                if (!value.empty())
+                {
+                    // The innermost context with experiment ids decides
+                    auto const& config = m_commonContextEventToConfigIds.find(eventName);
+                    if (config == m_commonContextEventToConfigIds.end())
+                    {
+                        return false;
+                    }
+                    experimentIds = config->second;
+                    return true;
+                }
+            }
         }
+        return (m_parent != nullptr) && m_parent->getEventExperimentIds(eventName, experimentIds);
+    }
 
+    // Writes the fields of this context only, caller holds m_lock
+    void ContextFieldsProvider::writeFieldsToRecord(::CsProtocol::Record& record, bool commonOnly)
+    {
         if (record.data.size() == 0)
         {
             ::CsProtocol::Data data;
@@ -106,300 +246,296 @@ namespace MAT_NS_BEGIN
         }
 
         std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
-        {
-            LOCKGUARD(m_lock);
-
-            std::string value = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTIDS].as_string;
-            if (!value.empty())
-            {// for ECS set event specific config ids
-                std::string eventName = record.name;
-                if (!eventName.empty())
+        std::string value = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTIDS].as_string;
+        if (!value.empty())
+        {// for ECS set event specific config ids
+            std::string eventName = record.name;
+            if (!eventName.empty())
+            {
+                const auto& iter = m_commonContextEventToConfigIds.find(eventName);
+                if (iter != m_commonContextEventToConfigIds.end())
                 {
-                    const auto& iter = m_commonContextEventToConfigIds.find(eventName);
-                    if (iter != m_commonContextEventToConfigIds.end())
-                    {
-                        value = iter->second;
-                    }
+                    value = iter->second;
                 }
-
-                record.extApp[0].expId = value;
             }
 
-            if (!m_commonContextFields.empty())
+            record.extApp[0].expId = value;
+        }
+
+        if (!m_commonContextFields.empty())
+        {
+            if (m_commonContextFields.find(SESSION_IMPRESSION_ID) != m_commonContextFields.end())
             {
-                if (m_commonContextFields.find(SESSION_IMPRESSION_ID) != m_commonContextFields.end())
-                {
-                    CsProtocol::Value temp;
-                    EventProperty prop = m_commonContextFields[SESSION_IMPRESSION_ID];
-                    temp.stringValue = prop.as_string;
+                CsProtocol::Value temp;
+                EventProperty prop = m_commonContextFields[SESSION_IMPRESSION_ID];
+                temp.stringValue = prop.as_string;
 
-                    ext[SESSION_IMPRESSION_ID] = temp;
-                }
+                ext[SESSION_IMPRESSION_ID] = temp;
+            }
 
-                if (m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTETAG) != m_commonContextFields.end())
-                {
-                    CsProtocol::Value temp;
-                    EventProperty prop = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTETAG];
-                    temp.stringValue = prop.as_string;
+            if (m_commonContextFields.find(COMMONFIELDS_APP_EXPERIMENTETAG) != m_commonContextFields.end())
+            {
+                CsProtocol::Value temp;
+                EventProperty prop = m_commonContextFields[COMMONFIELDS_APP_EXPERIMENTETAG];
+                temp.stringValue = prop.as_string;
 
-                    ext[COMMONFIELDS_APP_EXPERIMENTETAG] = temp;
-                }
+                ext[COMMONFIELDS_APP_EXPERIMENTETAG] = temp;
+            }
 
-                auto iter = m_commonContextFields.find(COMMONFIELDS_APP_ID);
-                bool hasAppId = (iter != m_commonContextFields.end());
-                if (hasAppId)
-                {
-                    record.extApp[0].id = iter->second.as_string;
-                }
+            auto iter = m_commonContextFields.find(COMMONFIELDS_APP_ID);
+            bool hasAppId = (iter != m_commonContextFields.end());
+            if (hasAppId)
+            {
+                record.extApp[0].id = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_ENV);
-                bool hasAppEnv = (iter != m_commonContextFields.end());
-                if (hasAppEnv)
-                {
-                    record.extApp[0].env = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_APP_ENV);
+            bool hasAppEnv = (iter != m_commonContextFields.end());
+            if (hasAppEnv)
+            {
+                record.extApp[0].env = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_NAME);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extApp[0].name = iter->second.as_string;
-                }
-                else if (hasAppId)
-                {
-                    // Backwards-compat: legacy Aria exporter maps CS3.0 ext.app.name to AppInfo.Id
-                    // TODO:
-                    // - consider resolving that protocol "wrinkle" backend-side
-                    // - consider parsing ext.app.id if it contains app hash!name:ver information
-                    record.extApp[0].name = record.extApp[0].id;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_APP_NAME);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extApp[0].name = iter->second.as_string;
+            }
+            else if (hasAppId)
+            {
+                // Backwards-compat: legacy Aria exporter maps CS3.0 ext.app.name to AppInfo.Id
+                // TODO:
+                // - consider resolving that protocol "wrinkle" backend-side
+                // - consider parsing ext.app.id if it contains app hash!name:ver information
+                record.extApp[0].name = record.extApp[0].id;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_VERSION);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extApp[0].ver = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_APP_VERSION);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extApp[0].ver = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_APP_LANGUAGE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extApp[0].locale = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_APP_LANGUAGE);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extApp[0].locale = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ID);
-                if (iter != m_commonContextFields.end())
+            iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ID);
+            if (iter != m_commonContextFields.end())
+            {
+                // Use "c:" prefix
+                std::string temp("c:");
+                const char *deviceId = iter->second.as_string;
+                if (deviceId != nullptr)
                 {
-                    // Use "c:" prefix
-                    std::string temp("c:");
-                    const char *deviceId = iter->second.as_string;
-                    if (deviceId != nullptr)
+                    size_t len = strlen(deviceId);
+                    if (len >= 2 && deviceId[1] == ':' && (
+                        deviceId[0] == 'c' || // c: Custom identifier
+                        deviceId[0] == 'u' || // u: Mac OS X UUID
+                        deviceId[0] == 'a' || // a: Android ID
+                        deviceId[0] == 's' || // s: SQM ID
+                        deviceId[0] == 'x' || // x: XBox One hardware ID
+                        deviceId[0] == 'i'))  // i: iOS ID
                     {
-                        size_t len = strlen(deviceId);
-                        if (len >= 2 && deviceId[1] == ':' && (
-                            deviceId[0] == 'c' || // c: Custom identifier
-                            deviceId[0] == 'u' || // u: Mac OS X UUID
-                            deviceId[0] == 'a' || // a: Android ID
-                            deviceId[0] == 's' || // s: SQM ID
-                            deviceId[0] == 'x' || // x: XBox One hardware ID
-                            deviceId[0] == 'i'))  // i: iOS ID
-                        {
-                            // Remove "c:" prefix
-                            temp = "";
-                        }
-                        // Strip curly braces from GUID while populating localId.
-                        // Otherwise 1DS collector would not strip the prefix.
-                        if ((deviceId[0] == '{') && (deviceId[len - 1] == '}'))
-                        {
-                            temp.append(deviceId + 1, len - 2);
-                        }
-                        else
-                        {
-                            temp.append(deviceId);
-                        }
+                        // Remove "c:" prefix
+                        temp = "";
+                    }
+                    // Strip curly braces from GUID while populating localId.
+                    // Otherwise 1DS collector would not strip the prefix.
+                    if ((deviceId[0] == '{') && (deviceId[len - 1] == '}'))
+                    {
+                        temp.append(deviceId + 1, len - 2);
+                    }
+                    else
+                    {
+                        temp.append(deviceId);
                     }
-                    record.extDevice[0].localId = temp;
                 }
+                record.extDevice[0].localId = temp;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ORGID);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extDevice[0].orgId = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_ORGID);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extDevice[0].orgId = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_MAKE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extProtocol[0].devMake = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_MAKE);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extProtocol[0].devMake = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_MODEL);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extProtocol[0].devModel = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_MODEL);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extProtocol[0].devModel = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_CLASS);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extDevice[0].deviceClass = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_DEVICE_CLASS);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extDevice[0].deviceClass = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_COMMERCIAL_ID);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extM365a[0].enrolledTenantId = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_COMMERCIAL_ID);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extM365a[0].enrolledTenantId = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_OS_NAME);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extOs[0].name = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_OS_NAME);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extOs[0].name = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_OS_BUILD);
-                if (iter != m_commonContextFields.end())
-                {
-                    //EventProperty prop = (*m_commonContextFieldsP)[COMMONFIELDS_OS_VERSION];
-                    record.extOs[0].ver = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_OS_BUILD);
+            if (iter != m_commonContextFields.end())
+            {
+                //EventProperty prop = (*m_commonContextFieldsP)[COMMONFIELDS_OS_VERSION];
+                record.extOs[0].ver = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_USER_ID);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extUser[0].localId = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_USER_ID);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extUser[0].localId = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_USER_LANGUAGE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extUser[0].locale = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_USER_LANGUAGE);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extUser[0].locale = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_USER_TIMEZONE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extLoc[0].timezone = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_USER_TIMEZONE);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extLoc[0].timezone = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_COST);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extNet[0].cost = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_COST);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extNet[0].cost = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_PROVIDER);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extNet[0].provider = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_PROVIDER);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extNet[0].provider = iter->second.as_string;
+            }
 
-                iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_TYPE);
-                if (iter != m_commonContextFields.end())
-                {
-                    record.extNet[0].type = iter->second.as_string;
-                }
+            iter = m_commonContextFields.find(COMMONFIELDS_NETWORK_TYPE);
+            if (iter != m_commonContextFields.end())
+            {
+                record.extNet[0].type = iter->second.as_string;
             }
+        }
 
-            if (m_ticketsMap.size() > 0)
+        if (m_ticketsMap.size() > 0)
+        {
+            std::vector<std::string> tickets;
+            for (auto const& field : m_ticketsMap)
             {
-                std::vector<std::string> tickets;
-                for (auto const& field : m_ticketsMap)
-                {
-                    tickets.push_back(field.second);
-                }
-                CsProtocol::Protocol temp;
-                temp.ticketKeys.push_back(tickets);
-                record.extProtocol.push_back(temp);
+                tickets.push_back(field.second);
             }
+            CsProtocol::Protocol temp;
+            temp.ticketKeys.push_back(tickets);
+            record.extProtocol.push_back(temp);
+        }
 
-            if (!commonOnly)
+        if (!commonOnly)
+        {
+            for (auto const& field : m_customContextFields)
             {
-                for (auto const& field : m_customContextFields)
+                if (field.second.piiKind != PiiKind_None)
                 {
-                    if (field.second.piiKind != PiiKind_None)
-                    {
-                        CsProtocol::PII pii;
-                        pii.Kind = static_cast<CsProtocol::PIIKind>(field.second.piiKind);
-                        CsProtocol::Value temp;
-                        CsProtocol::Attributes attrib;
-                        attrib.pii.push_back(pii);
+                    CsProtocol::PII pii;
+                    pii.Kind = static_cast<CsProtocol::PIIKind>(field.second.piiKind);
+                    CsProtocol::Value temp;
+                    CsProtocol::Attributes attrib;
+                    attrib.pii.push_back(pii);
 
 
-                        temp.attributes.push_back(attrib);
+                    temp.attributes.push_back(attrib);
 
+                    temp.stringValue = field.second.to_string();
+                    record.data[0].properties[field.first] = temp;
+                }
+                else
+                {
+                    std::vector<uint8_t> guid;
+                    uint8_t guid_bytes[16] = { 0 };
+
+                    switch (field.second.type)
+                    {
+                    case EventProperty::TYPE_STRING:
+                    {
+                        CsProtocol::Value temp;
                         temp.stringValue = field.second.to_string();
                         record.data[0].properties[field.first] = temp;
+                        break;
                     }
-                    else
+                    case EventProperty::TYPE_INT64:
                     {
-                        std::vector<uint8_t> guid;
-                        uint8_t guid_bytes[16] = { 0 };
-
-                        switch (field.second.type)
-                        {
-                        case EventProperty::TYPE_STRING:
-                        {
-                            CsProtocol::Value temp;
-                            temp.stringValue = field.second.to_string();
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_INT64:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueInt64;
-                            temp.longValue = field.second.as_int64;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_DOUBLE:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueDouble;
-                            temp.doubleValue = field.second.as_double;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_TIME:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueDateTime;
-                            temp.longValue = field.second.as_time_ticks.ticks;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_BOOLEAN:
-                        {
-                            CsProtocol::Value temp;
-                            temp.type = ::CsProtocol::ValueKind::ValueBool;
-                            temp.longValue = field.second.as_bool;
-                            record.data[0].properties[field.first] = temp;
-                            break;
-                        }
-                        case EventProperty::TYPE_GUID:
-                        {
-                            GUID_t temp = field.second.as_guid;
-                            temp.to_bytes(guid_bytes);
-                            guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-
-                            CsProtocol::Value tempValue;
-                            tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
-                            tempValue.guidValue.push_back(guid);
-                            record.data[0].properties[field.first] = tempValue;
-                            break;
-                        }
-                        default:
-                        {
-                            // Convert all unknown types to string
-                            CsProtocol::Value temp;
-                            temp.stringValue = field.second.to_string();
-                            record.data[0].properties[field.first] = temp;
-                        }
-                        }
+                        CsProtocol::Value temp;
+                        temp.type = ::CsProtocol::ValueKind::ValueInt64;
+                        temp.longValue = field.second.as_int64;
+                        record.data[0].properties[field.first] = temp;
+                        break;
+                    }
+                    case EventProperty::TYPE_DOUBLE:
+                    {
+                        CsProtocol::Value temp;
+                        temp.type = ::CsProtocol::ValueKind::ValueDouble;
+                        temp.doubleValue = field.second.as_double;
+                        record.data[0].properties[field.first] = temp;
+                        break;
+                    }
+                    case EventProperty::TYPE_TIME:
+                    {
+                        CsProtocol::Value temp;
+                        temp.type = ::CsProtocol::ValueKind::ValueDateTime;
+                        temp.longValue = field.second.as_time_ticks.ticks;
+                        record.data[0].properties[field.first] = temp;
+                        break;
+                    }
+                    case EventProperty::TYPE_BOOLEAN:
+                    {
+                        CsProtocol::Value temp;
+                        temp.type = ::CsProtocol::ValueKind::ValueBool;
+                        temp.longValue = field.second.as_bool;
+                        record.data[0].properties[field.first] = temp;
+                        break;
+                    }
+                    case EventProperty::TYPE_GUID:
+                    {
+                        GUID_t temp = field.second.as_guid;
+                        temp.to_bytes(guid_bytes);
+                        guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
+
+                        CsProtocol::Value tempValue;
+                        tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
+                        tempValue.guidValue.push_back(guid);
+                        record.data[0].properties[field.first] = tempValue;
+                        break;
+                    }
+                    default:
+                    {
+                        // Convert all unknown types to string
+                        CsProtocol::Value temp;
+                        temp.stringValue = field.second.to_string();
+                        record.data[0].properties[field.first] = temp;
+                    }
                     }
                 }
             }
-            LOG_TRACE("Record=%p decorated with SemanticContext=%p", &record, this);
         }
+        LOG_TRACE("Record=%p decorated with SemanticContext=%p", &record, this);
     }
 
     void ContextFieldsProvider::ClearExperimentIds()
@@ -408,6 +544,7 @@ namespace MAT_NS_BEGIN
         SetCommonField(COMMONFIELDS_APP_EXPERIMENTIDS, "");
 
         // Clear the map of all ExperimentsIds (that's associated with event)
+        LOCKGUARD(m_lock);
         m_commonContextEventToConfigIds.clear();
     }
 
@@ -419,6 +556,7 @@ namespace MAT_NS_BEGIN
         }
 
         std::string eventNameNormalized = toLower(eventName);
+        LOCKGUARD(m_lock);
         if (!experimentIds.empty())
         {
             m_commonContextEventToConfigIds[eventNameNormalized] = experimentIds;
@@ -433,12 +571,14 @@ namespace MAT_NS_BEGIN
     {
         LOCKGUARD(m_lock);
         m_commonContextFields[name] = value;
+        bumpGeneration();
     }
 
     void ContextFieldsProvider::SetCustomField(const std::string& name, const EventProperty& value)
     {
         LOCKGUARD(m_lock);
         m_customContextFields[name] = value;
+        bumpGeneration();
     }
 
     void ContextFieldsProvider::SetTicket(TicketType type, const std::string& ticketValue)
@@ -447,21 +587,27 @@ namespace MAT_NS_BEGIN
         if (!ticketValue.empty())
         {
             m_ticketsMap[type] = ticketValue;
+            bumpGeneration();
         }
     }
 
     void ContextFieldsProvider::SetParentContext(ContextFieldsProvider* parent)
     {
         m_parent = parent;
+        bumpGeneration();
     }
 
     std::map<std::string, EventProperty>& ContextFieldsProvider::GetCommonFields()
     {
+        // Callers may modify the fields through the reference at any time later on,
+        // records of this context are no longer decorated from a snapshot
+        m_fieldsExposed = true;
         return m_commonContextFields;
     }
 
     std::map<std::string, EventProperty>& ContextFieldsProvider::GetCustomFields()
     {
+        m_fieldsExposed = true;
         return m_customContextFields;
     }
 
@@ -10,6 +10,7 @@
 
 #include "utils/Utils.hpp"
 
+#include <atomic>
 #include <mutex>
 #include <set>
 #include <string>
@@ -18,6 +19,12 @@
 namespace MAT_NS_BEGIN
 {
 
+    /// <summary>
+    /// Holds the Part A and custom context fields of a log manager or logger.
+    /// The fields are rendered into a cached snapshot record, which is rebuilt only
+    /// when the generation of this context or one of its parents changes, so that
+    /// decorating an event copies the prepared ext* structs instead of rebuilding them.
+    /// </summary>
     class ContextFieldsProvider : public ISemanticContext
     {
 
@@ -37,10 +44,27 @@ namespace MAT_NS_BEGIN
         virtual void SetEventExperimentIds(std::string const & eventName, std::string const & experimentIds) override;
         virtual void ClearExperimentIds() override;
 
+        /// <summary>
+        /// Direct access to the fields of this context. Prefer SetCommonField / SetCustomField:
+        /// once a reference has been handed out, records of this context and its children are
+        /// decorated field by field rather than from a cached snapshot.
+        /// </summary>
         virtual std::map<std::string, EventProperty>& GetCommonFields();
         virtual std::map<std::string, EventProperty>& GetCustomFields();
 
+        /// <summary>
+        /// Returns the generation of the fields visible through this context.
+        /// It grows whenever a field of this context or any of its parents changes.
+        /// </summary>
+        uint64_t GetGeneration() const;
+
     protected:
+        void bumpGeneration();
+        bool hasExposedFields() const;
+        void writeFieldsToRecord(::CsProtocol::Record& record, bool commonOnly);
+        void refreshSnapshot(bool commonOnly);
+        bool getEventExperimentIds(std::string const& eventName, std::string& experimentIds);
+        static bool canUseSnapshot(::CsProtocol::Record const& record);
 
         std::mutex              m_lock;
         ContextFieldsProvider*  m_parent;
@@ -52,6 +76,15 @@ namespace MAT_NS_BEGIN
         std::map<std::string, std::string>   m_commonContextEventToConfigIds;
 
         std::map<TicketType, std::string>    m_ticketsMap;
+
+        std::atomic<uint64_t>                m_generation;
+        // Set once GetCommonFields() / GetCustomFields() handed out a mutable reference
+        std::atomic<bool>                    m_fieldsExposed;
+
+        // Fields of this context and its parents rendered into a record, valid for m_snapshotGeneration
+        ::CsProtocol::Record                 m_snapshot;
+        uint64_t                             m_snapshotGeneration;
+        bool                                 m_snapshotCommonOnly;
     };
 
 
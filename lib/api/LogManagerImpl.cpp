@@ -104,6 +104,9 @@ namespace MAT_NS_BEGIN
 
     MATSDK_LOG_INST_COMPONENT_CLASS(LogManagerImpl, "EventsSDK.LogManager", "Microsoft Telemetry Client - LogManager class");
 
+    // Longest sleep of a producer blocked by IngestionOverflow_Block between two attempts
+    static const unsigned INGESTION_BLOCK_MAX_SLEEP_MS = 10;
+
 #if 1
     // TODO: integrate Tracing API from v1
     // Meanwhile we'd set the g_logLevel using ILogConfiguration settings
@@ -324,6 +327,18 @@ namespace MAT_NS_BEGIN
             m_isSystemStarted = true;
         }
 
+        bool asyncIngestion = m_logConfiguration[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ASYNC];
+        if (asyncIngestion)
+        {
+            uint32_t queueSize = m_logConfiguration[CFG_MAP_INGESTION][CFG_INT_INGESTION_QUEUE_SIZE];
+            int32_t overflowPolicy = m_logConfiguration[CFG_MAP_INGESTION][CFG_INT_INGESTION_OVERFLOW_POLICY];
+            m_ingestionOverflowPolicy = static_cast<IngestionOverflowPolicy>(overflowPolicy);
+            m_ingestionBlockTimeoutMs = m_logConfiguration[CFG_MAP_INGESTION][CFG_INT_INGESTION_BLOCK_TIMEOUT];
+            m_ingestionQueue.reset(new IngestionQueue<QueuedEventContextPtr>(queueSize));
+            LOG_INFO("Asynchronous ingestion enabled: queue size=%zu, overflow policy=%d",
+                     m_ingestionQueue->Capacity(), m_ingestionOverflowPolicy);
+        }
+
 #ifdef HAVE_MAT_DEFAULT_FILTER
         m_modules.push_back(std::unique_ptr<CompliantByDefaultEventFilterModule>(new CompliantByDefaultEventFilterModule()));
 #endif  // HAVE_MAT_DEFAULT_FILTER
@@ -385,6 +400,18 @@ namespace MAT_NS_BEGIN
             // Ensure that AddMap clears m_loggers (it does, it should continue to).
             assert(m_loggers.empty());
 
+            // No more producers: stop the ingestion consumer and push
+            // whatever is still queued through to the telemetry system.
+            if (m_ingestionQueue)
+            {
+                {
+                    LOCKGUARD(m_ingestionHandleLock);
+                    m_ingestionStopped = true;
+                    m_ingestionDrainHandle.Cancel();
+                }
+                processIngestionQueue();
+            }
+
             LOG_INFO("Tearing down modules");
             TeardownModules();
 
@@ -417,6 +444,11 @@ namespace MAT_NS_BEGIN
     status_t LogManagerImpl::Flush()
     {
         LOG_INFO("Flush()");
+        if (m_ingestionQueue)
+        {
+            LOCKGUARD(m_lock);
+            processIngestionQueue();
+        }
         if (m_offlineStorage)
             m_offlineStorage->Flush();
         return STATUS_SUCCESS;
@@ -425,6 +457,10 @@ namespace MAT_NS_BEGIN
     status_t LogManagerImpl::UploadNow()
     {
         LOCKGUARD(m_lock);
+        if (m_ingestionQueue)
+        {
+            processIngestionQueue();
+        }
         if (GetSystem())
         {
             GetSystem()->upload();
@@ -699,6 +735,20 @@ namespace MAT_NS_BEGIN
 
     void LogManagerImpl::sendEvent(IncomingEventContextPtr const& event)
     {
+        if (m_ingestionQueue)
+        {
+            // Producer side of asynchronous ingestion: only decorate and enqueue.
+            // Custom decorator is set once at construction time and must be
+            // thread-safe in this mode. Inspection, serialization and storage
+            // run on the worker thread in drainIngestionQueue.
+            if (m_customDecorator)
+            {
+                m_customDecorator->decorate(*(event->source));
+            }
+            enqueueEvent(event);
+            return;
+        }
+
         LOCKGUARD(m_lock);
         if (GetSystem())
         {
@@ -719,6 +769,148 @@ namespace MAT_NS_BEGIN
         }
     }
 
+    void LogManagerImpl::enqueueEvent(IncomingEventContextPtr const& event)
+    {
+        QueuedEventContextPtr item(new QueuedEventContext(*event));
+        if (!m_ingestionQueue->TryPush(item))
+        {
+            size_t dropped = 1;
+            switch (m_ingestionOverflowPolicy)
+            {
+            case IngestionOverflow_DropOldest:
+            {
+                QueuedEventContextPtr oldest;
+                dropped = 0;
+                while (!m_ingestionQueue->TryPush(item))
+                {
+                    if (m_ingestionQueue->TryPop(oldest))
+                    {
+                        dropQueuedEvent(oldest);
+                        dropped++;
+                    }
+                }
+                break;
+            }
+
+            case IngestionOverflow_Block:
+            {
+                const auto deadline = PAL::getMonotonicTimeMs() + m_ingestionBlockTimeoutMs;
+                unsigned sleepMs = 1;
+                bool queued = false;
+                while (!(queued = m_ingestionQueue->TryPush(item)))
+                {
+                    const auto now = PAL::getMonotonicTimeMs();
+                    if (now >= deadline)
+                    {
+                        break;
+                    }
+                    // Sleep rather than spin, so that blocked producers leave the cores to the worker thread
+                    std::this_thread::sleep_for(std::chrono::milliseconds(std::min<uint64_t>(sleepMs, deadline - now)));
+                    sleepMs = std::min(sleepMs * 2, INGESTION_BLOCK_MAX_SLEEP_MS);
+                }
+                dropped = queued ? 0 : 1;
+                break;
+            }
+
+            case IngestionOverflow_DropNewest:
+            default:
+                break;
+            }
+
+            if (item)
+            {
+                dropQueuedEvent(item);
+            }
+            if (dropped)
+            {
+                LOG_WARN("Ingestion queue full: %zu event(s) dropped", dropped);
+            }
+            DispatchEvent(DebugEvent(DebugEventType::EVT_INGESTION_OVERFLOW, size_t(m_ingestionOverflowPolicy), dropped));
+        }
+
+        if (!m_ingestionDrainScheduled.exchange(true))
+        {
+            scheduleIngestionDrain(0);
+        }
+    }
+
+    /// <summary>
+    /// Report an event the overflow policy discarded: listeners get EVT_DROPPED right away,
+    /// the stats get the count of its tenant with the next pass over the ingestion queue.
+    /// </summary>
+    void LogManagerImpl::dropQueuedEvent(QueuedEventContextPtr& item)
+    {
+        DispatchEvent(DebugEvent(DebugEventType::EVT_DROPPED, size_t(1), size_t(item->record.latency), &item->record, sizeof(item->record)));
+        {
+            LOCKGUARD(m_ingestionDroppedLock);
+            m_ingestionDropped[item->record.tenantToken]++;
+        }
+        item.reset();
+    }
+
+    /// <summary>
+    /// Hand the drops counted by producers to the telemetry system, under m_lock.
+    /// </summary>
+    void LogManagerImpl::reportIngestionDrops()
+    {
+        std::map<std::string, size_t> dropped;
+        {
+            LOCKGUARD(m_ingestionDroppedLock);
+            dropped.swap(m_ingestionDropped);
+        }
+        if (!dropped.empty() && GetSystem())
+        {
+            GetSystem()->eventsDropped(dropped);
+        }
+    }
+
+    void LogManagerImpl::scheduleIngestionDrain(unsigned delayMs)
+    {
+        LOCKGUARD(m_ingestionHandleLock);
+        if (!m_ingestionStopped)
+        {
+            m_ingestionDrainHandle = PAL::scheduleTask(m_taskDispatcher.get(), delayMs, this, &LogManagerImpl::drainIngestionQueue);
+        }
+    }
+
+    void LogManagerImpl::drainIngestionQueue()
+    {
+        // Never block the worker thread on m_lock: its owner may be waiting
+        // for the worker thread to finish (FlushAndTeardown, DeleteData).
+        std::unique_lock<std::recursive_mutex> lock(m_lock, std::try_to_lock);
+        if (!lock.owns_lock())
+        {
+            scheduleIngestionDrain(10);
+            return;
+        }
+        // Reset before draining: producers that enqueue after this point
+        // either get picked up by this pass or schedule a new one.
+        m_ingestionDrainScheduled = false;
+        processIngestionQueue();
+    }
+
+    void LogManagerImpl::processIngestionQueue()
+    {
+        QueuedEventContextPtr item;
+        while (m_ingestionQueue->TryPop(item))
+        {
+            if (GetSystem())
+            {
+                {
+                    LOCKGUARD(m_dataInspectorGuard);
+
+                    if (m_dataInspector)
+                    {
+                        m_dataInspector->InspectRecord(*(item->source));
+                    }
+                }
+                GetSystem()->sendEvent(item.get());
+            }
+            item.reset();
+        }
+        reportIngestionDrops();
+    }
+
     ILogController* LogManagerImpl::GetLogController()
     {
         return this;
@@ -9,6 +9,8 @@
 #include "config/RuntimeConfig_Default.hpp"
 
 #include "system/Contexts.hpp"
+#include "system/IngestionQueue.hpp"
+#include "pal/TaskDispatcher.hpp"
 
 #include "IDecorator.hpp"
 #include "IHttpClient.hpp"
@@ -32,22 +34,83 @@
 #include "IDataInspector.hpp"
 #include "offline/LogSessionDataProvider.hpp"
 
+#include <atomic>
+#include <map>
 #include <mutex>
 #include <set>
+#include <thread>
 
 namespace MAT_NS_BEGIN
 {
     class ITelemetrySystem;
 
+    /// <summary>
+    /// Default level and allowed levels of a DiagLevelFilter, read together in one consistent copy
+    /// </summary>
+    struct DiagLevelsSnapshot final
+    {
+        uint8_t level = DIAG_LEVEL_DEFAULT;
+        // Levels allowed by either the set or the range, one bit per level
+        uint64_t allowed[4] = {};
+
+        bool IsAllowed(uint8_t l) const
+        {
+            return ((allowed[l >> 6] >> (l & 63)) & 1) != 0;
+        }
+    };
+
+    /// <summary>
+    /// State of a DiagLevelFilter, changed under its lock
+    /// </summary>
+    struct DiagLevels final
+    {
+        uint8_t levelMin = DIAG_LEVEL_DEFAULT_MIN;
+        uint8_t levelMax = DIAG_LEVEL_DEFAULT_MAX;
+        uint8_t level = DIAG_LEVEL_DEFAULT;
+        std::set<uint8_t> levelSet;
+
+        DiagLevelsSnapshot getSnapshot() const
+        {
+            DiagLevelsSnapshot snapshot;
+            snapshot.level = level;
+            if (!levelSet.empty())
+            {
+                for (uint8_t l : levelSet)
+                {
+                    snapshot.allowed[l >> 6] |= uint64_t(1) << (l & 63);
+                }
+            }
+            else
+            {
+                for (unsigned l = levelMin; l <= levelMax; l++)
+                {
+                    snapshot.allowed[l >> 6] |= uint64_t(1) << (l & 63);
+                }
+            }
+            return snapshot;
+        }
+
+        bool IsFilterEnabled() const
+        {
+            return !levelSet.empty() || levelMin != DIAG_LEVEL_DEFAULT_MIN || levelMax != DIAG_LEVEL_DEFAULT_MAX || level != DIAG_LEVEL_DEFAULT;
+        }
+    };
+
+    /// <summary>
+    /// Diagnostic level filter of a LogManager. The levels are checked for every event and
+    /// rarely changed: readers take no lock, they copy them out under a sequence counter and
+    /// read again if a change was being published meanwhile.
+    /// </summary>
     class DiagLevelFilter final
     {
        public:
         DiagLevelFilter() :
-            m_levelMin(DIAG_LEVEL_DEFAULT_MIN),
-            m_levelMax(DIAG_LEVEL_DEFAULT_MAX),
-            m_level(DIAG_LEVEL_DEFAULT),
-            m_levelSet({})
+            m_enabled(false),
+            m_sequence(0),
+            m_level(DIAG_LEVEL_DEFAULT)
         {
+            std::lock_guard<std::mutex> guard(m_lock);
+            publish();
         }
 
         /// <summary>
@@ -55,7 +118,7 @@ namespace MAT_NS_BEGIN
         /// </summary>
         uint8_t GetDefaultLevel() const
         {
-            return m_level;
+            return m_level.load(std::memory_order_acquire);
         }
 
         /// <summary>
@@ -64,19 +127,43 @@ namespace MAT_NS_BEGIN
         /// <param name="level">Diagnostic level.</param>
         bool IsLevelEnabled(uint8_t level) const
         {
-            if (!m_levelSet.empty())
-            {
-                return m_levelSet.find(level) != m_levelSet.end();
-            }
-            return m_levelMin <= m_levelMax && m_levelMin <= level && level <= m_levelMax;
+            return ((m_allowed[level >> 6].load(std::memory_order_acquire) >> (level & 63)) & 1) != 0;
         }
 
         /// <summary>
-        /// Method that checks if the filtering has been enabled
+        /// Method that checks if the filtering has been enabled, a single atomic load
         /// </summary>
         bool IsLevelFilterEnabled() const
         {
-            return !m_levelSet.empty() || m_levelMin != DIAG_LEVEL_DEFAULT_MIN || m_levelMax != DIAG_LEVEL_DEFAULT_MAX || m_level != DIAG_LEVEL_DEFAULT;
+            return m_enabled.load(std::memory_order_acquire);
+        }
+
+        /// <summary>
+        /// Consistent copy of the default level and allowed levels, for several checks in a row
+        /// </summary>
+        DiagLevelsSnapshot GetLevels() const
+        {
+            DiagLevelsSnapshot snapshot;
+            for (;;)
+            {
+                unsigned before = m_sequence.load(std::memory_order_acquire);
+                if ((before & 1) != 0)
+                {
+                    // A change is being published
+                    std::this_thread::yield();
+                    continue;
+                }
+                snapshot.level = m_level.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < 4; i++)
+                {
+                    snapshot.allowed[i] = m_allowed[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before)
+                {
+                    return snapshot;
+                }
+            }
         }
 
         /// <summary>
@@ -87,9 +174,11 @@ namespace MAT_NS_BEGIN
         /// </summary>
         void SetFilter(uint8_t defaultLevel, uint8_t levelMin, uint8_t levelMax)
         {
-            m_level = defaultLevel;
-            m_levelMin = levelMin;
-            m_levelMax = levelMax;
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_levels.level = defaultLevel;
+            m_levels.levelMin = levelMin;
+            m_levels.levelMax = levelMax;
+            publish();
         }
 
         /// <summary>
@@ -99,15 +188,35 @@ namespace MAT_NS_BEGIN
         /// </summary>
         void SetFilter(uint8_t defaultLevel, const std::set<uint8_t>& allowedLevels)
         {
-            m_level = defaultLevel;
-            m_levelSet = allowedLevels;
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_levels.level = defaultLevel;
+            m_levels.levelSet = allowedLevels;
+            publish();
         }
 
        private:
-        uint8_t m_levelMin;
-        uint8_t m_levelMax;
-        uint8_t m_level;
-        std::set<uint8_t> m_levelSet;
+        // Called under m_lock
+        void publish()
+        {
+            DiagLevelsSnapshot snapshot = m_levels.getSnapshot();
+            unsigned sequence = m_sequence.load(std::memory_order_relaxed);
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_level.store(snapshot.level, std::memory_order_relaxed);
+            for (size_t i = 0; i < 4; i++)
+            {
+                m_allowed[i].store(snapshot.allowed[i], std::memory_order_relaxed);
+            }
+            m_sequence.store(sequence + 2, std::memory_order_release);
+            m_enabled.store(m_levels.IsFilterEnabled(), std::memory_order_release);
+        }
+
+        std::mutex m_lock;
+        DiagLevels m_levels;
+        std::atomic<bool> m_enabled;
+        std::atomic<unsigned> m_sequence;
+        std::atomic<uint8_t> m_level;
+        std::atomic<uint64_t> m_allowed[4];
     };
 
     class ILogManagerInternal : public ILogManager
@@ -305,6 +414,13 @@ namespace MAT_NS_BEGIN
         void InitializeModules() noexcept;
         void TeardownModules() noexcept;
 
+        void enqueueEvent(IncomingEventContextPtr const& event);
+        void dropQueuedEvent(QueuedEventContextPtr& item);
+        void reportIngestionDrops();
+        void scheduleIngestionDrain(unsigned delayMs);
+        void drainIngestionQueue();
+        void processIngestionQueue();
+
         MATSDK_LOG_DECL_COMPONENT_CLASS();
 
         static DeadLoggers s_deadLoggers;
@@ -339,6 +455,18 @@ namespace MAT_NS_BEGIN
         DataViewerCollection m_dataViewerCollection;
         std::shared_ptr<IDataInspector> m_dataInspector;
         std::recursive_mutex m_dataInspectorGuard;
+
+        // Asynchronous ingestion (CFG_BOOL_INGESTION_ASYNC)
+        std::unique_ptr<IngestionQueue<QueuedEventContextPtr>> m_ingestionQueue;
+        IngestionOverflowPolicy m_ingestionOverflowPolicy{IngestionOverflow_DropOldest};
+        unsigned m_ingestionBlockTimeoutMs{};
+        std::atomic<bool> m_ingestionDrainScheduled{false};
+        bool m_ingestionStopped{false};
+        std::mutex m_ingestionHandleLock;
+        PAL::DeferredCallbackHandle m_ingestionDrainHandle;
+        // Events dropped by the overflow policy per tenant token, not reported to the stats yet
+        std::mutex m_ingestionDroppedLock;
+        std::map<std::string, size_t> m_ingestionDropped;
     };
 
 }
@@ -7,6 +7,7 @@
 #include "CommonFields.h"
 #include "LogSessionData.hpp"
 #include "NullObjects.hpp"
+#include "system/EventPropertiesStorage.hpp"
 #include "utils/Utils.hpp"
 
 #include <algorithm>
@@ -81,6 +82,7 @@ namespace MAT_NS_BEGIN
         ContextFieldsProvider& parentContext,
         IRuntimeConfig& runtimeConfig) :
         m_tenantToken(tenantToken),
+        m_tenantId(TenantRegistry::Intern(tenantToken)),
         m_source(source),
         // TODO: scope parameter can be used to rewire the logger to alternate context.
         // Scope must uniquely identify the "shared context" instance id.
@@ -510,7 +512,8 @@ namespace MAT_NS_BEGIN
         }
         record.iKey = m_iKey;
 
-        return m_baseDecorator.decorate(record) && m_semanticContextDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties);
+        // Semantic context goes first, while the record has no ext* structs yet and can take the cached context snapshot
+        return m_semanticContextDecorator.decorate(record) && m_baseDecorator.decorate(record) && m_eventPropertiesDecorator.decorate(record, latency, properties);
     }
 
     void Logger::submit(::CsProtocol::Record& record, const EventProperties& props)
@@ -524,11 +527,11 @@ namespace MAT_NS_BEGIN
         const auto policyBitFlags = props.GetPolicyBitFlags();
         const auto persistence = props.GetPersistence();
         const auto latency = props.GetLatency();
-        auto levelFilter = m_logManager.GetLevelFilter();
+        const auto& levelFilter = m_logManager.GetLevelFilter();
         if (levelFilter.IsLevelFilterEnabled())
         {
-            const auto& m_props = props.GetProperties();
-            const auto it = m_props.find(COMMONFIELDS_EVENT_LEVEL);
+            const auto levels = levelFilter.GetLevels();
+            const auto levelProperty = props.m_storage->properties.find(COMMONFIELDS_EVENT_LEVEL);
             //
             // Level policy:
             // * get level from the COMMONFIELDS_EVENT_LEVEL property if set
@@ -538,10 +541,10 @@ namespace MAT_NS_BEGIN
             // then prefer to drop. This is user error: user set the range
             // restrition, but didn't specify the defaults.
             //
-            uint8_t level = (it != m_props.cend()) ? static_cast<uint8_t>(it->second.as_int64) : m_level;
+            uint8_t level = (levelProperty != nullptr) ? static_cast<uint8_t>(levelProperty->as_int64) : m_level;
             if (level == DIAG_LEVEL_DEFAULT)
             {
-                level = levelFilter.GetDefaultLevel();
+                level = levels.level;
                 if (level == DIAG_LEVEL_DEFAULT)
                 {
                     // If no default level, but restrictions are in effect, then prefer to drop event
@@ -551,7 +554,7 @@ namespace MAT_NS_BEGIN
                     return;
                 }
             }
-            if (!levelFilter.IsLevelEnabled(level))
+            if (!levels.IsAllowed(level))
             {
                 DispatchEvent(DebugEventType::EVT_FILTERED);
                 return;
@@ -566,8 +569,7 @@ namespace MAT_NS_BEGIN
             return;
         }
 
-        // TODO: [MG] - check if optimization is possible in generateUuidString
-        IncomingEventContext event(PAL::generateUuidString(), m_tenantToken, latency, persistence, &record);
+        IncomingEventContext event(PAL::generateUuidString(), m_tenantToken, m_tenantId, latency, persistence, &record);
         event.policyBitFlags = policyBitFlags;
 
         m_logManager.sendEvent(&event);
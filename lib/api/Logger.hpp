@@ -24,6 +24,8 @@
 
 #include "filter/EventFilterCollection.hpp"
 
+#include "system/TenantRegistry.hpp"
+
 namespace MAT_NS_BEGIN
 {
     class BaseDecorator;
@@ -240,6 +242,7 @@ namespace MAT_NS_BEGIN
         std::mutex m_lock;
 
         std::string m_tenantToken;
+        TenantId m_tenantId;
         std::string m_iKey;
         std::string m_source;
 
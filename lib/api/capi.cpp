@@ -19,6 +19,7 @@
 #include <mutex>
 #include <map>
 #include <cstdint>
+#include <cstring>
 
 static const char * libSemver = TELEMETRY_EVENTS_VERSION;
 
@@ -229,22 +230,53 @@ evt_status_t mat_open_with_params(evt_context_t *ctx)
     return mat_open_core(ctx, data->config, httpSendFn, httpCancelFn, taskDispatcherQueueFn, taskDispatcherCancelFn, taskDispatcherJoinFn);
 }
 
-/**
- * Marashal C struct to C++ API
- */
-evt_status_t mat_log(evt_context_t *ctx)
+/// <summary>
+/// Unpack one C event into EventProperties, reading the tenant token and the
+/// event source straight from the evt_prop array rather than from a copy of
+/// the unpacked properties.
+/// </summary>
+static void unpack_event(evt_prop *evt, size_t size, EventProperties &props, std::string &token, std::string &source)
 {
-    VERIFY_CLIENT_HANDLE(client, ctx);
-
-    ILogConfiguration & config = client->config;
-    evt_prop *evt = static_cast<evt_prop*>(ctx->data);
-    EventProperties props;
-    props.unpack(evt, ctx->size);
+    token.clear();
+    source.clear();
+    // Same bounds as EventProperties::unpack, the last value of a repeated key wins there too
+    size_t count = (size == 0) ? SIZE_MAX : size;
+    for (evt_prop *curr = evt; (curr != nullptr) && (count > 0) && (curr->type != TYPE_NULL); count--, curr++)
+    {
+        if ((curr->type != TYPE_STRING) || (curr->name == nullptr) || (curr->value.as_string == nullptr))
+        {
+            continue;
+        }
+        if (strcmp(curr->name, COMMONFIELDS_IKEY) == 0)
+        {
+            token = curr->value.as_string;
+        }
+        else if (strcmp(curr->name, COMMONFIELDS_EVENT_SOURCE) == 0)
+        {
+            source = curr->value.as_string;
+        }
+    }
 
-    auto m = props.GetProperties();
-    EventProperty &prop = m[COMMONFIELDS_IKEY];
-    std::string token = prop.as_string;
+    props.unpack(evt, size);
     props.erase(COMMONFIELDS_IKEY);
+}
+
+/// <summary>
+/// Get the logger for a tenant token and event source, resolving it from the
+/// client's ILogManager only the first time this pair is seen on the handle.
+/// </summary>
+static ILogger * get_logger(capi_client *client, std::string const &token, std::string const &source)
+{
+    std::string key = token;
+    key += '\0';
+    key += source;
+
+    LOCKGUARD(client->loggersLock);
+    const auto &it = client->loggers.find(key);
+    if (it != client->loggers.cend())
+    {
+        return it->second;
+    }
 
     // Privacy feature for OTEL C API client:
     //
@@ -254,11 +286,11 @@ evt_status_t mat_log(evt_context_t *ctx)
     // should not be able to capture the host's context vars.
     std::string scope = CONTEXT_SCOPE_NONE;
     {
-        MAT::VariantMap &config_map = config[CFG_MAP_FACTORY_CONFIG];
-        const auto & it = config_map.find(CFG_STR_CONTEXT_SCOPE);
-        if (it != config_map.cend())
+        MAT::VariantMap &config_map = client->config[CFG_MAP_FACTORY_CONFIG];
+        const auto & itScope = config_map.find(CFG_STR_CONTEXT_SCOPE);
+        if (itScope != config_map.cend())
         {
-            scope = static_cast<const char *>(it->second);
+            scope = static_cast<const char *>(itScope->second);
             // Specifying "*" in JSON config allows Guest C API logger to capture Host context variables
             if (scope == CONTEXT_SCOPE_ALL)
             {
@@ -267,23 +299,91 @@ evt_status_t mat_log(evt_context_t *ctx)
         }
     }
 
-    const auto & it = m.find(COMMONFIELDS_EVENT_SOURCE);
-    std::string source = ((it != m.cend()) && (it->second.type == EventProperty::TYPE_STRING)) ? it->second.as_string : "";
-
     ILogger *logger = client->logmanager->GetLogger(token, source, scope);
+    if (logger != nullptr)
+    {
+        logger->SetParentContext(nullptr);
+        client->loggers[key] = logger;
+    }
+    return logger;
+}
+
+/**
+ * Marashal C struct to C++ API
+ */
+evt_status_t mat_log(evt_context_t *ctx)
+{
+    VERIFY_CLIENT_HANDLE(client, ctx);
+
+    evt_prop *evt = static_cast<evt_prop*>(ctx->data);
+    EventProperties props;
+    std::string token;
+    std::string source;
+    unpack_event(evt, ctx->size, props, token, source);
+
+    ILogger *logger = get_logger(client, token, source);
     if (logger == nullptr)
     {
         ctx->result = EFAULT; /* invalid address */
     }
     else
     {
-        logger->SetParentContext(nullptr);
         logger->LogEvent(props);
         ctx->result = EOK;
     }
     return ctx->result;
 }
 
+/**
+ * Marashal an array of C structs to C++ API, looking the logger up again
+ * only when the tenant token or the event source changes between events.
+ */
+evt_status_t mat_log_batch(evt_context_t *ctx)
+{
+    VERIFY_CLIENT_HANDLE(client, ctx);
+
+    evt_prop **evts = static_cast<evt_prop**>(ctx->data);
+    if ((evts == nullptr) && (ctx->size != 0))
+    {
+        ctx->result = EFAULT; /* bad address */
+        return ctx->result;
+    }
+
+    ctx->result = EOK;
+    ILogger *logger = nullptr;
+    std::string lastToken;
+    std::string lastSource;
+    std::string token;
+    std::string source;
+    for (size_t i = 0; i < ctx->size; i++)
+    {
+        if (evts[i] == nullptr)
+        {
+            // Not an event, rather than an empty one for the default tenant
+            ctx->result = EFAULT; /* bad address */
+            continue;
+        }
+
+        EventProperties props;
+        unpack_event(evts[i], 0, props, token, source);
+
+        if ((logger == nullptr) || (token != lastToken) || (source != lastSource))
+        {
+            logger = get_logger(client, token, source);
+            lastToken.swap(token);
+            lastSource.swap(source);
+        }
+
+        if (logger == nullptr)
+        {
+            ctx->result = EFAULT; /* invalid address */
+            continue;
+        }
+        logger->LogEvent(props);
+    }
+    return ctx->result;
+}
+
 evt_status_t mat_close(evt_context_t *ctx)
 {
     VERIFY_CLIENT_HANDLE(client, ctx);
@@ -377,6 +477,10 @@ extern "C" {
                 result = mat_log(ctx);
                 break;
 
+            case EVT_OP_LOG_BATCH:
+                result = mat_log_batch(ctx);
+                break;
+
             case EVT_OP_PAUSE:
                 result = mat_pause(ctx);
                 break;
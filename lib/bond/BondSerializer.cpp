@@ -16,10 +16,8 @@ namespace MAT_NS_BEGIN {
     bool BondSerializer::handleSerialize(IncomingEventContextPtr const& ctx)
     {
         OACR_USE_PTR(this);
-        {
-            bond_lite::CompactBinaryProtocolWriter writer(ctx->record.blob);
-            bond_lite::Serialize(writer, *ctx->source);
-        }
+        // Exactly sized, so that the blob is allocated once and kept as is in the ram queue
+        bond_lite::SerializeToBuffer(ctx->record.blob, *ctx->source);
 
         LOG_TRACE("Event %s/%s submitted, priority %u (%s), serialized size %u bytes, ID %s",
             tenantTokenToId(ctx->record.tenantToken).c_str(), ctx->source->baseType.c_str(),
@@ -39,6 +39,23 @@ class CompactBinaryProtocolReader {
     template<typename T>
     bool readVarint(T& value)
     {
+        // When the longest possible varint fits in the remaining input, bytes don't need bounds checks
+        size_t const maxSize = (sizeof(T) * 8 + 6) / 7;
+        if (m_input.size() - m_ofs >= maxSize) {
+            uint8_t const* data = m_input.data() + m_ofs;
+            T result = 0;
+            for (size_t i = 0; i < maxSize; i++) {
+                uint8_t raw = data[i];
+                result |= static_cast<T>(static_cast<T>(raw & 127) << (7 * i));
+                if (!(raw & 128)) {
+                    value = result;
+                    m_ofs += i + 1;
+                    return true;
+                }
+            }
+            return false;
+        }
+
         value = 0;
         unsigned bits = 0;
         for (;;) {
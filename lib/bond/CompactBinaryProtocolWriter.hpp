@@ -9,6 +9,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -17,57 +18,218 @@ namespace bond_lite {
 // Based on:
 // https://github.com/Microsoft/bond/blob/master/cpp/inc/bond/protocol/compact_binary.h
 
-class CompactBinaryProtocolWriter {
+// Maximum size of an encoded 64-bit varint
+static const size_t MaxVarintSize = 10;
+
+// Encodes a varint into out, which must have room for MaxVarintSize bytes, and returns its size.
+// One and two byte values, i.e. most lengths, counts and enum values, take no loop at all.
+template<typename T>
+inline size_t EncodeVarint(T value, uint8_t* out)
+{
+    if (value < 0x80) {
+        out[0] = static_cast<uint8_t>(value);
+        return 1;
+    }
+    if (value < 0x4000) {
+        out[0] = static_cast<uint8_t>(value | 0x80);
+        out[1] = static_cast<uint8_t>(value >> 7);
+        return 2;
+    }
+    size_t size = 0;
+    do {
+        out[size++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    } while (value > 127);
+    out[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+template<typename T>
+inline size_t VarintSize(T value)
+{
+    size_t size = 1;
+    while (value > 127) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+// Output of CompactBinaryProtocolWriter: appends to a vector, growing it as needed.
+class VectorOutput {
   protected:
     std::vector<uint8_t>& m_output;
 
   public:
-    CompactBinaryProtocolWriter(std::vector<uint8_t>& output)
+    VectorOutput(std::vector<uint8_t>& output)
       : m_output(output)
     {
     }
 
+    void write(uint8_t value)
+    {
+        m_output.push_back(value);
+    }
+
+    void write(uint8_t const* data, size_t size)
+    {
+        m_output.insert(m_output.end(), data, data + size);
+    }
+
+    template<typename T>
+    void writeVarint(T value)
+    {
+        uint8_t buffer[MaxVarintSize];
+        write(buffer, EncodeVarint(value, buffer));
+    }
+
+    size_t getSize() const
+    {
+        return m_output.size();
+    }
+};
+
+// Output of CompactBinaryProtocolSizer: counts the bytes, writes nothing.
+class SizeCountingOutput {
   protected:
+    size_t m_size;
+
+  public:
+    SizeCountingOutput()
+      : m_size(0)
+    {
+    }
+
+    void write(uint8_t)
+    {
+        m_size++;
+    }
+
+    void write(uint8_t const*, size_t size)
+    {
+        m_size += size;
+    }
+
     template<typename T>
     void writeVarint(T value)
     {
-        while (value > 127) {
-            m_output.push_back((value & 127) | 128);
-            value >>= 7;
+        m_size += VarintSize(value);
+    }
+
+    size_t getSize() const
+    {
+        return m_size;
+    }
+};
+
+// Output of CompactBinaryProtocolBufferWriter: writes into a caller-supplied buffer.
+// Writes that don't fit are dropped and flag the output as overflowed.
+class BufferOutput {
+  protected:
+    uint8_t* m_begin;
+    uint8_t* m_cursor;
+    uint8_t* m_end;
+    bool m_overflow;
+
+  public:
+    BufferOutput(uint8_t* buffer, size_t size)
+      : m_begin(buffer),
+        m_cursor(buffer),
+        m_end(buffer + size),
+        m_overflow(false)
+    {
+    }
+
+    void write(uint8_t value)
+    {
+        if (m_cursor == m_end) {
+            m_overflow = true;
+            return;
+        }
+        *m_cursor++ = value;
+    }
+
+    void write(uint8_t const* data, size_t size)
+    {
+        if (size > static_cast<size_t>(m_end - m_cursor)) {
+            m_overflow = true;
+            return;
+        }
+        if (size != 0) {
+            memcpy(m_cursor, data, size);
+            m_cursor += size;
         }
-        m_output.push_back(value & 127);
+    }
+
+    template<typename T>
+    void writeVarint(T value)
+    {
+        if (static_cast<size_t>(m_end - m_cursor) >= MaxVarintSize) {
+            m_cursor += EncodeVarint(value, m_cursor);
+        } else {
+            uint8_t buffer[MaxVarintSize];
+            write(buffer, EncodeVarint(value, buffer));
+        }
+    }
+
+    size_t getSize() const
+    {
+        return static_cast<size_t>(m_cursor - m_begin);
+    }
+
+    bool hasOverflowed() const
+    {
+        return m_overflow;
+    }
+};
+
+// Compact binary protocol encoding on top of one of the outputs above.
+// All the writers have the same interface, so that the serializers
+// generated from the schema work with any of them.
+template<typename TOutput>
+class CompactBinaryProtocolWriterBase {
+  protected:
+    TOutput m_output;
+
+    CompactBinaryProtocolWriterBase(TOutput const& output)
+      : m_output(output)
+    {
     }
 
   public:
+    size_t getSize() const
+    {
+        return m_output.getSize();
+    }
+
     void WriteBlob(void const* data, size_t size)
     {
-        uint8_t const* ptr = static_cast<uint8_t const*>(data);
-        m_output.insert(m_output.end(), ptr, ptr + size);
+        m_output.write(static_cast<uint8_t const*>(data), size);
     }
 
     void WriteBool(bool value)
     {
-        m_output.push_back(value ? 1 : 0);
+        m_output.write(static_cast<uint8_t>(value ? 1 : 0));
     }
 
     void WriteUInt8(uint8_t value)
     {
-        m_output.push_back(value);
+        m_output.write(value);
     }
 
     void WriteUInt16(uint16_t value)
     {
-        writeVarint(value);
+        m_output.writeVarint(value);
     }
 
     void WriteUInt32(uint32_t value)
     {
-        writeVarint(value);
+        m_output.writeVarint(value);
     }
 
     void WriteUInt64(uint64_t value)
     {
-        writeVarint(value);
+        m_output.writeVarint(value);
     }
 
     void WriteInt8(int8_t value)
@@ -110,13 +272,15 @@ class CompactBinaryProtocolWriter {
 
     void WriteString(std::string const& value)
     {
-        if (value.empty()) {
-            WriteUInt32(0);
-        } else {
-            assert(value.size() <= UINT32_MAX);
-            WriteUInt32(static_cast<uint32_t>(value.size()));
-            WriteBlob(value.data(), value.size());
-        }
+        assert(value.size() <= UINT32_MAX);
+        WriteString(value.data(), value.size());
+    }
+
+    // Length prefix and characters, e.g. for keys and values stored outside of a std::string
+    void WriteString(char const* data, size_t size)
+    {
+        WriteUInt32(static_cast<uint32_t>(size));
+        WriteBlob(data, size);
     }
 
     void WriteWString(std::string const& value)
@@ -135,8 +299,8 @@ class CompactBinaryProtocolWriter {
 
     void WriteMapContainerBegin(size_t size, uint8_t keyType, uint8_t valueType)
     {
-        WriteUInt8(keyType);
-        WriteUInt8(valueType);
+        uint8_t header[2] = { keyType, valueType };
+        m_output.write(header, 2);
         assert(size <= UINT32_MAX);
         WriteUInt32(static_cast<uint32_t>(size));
     }
@@ -149,17 +313,32 @@ class CompactBinaryProtocolWriter {
     {
 		UNREFERENCED_PARAMETER(metadata);
         if (id <= 5) {
-            m_output.push_back(type | ((uint8_t)id << 5));
+            WriteFieldHeader(static_cast<uint8_t>(type | ((uint8_t)id << 5)));
         } else if (id <= 0xff) {
-            m_output.push_back(type | (6 << 5));
-            m_output.push_back(id & 255);
+            WriteFieldHeader(static_cast<uint8_t>(type | (6 << 5)), static_cast<uint8_t>(id & 255));
         } else {
-            m_output.push_back(type | (7 << 5));
-            m_output.push_back(id & 255);
-            m_output.push_back(id >> 8);
+            WriteFieldHeader(static_cast<uint8_t>(type | (7 << 5)), static_cast<uint8_t>(id & 255), static_cast<uint8_t>(id >> 8));
         }
     }
 
+    // Field headers already encoded by the generated serializers, one overload per header size
+    void WriteFieldHeader(uint8_t header)
+    {
+        m_output.write(header);
+    }
+
+    void WriteFieldHeader(uint8_t header, uint8_t id)
+    {
+        uint8_t bytes[2] = { header, id };
+        m_output.write(bytes, 2);
+    }
+
+    void WriteFieldHeader(uint8_t header, uint8_t idLow, uint8_t idHigh)
+    {
+        uint8_t bytes[3] = { header, idLow, idHigh };
+        m_output.write(bytes, 3);
+    }
+
     void WriteFieldEnd()
     {
     }
@@ -183,6 +362,54 @@ class CompactBinaryProtocolWriter {
     }
 };
 
+// Appends to a vector. Simple, but the vector may be reallocated several times
+// while a large struct is written, unless the caller reserves enough first.
+class CompactBinaryProtocolWriter : public CompactBinaryProtocolWriterBase<VectorOutput> {
+  public:
+    CompactBinaryProtocolWriter(std::vector<uint8_t>& output)
+      : CompactBinaryProtocolWriterBase<VectorOutput>(VectorOutput(output))
+    {
+    }
+};
+
+// Computes the exact serialized size without writing anything, first pass of SerializeToBuffer().
+class CompactBinaryProtocolSizer : public CompactBinaryProtocolWriterBase<SizeCountingOutput> {
+  public:
+    CompactBinaryProtocolSizer()
+      : CompactBinaryProtocolWriterBase<SizeCountingOutput>(SizeCountingOutput())
+    {
+    }
+};
+
+// Writes into a caller-supplied contiguous buffer, without any allocation.
+// Check hasOverflowed() when the buffer was not sized by CompactBinaryProtocolSizer.
+class CompactBinaryProtocolBufferWriter : public CompactBinaryProtocolWriterBase<BufferOutput> {
+  public:
+    CompactBinaryProtocolBufferWriter(uint8_t* buffer, size_t size)
+      : CompactBinaryProtocolWriterBase<BufferOutput>(BufferOutput(buffer, size))
+    {
+    }
+
+    bool hasOverflowed() const
+    {
+        return m_output.hasOverflowed();
+    }
+};
+
+// Two-pass serialization: computes the exact size of value, then appends it to output
+// with a single allocation and no capacity checks while writing.
+template<typename TValue>
+void SerializeToBuffer(std::vector<uint8_t>& output, TValue const& value)
+{
+    CompactBinaryProtocolSizer sizer;
+    Serialize(sizer, value);
+
+    size_t offset = output.size();
+    output.resize(offset + sizer.getSize());
+    CompactBinaryProtocolBufferWriter writer(output.data() + offset, sizer.getSize());
+    Serialize(writer, value);
+    assert(!writer.hasOverflowed() && writer.getSize() == sizer.getSize());
+}
+
 } // namespace bond_lite
 #endif
-
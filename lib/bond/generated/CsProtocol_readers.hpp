@@ -758,7 +758,8 @@ bool Deserialize(TReader& reader, ::CsProtocol::Xbl& value, bool isBase)
                     if (!reader.ReadString(key4)) {
                         return false;
                     }
-                    if (!reader.ReadString(value.claims[key4])) {
+                    auto& item4 = value.claims.emplace_hint(value.claims.end(), std::move(key4), std::string())->second;
+                    if (!reader.ReadString(item4)) {
                         return false;
                     }
                 }
@@ -1735,7 +1736,8 @@ bool Deserialize(TReader& reader, ::CsProtocol::IntWeb& value, bool isBase)
                     if (!reader.ReadString(key4)) {
                         return false;
                     }
-                    if (!reader.ReadString(value.mscom[key4])) {
+                    auto& item4 = value.mscom.emplace_hint(value.mscom.end(), std::move(key4), std::string())->second;
+                    if (!reader.ReadString(item4)) {
                         return false;
                     }
                 }
@@ -2413,7 +2415,8 @@ bool Deserialize(TReader& reader, ::CsProtocol::Data& value, bool isBase)
                     if (!reader.ReadString(key4)) {
                         return false;
                     }
-                    if (!Deserialize(reader, value.properties[key4], false)) {
+                    auto& item4 = value.properties.emplace_hint(value.properties.end(), std::move(key4), ::CsProtocol::Value())->second;
+                    if (!Deserialize(reader, item4, false)) {
                         return false;
                     }
                 }
@@ -2986,7 +2989,8 @@ bool Deserialize(TReader& reader, ::CsProtocol::Record& value, bool isBase)
                     if (!reader.ReadString(key4)) {
                         return false;
                     }
-                    if (!reader.ReadString(value.tags[key4])) {
+                    auto& item4 = value.tags.emplace_hint(value.tags.end(), std::move(key4), std::string())->second;
+                    if (!reader.ReadString(item4)) {
                         return false;
                     }
                 }
@@ -6,63 +6,211 @@
 #include "DebugEvents.hpp"
 #include "utils/Utils.hpp"
 #include "pal/PAL.hpp"
+#include "utils/PublishedSnapshot.hpp"
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 
 namespace MAT_NS_BEGIN {
 
+    namespace {
+
+        /// <summary>
+        /// Immutable copy of the listeners and cascaded sources of a DebugEventSource.
+        /// Every change publishes a new one, dispatching threads only read it.
+        /// </summary>
+        struct DebugEventRegistry
+        {
+            std::map<unsigned, std::vector<DebugEventListener*> > listeners;
+            std::vector<DebugEventSource*> cascaded;
+        };
+
+        /// <summary>Number of deliveries in progress on this thread, including cascaded ones.</summary>
+        thread_local unsigned t_dispatchDepth = 0;
+
+        bool deliver(DebugEventRegistry const& registry, DebugEvent& evt)
+        {
+            bool dispatched = false;
+            t_dispatchDepth++;
+            auto it = registry.listeners.find(evt.type);
+            if (it != registry.listeners.end())
+            {
+                for (auto listener : it->second)
+                {
+                    listener->OnDebugEvent(evt);
+                    dispatched = true;
+                }
+            }
+
+            // Cascade event to all other attached sources
+            for (auto item : registry.cascaded)
+            {
+                item->DispatchEvent(evt);
+            }
+            t_dispatchDepth--;
+            return dispatched;
+        }
+
+    }
+
+    class DebugEventSourceState
+    {
+    public:
+        PublishedSnapshot<DebugEventRegistry> registry { new DebugEventRegistry() };
+
+        std::atomic<bool>       async { false };
+        std::atomic<uint64_t>   dropped { 0 };
+
+        std::mutex              lock;
+        std::condition_variable queued;
+        std::condition_variable drained;
+        std::deque<DebugEvent>  queue;
+        size_t                  maxQueued = 0;
+        bool                    delivering = false;
+        bool                    stopping = false;
+        std::thread             worker;
+
+        typedef PublishedSnapshot<DebugEventRegistry>::Reader Reader;
+
+        /// <summary>Publishes a new registry, called under stateLock().</summary>
+        void publish(std::map<unsigned, std::vector<DebugEventListener*> > const& listeners, std::set<DebugEventSource*> const& cascaded)
+        {
+            std::unique_ptr<DebugEventRegistry> next(new DebugEventRegistry());
+            for (auto const& kv : listeners)
+            {
+                if (!kv.second.empty())
+                {
+                    next->listeners.insert(kv);
+                }
+            }
+            for (auto item : cascaded)
+            {
+                if (item)
+                {
+                    next->cascaded.push_back(item);
+                }
+            }
+            registry.publish(next.release());
+        }
+
+        /// <summary>
+        /// Waits until no other thread delivers events with a replaced registry, so that the caller
+        /// may destroy a removed listener or detached source as soon as Remove/Detach returns.
+        /// A listener removing listeners from its own callback does not wait for itself, the
+        /// replaced registry is then freed by a later wait or with the source.
+        /// </summary>
+        void waitForReaders()
+        {
+            if (t_dispatchDepth != 0)
+            {
+                return;
+            }
+            registry.synchronize();
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;)
+            {
+                queued.wait(guard, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty())
+                {
+                    break;
+                }
+
+                DebugEvent evt = queue.front();
+                queue.pop_front();
+                delivering = true;
+                guard.unlock();
+                {
+                    Reader current(registry);
+                    deliver(*current, evt);
+                }
+                guard.lock();
+                delivering = false;
+                if (queue.empty())
+                {
+                    drained.notify_all();
+                }
+            }
+        }
+    };
+
+    DebugEventSource::DebugEventSource() :
+        seq(0),
+        dispatchState(new DebugEventSourceState())
+    {
+    }
+
+    DebugEventSource::~DebugEventSource() noexcept
+    {
+        SetAsyncDispatch(0);
+    }
+
     /// <summary>Add event listener for specific debug event type.</summary>
     void DebugEventSource::AddEventListener(DebugEventType type, DebugEventListener &listener)
     {
         DE_LOCKGUARD(stateLock());
         auto &v = listeners[type];
         v.push_back(&listener);
+        // Adding does not wait for dispatching threads, the replaced registry is freed
+        // by the next Remove/Detach or with the source
+        dispatchState->publish(listeners, cascaded);
     }
 
     /// <summary>Remove previously added debug event listener for specific type.</summary>
     void DebugEventSource::RemoveEventListener(DebugEventType type, DebugEventListener &listener)
     {
-        DE_LOCKGUARD(stateLock());
-        auto registeredTypes = listeners.find(type);
-        if (registeredTypes == listeners.end())
-            return;
+        {
+            DE_LOCKGUARD(stateLock());
+            auto registeredTypes = listeners.find(type);
+            if (registeredTypes == listeners.end())
+                return;
 
-        auto &registeredListeners = (*registeredTypes).second;
-        auto it = std::remove(registeredListeners.begin(), registeredListeners.end(), &listener);
-        registeredListeners.erase(it, registeredListeners.end());
+            auto &registeredListeners = (*registeredTypes).second;
+            auto it = std::remove(registeredListeners.begin(), registeredListeners.end(), &listener);
+            registeredListeners.erase(it, registeredListeners.end());
+            dispatchState->publish(listeners, cascaded);
+        }
+        dispatchState->waitForReaders();
     }
 
-    /// <summary>Microsoft Telemetry SDK invokes this method to dispatch event to client callback</summary>
+    /// <summary>
+    /// Microsoft Telemetry SDK invokes this method to dispatch event to client callback.
+    /// Takes no lock: listeners are called from the last published registry.
+    /// </summary>
     bool DebugEventSource::DispatchEvent(DebugEvent evt)
     {
-        seq++;
-        evt.seq = seq;
+        evt.seq = ++seq;
         evt.ts = PAL::getUtcSystemTime();
-        bool dispatched = false;
+        DebugEventSourceState::Reader registry(dispatchState->registry);
 
+        if (dispatchState->async.load(std::memory_order_relaxed))
         {
-            DE_LOCKGUARD(stateLock());
-            if (listeners.size()) {
-                // Events filter handlers list
-                auto &v = listeners[evt.type];
-                for (auto listener : v) {
-                    listener->OnDebugEvent(evt);
-                    dispatched = true;
-                }
-            }
-
-            if (cascaded.size())
+            std::unique_lock<std::mutex> guard(dispatchState->lock);
+            if (dispatchState->async)
             {
-                // Cascade event to all other attached sources
-                for (auto item : cascaded)
+                // data points to memory of the caller, which is gone by the time the event is delivered
+                evt.data = nullptr;
+                evt.size = 0;
+                if (dispatchState->queue.size() < dispatchState->maxQueued)
+                {
+                    dispatchState->queue.push_back(evt);
+                    guard.unlock();
+                    dispatchState->queued.notify_one();
+                }
+                else
                 {
-                    if (item)
-                        item->DispatchEvent(evt);
+                    dispatchState->dropped++;
                 }
+                return registry->listeners.find(evt.type) != registry->listeners.end();
             }
         }
 
-        return dispatched;
+        return deliver(*registry, evt);
     }
 
     /// <summary>Attach cascaded DebugEventSource to forward all events to</summary>
@@ -73,15 +221,78 @@ namespace MAT_NS_BEGIN {
 
         DE_LOCKGUARD(stateLock());
         cascaded.insert(&other);
+        dispatchState->publish(listeners, cascaded);
         return true;
     }
 
     /// <summary>Detach cascaded DebugEventSource to forward all events to</summary>
     bool DebugEventSource::DetachEventSource(DebugEventSource & other)
     {
-        DE_LOCKGUARD(stateLock());
-        return (cascaded.erase(&other)!=0);
+        {
+            DE_LOCKGUARD(stateLock());
+            if (cascaded.erase(&other) == 0)
+                return false;
+            dispatchState->publish(listeners, cascaded);
+        }
+        dispatchState->waitForReaders();
+        return true;
     }
 
-} MAT_NS_END
+    /// <summary>Switch between synchronous and asynchronous delivery of events</summary>
+    void DebugEventSource::SetAsyncDispatch(size_t maxQueuedEvents)
+    {
+        DebugEventSourceState& state = *dispatchState;
+        std::thread worker;
+        {
+            std::lock_guard<std::mutex> guard(state.lock);
+            state.maxQueued = maxQueuedEvents;
+            if (maxQueuedEvents > 0)
+            {
+                if (!state.worker.joinable())
+                {
+                    state.stopping = false;
+                    state.worker = std::thread([&state]() { state.run(); });
+                }
+                state.async = true;
+                return;
+            }
 
+            // The worker delivers the events already queued before it exits
+            state.async = false;
+            state.stopping = true;
+            worker = std::move(state.worker);
+        }
+        state.queued.notify_all();
+        if (worker.joinable())
+        {
+            if (worker.get_id() == std::this_thread::get_id())
+            {
+                // Called from a listener on the delivery thread
+                worker.detach();
+            }
+            else
+            {
+                worker.join();
+            }
+        }
+    }
+
+    /// <summary>Wait until the events queued for asynchronous delivery are delivered</summary>
+    void DebugEventSource::FlushAsyncDispatch()
+    {
+        DebugEventSourceState& state = *dispatchState;
+        std::unique_lock<std::mutex> guard(state.lock);
+        if (!state.worker.joinable() || state.worker.get_id() == std::this_thread::get_id())
+        {
+            return;
+        }
+        state.drained.wait(guard, [&state]() { return state.queue.empty() && !state.delivering; });
+    }
+
+    /// <summary>Number of events dropped because the asynchronous delivery queue was full</summary>
+    uint64_t DebugEventSource::GetDroppedEventCount() const
+    {
+        return dispatchState->dropped;
+    }
+
+} MAT_NS_END
@@ -11,16 +11,54 @@
 #include <zlib.h>
 #endif
 
+#include <algorithm>
+
 namespace MAT_NS_BEGIN {
 
+    // Initial output buffer size for a compressed request. Bond telemetry
+    // usually deflates to well under a quarter of its size, the buffer is
+    // grown geometrically if that turns out to be too optimistic.
+    static constexpr size_t MinOutputChunk = 4096;
+
+    void HttpDeflateCompression::StreamDeleter::operator()(z_stream_s* stream) const
+    {
+#ifdef HAVE_MAT_ZLIB
+        // A stream that was never initialized (or already ended) has no state
+        // and deflateEnd() just reports Z_STREAM_ERROR for it.
+        deflateEnd(stream);
+        delete stream;
+#else
+        UNREFERENCED_PARAMETER(stream);
+#endif
+    }
+
     HttpDeflateCompression::HttpDeflateCompression(IRuntimeConfig& runtimeConfig)
-        : m_config(runtimeConfig)
+        : m_config(runtimeConfig),
+          m_windowBits(0),
+          m_level(-1),
+          m_strategy(0)
     {
         // Plain "deflate": negative -MAX_WBITS argument which makes zlib use "raw deflate"
         // without zlib header, as required by IIS.
         // "gzip": Add 16 to windowBits to write a simple gzip header
 #ifdef HAVE_MAT_ZLIB
         m_windowBits = m_config.GetHttpRequestContentEncoding() == "gzip" ? (MAX_WBITS | 16) : -MAX_WBITS;
+
+        int32_t level = m_config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL];
+        if (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION) {
+            LOG_WARN("Invalid HTTP compression level %d, using default", level);
+            level = Z_DEFAULT_COMPRESSION;
+        }
+        m_level = level;
+
+        int32_t strategy = m_config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_STRATEGY];
+        if (strategy < Z_DEFAULT_STRATEGY || strategy > Z_FIXED) {
+            LOG_WARN("Invalid HTTP compression strategy %d, using default", strategy);
+            strategy = Z_DEFAULT_STRATEGY;
+        }
+        m_strategy = strategy;
+
+        m_stream.reset(new z_stream());
 #endif
     }
 
@@ -30,65 +68,135 @@ namespace MAT_NS_BEGIN {
 
     bool HttpDeflateCompression::handleCompress(EventsUploadContextPtr const& ctx)
     {
-        UNREFERENCED_PARAMETER(ctx);
 #ifdef HAVE_MAT_ZLIB
-        if (!m_config.IsHttpRequestCompressionEnabled()) {
-            return true;
+        if (m_config.IsHttpRequestCompressionEnabled()) {
+            return compressBody(ctx);
         }
+#endif
+        // Compression has been turned off after the package was finalized,
+        // the body still needs to be spliced for the encoder.
+        if (ctx->bodyInSplicer) {
+            ctx->body = ctx->splicer->splice();
+            ctx->splicer->clear();
+            ctx->bodyInSplicer = false;
+        }
+        return true;
+    }
 
-        // Using a slightly adapted in-place compression technique as suggested
-        // by Mark Adler himself: http://stackoverflow.com/a/12412863/3543211
-
-        z_stream stream;
-        memset(&stream, 0, sizeof(stream));
+    bool HttpDeflateCompression::compressBody(EventsUploadContextPtr const& ctx)
+    {
+#ifdef HAVE_MAT_ZLIB
+        LOCKGUARD(m_lock);
 
-        int result = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, m_windowBits, 8 /*DEF_MEM_LEVEL*/, Z_DEFAULT_STRATEGY);
+        int result = resetStream();
         if (result != Z_OK) {
-            LOG_WARN("HTTP request compressing failed, error=%u/%u (%s)", 1, result, stream.msg);
+            LOG_WARN("HTTP request compressing failed, error=%u/%d (%s)", 1, result, streamMessage());
             compressionFailed(ctx);
             return false;
         }
 
-        stream.avail_in = static_cast<uInt>(ctx->body.size());
-        ctx->body.resize(deflateBound(&stream, stream.avail_in));
-        stream.next_in = ctx->body.data();
-
-        std::vector<uint8_t> temp(32);
-        stream.next_out = temp.data();
-        stream.avail_out = static_cast<uInt>(temp.size());
-
-        result = deflate(&stream, Z_FINISH);
-        if (result == Z_OK || result == Z_STREAM_END) {
-            std::copy(temp.cbegin(), temp.cbegin() + stream.total_out, ctx->body.begin());
-            stream.next_out = ctx->body.data() + stream.total_out;
-            stream.avail_out = static_cast<uInt>(ctx->body.size()) - static_cast<uInt>(stream.total_out);
-        }
-        if (result == Z_OK) {
-            result = deflate(&stream, Z_FINISH);
+        std::vector<uint8_t> output;
+        if (ctx->bodyInSplicer) {
+            output.resize(std::max(ctx->splicer->getSizeEstimate() / 4, MinOutputChunk));
+            ctx->splicer->splice([this, &output, &result](uint8_t const* data, size_t size) {
+                result = deflateChunk(data, size, Z_NO_FLUSH, output);
+                return result == Z_OK;
+            });
             if (result == Z_OK) {
-                // The output shall never catch up with the input. Mark says in the
-                // Stack Overflow reference above that this should happen only for
-                // incompressible data longer than 20 MB, i.e. virtually never for
-                // telemetry events in Bond. But better make it 100% safe here.
-                temp.assign(ctx->body.cbegin() + stream.total_in, ctx->body.cbegin() + stream.total_in + stream.avail_in);
-                stream.next_in = temp.data();
-                stream.avail_in = static_cast<uInt>(temp.size());
-                result = deflate(&stream, Z_FINISH);
+                result = deflateChunk(nullptr, 0, Z_FINISH, output);
             }
+            ctx->splicer->clear();
+            ctx->bodyInSplicer = false;
+        } else {
+            output.resize(std::max(ctx->body.size() / 4, MinOutputChunk));
+            result = deflateChunk(ctx->body.data(), ctx->body.size(), Z_FINISH, output);
         }
 
-        deflateEnd(&stream);
-
         if (result != Z_STREAM_END) {
-            LOG_WARN("HTTP request compressing failed, error=%u/%u (%s)", 2, result, stream.msg);
+            LOG_WARN("HTTP request compressing failed, error=%u/%d (%s)", 2, result, streamMessage());
             compressionFailed(ctx);
             return false;
         }
 
-        ctx->body.resize(stream.total_out);
+        output.resize(static_cast<size_t>(m_stream->total_out));
+        ctx->body.swap(output);
         ctx->compressed = true;
-#endif
         return true;
+#else
+        UNREFERENCED_PARAMETER(ctx);
+        return true;
+#endif
+    }
+
+    int HttpDeflateCompression::resetStream()
+    {
+#ifdef HAVE_MAT_ZLIB
+        if (m_streamInitialized) {
+            int result = deflateReset(m_stream.get());
+            if (result == Z_OK) {
+                return Z_OK;
+            }
+            LOG_WARN("Failed to reset deflate stream, error=%d (%s)", result, streamMessage());
+            deflateEnd(m_stream.get());
+            m_streamInitialized = false;
+        }
+
+        *m_stream = z_stream();
+        int result = deflateInit2(m_stream.get(), m_level, Z_DEFLATED, m_windowBits, 8 /*DEF_MEM_LEVEL*/, m_strategy);
+        if (result != Z_OK) {
+            LOG_WARN("Failed to initialize deflate stream, error=%d (%s)", result, streamMessage());
+        } else {
+            m_streamInitialized = true;
+        }
+        return result;
+#else
+        return -1;
+#endif
+    }
+
+    int HttpDeflateCompression::deflateChunk(uint8_t const* data, size_t size, int flush, std::vector<uint8_t>& output)
+    {
+#ifdef HAVE_MAT_ZLIB
+        m_stream->next_in = data;
+        m_stream->avail_in = static_cast<uInt>(size);
+
+        for (;;) {
+            size_t used = static_cast<size_t>(m_stream->total_out);
+            if (used == output.size()) {
+                output.resize(std::max(output.size() * 2, MinOutputChunk));
+            }
+            m_stream->next_out = output.data() + used;
+            m_stream->avail_out = static_cast<uInt>(output.size() - used);
+
+            int result = deflate(m_stream.get(), flush);
+            if (result == Z_STREAM_END) {
+                return result;
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR) {
+                return result;
+            }
+            if (m_stream->avail_out != 0) {
+                // Output space left over means deflate has consumed all the input
+                // (and could not finish the stream if that was requested).
+                return (flush != Z_FINISH) ? Z_OK : Z_BUF_ERROR;
+            }
+        }
+#else
+        UNREFERENCED_PARAMETER(data);
+        UNREFERENCED_PARAMETER(size);
+        UNREFERENCED_PARAMETER(flush);
+        UNREFERENCED_PARAMETER(output);
+        return -1;
+#endif
+    }
+
+    char const* HttpDeflateCompression::streamMessage() const
+    {
+#ifdef HAVE_MAT_ZLIB
+        return (m_stream->msg != nullptr) ? m_stream->msg : "";
+#else
+        return "";
+#endif
     }
 
 
@@ -9,6 +9,11 @@
 #include "system/Route.hpp"
 #include "system/Contexts.hpp"
 
+#include <memory>
+#include <mutex>
+
+struct z_stream_s;
+
 namespace MAT_NS_BEGIN {
 
 
@@ -19,10 +24,29 @@ namespace MAT_NS_BEGIN {
 
     protected:
         bool handleCompress(EventsUploadContextPtr const& ctx);
+        bool compressBody(EventsUploadContextPtr const& ctx);
+
+        // Both return the zlib result code of the last call into the stream
+        int resetStream();
+        int deflateChunk(uint8_t const* data, size_t size, int flush, std::vector<uint8_t>& output);
+        char const* streamMessage() const;
 
     protected:
         IRuntimeConfig& m_config;
         int m_windowBits;
+        int m_level;
+        int m_strategy;
+
+        // Ends the deflate state along with the stream, whatever path drops it.
+        struct StreamDeleter {
+            void operator()(z_stream_s* stream) const;
+        };
+
+        // Long-lived deflate state, reset between uploads instead of being
+        // re-allocated (~256 KB of zlib tables) for every single request.
+        std::mutex                                m_lock;
+        std::unique_ptr<z_stream_s, StreamDeleter> m_stream;
+        bool                                      m_streamInitialized = false;
 
     public:
         RouteSource<EventsUploadContextPtr const&>                              compressionFailed;
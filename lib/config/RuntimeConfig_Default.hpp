@@ -12,6 +12,7 @@ namespace MAT_NS_BEGIN
     static ILogConfiguration defaultRuntimeConfig{
         {CFG_INT_TRACE_LEVEL_MIN, ACTTraceLevel::ACTTraceLevel_Error},
         {CFG_INT_SDK_MODE, SdkModeTypes::SdkModeTypes_CS},
+        {CFG_INT_TASK_SCHEDULER, TaskSchedulerType::TaskScheduler_List},
         {CFG_BOOL_ENABLE_ANALYTICS, false},
         {CFG_INT_CACHE_FILE_SIZE, 3145728},
         {CFG_INT_RAM_QUEUE_SIZE, 524288},
@@ -19,7 +20,10 @@ namespace MAT_NS_BEGIN
         {CFG_BOOL_ENABLE_DB_DROP_IF_FULL, false},
         {CFG_INT_MAX_TEARDOWN_TIME, 1},
         {CFG_INT_MAX_PENDING_REQ, 4},
+        {CFG_BOOL_TPM_ADAPTIVE_UPLOADS, false},
         {CFG_INT_RAM_QUEUE_BUFFERS, 3},
+        {CFG_BOOL_RAM_QUEUE_SHARDED, false},
+        {CFG_INT_RAM_QUEUE_FIFO_LATENCIES, 0},
         {CFG_INT_TRACE_LEVEL_MASK, 0},
         {CFG_BOOL_ENABLE_TRACE, true},
         {CFG_STR_COLLECTOR_URL, COLLECTOR_URL_PROD},
@@ -54,6 +58,9 @@ namespace MAT_NS_BEGIN
 #endif
              ,
              {"contentEncoding", "deflate"},
+             {CFG_INT_HTTP_COMPRESSION_LEVEL, -1},
+             {CFG_INT_HTTP_COMPRESSION_STRATEGY, 0},
+             {CFG_BOOL_HTTP_COMPRESSION_STREAMING, false},
              /* Optional parameter to require Microsoft Root CA */
              {CFG_BOOL_HTTP_MS_ROOT_CHECK, false}}},
         {CFG_MAP_TPM,
@@ -63,6 +70,13 @@ namespace MAT_NS_BEGIN
              {CFG_BOOL_TPM_CLOCK_SKEW_ENABLED, true},
              {CFG_STR_TPM_BACKOFF, "E,3000,300000,2,1"},
          }},
+        {CFG_MAP_INGESTION,
+         {
+             {CFG_BOOL_INGESTION_ASYNC, false},
+             {CFG_INT_INGESTION_QUEUE_SIZE, 4096},
+             {CFG_INT_INGESTION_OVERFLOW_POLICY, IngestionOverflow_DropOldest},
+             {CFG_INT_INGESTION_BLOCK_TIMEOUT, 50},
+         }},
         {CFG_MAP_COMPAT,
          {
              {CFG_BOOL_COMPAT_DOTS, true}  // false: v1 backwards-compat: event.SetType("My.Custom.Type") => custom.my_custom_type
@@ -7,6 +7,7 @@
 
 #include "IDecorator.hpp"
 #include "EventProperties.hpp"
+#include "system/EventPropertiesStorage.hpp"
 #include "CorrelationVector.hpp"
 #include "utils/Utils.hpp"
 
@@ -154,9 +155,10 @@ namespace MAT_NS_BEGIN {
             std::map<std::string, ::CsProtocol::Value>& ext = record.data[0].properties;
             std::map<std::string, ::CsProtocol::Value> extPartB;
 
-            for (auto &kv : eventProperties.GetProperties()) {
+            for (auto const& v : eventProperties.m_storage->properties) {
 
-                EventRejectedReason isValidPropertyName = validatePropertyName(kv.first);
+                std::string k(v.name, v.nameLength);
+                EventRejectedReason isValidPropertyName = validatePropertyName(k);
                 if (isValidPropertyName != REJECTED_REASON_OK)
                 {
                     DebugEvent evt;
@@ -165,258 +167,114 @@ namespace MAT_NS_BEGIN {
                     m_owner.DispatchEvent(evt);
                     return false;
                 }
-                const auto &k = kv.first;
-                const auto &v = kv.second;
+
+                CsProtocol::Value temp;
                 if (v.piiKind != PiiKind_None)
                 {
+                    CsProtocol::Attributes attrib;
                     if (v.piiKind == PiiKind::CustomerContentKind_GenericData)
                     {  //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
                         CsProtocol::CustomerContent cc;
                         cc.Kind = CsProtocol::CustomerContentKind::GenericContent;
-                        CsProtocol::Value temp;
-
-                        CsProtocol::Attributes attrib;
                         attrib.customerContent.push_back(cc);
-
-                        temp.attributes.push_back(attrib);
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-
                     }
                     else
                     { //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
                         CsProtocol::PII pii;
                         pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
-                        CsProtocol::Value temp;
-
-                        CsProtocol::Attributes attrib;
                         attrib.pii.push_back(pii);
-
-
-                        temp.attributes.push_back(attrib);
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
-#if 0 /* v2 code */
-                        if (v.piiKind != PiiKind_None)
-                        {
-                            //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                            CsProtocol::PII pii;
-                            pii.Kind = static_cast<CsProtocol::PIIKind>(v.piiKind);
-                            pii.RawContent = v.to_string();
-                            // ScrubType = 1 is the O365 scrubber which is the default behavior.
-                            // pii.ScrubType = static_cast<PIIScrubber>(O365);
-                            pii.ScrubType = CsProtocol::O365;
-                            PIIExtensions[k] = pii;
-                            // 4. Send event's Pii context fields as record.PIIExtensions
-                        }
-                        else
-                        {
-                            //LOG_TRACE("PIIExtensions: %s=%s (PiiKind=%u)", k.c_str(), v.to_string().c_str(), v.piiKind);
-                            CsProtocol::CustomerContent cc;
-                            cc.Kind = static_cast<CsProtocol::CustomerContentKind>(v.ccKind);
-                            cc.RawContent = v.to_string();
-                            ccExtensions[k] = cc;
-                            // 4. Send event's Pii context fields as record.PIIExtensions
-#endif
                     }
+                    temp.attributes.push_back(attrib);
+                    temp.stringValue = v.to_string();
                 }
                 else {
-                    std::vector<uint8_t> guid;
                     uint8_t guid_bytes[16] = { 0 };
 
                     switch (v.type)
                     {
                     case EventProperty::TYPE_STRING:
                     {
-                        CsProtocol::Value temp;
-                        temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
+                        temp.stringValue.assign(v.as_string, v.stringLength);
                         break;
                     }
                     case EventProperty::TYPE_INT64:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueInt64;
                         temp.longValue = v.as_int64;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
                         break;
                     }
                     case EventProperty::TYPE_DOUBLE:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueDouble;
                         temp.doubleValue = v.as_double;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
                         break;
                     }
                     case EventProperty::TYPE_TIME:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueDateTime;
-                        temp.longValue = v.as_time_ticks.ticks;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
+                        temp.longValue = v.as_ticks;
                         break;
                     }
                     case EventProperty::TYPE_BOOLEAN:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueBool;
                         temp.longValue = v.as_bool;
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
                         break;
                     }
                     case EventProperty::TYPE_GUID:
                     {
-                        GUID_t temp = v.as_guid;
-                        temp.to_bytes(guid_bytes);
-                        guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-
-                        CsProtocol::Value tempValue;
-                        tempValue.type = ::CsProtocol::ValueKind::ValueGuid;
-                        tempValue.guidValue.push_back(guid);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = tempValue;
-                        }
-                        else
-                        {
-                            ext[k] = tempValue;
-                        }
+                        v.boxed->as_guid.to_bytes(guid_bytes);
+                        temp.type = ::CsProtocol::ValueKind::ValueGuid;
+                        temp.guidValue.emplace_back(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
                         break;
                     }
                     case EventProperty::TYPE_INT64_ARRAY:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayInt64;
-                        temp.longArray.push_back(*v.as_longArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
+                        temp.longArray.push_back(*v.boxed->as_longArray);
                         break;
                     }
                     case EventProperty::TYPE_DOUBLE_ARRAY:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayDouble;
-                        temp.doubleArray.push_back(*v.as_doubleArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
+                        temp.doubleArray.push_back(*v.boxed->as_doubleArray);
                         break;
                     }
                     case EventProperty::TYPE_STRING_ARRAY:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayString;
-                        temp.stringArray.push_back(*v.as_stringArray);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
+                        temp.stringArray.push_back(*v.boxed->as_stringArray);
                         break;
                     }
                     case EventProperty::TYPE_GUID_ARRAY:
                     {
-                        CsProtocol::Value temp;
                         temp.type = ::CsProtocol::ValueKind::ValueArrayGuid;
 
                         std::vector<std::vector<uint8_t>> values;
-                        for (const auto& tempValue : *v.as_guidArray)
+                        for (const auto& tempValue : *v.boxed->as_guidArray)
                         {
                             tempValue.to_bytes(guid_bytes);
-                            guid = std::vector<uint8_t>(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
-                            values.push_back(guid);
-                        }
-                        temp.guidArray.push_back(values);
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
+                            values.emplace_back(guid_bytes, guid_bytes + sizeof(guid_bytes) / sizeof(guid_bytes[0]));
                         }
+                        temp.guidArray.push_back(std::move(values));
                         break;
                     }
                     default:
                     {
                         // Convert all unknown types to string
-                        CsProtocol::Value temp;
                         temp.stringValue = v.to_string();
-                        if (v.dataCategory == DataCategory_PartB)
-                        {
-                            extPartB[k] = temp;
-                        }
-                        else
-                        {
-                            ext[k] = temp;
-                        }
                     }
                     }
                 }
+
+                if (v.dataCategory == DataCategory_PartB)
+                {
+                    extPartB[std::move(k)] = std::move(temp);
+                }
+                else
+                {
+                    ext[std::move(k)] = std::move(temp);
+                }
             }
 
             if (extPartB.size() > 0)
@@ -32,16 +32,18 @@ namespace MAT_NS_BEGIN {
     {
     public:
 
-        HttpCallback(HttpClientManager& hcm, EventsUploadContextPtr const& ctx)
+        HttpCallback(HttpClientManager& hcm, size_t slot)
             : m_hcm(hcm),
-            m_ctx(ctx),
-            m_startTime(PAL::getMonotonicTimeMs())
+            m_slot(slot),
+            m_startTime(0),
+            m_responseTime(0)
         {
         }
 
         virtual void OnHttpResponse(IHttpResponse* response) override
         {
-            m_ctx->durationMs = static_cast<int>(PAL::getMonotonicTimeMs() - m_startTime);
+            m_responseTime = PAL::getMonotonicTimeMs();
+            m_ctx->durationMs = static_cast<int>(m_responseTime - m_startTime);
             m_ctx->httpResponse = response;
 #ifdef USE_SYNC_HTTPRESPONSE_HANDLER // handle HTTP callback synchronously in context of a callback thread
             // We need to decide on pros and cons of synchronous vs. asynchronous callback
@@ -66,13 +68,15 @@ namespace MAT_NS_BEGIN {
 
         virtual ~HttpCallback()
         {
-            LOG_TRACE("destroy HTTP callback=%p ctx=%p", this, m_ctx.get());
+            LOG_TRACE("destroy HTTP callback=%p slot=%u", this, static_cast<unsigned>(m_slot));
         }
 
     public:
         HttpClientManager&      m_hcm;
+        size_t const            m_slot;
         EventsUploadContextPtr  m_ctx;
-        int64_t                 m_startTime;
+        uint64_t                m_startTime;
+        uint64_t                m_responseTime;
     };
 
     //---
@@ -91,14 +95,26 @@ namespace MAT_NS_BEGIN {
 
     void HttpClientManager::handleSendRequest(EventsUploadContextPtr const& ctx)
     {
-        HttpCallback *callback = new HttpCallback(*this, ctx);
+        HttpCallback *callback;
         {
             LOCKGUARD(m_httpCallbacksMtx);
-            m_httpCallbacks.push_back(callback);
+            if (m_freeSlots.empty())
+            {
+                m_httpCallbacks.emplace_back(new HttpCallback(*this, m_httpCallbacks.size()));
+                callback = m_httpCallbacks.back().get();
+            }
+            else
+            {
+                callback = m_httpCallbacks[m_freeSlots.back()].get();
+                m_freeSlots.pop_back();
+            }
+            callback->m_ctx = ctx;
+            callback->m_startTime = PAL::getMonotonicTimeMs();
+            m_metrics.inFlight++;
         }
 
         LOG_INFO("Uploading %u event(s) of priority %d (%s) for %u tenant(s) in HTTP request %s (approx. %u bytes)...",
-            static_cast<unsigned>(ctx->recordIdsAndTenantIds.size()), ctx->latency, latencyToStr(ctx->latency), static_cast<unsigned>(ctx->packageIds.size()),
+            static_cast<unsigned>(ctx->records.size()), ctx->latency, latencyToStr(ctx->latency), static_cast<unsigned>(ctx->packageIds.size()),
             ctx->httpRequest->GetId().c_str(), static_cast<unsigned>(ctx->httpRequest->GetSizeEstimate()));
 
         m_httpClient.SendRequestAsync(ctx->httpRequest, callback);
@@ -112,32 +128,44 @@ namespace MAT_NS_BEGIN {
     /* This method may get executed synchronously on Windows from handleSendRequest in case of connection failure */
     void HttpClientManager::onHttpResponse(HttpCallback* callback)
     {
-        EventsUploadContextPtr &ctx = callback->m_ctx;
+#ifndef NDEBUG
         {
             LOCKGUARD(m_httpCallbacksMtx);
-            auto z = std::find(m_httpCallbacks.cbegin(), m_httpCallbacks.cend(), callback);
-            if (z == m_httpCallbacks.end()) {
-                assert(false);
-            }
+            assert(callback->m_slot < m_httpCallbacks.size() && m_httpCallbacks[callback->m_slot].get() == callback);
+        }
+#endif
+        EventsUploadContextPtr ctx = std::move(callback->m_ctx);
+        uint64_t const queueTime = PAL::getMonotonicTimeMs() - callback->m_responseTime;
+        uint64_t const latency = callback->m_responseTime - callback->m_startTime;
 
 #if !defined(NDEBUG) && defined(HAVE_MAT_LOGGING)
-            // Response may be null if request got aborted
-            if (ctx->httpResponse != nullptr)
-            {
-                IHttpResponse const& response = (*ctx->httpResponse);
-                LOG_TRACE("HTTP response %s: result=%u, status=%u, body=%u bytes",
-                    response.GetId().c_str(), response.GetResult(), response.GetStatusCode(), static_cast<unsigned>(response.GetBody().size()));
-            }
+        // Response may be null if request got aborted
+        if (ctx->httpResponse != nullptr)
+        {
+            IHttpResponse const& response = (*ctx->httpResponse);
+            LOG_TRACE("HTTP response %s: result=%u, status=%u, body=%u bytes",
+                response.GetId().c_str(), response.GetResult(), response.GetStatusCode(), static_cast<unsigned>(response.GetBody().size()));
+        }
 #endif
 
-            requestDone(ctx);
-            // request done should be handled by now
-
-            LOG_TRACE("HTTP remove callback=%p", callback);
-            m_httpCallbacks.remove(callback);
+        // Not under the lock: the TPM may send the next request from here
+        requestDone(ctx);
+        // request done should be handled by now
+        ctx.reset();
+
+        LOG_TRACE("HTTP release callback=%p", callback);
+        LOCKGUARD(m_httpCallbacksMtx);
+        m_freeSlots.push_back(callback->m_slot);
+        m_metrics.inFlight--;
+        m_metrics.completed++;
+        m_metrics.totalQueueTimeMs += queueTime;
+        m_metrics.maxQueueTimeMs = (std::max)(m_metrics.maxQueueTimeMs, queueTime);
+        m_metrics.totalLatencyMs += latency;
+        m_metrics.maxLatencyMs = (std::max)(m_metrics.maxLatencyMs, latency);
+        if (m_metrics.inFlight == 0)
+        {
+            m_httpCallbacksDone.notify_all();
         }
-
-        delete callback;
     }
 
     bool HttpClientManager::cancelAllRequestsAsync()
@@ -149,8 +177,20 @@ namespace MAT_NS_BEGIN {
     void HttpClientManager::cancelAllRequests()
     {
         cancelAllRequestsAsync();
-        while (!m_httpCallbacks.empty())
-            std::this_thread::yield();
+        std::unique_lock<std::mutex> lock(m_httpCallbacksMtx);
+        m_httpCallbacksDone.wait(lock, [this]() { return m_metrics.inFlight == 0; });
+    }
+
+    size_t HttpClientManager::requestCount() const
+    {
+        LOCKGUARD(m_httpCallbacksMtx);
+        return m_metrics.inFlight;
+    }
+
+    HttpClientManager::Metrics HttpClientManager::getMetrics() const
+    {
+        LOCKGUARD(m_httpCallbacksMtx);
+        return m_metrics;
     }
 
     // start async cancellation
@@ -10,8 +10,10 @@
 #include "system/Route.hpp"
 #include "ILogManager.hpp"
 
-#include <list>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace MAT_NS_BEGIN
 {
@@ -28,12 +30,25 @@ class HttpClientManager
 
         virtual ~HttpClientManager() noexcept;
 
+        /// <summary>
+        /// Cumulative timings of the HTTP requests, for diagnostics.
+        /// Queue time is the time a response waits before its completion is processed.
+        /// </summary>
+        struct Metrics
+        {
+            size_t   inFlight = 0;
+            uint64_t completed = 0;
+            uint64_t totalQueueTimeMs = 0;
+            uint64_t maxQueueTimeMs = 0;
+            uint64_t totalLatencyMs = 0;
+            uint64_t maxLatencyMs = 0;
+        };
+
         void cancelAllRequests();
 
-        size_t requestCount() const
-        {
-            return m_httpCallbacks.size();
-        }
+        size_t requestCount() const;
+
+        Metrics getMetrics() const;
 
         RouteSource<EventsUploadContextPtr const&> requestDone;
 
@@ -54,8 +69,13 @@ class HttpClientManager
         ILogManager&              m_logManager;
         IHttpClient&              m_httpClient;
         ITaskDispatcher&          m_taskDispatcher;
-        std::recursive_mutex      m_httpCallbacksMtx;
-        std::list<HttpCallback*>  m_httpCallbacks;
+
+        // In-flight table: callbacks are indexed by their slot and reused once their request is done
+        mutable std::mutex                          m_httpCallbacksMtx;
+        std::condition_variable                     m_httpCallbacksDone;
+        std::vector<std::unique_ptr<HttpCallback>>  m_httpCallbacks;
+        std::vector<size_t>                         m_freeSlots;
+        Metrics                                     m_metrics;
 };
 
 } MAT_NS_END
@@ -44,7 +44,7 @@ HttpHeaders& HttpClient_Android::HttpRequest::GetHeaders()
 
 void HttpClient_Android::HttpRequest::SetBody(std::vector<uint8_t>& body)
 {
-	m_body = body; // copy assignment for Great Copy Fun
+	m_body = std::move(body);
 }
 
 std::vector<uint8_t>& HttpClient_Android::HttpRequest::GetBody()
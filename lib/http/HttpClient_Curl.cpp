@@ -10,11 +10,18 @@
 
 #include "ctmacros.hpp"
 
+#include <algorithm>
 #include <memory>
 
 #include "utils/Utils.hpp"
 #include "HttpClient_Curl.hpp"
 
+/* Maximum number of idle easy handles kept for reuse */
+#define MAX_IDLE_CURL_HANDLES   8
+
+/* Maximum time the event loop sleeps waiting for socket activity */
+#define CURL_POLL_TIMEOUT_MS    1000
+
 namespace MAT_NS_BEGIN {
 
     static std::string NextReqId() {
@@ -26,33 +33,43 @@ namespace MAT_NS_BEGIN {
     {
     public:
         CurlHttpRequest() : SimpleHttpRequest(NextReqId()) { }
-
-        void SetOperation(const std::shared_ptr<CurlHttpOperation>& curlOperation)
-        {
-            m_curlOperation = curlOperation;
-        }
-
-        void Cancel()
-        {
-            if (m_curlOperation != nullptr) {
-                m_curlOperation->Abort();
-            }
-        }
-
-    private:
-        std::shared_ptr<CurlHttpOperation> m_curlOperation;
     };
 
-    HttpClient_Curl::HttpClient_Curl()
+    HttpClient_Curl::HttpClient_Curl() :
+        m_running(true)
     {
         /* In windows, this will init the winsock stuff */
         TRACE("Initializing HttpClient_Curl...\n");
         curl_global_init(CURL_GLOBAL_ALL);
-        TRACE("libcurl version = %s\n", curl_version_info(CURLVERSION_NOW)->version);
+        auto versionInfo = curl_version_info(CURLVERSION_NOW);
+        TRACE("libcurl version = %s\n", versionInfo->version);
+
+        m_multi = curl_multi_init();
+#if defined(CURL_VERSION_HTTP2) && defined(CURLPIPE_MULTIPLEX)
+        // Multiplex concurrent uploads to the same collector over one HTTP/2 connection
+        m_multiplex = (versionInfo->features & CURL_VERSION_HTTP2) != 0;
+        if (m_multi != nullptr && m_multiplex) {
+            curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        }
+#endif
+        m_thread = std::thread(&HttpClient_Curl::EventLoop, this);
     }
 
     HttpClient_Curl::~HttpClient_Curl()
     {
+        m_running = false;
+        Wakeup();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        for (auto handle : m_idleHandles) {
+            curl_easy_cleanup(handle);
+        }
+        m_idleHandles.clear();
+        if (m_multi != nullptr) {
+            curl_multi_cleanup(m_multi);
+        }
         curl_global_cleanup();
         TRACE("Destroyed HttpClient_Curl.\n");
     };
@@ -65,79 +82,333 @@ namespace MAT_NS_BEGIN {
     void HttpClient_Curl::SendRequestAsync(IHttpRequest* request, IHttpResponseCallback* callback)
     {
         // Note: 'request' is never owned by IHttpClient and gets deleted in EventsUploadContext.clear()
-        AddRequest(request);
+        // after the response callback, so the request body is passed to curl without copying.
         auto curlRequest = static_cast<CurlHttpRequest*>(request);
 
-        std::string requestId = curlRequest->GetId();
-        std::map<std::string, std::string> requestHeaders;
-        for (const auto& header : curlRequest->m_headers) {
-            requestHeaders[header.first] = header.second;
-        }
-
-        auto curlOperation = std::make_shared<CurlHttpOperation>(curlRequest->m_method, curlRequest->m_url, callback, requestHeaders, curlRequest->m_body);
-        curlRequest->SetOperation(curlOperation);
-        
-        // The lifetime of curlOperation is guarnteed by the call to result.wait() in the d'tor.  
-        curlOperation->SendAsync([this, callback, requestId](CurlHttpOperation& operation) {
-            this->EraseRequest(requestId);
-
-            auto response = std::unique_ptr<SimpleHttpResponse>(new SimpleHttpResponse(requestId));
-            response->m_result = HttpResult_OK;
-
-            response->m_statusCode = operation.GetResponseCode();
-            if (response->m_statusCode == CURLE_FAILED_INIT) {
-                // There was an error in CURL stack while trying to create request
-                response->m_result = HttpResult_LocalFailure;
-            } else if ((CURLE_OK < response->m_statusCode) && (response->m_statusCode <= CURL_LAST)) {
-                if (operation.WasAborted()) {
-                    // Operation was manually aborted
-                    response->m_result = HttpResult_Aborted;
-                } else {
-                    // There was an error in CURL stack while trying to connect
-                    response->m_result = HttpResult_NetworkFailure;
-                }
+        std::unique_ptr<Transfer> transfer(new Transfer());
+        transfer->id = curlRequest->GetId();
+        transfer->request = curlRequest;
+        transfer->callback = callback;
+        transfer->response.reset(new SimpleHttpResponse(transfer->id));
+        transfer->handle = AcquireHandle();
+        if (transfer->handle == nullptr || !SetupTransfer(*transfer)) {
+            TRACE("libcurl failed to init!\n");
+            DispatchEvent(*transfer, OnCreateFailed);
+            if (transfer->handle != nullptr) {
+                // Transfer without a handle is completed with a local failure by the event loop
+                ReleaseHandle(transfer->handle);
+                transfer->handle = nullptr;
             }
+        } else {
+            DispatchEvent(*transfer, OnCreated);
+        }
 
-            auto responseHeaders = operation.GetResponseHeaders();
-            response->m_headers.insert(responseHeaders.begin(), responseHeaders.end());
-            response->m_body = operation.GetResponseBody();
-            
-            // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
-            callback->OnHttpResponse(response.release());
-        });
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            m_requests[transfer->id] = request;
+            m_pending.push_back(std::move(transfer));
+        }
+        Wakeup();
     }
 
     void HttpClient_Curl::CancelRequestAsync(std::string const& id)
     {
-        CurlHttpRequest* request = nullptr;
         {
-            // Hold the lock only while iterating over the list of requests
             std::lock_guard<std::mutex> lock(m_requestsMtx);
-            if (m_requests.find(id) != m_requests.cend()) {
-                request = static_cast<CurlHttpRequest*>(m_requests[id]);
-                LOG_TRACE("HTTP request=%p id=%s being aborted...", request, id.c_str());
-                m_requests.erase(id);
+            if (m_requests.find(id) == m_requests.cend()) {
+                return;
             }
+            LOG_TRACE("HTTP request id=%s being aborted...", id.c_str());
+            m_cancelled.push_back(id);
         }
+        Wakeup();
+    }
 
-        if (request != nullptr) {
-            request->Cancel();
+    CURL* HttpClient_Curl::AcquireHandle()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            if (!m_idleHandles.empty()) {
+                CURL* handle = m_idleHandles.back();
+                m_idleHandles.pop_back();
+                return handle;
+            }
         }
+        return curl_easy_init();
     }
 
-    void HttpClient_Curl::EraseRequest(std::string const& id)
+    void HttpClient_Curl::ReleaseHandle(CURL* handle)
     {
-        std::lock_guard<std::mutex> lock(m_requestsMtx);
-        m_requests.erase(id);
+        // Reset keeps the DNS and TLS session caches; live connections belong to the multi handle
+        curl_easy_reset(handle);
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            if (m_idleHandles.size() < MAX_IDLE_CURL_HANDLES) {
+                m_idleHandles.push_back(handle);
+                return;
+            }
+        }
+        curl_easy_cleanup(handle);
     }
 
-    void HttpClient_Curl::AddRequest(IHttpRequest* request)
+    bool HttpClient_Curl::SetupTransfer(Transfer& transfer)
     {
-        std::lock_guard<std::mutex> lock(m_requestsMtx);
-        m_requests[request->GetId()] = request;
+        CURL* curl = transfer.handle;
+        auto request = transfer.request;
+
+        curl_easy_setopt(curl, CURLOPT_VERBOSE, 0L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_URL, request->m_url.c_str());
+
+        // TODO: expose SSL cert verification opts via ILogConfiguration
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);      // 1L
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);      // 2L
+
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, HTTP_CONN_TIMEOUT);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 30L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 4096L);
+#ifdef CURL_VERSION_HTTP2
+        if (m_multiplex) {
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+            // Prefer waiting for an existing connection to multiplex on over opening a new one
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        }
+#endif
+
+        // Specify our custom headers
+        for (auto const& kv : request->m_headers) {
+            std::string header = kv.first;
+            header += ": ";
+            header += kv.second;
+            transfer.headers = curl_slist_append(transfer.headers, header.c_str());
+        }
+        if (transfer.headers != nullptr) {
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer.headers);
+        }
+
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &HttpClient_Curl::WriteBodyCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, static_cast<void*>(transfer.response.get()));
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &HttpClient_Curl::WriteHeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, static_cast<void*>(transfer.response.get()));
+
+        // TODO: only two methods supported for now - POST and GET
+        if (request->m_method == "POST") {
+            // Empty body must still be a valid pointer, otherwise curl reads the body from stdin
+            const char* body = request->m_body.empty() ? "" : reinterpret_cast<const char*>(request->m_body.data());
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request->m_body.size()));
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+        } else if (request->m_method == "GET") {
+            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+        } else {
+            TRACE("Error: unsupported method %s\n", request->m_method.c_str());
+            return false;
+        }
+
+        TRACE("method=%s, url=%s\n", request->m_method.c_str(), request->m_url.c_str());
+        return true;
     }
 
-} MAT_NS_END
+    void HttpClient_Curl::Wakeup()
+    {
+#if LIBCURL_VERSION_NUM >= 0x074400 /* 7.68.0 */
+        if (m_multi != nullptr) {
+            curl_multi_wakeup(m_multi);
+        }
+#endif
+    }
+
+    void HttpClient_Curl::EventLoop()
+    {
+        while (m_running) {
+            std::vector<std::unique_ptr<Transfer>> pending;
+            std::vector<std::string> cancelled;
+            {
+                std::lock_guard<std::mutex> lock(m_requestsMtx);
+                pending.swap(m_pending);
+                cancelled.swap(m_cancelled);
+            }
+            CancelTransfers(cancelled, pending);
+            StartTransfers(pending);
+
+            if (m_multi == nullptr) {
+                PAL::sleep(CURL_POLL_TIMEOUT_MS / 10);
+                continue;
+            }
+
+            int running = 0;
+            curl_multi_perform(m_multi, &running);
+
+            int left = 0;
+            CURLMsg* msg;
+            while ((msg = curl_multi_info_read(m_multi, &left)) != nullptr) {
+                if (msg->msg != CURLMSG_DONE) {
+                    continue;
+                }
+                CURL* handle = msg->easy_handle;
+                CURLcode result = msg->data.result;
+                curl_multi_remove_handle(m_multi, handle);
+                auto it = m_active.find(handle);
+                if (it != m_active.end()) {
+                    std::unique_ptr<Transfer> transfer = std::move(it->second);
+                    m_active.erase(it);
+                    CompleteTransfer(std::move(transfer), result, false);
+                }
+            }
 
+#if LIBCURL_VERSION_NUM >= 0x074400 /* 7.68.0 */
+            curl_multi_poll(m_multi, nullptr, 0, CURL_POLL_TIMEOUT_MS, nullptr);
+#else
+            // No wakeup support: poll with a short timeout to pick up new and cancelled requests
+            curl_multi_wait(m_multi, nullptr, 0, CURL_POLL_TIMEOUT_MS / 20, nullptr);
 #endif
+        }
+
+        AbortAllTransfers();
+    }
+
+    void HttpClient_Curl::CancelTransfers(std::vector<std::string> const& cancelled, std::vector<std::unique_ptr<Transfer>>& pending)
+    {
+        for (auto const& id : cancelled) {
+            auto pendingIt = std::find_if(pending.begin(), pending.end(),
+                [&id](std::unique_ptr<Transfer> const& transfer) { return transfer->id == id; });
+            if (pendingIt != pending.end()) {
+                std::unique_ptr<Transfer> transfer = std::move(*pendingIt);
+                pending.erase(pendingIt);
+                CompleteTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK, true);
+                continue;
+            }
+
+            auto activeIt = std::find_if(m_active.begin(), m_active.end(),
+                [&id](std::pair<CURL* const, std::unique_ptr<Transfer>> const& item) { return item.second->id == id; });
+            if (activeIt != m_active.end()) {
+                std::unique_ptr<Transfer> transfer = std::move(activeIt->second);
+                m_active.erase(activeIt);
+                curl_multi_remove_handle(m_multi, transfer->handle);
+                CompleteTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK, true);
+            }
+        }
+    }
+
+    void HttpClient_Curl::StartTransfers(std::vector<std::unique_ptr<Transfer>>& pending)
+    {
+        for (auto& transfer : pending) {
+            if (m_multi == nullptr || transfer->handle == nullptr || transfer->response == nullptr) {
+                CompleteTransfer(std::move(transfer), CURLE_FAILED_INIT, false);
+                continue;
+            }
+            // The multi handle connects and sends in one go, both events are dispatched up front
+            DispatchEvent(*transfer, OnConnecting);
+            if (curl_multi_add_handle(m_multi, transfer->handle) != CURLM_OK) {
+                CompleteTransfer(std::move(transfer), CURLE_FAILED_INIT, false);
+                continue;
+            }
+            DispatchEvent(*transfer, OnSending);
+            CURL* handle = transfer->handle;
+            m_active[handle] = std::move(transfer);
+        }
+        pending.clear();
+    }
+
+    void HttpClient_Curl::AbortAllTransfers()
+    {
+        std::vector<std::unique_ptr<Transfer>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            pending.swap(m_pending);
+            m_cancelled.clear();
+        }
+        for (auto& transfer : pending) {
+            CompleteTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK, true);
+        }
+        while (!m_active.empty()) {
+            auto it = m_active.begin();
+            std::unique_ptr<Transfer> transfer = std::move(it->second);
+            m_active.erase(it);
+            curl_multi_remove_handle(m_multi, transfer->handle);
+            CompleteTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK, true);
+        }
+    }
 
+    void HttpClient_Curl::CompleteTransfer(std::unique_ptr<Transfer> transfer, CURLcode result, bool aborted)
+    {
+        auto& response = *transfer->response;
+        if (aborted) {
+            // Operation was manually aborted
+            response.m_result = HttpResult_Aborted;
+            response.m_statusCode = static_cast<unsigned>(result);
+        } else if (result == CURLE_OK) {
+            long statusCode = 0;
+            curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &statusCode);
+            TRACE("HTTP response code %d\n", statusCode);
+            response.m_result = HttpResult_OK;
+            response.m_statusCode = static_cast<unsigned>(statusCode);
+            DispatchEvent(*transfer, OnResponse);
+        } else {
+            TRACE("Error: %s\n", curl_easy_strerror(result));
+            // Request could not be created or is malformed vs. an error in CURL stack while trying to connect
+            bool localFailure = (result == CURLE_FAILED_INIT) || (result == CURLE_URL_MALFORMAT) || (result == CURLE_UNSUPPORTED_PROTOCOL);
+            response.m_result = localFailure ? HttpResult_LocalFailure : HttpResult_NetworkFailure;
+            response.m_statusCode = static_cast<unsigned>(result);
+            // No connection was ever made vs. a failure while sending or receiving
+            bool connectFailure = (result == CURLE_COULDNT_CONNECT) || (result == CURLE_COULDNT_RESOLVE_HOST) || (result == CURLE_COULDNT_RESOLVE_PROXY);
+            DispatchEvent(*transfer, connectFailure ? OnConnectFailed : OnSendFailed);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_requestsMtx);
+            m_requests.erase(transfer->id);
+        }
+
+        if (transfer->handle != nullptr) {
+            DispatchEvent(*transfer, OnDestroy);
+            ReleaseHandle(transfer->handle);
+            transfer->handle = nullptr;
+        }
+        curl_slist_free_all(transfer->headers);
+        transfer->headers = nullptr;
+
+        // 'response' is no longer owned by IHttpClient and gets deleted in EventsUploadContext.clear()
+        transfer->callback->OnHttpResponse(transfer->response.release());
+    }
+
+    void HttpClient_Curl::DispatchEvent(Transfer const& transfer, HttpStateEvent type)
+    {
+        if (transfer.callback != nullptr) {
+            transfer.callback->OnHttpStateEvent(type, static_cast<void*>(transfer.handle), 0);
+        }
+    }
+
+    size_t HttpClient_Curl::WriteBodyCallback(char* ptr, size_t size, size_t nmemb, void* userp)
+    {
+        auto response = static_cast<SimpleHttpResponse*>(userp);
+        response->m_body.insert(response->m_body.end(), ptr, ptr + size * nmemb);
+        return size * nmemb;
+    }
+
+    size_t HttpClient_Curl::WriteHeaderCallback(char* ptr, size_t size, size_t nmemb, void* userp)
+    {
+        // Called once per header line, including status lines of interim (1xx) responses
+        auto response = static_cast<SimpleHttpResponse*>(userp);
+        std::string line(ptr, size * nmemb);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.pop_back();
+        }
+
+        if (line.compare(0, 5, "HTTP/") == 0) {
+            // New response starts, drop headers of any interim response
+            response->m_headers.clear();
+        } else {
+            auto pos = line.find(':');
+            if (pos != std::string::npos) {
+                auto valuePos = line.find_first_not_of(' ', pos + 1);
+                response->m_headers.set(line.substr(0, pos), (valuePos == std::string::npos) ? std::string() : line.substr(valuePos));
+            }
+        }
+        return size * nmemb;
+    }
+
+} MAT_NS_END
+
+#endif
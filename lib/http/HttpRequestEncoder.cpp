@@ -136,7 +136,7 @@ namespace MAT_NS_BEGIN {
             if (!tenantTokens.empty()) {
                 tenantTokens.push_back(',');
             }
-            tenantTokens.append(item.first);
+            tenantTokens.append(TenantRegistry::GetToken(item.first));
         }
         ctx->httpRequest->GetHeaders().set("APIKey", tenantTokens);
 
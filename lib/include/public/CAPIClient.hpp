@@ -59,6 +59,11 @@ namespace MAT_NS_BEGIN
             return evt_log(handle, evt);
         }
 
+        evt_status_t log_batch(uint32_t size, evt_prop** evts)
+        {
+            return evt_log_batch(handle, size, evts);
+        }
+
         evt_status_t pause()
         {
             return evt_pause(handle);
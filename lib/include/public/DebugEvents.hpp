@@ -15,6 +15,7 @@
 #include <functional>
 #include <algorithm>
 #include <chrono>
+#include <memory>
 
 #ifndef __cplusplus_cli
 #include <atomic>
@@ -69,10 +70,19 @@ namespace MAT_NS_BEGIN
         EVT_ADDED               = 0x01001000,
         /// <summary>Event(s) cached in offline storage.</summary>
         EVT_CACHED              = 0x02000000,
-        /// <summary>Event(s) dropped.</summary>
+        /// <summary>Event(s) dropped.
+        /// param1 - number of events dropped.
+        /// Events dropped from the ingestion queue are reported one at a time with
+        /// param2 - their EventLatency, data - their StorageRecord.
+        /// </summary>
         EVT_DROPPED             = 0x03000000,
         /// <summary>Event(s) filtered.</summary>
         EVT_FILTERED            = 0x03000001,
+        /// <summary>Ingestion queue overflow.
+        /// param1 - IngestionOverflowPolicy applied,
+        /// param2 - number of events dropped (0 if the producer was throttled only).
+        /// </summary>
+        EVT_INGESTION_OVERFLOW  = 0x03000002,
 
         /// <summary>Event(s) sent.</summary>
         EVT_SENT                = 0x04000000,
@@ -123,6 +133,9 @@ namespace MAT_NS_BEGIN
         EVT_STORAGE_FULL        = 0x0E000000,
         /// <summary>Storage failed.</summary>
         EVT_STORAGE_FAILED      = 0x0E000001,
+        /// <summary>Storage trimmed to its size limit. param1: bytes reclaimed,
+        /// param2: longest time storing events had to wait for the trimming, in milliseconds.</summary>
+        EVT_STORAGE_TRIMMED     = 0x0E000002,
 
         /// <summary>Ticket Expired</summary>
         EVT_TICKET_EXPIRED      = 0x0F000000,
@@ -196,12 +209,17 @@ namespace MAT_NS_BEGIN
 #pragma warning( push )
 #pragma warning( disable: 4251 )
 #endif
+    class DebugEventSourceState;
+
     /// <summary>The DebugEventSource class represents a debug event source.</summary>
     class MATSDK_LIBABI DebugEventSource: public DebugEventDispatcher
     {
     public:
         /// <summary>The DebugEventSource constructor.</summary>
-        DebugEventSource() : seq(0) {}
+        DebugEventSource();
+
+        /// <summary>The DebugEventSource destructor.</summary>
+        virtual ~DebugEventSource() noexcept;
 
         /// <summary>Adds an event listener for the specified debug event type.</summary>
         virtual void AddEventListener(DebugEventType type, DebugEventListener &listener);
@@ -218,6 +236,20 @@ namespace MAT_NS_BEGIN
         /// <summary>Detach cascaded DebugEventSource to forward all events to</summary>
         virtual bool DetachEventSource(DebugEventSource & other);
 
+        /// <summary>
+        /// Delivers events to listeners and cascaded sources on a separate thread, so that slow
+        /// listeners don't stall the logging threads. Up to maxQueuedEvents events are queued, the
+        /// following ones are dropped until the queue drains. Queued events have no data and size.
+        /// Pass 0 to go back to synchronous delivery, which first delivers the queued events.
+        /// </summary>
+        virtual void SetAsyncDispatch(size_t maxQueuedEvents);
+
+        /// <summary>Waits until all the events queued for asynchronous delivery are delivered.</summary>
+        virtual void FlushAsyncDispatch();
+
+        /// <summary>Gets the number of events dropped because the asynchronous delivery queue was full.</summary>
+        virtual uint64_t GetDroppedEventCount() const;
+
     protected:
 #ifndef _MANAGED
         /// <summary>
@@ -238,7 +270,17 @@ namespace MAT_NS_BEGIN
         /// <summary>A collection of cascaded debug event sources.</summary>
         std::set<DebugEventSource*> cascaded;
 
+#ifndef __cplusplus_cli
+        std::atomic<uint64_t> seq;
+#else
         uint64_t seq;
+#endif
+
+        /// <summary>
+        /// Copy of listeners and cascaded published for dispatching without a lock,
+        /// and the queue of the asynchronous delivery mode.
+        /// </summary>
+        std::unique_ptr<DebugEventSourceState> dispatchState;
     };
 #ifdef _MSC_VER
 #pragma warning( pop )
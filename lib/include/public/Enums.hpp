@@ -568,6 +568,30 @@ namespace MAT_NS_BEGIN
 
     constexpr const static unsigned gc_NumDroppedReasons = DROPPED_REASON_COUNT;
 
+    /// <summary>
+    /// Action taken when the asynchronous ingestion queue is full
+    /// </summary>
+    enum IngestionOverflowPolicy
+    {
+        /// <summary>Evict the oldest queued event to make room for the new one.</summary>
+        IngestionOverflow_DropOldest = 0,
+        /// <summary>Drop the new event.</summary>
+        IngestionOverflow_DropNewest = 1,
+        /// <summary>Block the producer until there is room or the timeout expires, then drop the new event.</summary>
+        IngestionOverflow_Block = 2
+    };
+
+    /// <summary>
+    /// Timer queue used by the default worker thread task dispatcher
+    /// </summary>
+    enum TaskSchedulerType
+    {
+        /// <summary>Timed tasks are kept in a sorted list.</summary>
+        TaskScheduler_List = 0,
+        /// <summary>Timed tasks are kept in an indexed binary heap.</summary>
+        TaskScheduler_Heap = 1
+    };
+
 } MAT_NS_END
 
 #endif //EVENTPRIORITY_H
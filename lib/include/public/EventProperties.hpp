@@ -343,6 +343,7 @@ namespace MAT_NS_BEGIN
 
         /// <summary>
         /// Get the properties bag of an event.
+        /// The returned map is owned by this object and reflects later changes to its properties.
         /// </summary>
         /// <returns>Properties bag of the event</returns>
         const std::map<std::string, EventProperty>& GetProperties(DataCategory category = DataCategory_PartC) const;
@@ -367,6 +368,10 @@ namespace MAT_NS_BEGIN
 #endif
 
        private:
+        // SDK internals read the properties in place rather than through the GetProperties() map copy
+        friend class EventPropertiesDecorator;
+        friend class Logger;
+
         EventPropertiesStorage* m_storage;
     };
 } MAT_NS_END
@@ -144,6 +144,18 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_INT_RAM_QUEUE_BUFFERS = "maxDBFlushQueues";
 
+    /// <summary>
+    /// Use the sharded RAM queue, which locks each latency separately and doesn't block
+    /// incoming events while the uploader reserves a batch.
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_RAM_QUEUE_SHARDED = "cacheMemoryShardedQueue";
+
+    /// <summary>
+    /// Bit mask of the latencies that the sharded RAM queue serves oldest first (bit n for EventLatency n).
+    /// The other latencies are served newest first.
+    /// </summary>
+    static constexpr const char* const CFG_INT_RAM_QUEUE_FIFO_LATENCIES = "cacheMemoryFifoLatencies";
+
     /// <summary>
     /// The trace level mask.
     /// </summary>
@@ -189,6 +201,12 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_INT_MAX_PENDING_REQ = "maxPendingHTTPRequests";
 
+    /// <summary>
+    /// Keep several batches in flight while stored events remain, up to CFG_INT_MAX_PENDING_REQ.
+    /// The number of batches grows while uploads succeed quickly and halves when they fail.
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_TPM_ADAPTIVE_UPLOADS = "adaptiveUploads";
+
     /// <summary>
     /// The maximum package drop on full.
     /// </summary>
@@ -241,6 +259,12 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_MODULE_TASK_DISPATCHER = "taskDispatcher";
 
+    /// <summary>
+    /// Timer queue used by the default task dispatcher (see TaskSchedulerType).
+    /// Applied when the default task dispatcher is first created.
+    /// </summary>
+    static constexpr const char* const CFG_INT_TASK_SCHEDULER = "taskScheduler";
+
     /// <summary>
     /// IDataViewer override module
     /// </summary>
@@ -336,6 +360,22 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_HTTP_COMPRESSION = "compress";
 
+    /// <summary>
+    /// HTTP configuration: zlib compression level (-1 for the zlib default, 0..9)
+    /// </summary>
+    static constexpr const char* const CFG_INT_HTTP_COMPRESSION_LEVEL = "compressionLevel";
+
+    /// <summary>
+    /// HTTP configuration: zlib compression strategy (0 for Z_DEFAULT_STRATEGY)
+    /// </summary>
+    static constexpr const char* const CFG_INT_HTTP_COMPRESSION_STRATEGY = "compressionStrategy";
+
+    /// <summary>
+    /// HTTP configuration: feed the packaged records into the compressor
+    /// without building the uncompressed request body first
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_HTTP_COMPRESSION_STREAMING = "compressionStreaming";
+
     /// <summary>
     /// TPM configuration map
     /// </summary>
@@ -366,6 +406,31 @@ namespace MAT_NS_BEGIN
     /// </summary>
     static constexpr const char* const CFG_BOOL_SESSION_RESET_ENABLED = "sessionResetEnabled";
 
+    /// <summary>
+    /// Ingestion configuration map
+    /// </summary>
+    static constexpr const char* const CFG_MAP_INGESTION = "ingestion";
+
+    /// <summary>
+    /// Ingestion configuration: hand events over to the worker thread through a bounded lock-free queue
+    /// </summary>
+    static constexpr const char* const CFG_BOOL_INGESTION_ASYNC = "async";
+
+    /// <summary>
+    /// Ingestion configuration: maximum number of events waiting in the ingestion queue
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGESTION_QUEUE_SIZE = "queueSize";
+
+    /// <summary>
+    /// Ingestion configuration: IngestionOverflowPolicy applied when the ingestion queue is full
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGESTION_OVERFLOW_POLICY = "overflowPolicy";
+
+    /// <summary>
+    /// Ingestion configuration: max time in milliseconds a producer waits with IngestionOverflow_Block policy
+    /// </summary>
+    static constexpr const char* const CFG_INT_INGESTION_BLOCK_TIMEOUT = "blockTimeoutMs";
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4251)
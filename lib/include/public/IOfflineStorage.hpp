@@ -11,6 +11,7 @@
 #include "ILogManager.hpp"
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <map>
@@ -34,6 +35,13 @@ namespace MAT_NS_BEGIN {
         int             retryCount = 0;
         int64_t         reservedUntil = 0;
 
+        /// <summary>
+        /// Serialized event shared with the storage that keeps the record reserved,
+        /// so that handing an in-flight record to the uploader does not copy it.
+        /// When set, it replaces <see cref="blob"/>, which is left empty.
+        /// </summary>
+        std::shared_ptr<StorageBlob const> sharedBlob;
+
         StorageRecord()
         {}
 
@@ -43,9 +51,17 @@ namespace MAT_NS_BEGIN {
 
         StorageRecord(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence,
             int64_t timestamp, std::vector<uint8_t>&& blob, int retryCount = 0, int64_t reservedUntil = 0)
-            : id(id), tenantToken(tenantToken), latency(latency), persistence(persistence), timestamp(timestamp), blob(blob), retryCount(retryCount), reservedUntil(reservedUntil)
+            : id(id), tenantToken(tenantToken), latency(latency), persistence(persistence), timestamp(timestamp), blob(std::move(blob)), retryCount(retryCount), reservedUntil(reservedUntil)
         {}
 
+        /// <summary>
+        /// Serialized event, whether the record owns it or shares it
+        /// </summary>
+        StorageBlob const& getBlob() const
+        {
+            return (sharedBlob) ? *sharedBlob : blob;
+        }
+
         bool operator==(const StorageRecord& rhs) {
             return ((*this).id == rhs.id);
         }
@@ -174,6 +190,21 @@ namespace MAT_NS_BEGIN {
         /// <returns>Whether the record was successfully stored</returns>
         virtual bool StoreRecord(StorageRecord const& record) = 0;
 
+        /// <summary>
+        /// Store one telemetry event record, taking over its blob
+        /// </summary>
+        /// <remarks>
+        /// Implementations that keep records in memory should override this
+        /// to move the record instead of copying it. The default implementation
+        /// forwards to the copying overload.
+        /// </remarks>
+        /// <param name="record">Record data to store</param>
+        /// <returns>Whether the record was successfully stored</returns>
+        virtual bool StoreRecord(StorageRecord&& record)
+        {
+            return StoreRecord(static_cast<StorageRecord const&>(record));
+        }
+
         /// <summary>
         /// Store several telemetry event records
         /// </summary>
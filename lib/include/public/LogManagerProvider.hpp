@@ -12,6 +12,9 @@
 #include "NullObjects.hpp"
 #include "Version.hpp"
 
+#include <map>
+#include <mutex>
+
 namespace MAT_NS_BEGIN
 {
 
@@ -164,6 +167,7 @@ namespace MAT_NS_BEGIN
     /// ctx_data       - original JSON configuration or token passed to mat_open
     /// http           - optional IHttpClient override instance
     /// taskDispatcher - optional ITaskDispatcher override instance
+    /// loggers        - loggers resolved by tenant token and event source, guarded by loggersLock
     /// </summary>
     typedef struct capi_client_struct
     {
@@ -172,6 +176,8 @@ namespace MAT_NS_BEGIN
         std::string                      ctx_data;
         std::shared_ptr<IHttpClient>     http;
         std::shared_ptr<ITaskDispatcher> taskDispatcher;
+        std::mutex                       loggersLock;
+        std::map<std::string, ILogger*>  loggers;
     } capi_client;
 
     /// <summary>
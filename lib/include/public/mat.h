@@ -59,7 +59,8 @@ extern "C" {
         EVT_OP_FLUSH = 0x0000000A,
         EVT_OP_VERSION = 0x0000000B,
         EVT_OP_OPEN_WITH_PARAMS = 0x0000000C,
-        EVT_OP_MAX = EVT_OP_OPEN_WITH_PARAMS + 1
+        EVT_OP_LOG_BATCH = 0x0000000D,
+        EVT_OP_MAX = EVT_OP_LOG_BATCH + 1
     } evt_call_t;
 
     typedef enum
@@ -530,6 +531,27 @@ extern "C" {
 #define evt_log(handle, evt) evt_log_s(handle, EVT_ARRAY_SIZE(evt), evt)
 #endif
 #endif
+
+    /**
+     * <summary>
+     * Logs a batch of telemetry events in one call.
+     * Each event is an evt_prop array terminated by { .name = NULL, .type = TYPE_NULL }.
+     * Consecutive events with the same tenant token and event source share one logger lookup.
+     * </summary>
+     * <param name="handle">SDK handle.</param>
+     * <param name="size">Number of events in array.</param>
+     * <param name="evts">Array of event properties arrays.</param>
+     * <returns></returns>
+     */
+    static inline evt_status_t evt_log_batch(evt_handle_t handle, uint32_t size, evt_prop** evts)
+    {
+        evt_context_t ctx;
+        ctx.call = EVT_OP_LOG_BATCH;
+        ctx.handle = handle;
+        ctx.data = (void *)evts;
+        ctx.size = size;
+        return evt_api_call(&ctx);
+    }
     
     /**
      * <summary>
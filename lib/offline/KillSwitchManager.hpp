@@ -6,8 +6,12 @@
 #define KILLSWITCHMANAGER_HPP
 
 #include "pal/PAL.hpp"
+#include "system/TenantRegistry.hpp"
+#include "utils/PublishedSnapshot.hpp"
 
+#include <list>
 #include <map>
+#include <memory>
 #include <string>
 #include <mutex>
 
@@ -19,12 +23,18 @@ namespace MAT_NS_BEGIN {
     {
     public:
 
+        /// <summary>
+        /// Fast check done for every stored record: a single atomic load while no tenant is killed.
+        /// </summary>
         bool isActive()
         {
-            return !m_tokenTime.empty();
+            return m_isActive.load(std::memory_order_acquire);
         }
 
-        KillSwitchManager() : m_isRetryAfterActive(false), m_retryAfterExpiryTime(0)
+        KillSwitchManager() :
+            m_isActive(false),
+            m_isRetryAfterActive(false),
+            m_snapshot(new Snapshot())
         {
         }
 
@@ -42,9 +52,14 @@ namespace MAT_NS_BEGIN {
                 int64_t timeinSecs = std::stoi(timeStr);
                 if (timeinSecs > 0)
                 {
-                    std::lock_guard<std::mutex> guard(m_lock);
-                    m_retryAfterExpiryTime = PAL::getUtcSystemTime() + timeinSecs;
-                    m_isRetryAfterActive = true;
+                    {
+                        std::lock_guard<std::mutex> guard(m_lock);
+                        std::unique_ptr<Snapshot> next(new Snapshot(*m_snapshot.get()));
+                        next->retryAfterExpiryTime = PAL::getUtcSystemTime() + timeinSecs;
+                        m_isRetryAfterActive = true;
+                        publish(std::move(next));
+                    }
+                    m_snapshot.synchronize();
                 }
             }
 
@@ -88,64 +103,81 @@ namespace MAT_NS_BEGIN {
 
         void addToken(const std::string& tokenId, int64_t timeInSeconds)
         {
-            std::lock_guard<std::mutex> guard(m_lock);
             if (timeInSeconds > 0)
             {
-                m_tokenTime[tokenId] = PAL::getUtcSystemTime() + timeInSeconds; //convert milisec to sec
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    std::unique_ptr<Snapshot> next(new Snapshot(*m_snapshot.get()));
+                    next->tokenTime[TenantRegistry::Intern(tokenId)] = PAL::getUtcSystemTime() + timeInSeconds; //convert milisec to sec
+                    publish(std::move(next));
+                }
+                m_snapshot.synchronize();
             }
         }
 
+        /// <summary>
+        /// Reads the last published snapshot without taking the lock.
+        /// Expired entries are dropped from the next snapshot.
+        /// </summary>
         bool isTokenBlocked(const std::string& tokenId)
         {
-            std::lock_guard<std::mutex> guard(m_lock);
-
-            if (m_isRetryAfterActive)
+            int64_t now = PAL::getUtcSystemTime();
+            bool hasExpired = false;
             {
-                if (m_retryAfterExpiryTime > PAL::getUtcSystemTime())
+                SnapshotReader snapshot(m_snapshot);
+                if (m_isRetryAfterActive)
                 {
-                    return true;//always return true for all tokens
+                    if (snapshot->retryAfterExpiryTime > now)
+                    {
+                        return true;//always return true for all tokens
+                    }
+                    hasExpired = true;
                 }
-                else
-                {
-                    m_retryAfterExpiryTime = 0;
-                    m_isRetryAfterActive = false;
+                // Killed tokens are interned by addToken(), a token never seen is not killed
+                TenantId tenantId;
+                auto iter = TenantRegistry::Find(tokenId, tenantId) ? snapshot->tokenTime.find(tenantId) : snapshot->tokenTime.end();
+                if (iter != snapshot->tokenTime.end())
+                {//found, check the time stamp
+                    if (iter->second > now)  //convert milisec to sec
+                    {
+                        return true;
+                    }
+                    hasExpired = true;
                 }
             }
-            std::map<std::string, int64_t>::iterator iter = m_tokenTime.find(tokenId);
-            if (iter != m_tokenTime.end())
-            {//found, check the time stamp
-                int64_t timeStamp = m_tokenTime[tokenId];
 
-                if (timeStamp > PAL::getUtcSystemTime())  //convert milisec to sec
-                {
-                    return true;
-                }
-                else
-                { //remove the entry for this token as this has expired
-                    m_tokenTime.erase(tokenId);
-                }
+            // Publishing waits for readers, the snapshot above has to be released first
+            if (hasExpired)
+            {
+                removeExpired(now);
             }
-
             return false;
         }
 
         void removeToken(const std::string& tokenId)
         {
-            std::lock_guard<std::mutex> guard(m_lock);
-            std::map<std::string, int64_t>::iterator iter = m_tokenTime.find(tokenId);
-            if (iter != m_tokenTime.end())
-            {//found, check the time stamp
-                m_tokenTime.erase(tokenId);
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                Snapshot const* snapshot = m_snapshot.get();
+                TenantId tenantId;
+                if (!TenantRegistry::Find(tokenId, tenantId) || snapshot->tokenTime.count(tenantId) == 0)
+                {
+                    return;
+                }
+                std::unique_ptr<Snapshot> next(new Snapshot(*snapshot));
+                next->tokenTime.erase(tenantId);
+                publish(std::move(next));
             }
+            m_snapshot.synchronize();
         }
 
         std::list<std::string> getTokensList()
         {
-            std::lock_guard<std::mutex> guard(m_lock);
+            SnapshotReader snapshot(m_snapshot);
             std::list<std::string> result;
-            for (const auto &kv : m_tokenTime)
+            for (const auto &kv : snapshot->tokenTime)
             {
-                result.push_back(kv.first);
+                result.push_back(TenantRegistry::GetToken(kv.first));
             }
             return result;
         }
@@ -156,10 +188,47 @@ namespace MAT_NS_BEGIN {
         }
 
     private:
-        std::map<std::string, int64_t> m_tokenTime;
-        std::mutex      m_lock;
-        bool            m_isRetryAfterActive;
-        int64_t         m_retryAfterExpiryTime;
+        /// <summary>
+        /// Killed tenants and Retry-After expiry, immutable once published.
+        /// </summary>
+        struct Snapshot
+        {
+            std::map<TenantId, int64_t>    tokenTime;
+            int64_t                        retryAfterExpiryTime = 0;
+        };
+
+        typedef PublishedSnapshot<Snapshot>::Reader SnapshotReader;
+
+        // Called under m_lock, the caller frees the replaced snapshot with m_snapshot.synchronize()
+        void publish(std::unique_ptr<Snapshot> next)
+        {
+            m_isActive.store(!next->tokenTime.empty(), std::memory_order_release);
+            m_snapshot.publish(next.release());
+        }
+
+        void removeExpired(int64_t now)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                std::unique_ptr<Snapshot> next(new Snapshot(*m_snapshot.get()));
+                if (m_isRetryAfterActive && next->retryAfterExpiryTime <= now)
+                {
+                    next->retryAfterExpiryTime = 0;
+                    m_isRetryAfterActive = false;
+                }
+                for (auto it = next->tokenTime.begin(); it != next->tokenTime.end();)
+                {
+                    it = (it->second > now) ? std::next(it) : next->tokenTime.erase(it);
+                }
+                publish(std::move(next));
+            }
+            m_snapshot.synchronize();
+        }
+
+        std::atomic<bool>               m_isActive;
+        std::atomic<bool>               m_isRetryAfterActive;
+        std::mutex                      m_lock;
+        PublishedSnapshot<Snapshot>     m_snapshot;
     };
 
 } MAT_NS_END
@@ -69,6 +69,18 @@ namespace MAT_NS_BEGIN {
     {
     }
     
+    namespace {
+
+        /// <summary>
+        /// Approximate ram footprint of a record, whichever way its blob is held
+        /// </summary>
+        size_t recordSize(StorageRecord const& record)
+        {
+            return record.getBlob().size() + sizeof(record);
+        }
+
+    }
+
     template<typename T, typename V>
     bool contains(T vec, V value)
     {
@@ -91,13 +103,29 @@ namespace MAT_NS_BEGIN {
     /// Called from the internal worker thread.
     /// </remarks>
     bool MemoryStorage::StoreRecord(StorageRecord const & record)
+    {
+        // Don't copy a record that is going to be rejected
+        if (record.latency == EventLatency_Off)
+            return false;
+
+        return StoreRecord(StorageRecord(record));
+    }
+
+    /// <summary>
+    /// Store one telemetry event record, moving it into the ram queue
+    /// </summary>
+    /// <param name="record">Record data to store</param>
+    /// <returns>
+    /// Whether the record was successfully stored
+    /// </returns>
+    bool MemoryStorage::StoreRecord(StorageRecord && record)
     {
         // Don't store events with latency set to off. Logger API already does a similar check.
         if (record.latency == EventLatency_Off)
             return false;
 
         LOCKGUARD(m_records_lock);
-        m_size += record.blob.size() + sizeof(record); // approximate contents size
+        m_size += recordSize(record); // approximate contents size
 
 #ifdef DEBUG_DUPLICATE_ROUTES
         if (contains(m_records[record.latency], record))
@@ -121,8 +149,9 @@ namespace MAT_NS_BEGIN {
 
     /// <summary>
     /// Get records from MemoryStorage.
-    /// Getting records automatically deletes them.
-    /// Reservation is not currently supported.
+    /// Getting records removes them from the ram queue. With a lease time the records
+    /// are kept reserved until deleted or released, sharing their blob with the consumer;
+    /// without one they are moved to the consumer.
     /// </summary>
     /// <param name="consumer">The consumer.</param>
     /// <param name="leaseTimeMs">The lease time ms.</param>
@@ -153,23 +182,47 @@ namespace MAT_NS_BEGIN {
             {
                 StorageRecord & record = m_records[latency].back();
 
-                size_t recordSize = record.blob.size() + sizeof(record);
-                StorageRecord forConsumer(record);
+                size_t size = recordSize(record);
+                bool wantMore;
                 if (leaseTimeMs)
                 {
+                    // Share the blob between the consumer and the reserved copy of the record
+                    if (!record.sharedBlob)
+                    {
+                        record.sharedBlob = std::make_shared<StorageBlob const>(std::move(record.blob));
+                        record.blob.clear();
+                    }
+                    StorageRecord forConsumer(record);
                     forConsumer.reservedUntil = PAL::getUtcSystemTimeMs() + leaseTimeMs;
+                    wantMore = consumer(std::move(forConsumer));
+                    if (wantMore)
+                    {
+                        m_reserved_records[record.id] = std::move(record); // move to reserved
+                    }
+                }
+                else
+                {
+                    // Consumers of unreserved records (e.g. flush to disk) expect the blob in place
+                    if (record.sharedBlob)
+                    {
+                        record.blob = *record.sharedBlob;
+                        record.sharedBlob.reset();
+                    }
+                    StorageRecord forConsumer(std::move(record));
+                    wantMore = consumer(std::move(forConsumer));
+                    if (!wantMore)
+                    {
+                        // The consumer leaves records it does not want untouched, keep it queued
+                        record = std::move(forConsumer);
+                    }
                 }
 
-                bool wantMore = consumer(std::move(forConsumer)); // move to consumer
                 if (!wantMore) {
                     return true;
                 }
 
-                if (leaseTimeMs) {
-                    m_reserved_records[record.id] = std::move(record); // move to reserved
-                }
                 m_records[latency].pop_back();
-                m_size -= std::min(m_size, recordSize);
+                m_size -= std::min(m_size, size);
                 maxCount--;
                 m_lastReadCount++;
             }
@@ -271,8 +324,7 @@ namespace MAT_NS_BEGIN {
                     auto &v = *it;
                     if (matcher(v, whereFilter))
                     {
-                        size_t recordSize = v.blob.size() + sizeof(v);
-                        m_size -= std::min(m_size, recordSize);
+                        m_size -= std::min(m_size, recordSize(v));
                         it = records.erase(it);
                         continue;
                     }
@@ -336,8 +388,7 @@ namespace MAT_NS_BEGIN {
                         {
                             // record id appears once only, so remove from set
                             idSet.erase(v.id);
-                            size_t recordSize = v.blob.size() + sizeof(v);
-                            m_size -= std::min(m_size, recordSize);
+                            m_size -= std::min(m_size, recordSize(v));
                             it = records.erase(it);
                             continue;
                         }
@@ -374,7 +425,7 @@ namespace MAT_NS_BEGIN {
                 {
                     if (incrementRetryCount)
                         kv.second.retryCount++;
-                    StoreRecord(kv.second);
+                    StoreRecord(std::move(kv.second));
                     idSet.erase(kv.first);
                     it = m_reserved_records.erase(it);
                     continue;
@@ -395,7 +446,7 @@ namespace MAT_NS_BEGIN {
             while (it != m_reserved_records.end())
             {
                 auto &kv = *it;
-                StoreRecord(kv.second);
+                StoreRecord(std::move(kv.second));
                 it = m_reserved_records.erase(it);
             }
         }
@@ -38,6 +38,8 @@ namespace MAT_NS_BEGIN {
 
         virtual bool StoreRecord(StorageRecord const& record) override;
 
+        virtual bool StoreRecord(StorageRecord&& record) override;
+
         virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
 
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs,
@@ -87,6 +89,7 @@ namespace MAT_NS_BEGIN {
         /// <summary>
         /// Contains reserved (aka in-flight) records.
         /// Current storage interface API requires deletion and release by StorageRecordId.
+        /// Their blobs are shared with the records handed out to the uploader.
         /// </summary>
         std::mutex                  m_reserved_lock;
         std::map<StorageRecordId, StorageRecord> m_reserved_records;
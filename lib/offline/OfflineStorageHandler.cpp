@@ -7,14 +7,21 @@
 #include "OfflineStorageFactory.hpp"
 
 #include "offline/MemoryStorage.hpp"
+#include "offline/ShardedMemoryStorage.hpp"
 
 #include "ILogManager.hpp"
 #include <algorithm>
 #include <numeric>
 #include <set>
+#include <utility>
 
 namespace MAT_NS_BEGIN {
 
+    // Shutdown waits for a running trimming pass in slices of this length
+    static uint64_t const TRIM_CANCEL_WAIT_MS = 500;
+    // Without a ram queue, the disk storage size is checked again after storing this much
+    static size_t const TRIM_CHECK_INTERVAL_BYTES = 64 * 1024;
+
 
     MATSDK_LOG_INST_COMPONENT_CLASS(OfflineStorageHandler, "EventsSDK.StorageHandler", "Events telemetry client - OfflineStorageHandler class");
 
@@ -26,6 +33,8 @@ namespace MAT_NS_BEGIN {
         m_killSwitchManager(),
         m_clockSkewManager(),
         m_flushPending(false),
+        m_trimPending(false),
+        m_bytesStoredSinceTrimCheck(0),
         m_offlineStorageMemory(nullptr),
         m_offlineStorageDisk(nullptr),
         m_readFromMemory(false),
@@ -67,8 +76,78 @@ namespace MAT_NS_BEGIN {
         m_flushComplete.wait();
     }
 
+    /// <summary>
+    /// Schedule a trimming pass of the disk storage on the task dispatcher when it is over
+    /// its size limit, so that the threads storing events never trim it themselves.
+    /// The storage is always trimmed once it is opened, trimming as events get stored
+    /// is enabled by CFG_BOOL_ENABLE_DB_DROP_IF_FULL.
+    /// </summary>
+    void OfflineStorageHandler::ScheduleTrim()
+    {
+        if (m_trimPending || m_shutdownStarted || (nullptr == m_offlineStorageDisk))
+            return;
+
+        if (m_offlineStorageDisk->GetSize() <= m_config.GetOfflineStorageMaximumSizeBytes())
+            return;
+
+        LOCKGUARD(m_trimLock);
+        if (!m_trimPending && !m_shutdownStarted)
+        {
+            m_trimPending = true;
+            m_trimHandle = PAL::scheduleTask(&m_taskDispatcher, 0, this, &OfflineStorageHandler::Trim);
+            LOG_INFO("Requested Trim (%p)", m_trimHandle.m_task);
+        }
+    }
+
+    void OfflineStorageHandler::CancelTrim()
+    {
+        {
+            // Once shutdown has started, no more passes get scheduled past this point
+            LOCKGUARD(m_trimLock);
+        }
+        // A running pass still uses the disk storage and this handler, it must be done
+        // before either of them goes away
+        while (!m_trimHandle.Cancel(TRIM_CANCEL_WAIT_MS))
+        {
+            LOG_INFO("Waiting for running Trim (%p) to complete...", m_trimHandle.m_task);
+        }
+        m_trimPending = false;
+    }
+
+    /// <summary>
+    /// Check the disk storage size once enough has been stored since the last check,
+    /// so that storing events without a ram queue does not query it every time.
+    /// </summary>
+    void OfflineStorageHandler::ScheduleTrimAfterStoring(size_t size)
+    {
+        if (!m_config[CFG_BOOL_ENABLE_DB_DROP_IF_FULL])
+            return;
+
+        if (m_bytesStoredSinceTrimCheck.fetch_add(size) + size < TRIM_CHECK_INTERVAL_BYTES)
+            return;
+
+        m_bytesStoredSinceTrimCheck = 0;
+        ScheduleTrim();
+    }
+
+    /// <summary>
+    /// Run one bounded trimming pass, then schedule the next one while the disk
+    /// storage is still over its limit, letting other tasks run in between.
+    /// </summary>
+    void OfflineStorageHandler::Trim()
+    {
+        bool trimmed = m_offlineStorageDisk->ResizeDb();
+        m_trimPending = false;
+        if (trimmed)
+        {
+            ScheduleTrim();
+        }
+    }
+
     OfflineStorageHandler::~OfflineStorageHandler()
     {
+        m_shutdownStarted = true;
+        CancelTrim();
         WaitForFlush();
         if (nullptr != m_offlineStorageMemory)
         {
@@ -93,18 +172,28 @@ namespace MAT_NS_BEGIN {
         // disk.
         if (cacheMemorySizeLimitInBytes > 0)
         {
-            m_offlineStorageMemory.reset(new MemoryStorage(m_logManager, m_config));
+            bool sharded = m_config[CFG_BOOL_RAM_QUEUE_SHARDED];
+            if (sharded)
+            {
+                m_offlineStorageMemory.reset(new ShardedMemoryStorage(m_logManager, m_config));
+            }
+            else
+            {
+                m_offlineStorageMemory.reset(new MemoryStorage(m_logManager, m_config));
+            }
             m_offlineStorageMemory->Initialize(*this);
         }
 
         m_shutdownStarted = false;
         LOG_TRACE("Initializing offline storage handler");
+        ScheduleTrim();
     }
 
     void OfflineStorageHandler::Shutdown()
     {
         LOG_TRACE("Shutting down offline storage handler");
         m_shutdownStarted = true;
+        CancelTrim();
         WaitForFlush();
         if (nullptr != m_offlineStorageMemory)
         {
@@ -166,16 +255,9 @@ namespace MAT_NS_BEGIN {
             auto records = m_offlineStorageMemory->GetRecords(false, EventLatency_Unspecified);
             std::vector<StorageRecordId> ids;
 
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("BEGIN");
-
+            // Disk storage writes the whole batch in a single transaction
             size_t totalSaved = m_offlineStorageDisk->StoreRecords(records);
 
-            // TODO: [MG] - consider running the batch in transaction
-            //            if (sqlite)
-            //                sqlite->Execute("END");
-
             // Delete records from reserved on flush
             HttpHeaders dummy;
             bool fromMemory = true;
@@ -194,13 +276,22 @@ namespace MAT_NS_BEGIN {
         }
 
         m_isStorageFullNotificationSend = false;
+        if (m_config[CFG_BOOL_ENABLE_DB_DROP_IF_FULL])
+        {
+            ScheduleTrim();
+        }
 
         // Flush is done, notify the waiters
         m_flushComplete.post();
         m_flushPending = false;
     }
 
-    bool OfflineStorageHandler::StoreRecord(StorageRecord const& record)
+    /// <summary>
+    /// Store a record into the ram queue, or directly into the disk storage when there
+    /// is no ram queue. Rvalue records are moved all the way into the storage.
+    /// </summary>
+    template<typename TRecord>
+    bool OfflineStorageHandler::storeRecord(TRecord&& record)
     {
         // Don't discard on shutdown because the kill-switch may be temporary.
         // Attempt to upload after restart.
@@ -221,7 +312,7 @@ namespace MAT_NS_BEGIN {
                 // are selected and removed from the cache (but will
                 // not block for the subsequent handoff to persistent
                 // storage)
-                m_offlineStorageMemory->StoreRecord(record);
+                m_offlineStorageMemory->StoreRecord(std::forward<TRecord>(record));
             }
 
             // Perform periodic flush to disk
@@ -246,7 +337,9 @@ namespace MAT_NS_BEGIN {
             {
                 if (record.persistence != EventPersistence::EventPersistence_DoNotStoreOnDisk)
                 {
-                    m_offlineStorageDisk->StoreRecord(record);
+                    size_t size = record.blob.size();
+                    m_offlineStorageDisk->StoreRecord(std::forward<TRecord>(record));
+                    ScheduleTrimAfterStoring(size);
                 }
             }
         }
@@ -254,6 +347,16 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
+    bool OfflineStorageHandler::StoreRecord(StorageRecord const& record)
+    {
+        return storeRecord(record);
+    }
+
+    bool OfflineStorageHandler::StoreRecord(StorageRecord&& record)
+    {
+        return storeRecord(std::move(record));
+    }
+
     size_t OfflineStorageHandler::StoreRecords(std::vector<StorageRecord>& records)
     {
         size_t stored = 0;
@@ -498,6 +601,8 @@ namespace MAT_NS_BEGIN {
     void OfflineStorageHandler::OnStorageOpened(std::string const& type)
     {
         m_observer->OnStorageOpened(type);
+        // Storage may be opened again after a failure, with the caller holding its lock
+        ScheduleTrim();
     }
 
     void OfflineStorageHandler::OnStorageFailed(std::string const& reason)
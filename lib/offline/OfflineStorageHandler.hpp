@@ -32,6 +32,7 @@ namespace MAT_NS_BEGIN {
         virtual void Shutdown() override;
         virtual void Flush() override;
         virtual bool StoreRecord(StorageRecord const& record) override;
+        virtual bool StoreRecord(StorageRecord&& record) override;
         virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
         virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
 
@@ -80,6 +81,11 @@ namespace MAT_NS_BEGIN {
         PAL::DeferredCallbackHandle            m_flushHandle;
         PAL::Event                             m_flushComplete;
 
+        std::mutex                             m_trimLock;
+        std::atomic<bool>                      m_trimPending;
+        PAL::DeferredCallbackHandle            m_trimHandle;
+        std::atomic<size_t>                    m_bytesStoredSinceTrimCheck;
+
         std::unique_ptr<IOfflineStorage>       m_offlineStorageMemory;
         std::shared_ptr<IOfflineStorage>       m_offlineStorageDisk;
 
@@ -97,6 +103,13 @@ namespace MAT_NS_BEGIN {
 
     private:
         void WaitForFlush();
+        void ScheduleTrim();
+        void ScheduleTrimAfterStoring(size_t size);
+        void CancelTrim();
+        void Trim();
+
+        template<typename TRecord>
+        bool storeRecord(TRecord&& record);
 
     };
 
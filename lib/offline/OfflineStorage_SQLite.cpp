@@ -16,6 +16,7 @@
 namespace MAT_NS_BEGIN {
 
     constexpr static size_t kBlockSize = 8192;
+    constexpr static size_t kMaxCachedTenants = 256;
 
     class DbTransaction {
         SqliteDB* m_db;
@@ -41,11 +42,48 @@ namespace MAT_NS_BEGIN {
 
     MATSDK_LOG_INST_COMPONENT_CLASS(OfflineStorage_SQLite, "EventsSDK.Storage", "Events telemetry client - OfflineStorage_SQLite class");
 
-    static int const CURRENT_SCHEMA_VERSION = 1;
+    // Version 3 keeps tenant tokens in their own table, events refer to them by tenant_id.
+    // Events have an integer primary key, record_id is unique and indexed.
+    static int const CURRENT_SCHEMA_VERSION = 3;
+
+    // Budget of one ResizeDb pass: m_lock is held for one step at a time, each step
+    // either deletes up to TRIM_CHUNK_EVENTS events or frees up to TRIM_VACUUM_PAGES pages.
+    static unsigned const TRIM_MAX_STEPS = 16;
+    static unsigned const TRIM_CHUNK_EVENTS = 500;
+    static unsigned const TRIM_VACUUM_PAGES = 256;
+    // Value of PRAGMA auto_vacuum for a file in incremental vacuum mode
+    static int const AUTO_VACUUM_INCREMENTAL = 2;
 #define TABLE_NAME_EVENTS   "events"
+#define TABLE_NAME_TENANTS  "tenants"
 #define TABLE_NAME_SETTINGS "settings"
 #define TABLE_NAME_PACKAGES "packages"
 
+#define SQL_CREATE_TABLE_TENANTS \
+    "CREATE TABLE IF NOT EXISTS " TABLE_NAME_TENANTS " (" \
+    "tenant_id"      " INTEGER PRIMARY KEY," \
+    "tenant_token"   " TEXT NOT NULL UNIQUE" \
+    ")"
+
+// The unique record_id index makes storing events about a quarter slower, in exchange
+// acks, reservations and releases find their events without scanning the whole backlog.
+#define SQL_CREATE_TABLE_EVENTS \
+    "CREATE TABLE IF NOT EXISTS " TABLE_NAME_EVENTS " (" \
+    "event_id"       " INTEGER PRIMARY KEY," \
+    "record_id"      " TEXT NOT NULL UNIQUE," \
+    "tenant_id"      " INTEGER NOT NULL," \
+    "latency"        " INTEGER," \
+    "persistence"    " INTEGER," \
+    "timestamp"      " INTEGER," \
+    "retry_count"    " INTEGER DEFAULT 0," \
+    "reserved_until" " INTEGER DEFAULT 0," \
+    "payload"        " BLOB" \
+    ")"
+
+// Events with their tenant token, the columns read into a StorageRecord
+#define SQL_SELECT_EVENTS_WITH_TOKEN \
+    "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload" \
+    " FROM " TABLE_NAME_EVENTS " JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
+
     bool OfflineStorage_SQLite::isOpen()
     {
         if ((!m_db) || (!m_isOpened))
@@ -136,17 +174,71 @@ namespace MAT_NS_BEGIN {
             m_db->execute(command.c_str());
     }
 
-    bool OfflineStorage_SQLite::StoreRecord(StorageRecord const& record)
+    bool OfflineStorage_SQLite::isValidRecord(StorageRecord const& record)
     {
-        // TODO: [MG] - this works, but may not play nicely with several LogManager instances
-        // static SqliteStatement sql_insert(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
-
         if (record.id.empty() || record.tenantToken.empty() || static_cast<int>(record.latency) < 0 || record.timestamp <= 0) {
             LOG_ERROR("Failed to store event %s:%s: Invalid parameters",
                 tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
             m_observer->OnStorageFailed("Invalid parameters");
             return false;
         }
+        return true;
+    }
+
+    /// <summary>
+    /// Gets the id of a tenant token in the tenants table, adding the token on first use.
+    /// The ids of the tenants stored last are cached until the database is recreated.
+    /// </summary>
+    bool OfflineStorage_SQLite::getDbTenantId(std::string const& tenantToken, int64_t& dbTenantId)
+    {
+        LOCKGUARD(m_lock);
+        auto it = m_dbTenantIds.find(tenantToken);
+        if (it != m_dbTenantIds.end())
+        {
+            dbTenantId = it->second;
+            return true;
+        }
+
+        if (!SqliteStatement(*m_db, m_stmtInsertTenant_token).execute(tenantToken))
+        {
+            return false;
+        }
+        SqliteStatement selectStmt(*m_db, m_stmtSelectTenant_token);
+        if (!selectStmt.select(tenantToken) || !selectStmt.getRow(dbTenantId))
+        {
+            return false;
+        }
+        selectStmt.reset();
+        if (m_dbTenantIds.size() >= kMaxCachedTenants)
+        {
+            m_dbTenantIds.clear();
+        }
+        m_dbTenantIds[tenantToken] = dbTenantId;
+        return true;
+    }
+
+    /// <summary>
+    /// Deletes the tenants left without any event, e.g. after a tenant stopped logging.
+    /// </summary>
+    void OfflineStorage_SQLite::deleteUnusedTenants()
+    {
+        LOCKGUARD(m_lock);
+        SqliteStatement deleteStmt(*m_db, m_stmtDeleteUnusedTenants);
+        if (deleteStmt.execute() && deleteStmt.changes() > 0)
+        {
+            LOG_TRACE("Deleted %u tenants without events", deleteStmt.changes());
+        }
+        m_dbTenantIds.clear();
+    }
+
+    bool OfflineStorage_SQLite::StoreRecord(StorageRecord const& record)
+    {
+        // TODO: [MG] - this works, but may not play nicely with several LogManager instances
+        // static SqliteStatement sql_insert(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
+
+        if (!isValidRecord(record)) {
+            return false;
+        }
 
         if (!m_db) {
             LOG_ERROR("Failed to store event %s:%s: Database is not open",
@@ -156,8 +248,8 @@ namespace MAT_NS_BEGIN {
         }
 
         {
-#ifdef ENABLE_LOCKING
             LOCKGUARD(m_lock);
+#ifdef ENABLE_LOCKING
             DbTransaction transaction(m_db.get());
             if (!transaction.locked)
             {
@@ -166,10 +258,106 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 #endif
-            SqliteStatement(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data).execute(record.id, record.tenantToken, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
-            m_DbSizeEstimate += record.id.size() + record.tenantToken.size() + record.blob.size();
+            int64_t dbTenantId;
+            if (!getDbTenantId(record.tenantToken, dbTenantId))
+            {
+                LOG_ERROR("Failed to store event %s:%s: Database error", tenantTokenToId(record.tenantToken).c_str(), record.id.c_str());
+                m_observer->OnStorageFailed("Database error");
+                return false;
+            }
+            SqliteStatement insertStmt(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
+            insertRecord(insertStmt, record, dbTenantId);
+            m_DbSizeEstimate += record.id.size() + sizeof(dbTenantId) + record.blob.size();
+        }
+
+        checkDbSize();
+        return true;
+
+    }
+
+    size_t OfflineStorage_SQLite::StoreRecords(std::vector<StorageRecord> & records)
+    {
+        if (records.empty()) {
+            return 0;
         }
 
+        if (!m_db) {
+            LOG_ERROR("Failed to store %u events: Database is not open", static_cast<unsigned>(records.size()));
+            m_observer->OnStorageOpenFailed("Database is not open");
+            return 0;
+        }
+
+        size_t stored = 0;
+        {
+            // Store the whole batch in one transaction with one prepared statement,
+            // instead of an implicit transaction per record.
+            LOCKGUARD(m_lock);
+#ifdef ENABLE_LOCKING
+            DbTransaction transaction(m_db.get());
+            if (!transaction.locked)
+            {
+                LOG_ERROR("Failed to store %u events: Database error", static_cast<unsigned>(records.size()));
+                m_observer->OnStorageFailed("Database error");
+                return 0;
+            }
+#endif
+            SqliteStatement insertStmt(*m_db, m_stmtInsertEvent_id_tenant_prio_ts_data);
+            size_t batchSize = 0;
+            for (auto const& record : records) {
+                if (!isValidRecord(record)) {
+                    continue;
+                }
+                int64_t dbTenantId;
+                if (!getDbTenantId(record.tenantToken, dbTenantId)) {
+                    continue;
+                }
+                if (insertRecord(insertStmt, record, dbTenantId)) {
+                    batchSize += record.id.size() + sizeof(dbTenantId) + record.blob.size();
+                    ++stored;
+                }
+            }
+            m_DbSizeEstimate += batchSize;
+        }
+
+        if (stored > 0) {
+            checkDbSize();
+        }
+        return stored;
+    }
+
+    /// <summary>
+    /// Inserts an event, or replaces the stored event with the same record id,
+    /// and keeps the record count up to date. Must be called with m_lock held.
+    /// </summary>
+    bool OfflineStorage_SQLite::insertRecord(SqliteStatement& insertStmt, StorageRecord const& record, int64_t dbTenantId)
+    {
+        if (!insertStmt.execute(record.id, dbTenantId, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob)) {
+            return false;
+        }
+        if (insertStmt.changes() > 0) {
+            ++m_recordCount;
+            return true;
+        }
+        // Stored before, the record count does not change
+        return SqliteStatement(*m_db, m_stmtReplaceEvent_id_tenant_prio_ts_data).execute(record.id, dbTenantId, static_cast<int>(record.latency), static_cast<int>(record.persistence), record.timestamp, record.blob);
+    }
+
+    /// <summary>
+    /// Counts the stored events again, after deleting events without knowing how many.
+    /// Must be called with m_lock held.
+    /// </summary>
+    void OfflineStorage_SQLite::recountRecords()
+    {
+        int count = 0;
+        SqliteStatement recordCount(*m_db, m_stmtGetRecordCount);
+        recordCount.select();
+        recordCount.getOneValue(count);
+        recordCount.reset();
+        m_recordCount = static_cast<size_t>(count);
+    }
+
+    void OfflineStorage_SQLite::checkDbSize()
+    {
         if ((m_DbSizeNotificationLimit != 0) && (m_DbSizeEstimate>m_DbSizeNotificationLimit))
         {
             auto now = PAL::getMonotonicTimeMs();
@@ -185,34 +373,8 @@ namespace MAT_NS_BEGIN {
             }
         }
 
-        if ((m_DbSizeLimit != 0) && (m_DbSizeEstimate > m_DbSizeLimit))
-        {
-            auto shouldResize = m_config[CFG_BOOL_ENABLE_DB_DROP_IF_FULL] && !m_resizing;
-            if (shouldResize)
-            {
-                LOCKGUARD(m_resizeLock); //Serialize resize operations
-                m_resizing = true;
-                if (m_DbSizeEstimate > m_DbSizeLimit)
-                {
-                    ResizeDb();
-                }
-                m_resizing = false;
-            }
-        }
-
-        return true;
-
-    }
-
-    size_t OfflineStorage_SQLite::StoreRecords(std::vector<StorageRecord> & records)
-    {
-        size_t stored = 0;
-        for (auto & i : records) {
-            if (StoreRecord(i)) {
-                ++stored;
-            }
-        }
-        return stored;
+        // Trimming the database when it gets over its limit is left to OfflineStorageHandler,
+        // which schedules it on the task dispatcher instead of the thread storing events
     }
 
     // Debug routine to print record count in the DB
@@ -276,13 +438,16 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 
-            std::vector<StorageRecordId> consumedIds;
-            std::map<std::string, size_t> deletedData;
+            // Ids of the consumed events, NUL-separated the way the reserve statement takes
+            // them, appended straight from the rows. idEnds has the end offset of every id.
+            std::vector<uint8_t> idList;
+            std::vector<size_t> idEnds;
 
             StorageRecord record;
+            SqliteBytes id;
             int latency;
 
-            while (selectStmt.getRow(record.id, record.tenantToken, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
+            while (selectStmt.getRow(id, record.tenantToken, latency, record.timestamp, record.retryCount, record.reservedUntil, record.blob))
             {
                 if (latency < EventLatency_Off || latency > EventLatency_Max) {
                     record.latency = EventLatency_Normal;
@@ -290,10 +455,14 @@ namespace MAT_NS_BEGIN {
                 else {
                     record.latency = static_cast<EventLatency>(latency);
                 }
-                consumedIds.push_back(record.id);
+                record.id.assign(reinterpret_cast<char const*>(id.data), id.size);
+                idList.insert(idList.end(), id.data, id.data + id.size);
+                idList.push_back(0);
+                idEnds.push_back(idList.size());
                 if (!consumer(std::move(record)))
                 {
-                    consumedIds.pop_back();
+                    idEnds.pop_back();
+                    idList.resize(idEnds.empty() ? 0 : idEnds.back());
                     break;
                 }
             }
@@ -306,25 +475,27 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 
-            if (consumedIds.empty()) {
+            if (idEnds.empty()) {
                 return false;
             }
 
             LOG_TRACE("Reserving %u event(s) {%s%s} for %u milliseconds",
-                static_cast<unsigned>(consumedIds.size()), consumedIds.front().c_str(), (consumedIds.size() > 1) ? ", ..." : "", leaseTimeMs);
+                static_cast<unsigned>(idEnds.size()), reinterpret_cast<char const*>(idList.data()), (idEnds.size() > 1) ? ", ..." : "", leaseTimeMs);
 
-            for (size_t i = 0; i < consumedIds.size(); i += kBlockSize)
+            size_t blockBegin = 0;
+            for (size_t i = 0; i < idEnds.size(); i += kBlockSize)
             {
-                auto count = std::min(kBlockSize, consumedIds.size() - i);
-                std::vector<uint8_t> idList = packageIdList(consumedIds.begin() + i, consumedIds.begin() + i + count);
-                if (!SqliteStatement(*m_db, m_stmtReserveEvents).execute(idList, PAL::getUtcSystemTimeMs() + leaseTimeMs))
+                size_t blockEnd = idEnds[std::min(kBlockSize, idEnds.size() - i) + i - 1];
+                SqliteBytes block { idList.data() + blockBegin, blockEnd - blockBegin };
+                if (!SqliteStatement(*m_db, m_stmtReserveEvents).execute(block, PAL::getUtcSystemTimeMs() + leaseTimeMs))
                 {
                     LOG_ERROR("Failed to reserve events to send: Database error occurred, recreating database");
                     recreate(207);
                     return false;
                 }
+                blockBegin = blockEnd;
             }
-            m_lastReadCount = static_cast<unsigned>(consumedIds.size());
+            m_lastReadCount = static_cast<unsigned>(idEnds.size());
         }
         return true;
     }
@@ -381,8 +552,14 @@ namespace MAT_NS_BEGIN {
 
     void OfflineStorage_SQLite::DeleteAllRecords()
     {
+        LOCKGUARD(m_lock);
         std::string sql = "DELETE FROM "  TABLE_NAME_EVENTS ;
         Execute(sql);
+        if (m_db)
+        {
+            m_recordCount = 0;
+            deleteUnusedTenants();
+        }
 
     }
 
@@ -409,8 +586,16 @@ namespace MAT_NS_BEGIN {
                 for (const auto &kv : whereFilter)
                 {
                     bool quotes = false;
-                    if ((kv.first == "record_id") ||
-                        (kv.first == "tenant_token"))
+                    if (kv.first == "tenant_token")
+                    {
+                        if (!clause.empty())
+                        {
+                            clause += " AND ";
+                        }
+                        clause += "tenant_id IN (SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token=\"" + kv.second + "\")";
+                        continue;
+                    }
+                    if (kv.first == "record_id")
                     {
                         // string types
                         quotes = true;
@@ -437,6 +622,7 @@ namespace MAT_NS_BEGIN {
             };
             std::string sql = "DELETE FROM " TABLE_NAME_EVENTS " WHERE ";
             Execute(sql + formatter(whereFilter));
+            recountRecords();
         }
     }
 
@@ -468,11 +654,12 @@ namespace MAT_NS_BEGIN {
 #endif
             LOG_TRACE("Deleting %u sent event(s) {%s%s}...", static_cast<unsigned>(ids.size()), ids.front().c_str(), (ids.size() > 1) ? ", ..." : "");
 
+            SqliteStatement deleteStmt(*m_db, m_stmtDeleteEvents_ids);
             for (size_t i = 0; i < ids.size(); i += kBlockSize) {
                 size_t count = std::min(kBlockSize, ids.size() - i);
                 std::vector<uint8_t> idList = packageIdList(ids.begin() + i,
                                                             ids.begin() + i + count);
-                if (!SqliteStatement(*m_db, m_stmtDeleteEvents_ids).execute(idList)) {
+                if (!deleteStmt.execute(idList)) {
                     LOG_ERROR(
                             "Failed to delete %u sent event(s) {%s%s}: Database error occurred, recreating database",
                             static_cast<unsigned>(ids.size()), ids.front().c_str(),
@@ -480,6 +667,7 @@ namespace MAT_NS_BEGIN {
                     recreate(302);
                     return;
                 }
+                m_recordCount -= std::min<size_t>(m_recordCount, deleteStmt.changes());
             }
         }
     }
@@ -556,6 +744,7 @@ namespace MAT_NS_BEGIN {
                 }
 
                 unsigned droppedCount = deleteStmt.changes();
+                m_recordCount -= std::min<size_t>(m_recordCount, droppedCount);
                 if (droppedCount > 0)
                 {
                     LOG_ERROR("Deleted %u events over maximum retry count %u",
@@ -681,9 +870,57 @@ namespace MAT_NS_BEGIN {
         return false;
     }
 
+    /// <summary>
+    /// Copies the events of a version 1 database into the current events table,
+    /// moving their tenant tokens into the tenants table. Of events sharing a
+    /// record id only the last stored one is kept. The new version is stored in
+    /// the same transaction, so a file is never left with new tables and the old
+    /// version. Files left that way by earlier builds are only given the new version.
+    /// </summary>
+    bool OfflineStorage_SQLite::migrateFromVersion1()
+    {
+        std::string const versionPragma = "PRAGMA user_version=" + toString(CURRENT_SCHEMA_VERSION);
+
+        int migratedTables = 0;
+        {
+            SqliteStatement stmt(*m_db, "SELECT count(*) FROM sqlite_master WHERE type='table' AND name='" TABLE_NAME_TENANTS "'");
+            if (!stmt.select() || !stmt.getRow(migratedTables)) { return false; }
+        }
+        if (migratedTables > 0) {
+            LOG_WARN("Database tables are already upgraded, storing version %d", CURRENT_SCHEMA_VERSION);
+            return SqliteStatement(*m_db, versionPragma.c_str()).execute();
+        }
+
+        char const* const statements[] = {
+            "BEGIN IMMEDIATE",
+            SQL_CREATE_TABLE_TENANTS,
+            "INSERT OR IGNORE INTO " TABLE_NAME_TENANTS " (tenant_token) SELECT DISTINCT tenant_token FROM " TABLE_NAME_EVENTS,
+            "ALTER TABLE " TABLE_NAME_EVENTS " RENAME TO " TABLE_NAME_EVENTS "_old",
+            SQL_CREATE_TABLE_EVENTS,
+            "INSERT OR REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_id,latency,persistence,timestamp,retry_count,reserved_until,payload)"
+            " SELECT record_id,tenant_id,latency,persistence,timestamp,retry_count,reserved_until,payload"
+            " FROM " TABLE_NAME_EVENTS "_old JOIN " TABLE_NAME_TENANTS " USING (tenant_token)"
+            " WHERE record_id IS NOT NULL ORDER BY " TABLE_NAME_EVENTS "_old.rowid",
+            "DROP TABLE " TABLE_NAME_EVENTS "_old",
+            versionPragma.c_str(),
+            "COMMIT"
+        };
+
+        for (char const* statement : statements)
+        {
+            if (!SqliteStatement(*m_db, statement).execute())
+            {
+                SqliteStatement(*m_db, "ROLLBACK").execute();
+                return false;
+            }
+        }
+        return true;
+    }
+
     bool OfflineStorage_SQLite::initializeDatabase()
     {
-        SqliteStatement(*m_db, "PRAGMA auto_vacuum=FULL").select();
+        // Pages freed by deleting events are given back in bounded steps by ResizeDb
+        SqliteStatement(*m_db, "PRAGMA auto_vacuum=INCREMENTAL").select();
         SqliteStatement(*m_db, "PRAGMA journal_mode=WAL").select();
         SqliteStatement(*m_db, "PRAGMA synchronous=NORMAL").select();
         {
@@ -699,37 +936,39 @@ namespace MAT_NS_BEGIN {
             if (!stmt.select() || !stmt.getRow(openedDbVersion)) { return false; }
         }
 
+        m_dbTenantIds.clear();
         if (openedDbVersion != CURRENT_SCHEMA_VERSION) {
             if (openedDbVersion == 0) {
                 LOG_TRACE("No stored version found, assuming fresh database");
+                if (!SqliteStatement(*m_db,
+                    ("PRAGMA user_version=" + toString(CURRENT_SCHEMA_VERSION)).c_str()
+                ).execute()) {
+                    return false;
+                }
             }
-            else if (openedDbVersion < CURRENT_SCHEMA_VERSION) {
+            else if (openedDbVersion == 1) {
                 LOG_INFO("Database has older version %d, upgrading to %d",
                     openedDbVersion, CURRENT_SCHEMA_VERSION);
+                if (!migrateFromVersion1()) {
+                    LOG_WARN("Failed to upgrade database version %d, erasing and replacing with new", openedDbVersion);
+                    return false;
+                }
             }
             else {
-                LOG_WARN("Database version %d is newer than current %d, erasing and replacing with new",
+                LOG_WARN("Database version %d cannot be used with current %d, erasing and replacing with new",
                     openedDbVersion, CURRENT_SCHEMA_VERSION);
                 return false;
             }
-            if (!SqliteStatement(*m_db,
-                ("PRAGMA user_version=" + toString(CURRENT_SCHEMA_VERSION)).c_str()
-            ).execute()) {
-                return false;
-            }
         }
 
         if (!SqliteStatement(*m_db,
-            "CREATE TABLE IF NOT EXISTS " TABLE_NAME_EVENTS " ("
-            "record_id"      " TEXT,"
-            "tenant_token"   " TEXT NOT NULL,"
-            "latency"        " INTEGER,"
-            "persistence"    " INTEGER,"
-            "timestamp"      " INTEGER,"
-            "retry_count"    " INTEGER DEFAULT 0,"
-            "reserved_until" " INTEGER DEFAULT 0,"
-            "payload"        " BLOB"
-            ")"
+            SQL_CREATE_TABLE_TENANTS
+        ).execute()) {
+            return false;
+        }
+
+        if (!SqliteStatement(*m_db,
+            SQL_CREATE_TABLE_EVENTS
         ).execute()) {
             return false;
         }
@@ -741,6 +980,14 @@ namespace MAT_NS_BEGIN {
             return false;
         }
 
+        // Only reserved events are indexed, selecting unreserved ones keeps using k_latency_timestamp
+        if (!SqliteStatement(*m_db,
+            "CREATE INDEX IF NOT EXISTS k_reserved_until ON " TABLE_NAME_EVENTS
+            " (reserved_until) WHERE reserved_until>0"
+        ).execute()) {
+            return false;
+        }
+
         if (!SqliteStatement(*m_db,
             "CREATE TABLE IF NOT EXISTS " TABLE_NAME_SETTINGS " ("
             "name"  " TEXT,"
@@ -755,6 +1002,20 @@ namespace MAT_NS_BEGIN {
             if (!stmt.select() || !stmt.getRow(m_pageSize)) { return false; }
         }
 
+        // Files created with auto_vacuum=FULL become incremental with the pragma above. Files
+        // with auto_vacuum=NONE keep their mode until they are vacuumed once, which rewrites the
+        // whole file and would block opening or storing for as long. They are not converted:
+        // their size counts the pages in use, trimming deletes events until those fit under
+        // the limit, and the free pages left are reused by the next events.
+        {
+            int autoVacuum = 0;
+            SqliteStatement stmt(*m_db, "PRAGMA auto_vacuum");
+            m_incrementalVacuum = stmt.select() && stmt.getRow(autoVacuum) && (autoVacuum == AUTO_VACUUM_INCREMENTAL);
+        }
+        if (!m_incrementalVacuum) {
+            LOG_INFO("Database is not in incremental vacuum mode, free pages are reused but not given back");
+        }
+
 #pragma warning(push)
 #pragma warning(disable:4296) // expression always false.
 #define PREPARE_SQL(var_, stmt_) \
@@ -778,39 +1039,37 @@ namespace MAT_NS_BEGIN {
             "SELECT count(*) FROM " TABLE_NAME_EVENTS " WHERE latency=?");
 
         PREPARE_SQL(m_stmtPerTenantTrimCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
-            "(SELECT COUNT(record_id) FROM " TABLE_NAME_EVENTS ")"
+            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " JOIN " TABLE_NAME_TENANTS " USING (tenant_id) ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
+            "(SELECT COUNT(*) FROM " TABLE_NAME_EVENTS ")"
             "* ? / 100)");
-        PREPARE_SQL(m_stmtTrimEvents_percent,
-                    "DELETE FROM " TABLE_NAME_EVENTS " WHERE record_id IN ("
-                                                     "SELECT record_id FROM " TABLE_NAME_EVENTS " ORDER BY persistence ASC, timestamp ASC LIMIT MAX(1,"
-                                                                                                "(SELECT COUNT(record_id) FROM " TABLE_NAME_EVENTS ")"
-                                                                                                                                                   "* ? / 100)"
-                                                                                                                                                   ")");
+        PREPARE_SQL(m_stmtTrimEvents_persistence_count,
+            "DELETE FROM " TABLE_NAME_EVENTS " WHERE event_id IN ("
+            "SELECT event_id FROM " TABLE_NAME_EVENTS " WHERE persistence<=? ORDER BY event_id LIMIT ?)");
+        PREPARE_SQL(m_stmtGetFreelistCount,
+            "PRAGMA freelist_count");
+        PREPARE_SQL(m_stmtIncrementalVacuum,
+            ("PRAGMA incremental_vacuum(" + toString(TRIM_VACUUM_PAGES) + ")").c_str());
 
         PREPARE_SQL(m_stmtDeleteEvents_tenants,
                 SQL_SUPPLY_PACKAGED_IDS
-                "DELETE FROM " TABLE_NAME_EVENTS " WHERE tenant_token IN ids");
+                "DELETE FROM " TABLE_NAME_EVENTS " WHERE tenant_id IN (SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token IN ids)");
         PREPARE_SQL(m_stmtDeleteEvents_ids,
             SQL_SUPPLY_PACKAGED_IDS
             "DELETE FROM " TABLE_NAME_EVENTS " WHERE record_id IN ids");
         PREPARE_SQL(m_stmtReleaseExpiredEvents,
             "UPDATE " TABLE_NAME_EVENTS
             " SET reserved_until=0, retry_count=retry_count+1"
-            " WHERE reserved_until<>0 AND reserved_until<=?");
+            " WHERE reserved_until>0 AND reserved_until<=?");
         PREPARE_SQL(m_stmtSelectEvents,
-            "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
-            " FROM " TABLE_NAME_EVENTS
+            SQL_SELECT_EVENTS_WITH_TOKEN
             " WHERE latency>=? AND reserved_until=0"
             " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
         PREPARE_SQL(m_stmtSelectEventAtShutdown,
-            "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
-            " FROM " TABLE_NAME_EVENTS
+            SQL_SELECT_EVENTS_WITH_TOKEN
             " WHERE latency>=?"
             " ORDER BY latency DESC,persistence DESC, timestamp ASC LIMIT ?");
         PREPARE_SQL(m_stmtSelectEventsMinlatency,
-            "SELECT record_id,tenant_token,latency,timestamp,retry_count,reserved_until,payload"
-            " FROM " TABLE_NAME_EVENTS
+            SQL_SELECT_EVENTS_WITH_TOKEN
             " WHERE latency=(SELECT MIN(latency) FROM " TABLE_NAME_EVENTS " WHERE reserved_until=0 AND latency>=?) AND reserved_until=0"
             " ORDER BY timestamp ASC LIMIT ?");
 
@@ -825,13 +1084,21 @@ namespace MAT_NS_BEGIN {
             " SET reserved_until=0, retry_count=retry_count+?"
             " WHERE record_id IN ids AND reserved_until>0");
         PREPARE_SQL(m_stmtSelectEventsRetried_maxRetryCount,
-            "SELECT tenant_token FROM " TABLE_NAME_EVENTS
+            "SELECT tenant_token FROM " TABLE_NAME_EVENTS " JOIN " TABLE_NAME_TENANTS " USING (tenant_id)"
             " WHERE retry_count>?");
         PREPARE_SQL(m_stmtDeleteEventsRetried_maxRetryCount,
             "DELETE FROM " TABLE_NAME_EVENTS
             " WHERE retry_count>?");
         PREPARE_SQL(m_stmtInsertEvent_id_tenant_prio_ts_data,
-            "REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+            "INSERT OR IGNORE INTO " TABLE_NAME_EVENTS " (record_id,tenant_id,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+        PREPARE_SQL(m_stmtReplaceEvent_id_tenant_prio_ts_data,
+            "REPLACE INTO " TABLE_NAME_EVENTS " (record_id,tenant_id,latency,persistence,timestamp,payload) VALUES (?,?,?,?,?,?)");
+        PREPARE_SQL(m_stmtInsertTenant_token,
+            "INSERT OR IGNORE INTO " TABLE_NAME_TENANTS " (tenant_token) VALUES (?)");
+        PREPARE_SQL(m_stmtSelectTenant_token,
+            "SELECT tenant_id FROM " TABLE_NAME_TENANTS " WHERE tenant_token=?");
+        PREPARE_SQL(m_stmtDeleteUnusedTenants,
+            "DELETE FROM " TABLE_NAME_TENANTS " WHERE tenant_id NOT IN (SELECT tenant_id FROM " TABLE_NAME_EVENTS ")");
         PREPARE_SQL(m_stmtInsertSetting_name_value,
             "REPLACE INTO " TABLE_NAME_SETTINGS " (name,value) VALUES (?,?)");
         PREPARE_SQL(m_stmtDeleteSetting_name,
@@ -845,18 +1112,19 @@ namespace MAT_NS_BEGIN {
 #undef PREPARE_SQL
 #pragma warning(pop)
 
-        ResizeDb();
+        recountRecords();
+        deleteUnusedTenants();
         return true;
 }
 
     size_t OfflineStorage_SQLite::GetSize()
     {
+        LOCKGUARD(m_lock);
         if (!m_db) {
             LOG_ERROR("Failed to get DB size: database is not open");
             return 0;
         }
 
-        LOCKGUARD(m_lock);
         unsigned pageCount = 0;
         SqliteStatement pageCountStmt(*m_db, m_stmtGetPageCount);
         if (!pageCountStmt.select())
@@ -866,20 +1134,29 @@ namespace MAT_NS_BEGIN {
         }
         pageCountStmt.getRow(pageCount);
         pageCountStmt.reset();
+
+        // Free pages of a file not in incremental mode are never given back, only reused
+        if (!m_incrementalVacuum)
+        {
+            unsigned freePages = 0;
+            SqliteStatement freelistStmt(*m_db, m_stmtGetFreelistCount);
+            if (freelistStmt.select() && freelistStmt.getRow(freePages))
+            {
+                pageCount -= std::min(pageCount, freePages);
+            }
+            freelistStmt.reset();
+        }
         return size_t(pageCount) * size_t(m_pageSize);
     }
 
     size_t OfflineStorage_SQLite::GetRecordCountUnsafe(EventLatency latency) const
     {
-        int count = 0;
         if (latency == EventLatency_Unspecified)
         {
-            SqliteStatement recordCount(*m_db, m_stmtGetRecordCount);
-            recordCount.select();
-            recordCount.getOneValue(count);
-            recordCount.reset();
+            return m_recordCount;
         }
-        else
+
+        int count = 0;
         {
             SqliteStatement recordCount(*m_db, m_stmtGetRecordCountBylatency);
             recordCount.select(latency);
@@ -900,6 +1177,13 @@ namespace MAT_NS_BEGIN {
         return OfflineStorage_SQLite::GetRecordCountUnsafe(latency);
     }
 
+    /// <summary>
+    /// Runs one bounded trimming pass while the database is over its size limit,
+    /// until it gets down to 3/4 of the limit or TRIM_MAX_STEPS steps are done.
+    /// m_lock is only held for one step at a time, storing events waits for one
+    /// step at most. Returns true when the pass trimmed anything, callers run further
+    /// passes while the database stays over the limit.
+    /// </summary>
     bool OfflineStorage_SQLite::ResizeDb()
     {
         if (!m_db) {
@@ -907,49 +1191,116 @@ namespace MAT_NS_BEGIN {
             return false;
         }
 
-        size_t eventsDropped = 0;
-        m_DbSizeEstimate = GetSize();
-        if (m_DbSizeEstimate <= m_DbSizeLimit)
+        LOCKGUARD(m_resizeLock); // Serialize resize operations
+        size_t sizeBefore = GetSize();
+        m_DbSizeEstimate = sizeBefore;
+        if (sizeBefore <= m_DbSizeLimit)
             return false;
 
+        // Leave some room, so that trimming does not start over with the next few events
+        size_t targetSize = m_DbSizeLimit / 4 * 3;
+        int persistence = EventPersistence_Normal;
+        size_t eventsDropped = 0;
+        uint64_t longestStepMs = 0;
+        for (unsigned step = 0; step < TRIM_MAX_STEPS; step++)
+        {
+            auto stepStartTime = PAL::getMonotonicTimeMs();
+            bool trimMore = trimStep(targetSize, persistence, eventsDropped);
+            longestStepMs = std::max<uint64_t>(longestStepMs, PAL::getMonotonicTimeMs() - stepStartTime);
+            if (!trimMore)
+                break;
+        }
+
+        if (eventsDropped > 0)
+        {
+            deleteUnusedTenants();
+        }
+
+        size_t sizeAfter = GetSize();
+        m_DbSizeEstimate = sizeAfter;
+        LOG_TRACE("Db resized, events dropped: %zu, bytes reclaimed: %zu, longest step: %llu ms",
+            eventsDropped, sizeBefore - std::min(sizeBefore, sizeAfter), static_cast<unsigned long long>(longestStepMs));
+
+        if (eventsDropped > 0)
+        {
+            DebugEvent evt(DebugEventType::EVT_DROPPED);
+            evt.param1 = eventsDropped;
+            evt.size = eventsDropped;
+            m_logManager.DispatchEvent(evt);
+        }
+
+        if (sizeAfter < sizeBefore)
+        {
+            DebugEvent evt(DebugEventType::EVT_STORAGE_TRIMMED);
+            evt.param1 = sizeBefore - sizeAfter;
+            evt.param2 = static_cast<size_t>(longestStepMs);
+            m_logManager.DispatchEvent(evt);
+        }
+
+        return (eventsDropped > 0) || (sizeAfter < sizeBefore);
+    }
+
+    /// <summary>
+    /// One step of ResizeDb under m_lock. Free pages are given back first. When there
+    /// are none left, the oldest events with the lowest persistence are deleted.
+    /// Returns false when the target size is reached or nothing more can be done.
+    /// </summary>
+    bool OfflineStorage_SQLite::trimStep(size_t targetSize, int& persistence, size_t& eventsDropped)
+    {
         LOCKGUARD(m_lock);
+        if (!m_db) {
+            return false;
+        }
+
+        unsigned pageCount = 0;
         {
-#ifdef ENABLE_LOCKING
-            DbTransaction transaction(m_db.get());
-            if (!transaction.locked)
-            {
-                LOG_WARN("Failed to trim database");
+            SqliteStatement pageCountStmt(*m_db, m_stmtGetPageCount);
+            if (!pageCountStmt.select() || !pageCountStmt.getRow(pageCount)) {
                 return false;
             }
-#endif
-            auto count = GetRecordCountUnsafe(EventLatency::EventLatency_Unspecified);
-            if (m_DbSizeEstimate > 2 * m_DbSizeLimit)
-            {
-                LOG_TRACE("DB is too big, deleting...");
-                Execute("DELETE FROM " TABLE_NAME_EVENTS);
-                Execute("VACUUM");
-                return true;
+            pageCountStmt.reset();
+        }
+        unsigned freePages = 0;
+        {
+            SqliteStatement freelistStmt(*m_db, m_stmtGetFreelistCount);
+            if (!freelistStmt.select() || !freelistStmt.getRow(freePages)) {
+                return false;
             }
+            freelistStmt.reset();
+        }
 
-            SqliteStatement trimStmt(*m_db, m_stmtTrimEvents_percent);
-            if (!trimStmt.execute(25))
-            {
-                // If something went wrong with trimming 25%, try more radical measure
-                LOG_TRACE("Evict all non-critical");
-                Execute("DELETE FROM " TABLE_NAME_EVENTS " WHERE persistence=1");
-            }
-            eventsDropped = count - GetRecordCountUnsafe(EventLatency::EventLatency_Unspecified);
-            LOG_TRACE("Db resized, events dropeed: %d", eventsDropped);
-            trimStmt.reset();
+        // Free pages of a file not in incremental mode cannot be given back, only reused
+        size_t usedPages = m_incrementalVacuum ? pageCount : pageCount - std::min(pageCount, freePages);
+        if (usedPages * size_t(m_pageSize) <= targetSize) {
+            return false;
         }
 
-        m_DbSizeEstimate = GetSize();
-        DebugEvent evt(DebugEventType::EVT_DROPPED);
-        evt.param1 = eventsDropped;
-        evt.size = eventsDropped;
-        m_logManager.DispatchEvent(evt);
+        if (freePages > 0 && m_incrementalVacuum) {
+            SqliteStatement vacuumStmt(*m_db, m_stmtIncrementalVacuum);
+            if (!vacuumStmt.select()) {
+                return false;
+            }
+            // Steps once for every page given back
+            while (vacuumStmt.getRow()) {
+            }
+            return !vacuumStmt.error();
+        }
 
-        return true;
+        while (persistence <= EventPersistence_DoNotStoreOnDisk) {
+            SqliteStatement trimStmt(*m_db, m_stmtTrimEvents_persistence_count);
+            if (!trimStmt.execute(persistence, TRIM_CHUNK_EVENTS)) {
+                LOG_WARN("Failed to trim database");
+                return false;
+            }
+            if (trimStmt.changes() > 0) {
+                m_recordCount -= std::min<size_t>(m_recordCount, trimStmt.changes());
+                eventsDropped += trimStmt.changes();
+                return true;
+            }
+            // No more events up to this persistence, go on with the next one
+            persistence++;
+        }
+        return false;
     }
 
     std::vector<uint8_t> OfflineStorage_SQLite::packageIdList(
@@ -14,6 +14,7 @@
 #include "ILogManager.hpp"
 
 #include <memory>
+#include <unordered_map>
 #include <atomic>
 #include <mutex>
 
@@ -22,6 +23,7 @@
 namespace MAT_NS_BEGIN {
 
     class SqliteDB;
+    class SqliteStatement;
 
     class OfflineStorage_SQLite : public IOfflineStorage
     {
@@ -55,6 +57,14 @@ namespace MAT_NS_BEGIN {
     protected:
         bool initializeDatabase();
         bool recreate(unsigned failureCode);
+        bool isValidRecord(StorageRecord const& record);
+        bool getDbTenantId(std::string const& tenantToken, int64_t& dbTenantId);
+        void deleteUnusedTenants();
+        bool migrateFromVersion1();
+        bool insertRecord(SqliteStatement& insertStmt, StorageRecord const& record, int64_t dbTenantId);
+        void recountRecords();
+        void checkDbSize();
+        bool trimStep(size_t targetSize, int& persistence, size_t& eventsDropped);
 
         std::vector<uint8_t> packageIdList(
             std::vector<std::string>::const_iterator const & begin,
@@ -73,12 +83,13 @@ namespace MAT_NS_BEGIN {
         bool                        isOpen();
 
         int                         m_pageSize {};
+        // Whether the file is in auto_vacuum=INCREMENTAL mode
+        bool                        m_incrementalVacuum {};
 
         bool                        m_skipInitAndShutdown {};
         bool                        m_isOpened {};
 
         std::mutex                  m_resizeLock{};
-        std::atomic<bool>           m_resizing{false};
 
         size_t                      m_stmtBeginTransaction {};
         size_t                      m_stmtCommitTransaction {};
@@ -87,7 +98,9 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtGetRecordCount {};
         size_t                      m_stmtGetRecordCountBylatency {};
         size_t                      m_stmtPerTenantTrimCount {};
-        size_t                      m_stmtTrimEvents_percent {};
+        size_t                      m_stmtTrimEvents_persistence_count {};
+        size_t                      m_stmtGetFreelistCount {};
+        size_t                      m_stmtIncrementalVacuum {};
         size_t                      m_stmtDeleteEvents_ids {};
         size_t                      m_stmtReleaseExpiredEvents {};
         size_t                      m_stmtDeleteEvents_tenants {};
@@ -99,9 +112,15 @@ namespace MAT_NS_BEGIN {
         size_t                      m_stmtDeleteEventsRetried_maxRetryCount {};
         size_t                      m_stmtSelectEventsRetried_maxRetryCount {};
         size_t                      m_stmtInsertEvent_id_tenant_prio_ts_data {};
+        size_t                      m_stmtReplaceEvent_id_tenant_prio_ts_data {};
+        size_t                      m_stmtInsertTenant_token {};
+        size_t                      m_stmtSelectTenant_token {};
+        size_t                      m_stmtDeleteUnusedTenants {};
         size_t                      m_stmtInsertSetting_name_value {};
         size_t                      m_stmtDeleteSetting_name {};
         size_t                      m_stmtSelectSetting_name {};
+        // Row ids of the tenants table by tenant token, for the tenants stored last
+        std::unordered_map<std::string, int64_t> m_dbTenantIds;
         unsigned                    m_lastReadCount {};
         std::string                 m_offlineStorageFileName {};
         unsigned                    m_DbSizeNotificationLimit {};
@@ -109,6 +128,8 @@ namespace MAT_NS_BEGIN {
         size_t                      m_DbSizeHeapLimit {};
         size_t                      m_DbSizeLimit {};
         std::atomic<size_t>         m_DbSizeEstimate {};
+        // Number of stored events, counted on open and kept up to date under m_lock
+        size_t                      m_recordCount {};
         uint64_t                    m_isStorageFullNotificationSendTime {};
 
     protected:
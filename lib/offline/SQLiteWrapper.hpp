@@ -23,7 +23,7 @@ namespace MAT_NS_BEGIN {
 
     static const unsigned MAX_DB_LOCKWAIT_DELAY = 500; // 500 ms
 
-    class RealSqlite3Proxy : public ISqlite3Proxy {
+    class RealSqlite3Proxy final : public ISqlite3Proxy {
     public:
 
         int sqlite3_bind_blob(sqlite3_stmt* stmt, int idx, void const* value, int size, void(*d)(void*)) override
@@ -188,6 +188,36 @@ namespace MAT_NS_BEGIN {
 
     ISqlite3Proxy* g_sqlite3Proxy = &g_realSqlite3Proxy;
 
+    /// <summary>
+    /// sqlite3 calls made straight into the sqlite3 library. RealSqlite3Proxy is
+    /// final, so calls through it are resolved (and inlined) at compile time.
+    /// </summary>
+    struct DirectSqlite3Api {
+        static RealSqlite3Proxy& get()
+        {
+            return g_realSqlite3Proxy;
+        }
+    };
+
+    /// <summary>
+    /// sqlite3 calls made through g_sqlite3Proxy, so that tests can intercept them
+    /// by installing MockISqlite3Proxy.
+    /// </summary>
+    struct ProxySqlite3Api {
+        static ISqlite3Proxy& get()
+        {
+            return *g_sqlite3Proxy;
+        }
+    };
+
+    // Release builds bind directly to sqlite3, define HAVE_MAT_SQLITE3_PROXY to
+    // route all calls through the virtual ISqlite3Proxy instead.
+#ifdef HAVE_MAT_SQLITE3_PROXY
+    using Sqlite3Api = ProxySqlite3Api;
+#else
+    using Sqlite3Api = DirectSqlite3Api;
+#endif
+
     //---
 
     /// Provide virtual table 'ids' filled from NUL-separated list parameter
@@ -215,7 +245,7 @@ namespace MAT_NS_BEGIN {
             int result;
 
             if (!m_skipInitAndShutdown) {
-                result = g_sqlite3Proxy->sqlite3_initialize();
+                result = Sqlite3Api::get().sqlite3_initialize();
                 if (result != SQLITE_OK) {
                     LOG_ERROR("Failed to initialize SQLite (%d)", result);
                     return false;
@@ -225,7 +255,7 @@ namespace MAT_NS_BEGIN {
             if (deletePrevious) {
                 // We cannot call plain ::remove() here, filename is in UTF-8. Rather
                 // than adding a new set of functions to PAL, let's use SQLite VFS.
-                sqlite3_vfs* vfs = g_sqlite3Proxy->sqlite3_vfs_find(NULL);
+                sqlite3_vfs* vfs = Sqlite3Api::get().sqlite3_vfs_find(NULL);
                 result = (vfs != NULL) ? vfs->xDelete(vfs, filename.c_str(), 0) : SQLITE_ERROR;
                 if (result == SQLITE_OK) {
                     LOG_INFO("Unusable existing database file was successfully deleted");
@@ -233,7 +263,7 @@ namespace MAT_NS_BEGIN {
                 else if (result != SQLITE_IOERR_DELETE_NOENT) {
                     LOG_WARN("Failed to delete unusable database file (%d)", result);
                     if (!m_skipInitAndShutdown) {
-                        g_sqlite3Proxy->sqlite3_shutdown();
+                        Sqlite3Api::get().sqlite3_shutdown();
                     }
                     return false;
                 }
@@ -244,21 +274,21 @@ namespace MAT_NS_BEGIN {
             std::string basename(filename, (ofs != std::string::npos) ? (ofs + 1) : 0);
             LOG_INFO("Opening database \"%s\"...", basename.c_str());
 
-            result = g_sqlite3Proxy->sqlite3_open_v2(filename.c_str(), &m_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, NULL);
+            result = Sqlite3Api::get().sqlite3_open_v2(filename.c_str(), &m_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, NULL);
            if (result != SQLITE_OK) {
                 LOG_ERROR("Failed to open database file: (%d) %s",
-                    result, m_db ? g_sqlite3Proxy->sqlite3_errmsg(m_db) : "-");
+                    result, m_db ? Sqlite3Api::get().sqlite3_errmsg(m_db) : "-");
                 if (m_db) {
-                    g_sqlite3Proxy->sqlite3_close_v2(m_db);
+                    Sqlite3Api::get().sqlite3_close_v2(m_db);
                     m_db = nullptr;
                 }
                 if (!m_skipInitAndShutdown) {
-                    g_sqlite3Proxy->sqlite3_shutdown();
+                    Sqlite3Api::get().sqlite3_shutdown();
                 }
                 return false;
             }
 
-            g_sqlite3Proxy->sqlite3_extended_result_codes(m_db, 1);
+            Sqlite3Api::get().sqlite3_extended_result_codes(m_db, 1);
 
             if (!registerTokenizeFunction()) {
                 shutdown();
@@ -266,7 +296,7 @@ namespace MAT_NS_BEGIN {
             }
 
             if (maxHeapLimit) {
-                g_sqlite3Proxy->sqlite3_soft_heap_limit64(maxHeapLimit);
+                Sqlite3Api::get().sqlite3_soft_heap_limit64(maxHeapLimit);
             }
 
             LOG_TRACE("Database file was successfully opened");
@@ -283,16 +313,16 @@ namespace MAT_NS_BEGIN {
 
             for (sqlite3_stmt* stmt : m_statements) {
                 if (stmt != nullptr) {
-                    g_sqlite3Proxy->sqlite3_finalize(stmt);
+                    Sqlite3Api::get().sqlite3_finalize(stmt);
                 }
             }
             m_statements.clear();
 
-            g_sqlite3Proxy->sqlite3_close_v2(m_db);
+            Sqlite3Api::get().sqlite3_close_v2(m_db);
             m_db = nullptr;
 
             if (!m_skipInitAndShutdown) {
-                g_sqlite3Proxy->sqlite3_shutdown();
+                Sqlite3Api::get().sqlite3_shutdown();
             }
         }
 
@@ -300,7 +330,7 @@ namespace MAT_NS_BEGIN {
         {
             LOCKGUARD(m_lock);
             sqlite3_stmt* stmt;
-            int result = g_sqlite3Proxy->sqlite3_prepare_v2(m_db, statement, -1, &stmt, NULL);
+            int result = Sqlite3Api::get().sqlite3_prepare_v2(m_db, statement, -1, &stmt, NULL);
             if (result != SQLITE_OK) {
                 std::string excerpt(statement);
                 if (excerpt.length() > 100) {
@@ -308,7 +338,7 @@ namespace MAT_NS_BEGIN {
                     excerpt.append("...");
                 }
                 LOG_ERROR("Failed to prepare SQL statement \"%s\": %d (%s)",
-                    excerpt.c_str(), result, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    excerpt.c_str(), result, Sqlite3Api::get().sqlite3_errmsg(m_db));
                 return 0;
             }
             m_statements.push_back(stmt);
@@ -330,7 +360,7 @@ namespace MAT_NS_BEGIN {
                 if (it != std::end(m_statements))
                 {
                     m_statements.erase(it);
-                    g_sqlite3Proxy->sqlite3_finalize(stmt);
+                    Sqlite3Api::get().sqlite3_finalize(stmt);
                     LOG_INFO("--- [%p]");
                 }
             }
@@ -437,26 +467,26 @@ namespace MAT_NS_BEGIN {
         static void sqliteFunc_tokenize(sqlite3_context* ctx, int argc, sqlite3_value** argv)
         {
             UNREFERENCED_PARAMETER(argc);
-            int len = g_sqlite3Proxy->sqlite3_value_bytes(argv[0]);
-            int ofs = static_cast<int>(reinterpret_cast<intptr_t>(g_sqlite3Proxy->sqlite3_get_auxdata(ctx, 0)));
+            int len = Sqlite3Api::get().sqlite3_value_bytes(argv[0]);
+            int ofs = static_cast<int>(reinterpret_cast<intptr_t>(Sqlite3Api::get().sqlite3_get_auxdata(ctx, 0)));
             if (ofs >= len) {
-                g_sqlite3Proxy->sqlite3_result_null(ctx);
+                Sqlite3Api::get().sqlite3_result_null(ctx);
                 return;
             }
-            char const* data = static_cast<char const*>(g_sqlite3Proxy->sqlite3_value_blob(argv[0]));
+            char const* data = static_cast<char const*>(Sqlite3Api::get().sqlite3_value_blob(argv[0]));
             char const* sep = static_cast<char const*>(memchr(data + ofs, 0, len - ofs));
             int pos = sep ? static_cast<int>(sep - data) : len;
-            g_sqlite3Proxy->sqlite3_result_text(ctx, data + ofs, pos - ofs, SQLITE_STATIC);
-            g_sqlite3Proxy->sqlite3_set_auxdata(ctx, 0, reinterpret_cast<void*>(static_cast<intptr_t>(pos + 1)), NULL);
+            Sqlite3Api::get().sqlite3_result_text(ctx, data + ofs, pos - ofs, SQLITE_STATIC);
+            Sqlite3Api::get().sqlite3_set_auxdata(ctx, 0, reinterpret_cast<void*>(static_cast<intptr_t>(pos + 1)), NULL);
         }
 
         bool registerTokenizeFunction()
         {
-            int result = g_sqlite3Proxy->sqlite3_create_function_v2(m_db, "tokenize", 1, SQLITE_UTF8, NULL,
+            int result = Sqlite3Api::get().sqlite3_create_function_v2(m_db, "tokenize", 1, SQLITE_UTF8, NULL,
                 &SqliteDB::sqliteFunc_tokenize, NULL, NULL, NULL);
             if (result != SQLITE_OK) {
                 LOG_ERROR("Could not create tokenize function: (%d) %s",
-                    result, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    result, Sqlite3Api::get().sqlite3_errmsg(m_db));
                 return false;
             }
             return true;
@@ -476,9 +506,23 @@ namespace MAT_NS_BEGIN {
 
     //---
 
-    class SqliteStatement {
+    /// <summary>
+    /// Bytes owned by someone else, bound as a blob or read from a text or blob
+    /// column without copying. Read from a column, they are only valid until the
+    /// statement steps to the next row or gets reset.
+    /// </summary>
+    struct SqliteBytes {
+        uint8_t const* data;
+        size_t         size;
+    };
+
+    /// <summary>
+    /// Prepared statement, making its sqlite3 calls through the TSqlite3Api policy.
+    /// </summary>
+    template<typename TSqlite3Api>
+    class BasicSqliteStatement {
     public:
-        SqliteStatement(SqliteDB& db, size_t stmtId)
+        BasicSqliteStatement(SqliteDB& db, size_t stmtId)
             : m_db(db),
             m_stmtId(stmtId),
             m_stmt(db.statement(stmtId)),
@@ -492,7 +536,7 @@ namespace MAT_NS_BEGIN {
             reset();
         }
 
-        SqliteStatement(SqliteDB& db, char const* statement)
+        BasicSqliteStatement(SqliteDB& db, char const* statement)
             : m_db(db),
             m_stmtId(db.prepare(statement)),
             m_stmt(db.statement(m_stmtId)),
@@ -506,7 +550,7 @@ namespace MAT_NS_BEGIN {
             reset();
         }
 
-        ~SqliteStatement()
+        ~BasicSqliteStatement()
         {
             if (m_ownStmt) {
                 m_db.release(m_stmtId);
@@ -557,8 +601,8 @@ namespace MAT_NS_BEGIN {
         void reset()
         {
             if (m_stmt != nullptr) {
-                g_sqlite3Proxy->sqlite3_reset(m_stmt);
-                g_sqlite3Proxy->sqlite3_clear_bindings(m_stmt);
+                TSqlite3Api::get().sqlite3_reset(m_stmt);
+                TSqlite3Api::get().sqlite3_clear_bindings(m_stmt);
             }
         }
 
@@ -580,27 +624,32 @@ namespace MAT_NS_BEGIN {
     protected:
         int bind(int idx, int arg)
         {
-            return g_sqlite3Proxy->sqlite3_bind_int(m_stmt, idx, arg);
+            return TSqlite3Api::get().sqlite3_bind_int(m_stmt, idx, arg);
         }
 
         int bind(int idx, unsigned arg)
         {
-            return g_sqlite3Proxy->sqlite3_bind_int64(m_stmt, idx, static_cast<int64_t>(static_cast<uint64_t>(arg)));
+            return TSqlite3Api::get().sqlite3_bind_int64(m_stmt, idx, static_cast<int64_t>(static_cast<uint64_t>(arg)));
         }
 
         int bind(int idx, int64_t arg)
         {
-            return g_sqlite3Proxy->sqlite3_bind_int64(m_stmt, idx, arg);
+            return TSqlite3Api::get().sqlite3_bind_int64(m_stmt, idx, arg);
         }
 
         int bind(int idx, std::string const& arg)
         {
-            return g_sqlite3Proxy->sqlite3_bind_text(m_stmt, idx, arg.data(), static_cast<int>(arg.size()), SQLITE_STATIC);
+            return TSqlite3Api::get().sqlite3_bind_text(m_stmt, idx, arg.data(), static_cast<int>(arg.size()), SQLITE_STATIC);
         }
 
         int bind(int idx, std::vector<uint8_t> const& arg)
         {
-            return g_sqlite3Proxy->sqlite3_bind_blob(m_stmt, idx, arg.data(), static_cast<int>(arg.size()), SQLITE_STATIC);
+            return TSqlite3Api::get().sqlite3_bind_blob(m_stmt, idx, arg.data(), static_cast<int>(arg.size()), SQLITE_STATIC);
+        }
+
+        int bind(int idx, SqliteBytes const& arg)
+        {
+            return TSqlite3Api::get().sqlite3_bind_blob(m_stmt, idx, arg.data, static_cast<int>(arg.size), SQLITE_STATIC);
         }
 
         int bindAll(int idx)
@@ -623,32 +672,38 @@ namespace MAT_NS_BEGIN {
     protected:
         void retrieve(int idx, int& output)
         {
-            output = g_sqlite3Proxy->sqlite3_column_int(m_stmt, idx);
+            output = TSqlite3Api::get().sqlite3_column_int(m_stmt, idx);
         }
 
         void retrieve(int idx, unsigned& output)
         {
-            output = static_cast<unsigned>(g_sqlite3Proxy->sqlite3_column_int64(m_stmt, idx));
+            output = static_cast<unsigned>(TSqlite3Api::get().sqlite3_column_int64(m_stmt, idx));
         }
 
         void retrieve(int idx, int64_t& output)
         {
-            output = g_sqlite3Proxy->sqlite3_column_int64(m_stmt, idx);
+            output = TSqlite3Api::get().sqlite3_column_int64(m_stmt, idx);
         }
 
         void retrieve(int idx, std::string& output)
         {
-            int len = g_sqlite3Proxy->sqlite3_column_bytes(m_stmt, idx);
-            output.assign(reinterpret_cast<char const*>(g_sqlite3Proxy->sqlite3_column_text(m_stmt, idx)), len);
+            int len = TSqlite3Api::get().sqlite3_column_bytes(m_stmt, idx);
+            output.assign(reinterpret_cast<char const*>(TSqlite3Api::get().sqlite3_column_text(m_stmt, idx)), len);
         }
 
         void retrieve(int idx, std::vector<uint8_t>& output)
         {
-            int len = g_sqlite3Proxy->sqlite3_column_bytes(m_stmt, idx);
-            uint8_t const* ptr = reinterpret_cast<uint8_t const*>(g_sqlite3Proxy->sqlite3_column_blob(m_stmt, idx));
+            int len = TSqlite3Api::get().sqlite3_column_bytes(m_stmt, idx);
+            uint8_t const* ptr = reinterpret_cast<uint8_t const*>(TSqlite3Api::get().sqlite3_column_blob(m_stmt, idx));
             output.assign(ptr, ptr + len);
         }
 
+        void retrieve(int idx, SqliteBytes& output)
+        {
+            output.data = reinterpret_cast<uint8_t const*>(TSqlite3Api::get().sqlite3_column_blob(m_stmt, idx));
+            output.size = static_cast<size_t>(TSqlite3Api::get().sqlite3_column_bytes(m_stmt, idx));
+        }
+
         bool retrieveAll(int idx)
         {
             UNREFERENCED_PARAMETER(idx);
@@ -667,14 +722,14 @@ namespace MAT_NS_BEGIN {
         {
             if (bindFailedIdx > 0) {
                 LOG_ERROR("Failed to bind parameter #%d of statement #[%p]: %s",
-                    bindFailedIdx, m_stmtId, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    bindFailedIdx, m_stmtId, TSqlite3Api::get().sqlite3_errmsg(m_db));
                 m_error = true;
                 return false;
             }
 
             auto startTime = PAL::getMonotonicTimeMs();
             LOG_DEBUG("=== [%p] execute2 step...", m_stmt);
-            int result = g_sqlite3Proxy->sqlite3_step(m_stmt);
+            int result = TSqlite3Api::get().sqlite3_step(m_stmt);
             m_duration = static_cast<unsigned>(PAL::getMonotonicTimeMs() - startTime);
 
             if (result == SQLITE_ROW) {
@@ -682,11 +737,11 @@ namespace MAT_NS_BEGIN {
             }
             else if (result != SQLITE_DONE) {
                 LOG_ERROR("Failed to modify database while executing statement [%p]: %d (%s)",
-                    m_stmtId, result, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    m_stmtId, result, TSqlite3Api::get().sqlite3_errmsg(m_db));
                 m_error = true;
             }
 
-            m_changes = g_sqlite3Proxy->sqlite3_changes(m_db);
+            m_changes = TSqlite3Api::get().sqlite3_changes(m_db);
             reset();
 
             return (result == SQLITE_DONE) || (result == SQLITE_ROW);
@@ -696,12 +751,12 @@ namespace MAT_NS_BEGIN {
         {
             if (bindFailedIdx > 0) {
                 LOG_ERROR("Failed to bind parameter #%d of statement #[%p]: %s",
-                    bindFailedIdx, m_stmtId, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    bindFailedIdx, m_stmtId, TSqlite3Api::get().sqlite3_errmsg(m_db));
                 m_error = true;
                 return false;
             }
 
-            int result = g_sqlite3Proxy->sqlite3_step(m_stmt);
+            int result = TSqlite3Api::get().sqlite3_step(m_stmt);
             if (result == SQLITE_ROW) {
                 m_hasRow = true;
                 m_done = false;
@@ -714,7 +769,7 @@ namespace MAT_NS_BEGIN {
             }
             else {
                 LOG_ERROR("Failed to query database while executing statement #[%p]: %d (%s)",
-                    m_stmtId, result, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    m_stmtId, result, TSqlite3Api::get().sqlite3_errmsg(m_db));
                 m_error = true;
                 reset();
                 return false;
@@ -731,14 +786,14 @@ namespace MAT_NS_BEGIN {
                 return false;
             }
 
-            int result = g_sqlite3Proxy->sqlite3_step(m_stmt);
+            int result = TSqlite3Api::get().sqlite3_step(m_stmt);
             if (result == SQLITE_ROW) {
                 return true;
             }
 
             if (result != SQLITE_DONE) {
                 LOG_ERROR("Failed to read database while executing statement #[%p]: %d (%s)",
-                    m_stmtId, result, g_sqlite3Proxy->sqlite3_errmsg(m_db));
+                    m_stmtId, result, TSqlite3Api::get().sqlite3_errmsg(m_db));
                 m_error = true;
             }
             reset();
@@ -763,7 +818,17 @@ namespace MAT_NS_BEGIN {
         MATSDK_LOG_DECL_COMPONENT_CLASS();
     };
 
-    MATSDK_LOG_INST_COMPONENT_CLASS(SqliteStatement, "EventsSDK.SQLiteStatement", "Events telemetry client - Sqlite statement class");
+    template<typename TSqlite3Api>
+    char const* BasicSqliteStatement<TSqlite3Api>::getMATSDKLogComponent()
+    {
+        return "EventsSDK.SQLiteStatement";
+    }
+
+    class SqliteStatement : public BasicSqliteStatement<Sqlite3Api> {
+    public:
+        using BasicSqliteStatement<Sqlite3Api>::BasicSqliteStatement;
+    };
+
 
 
 } MAT_NS_END
@@ -0,0 +1,550 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "ShardedMemoryStorage.hpp"
+
+#include "utils/StringUtils.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <unordered_set>
+
+namespace MAT_NS_BEGIN {
+
+    MATSDK_LOG_INST_COMPONENT_CLASS(ShardedMemoryStorage, "EventsSDK.ShardedMemoryStorage", "Events telemetry client - ShardedMemoryStorage class");
+
+    namespace {
+
+        /// <summary>
+        /// Approximate ram footprint of a record, whichever way its blob is held
+        /// </summary>
+        size_t recordSize(StorageRecord const& record)
+        {
+            return record.getBlob().size() + sizeof(record);
+        }
+
+        bool isQueuedLatency(EventLatency latency)
+        {
+            return (latency > EventLatency_Off) && (latency <= EventLatency_Max);
+        }
+
+    }
+
+    ShardedMemoryStorage::ShardedMemoryStorage(ILogManager & logManager, IRuntimeConfig & runtimeConfig) :
+        m_observer(nullptr),
+        m_config(runtimeConfig),
+        m_logManager(logManager),
+        m_size(0),
+        m_lastReadCount(0)
+    {
+        uint32_t fifoLatencies = m_config[CFG_INT_RAM_QUEUE_FIFO_LATENCIES];
+        for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max; latency++)
+        {
+            m_shards[latency].fifo = ((fifoLatencies >> latency) & 1) != 0;
+        }
+    }
+
+    ShardedMemoryStorage::~ShardedMemoryStorage()
+    {
+    }
+
+    void ShardedMemoryStorage::Initialize(IOfflineStorageObserver & observer)
+    {
+        m_observer = &observer;
+    }
+
+    void ShardedMemoryStorage::Shutdown()
+    {
+        for (unsigned latency = EventLatency_Off; latency <= EventLatency_Max; latency++)
+        {
+            size_t numRecords = m_shards[latency].count;
+            if (numRecords)
+            {
+                // OfflineStorageHandler high-level wrapper must flush these on graceful shutdown
+                LOG_WARN("Discarding %u unflushed records of latency %u", numRecords, latency);
+            }
+        }
+
+        LOCKGUARD(m_reserved_lock);
+        if (m_reserved_records.size())
+        {
+            LOG_WARN("Discarding %u reserved records", m_reserved_records.size());
+        }
+    }
+
+    /// <summary>
+    /// Not implemented, the flush to disk is done by OfflineStorageHandler.
+    /// </summary>
+    void ShardedMemoryStorage::Flush()
+    {
+    }
+
+    bool ShardedMemoryStorage::StoreRecord(StorageRecord const & record)
+    {
+        // Don't copy a record that is going to be rejected
+        if (!isQueuedLatency(record.latency))
+            return false;
+
+        return StoreRecord(StorageRecord(record));
+    }
+
+    /// <summary>
+    /// Store one telemetry event record, moving it into the shard of its latency.
+    /// </summary>
+    bool ShardedMemoryStorage::StoreRecord(StorageRecord && record)
+    {
+        // Don't store events with latency set to off. Logger API already does a similar check.
+        if (!isQueuedLatency(record.latency))
+            return false;
+
+        // Counted before the record can be taken, so that the size never goes below zero
+        m_size += recordSize(record);
+        Shard& shard = m_shards[record.latency];
+        {
+            LOCKGUARD(shard.lock);
+            shard.records.push_back(std::move(record));
+            shard.count++;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Store a batch of records, moving them out of the vector.
+    /// </summary>
+    size_t ShardedMemoryStorage::StoreRecords(std::vector<StorageRecord> & records)
+    {
+        size_t stored = 0;
+        for (auto & record : records)
+        {
+            if (StoreRecord(std::move(record)))
+            {
+                ++stored;
+            }
+        }
+        return stored;
+    }
+
+    /// <summary>
+    /// Take the next record to be served from a shard.
+    /// </summary>
+    bool ShardedMemoryStorage::popRecord(Shard & shard, StorageRecord & record)
+    {
+        LOCKGUARD(shard.lock);
+        if (shard.records.empty())
+        {
+            return false;
+        }
+
+        if (shard.fifo)
+        {
+            record = std::move(shard.records.front());
+            shard.records.pop_front();
+        }
+        else
+        {
+            record = std::move(shard.records.back());
+            shard.records.pop_back();
+        }
+        shard.count--;
+        return true;
+    }
+
+    /// <summary>
+    /// Put records back at the serving end of their shards, so that they are the next
+    /// ones picked, oldest first for FIFO and newest first for LIFO shards.
+    /// </summary>
+    void ShardedMemoryStorage::returnRecords(std::vector<StorageRecord> & records)
+    {
+        std::sort(records.begin(), records.end(), [](StorageRecord const& lhs, StorageRecord const& rhs) {
+            return lhs.timestamp < rhs.timestamp;
+        });
+
+        size_t size = 0;
+        for (auto const& record : records)
+        {
+            size += recordSize(record);
+        }
+        m_size += size;
+
+        for (auto it = records.rbegin(); it != records.rend(); ++it)
+        {
+            Shard& shard = m_shards[it->latency];
+            if (shard.fifo)
+            {
+                LOCKGUARD(shard.lock);
+                shard.records.push_front(std::move(*it));
+                shard.count++;
+            }
+        }
+        for (auto& record : records)
+        {
+            Shard& shard = m_shards[record.latency];
+            if (!shard.fifo)
+            {
+                LOCKGUARD(shard.lock);
+                shard.records.push_back(std::move(record));
+                shard.count++;
+            }
+        }
+        records.clear();
+    }
+
+    void ShardedMemoryStorage::subtractSize(size_t size)
+    {
+        // DeleteAllRecords() may have reset the size while a record was being handed out
+        size_t current = m_size.load();
+        while (!m_size.compare_exchange_weak(current, current - std::min(current, size)))
+        {
+        }
+    }
+
+    /// <summary>
+    /// Get records from the shards, highest latency first. With a lease time the records
+    /// are kept reserved until deleted or released, sharing their blob with the consumer;
+    /// without one they are moved to the consumer. No lock is held while the consumer runs.
+    /// Records are reserved before they are handed to the consumer, so that they can be
+    /// deleted or released while it runs; a declined record is taken back if still reserved.
+    /// </summary>
+    bool ShardedMemoryStorage::GetAndReserveRecords(std::function<bool(StorageRecord&&)> const & consumer, unsigned leaseTimeMs, EventLatency minLatency, unsigned maxCount)
+    {
+        LOG_TRACE("Retrieving max. %u%s events of latency at least %d (%s)",
+            maxCount, (maxCount > 0) ? "" : " (unlimited)",
+            minLatency, latencyToStr(static_cast<EventLatency>(minLatency)));
+
+        if (maxCount == 0)
+            maxCount = UINT_MAX;
+
+        if (minLatency == EventLatency_Unspecified)
+            minLatency = EventLatency_Off;
+
+        unsigned readCount = 0;
+        for (int latency = static_cast<int>(EventLatency_Max); (latency >= static_cast<int>(minLatency)) && (maxCount); latency--)
+        {
+            Shard& shard = m_shards[latency];
+            StorageRecord record;
+            while (maxCount && popRecord(shard, record))
+            {
+                size_t size = recordSize(record);
+                bool wantMore;
+                if (leaseTimeMs)
+                {
+                    // Share the blob between the consumer and the reserved copy of the record
+                    if (!record.sharedBlob)
+                    {
+                        record.sharedBlob = std::make_shared<StorageBlob const>(std::move(record.blob));
+                        record.blob.clear();
+                    }
+                    StorageRecord forConsumer(record);
+                    forConsumer.reservedUntil = PAL::getUtcSystemTimeMs() + leaseTimeMs;
+                    {
+                        LOCKGUARD(m_reserved_lock);
+                        m_reserved_records[forConsumer.id] = std::move(record); // move to reserved
+                    }
+                    subtractSize(size);
+                    wantMore = consumer(std::move(forConsumer));
+                    if (!wantMore)
+                    {
+                        // The consumer leaves records it does not want untouched, the id is still there
+                        std::vector<StorageRecord> declined;
+                        {
+                            LOCKGUARD(m_reserved_lock);
+                            auto it = m_reserved_records.find(forConsumer.id);
+                            if (it != m_reserved_records.end())
+                            {
+                                declined.push_back(std::move(it->second));
+                                m_reserved_records.erase(it);
+                            }
+                        }
+                        returnRecords(declined);
+                        m_lastReadCount = readCount;
+                        return true;
+                    }
+                }
+                else
+                {
+                    // Consumers of unreserved records (e.g. flush to disk) expect the blob in place
+                    if (record.sharedBlob)
+                    {
+                        record.blob = *record.sharedBlob;
+                        record.sharedBlob.reset();
+                    }
+                    StorageRecord forConsumer(std::move(record));
+                    wantMore = consumer(std::move(forConsumer));
+                    if (!wantMore)
+                    {
+                        // The consumer leaves records it does not want untouched
+                        std::vector<StorageRecord> declined;
+                        declined.push_back(std::move(forConsumer));
+                        // Not counted in the size any more, returnRecords() adds it back
+                        subtractSize(size);
+                        returnRecords(declined);
+                        m_lastReadCount = readCount;
+                        return true;
+                    }
+                    subtractSize(size);
+                }
+
+                maxCount--;
+                readCount++;
+            }
+        }
+        m_lastReadCount = readCount;
+        return true;
+    }
+
+    bool ShardedMemoryStorage::IsLastReadFromMemory()
+    {
+        return true;
+    }
+
+    /// <summary>
+    /// Record count of the last GetAndReserveRecords. This routine assumes that there is only one reader.
+    /// </summary>
+    unsigned ShardedMemoryStorage::LastReadRecordCount()
+    {
+        return m_lastReadCount;
+    }
+
+    void ShardedMemoryStorage::DeleteAllRecords()
+    {
+        {
+            LOCKGUARD(m_reserved_lock);
+            m_reserved_records.clear();
+        }
+        for (auto& shard : m_shards)
+        {
+            LOCKGUARD(shard.lock);
+            shard.records.clear();
+            shard.count = 0;
+        }
+        m_size = 0;
+        m_lastReadCount = 0;
+    }
+
+    void ShardedMemoryStorage::DeleteRecords(const std::map<std::string, std::string> & whereFilter)
+    {
+        auto matcher = [&whereFilter](const StorageRecord &r)
+        {
+            bool matched = true;
+            for (const auto &kv : whereFilter)
+            {
+                matched &=
+                    (kv.first == "record_id") ? (r.id == kv.second) :
+                    (kv.first == "tenant_token") ? (r.tenantToken == kv.second) :
+                    (kv.first == "latency") ? (std::to_string(r.latency) == kv.second) :
+                    (kv.first == "persistence") ? (std::to_string(r.persistence) == kv.second) :
+                    (kv.first == "retry_count") ? (std::to_string(r.retryCount) == kv.second) : false;
+                if (!matched)
+                    break;
+            }
+            return matched;
+        };
+
+        {
+            LOCKGUARD(m_reserved_lock);
+            for (auto it = m_reserved_records.begin(); it != m_reserved_records.end(); )
+            {
+                it = matcher(it->second) ? m_reserved_records.erase(it) : std::next(it);
+            }
+        }
+
+        for (auto& shard : m_shards)
+        {
+            size_t size = 0;
+            {
+                LOCKGUARD(shard.lock);
+                auto end = std::remove_if(shard.records.begin(), shard.records.end(), [&](StorageRecord const& record) {
+                    if (matcher(record))
+                    {
+                        size += recordSize(record);
+                        return true;
+                    }
+                    return false;
+                });
+                shard.records.erase(end, shard.records.end());
+                shard.count = shard.records.size();
+            }
+            subtractSize(size);
+        }
+    }
+
+    /// <summary>
+    /// Delete records from the reserved table and from the shards.
+    /// </summary>
+    void ShardedMemoryStorage::DeleteRecords(std::vector<StorageRecordId> const & ids, HttpHeaders headers, bool & fromMemory)
+    {
+        UNREFERENCED_PARAMETER(headers);
+        UNREFERENCED_PARAMETER(fromMemory);
+
+        // Uploaded records are reserved, so that this is typically a lookup per id
+        std::unordered_set<StorageRecordId> idSet;
+        {
+            LOCKGUARD(m_reserved_lock);
+            for (auto const& id : ids)
+            {
+                if (m_reserved_records.erase(id) == 0)
+                {
+                    idSet.insert(id);
+                }
+            }
+        }
+
+        for (auto& shard : m_shards)
+        {
+            if (idSet.empty())
+            {
+                return;
+            }
+
+            size_t size = 0;
+            {
+                LOCKGUARD(shard.lock);
+                auto end = std::remove_if(shard.records.begin(), shard.records.end(), [&](StorageRecord const& record) {
+                    if (idSet.erase(record.id))
+                    {
+                        size += recordSize(record);
+                        return true;
+                    }
+                    return false;
+                });
+                shard.records.erase(end, shard.records.end());
+                shard.count = shard.records.size();
+            }
+            subtractSize(size);
+        }
+    }
+
+    /// <summary>
+    /// Return records from in-flight into the shards, to be picked first next time.
+    /// </summary>
+    void ShardedMemoryStorage::ReleaseRecords(std::vector<StorageRecordId> const & ids, bool incrementRetryCount, HttpHeaders headers, bool & fromMemory)
+    {
+        UNREFERENCED_PARAMETER(headers);
+        UNREFERENCED_PARAMETER(fromMemory);
+
+        std::vector<StorageRecord> released;
+        {
+            LOCKGUARD(m_reserved_lock);
+            for (auto const& id : ids)
+            {
+                auto it = m_reserved_records.find(id);
+                if (it != m_reserved_records.end())
+                {
+                    if (incrementRetryCount)
+                        it->second.retryCount++;
+                    released.push_back(std::move(it->second));
+                    m_reserved_records.erase(it);
+                }
+            }
+        }
+        returnRecords(released);
+    }
+
+    void ShardedMemoryStorage::ReleaseAllRecords()
+    {
+        // In case if HTTP upload has been canceled or didn't succeed,
+        // we'd move all reserved records to regular ram queue
+        std::vector<StorageRecord> released;
+        {
+            LOCKGUARD(m_reserved_lock);
+            released.reserve(m_reserved_records.size());
+            for (auto& kv : m_reserved_records)
+            {
+                released.push_back(std::move(kv.second));
+            }
+            m_reserved_records.clear();
+        }
+        returnRecords(released);
+    }
+
+    /// <summary>
+    /// Storing settings in RAM storage is not supported
+    /// </summary>
+    bool ShardedMemoryStorage::StoreSetting(std::string const & name, std::string const & value)
+    {
+        UNREFERENCED_PARAMETER(name);
+        UNREFERENCED_PARAMETER(value);
+
+        LOG_WARN("Not implemented!");
+        return false;
+    }
+
+    /// <summary>
+    /// Retrieving settings from RAM storage is not supported
+    /// </summary>
+    std::string ShardedMemoryStorage::GetSetting(std::string const & name)
+    {
+        UNREFERENCED_PARAMETER(name);
+
+        LOG_WARN("Not implemented!");
+        return std::string();
+    }
+
+    /// <summary>
+    /// Deleting settings from RAM storage is not supported
+    /// </summary>
+    bool ShardedMemoryStorage::DeleteSetting(std::string const & name)
+    {
+        UNREFERENCED_PARAMETER(name);
+
+        LOG_WARN("Not implemented!");
+        return false;
+    }
+
+    /// <summary>
+    /// Get approximate size of the queued records, excluding reserved (in-flight) records.
+    /// </summary>
+    size_t ShardedMemoryStorage::GetSize()
+    {
+        return m_size;
+    }
+
+    /// <summary>
+    /// Gets the number of queued records of specific latency.
+    /// If latency is unspecified, get the total number of records.
+    /// </summary>
+    size_t ShardedMemoryStorage::GetRecordCount(EventLatency latency) const
+    {
+        if (latency == EventLatency_Unspecified)
+        {
+            size_t numRecords = 0;
+            for (auto const& shard : m_shards)
+                numRecords += shard.count;
+            return numRecords;
+        }
+        if (!isQueuedLatency(latency))
+            return 0;
+        return m_shards[latency].count;
+    }
+
+    std::vector<StorageRecord> ShardedMemoryStorage::GetRecords(bool shutdown, EventLatency minLatency, unsigned maxCount)
+    {
+        UNREFERENCED_PARAMETER(shutdown);
+
+        std::vector<StorageRecord> records;
+        auto consumer = [&records](StorageRecord&& record) -> bool {
+            records.push_back(std::move(record));
+            return true; // want more
+        };
+        GetAndReserveRecords(consumer, 0, minLatency, maxCount);
+        return records;
+    }
+
+    /// <remarks>This method is not currently implemented</remarks>
+    bool ShardedMemoryStorage::ResizeDb()
+    {
+        LOG_WARN("Not implemented!");
+        return true;
+    }
+
+    /// <summary>
+    /// Gets the reserved (in-flight) record count.
+    /// </summary>
+    size_t ShardedMemoryStorage::GetReservedCount()
+    {
+        LOCKGUARD(m_reserved_lock);
+        return m_reserved_records.size();
+    }
+
+} MAT_NS_END
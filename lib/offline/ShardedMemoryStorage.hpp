@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef SHARDEDMEMORYSTORAGE_HPP
+#define SHARDEDMEMORYSTORAGE_HPP
+
+#pragma once
+
+#include "pal/PAL.hpp"
+
+#include "IOfflineStorage.hpp"
+
+#include "api/IRuntimeConfig.hpp"
+
+#include "ILogManager.hpp"
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// RAM queue with one independently locked shard per latency and a hash-indexed
+    /// table of reserved (in-flight) records. Shard locks are held only to push or pop
+    /// a single record and never while the consumer of GetAndReserveRecords runs, so
+    /// incoming events don't wait for the uploader to package a batch.
+    /// Each latency is served either newest first (LIFO, same as MemoryStorage) or
+    /// oldest first (FIFO), as configured by CFG_INT_RAM_QUEUE_FIFO_LATENCIES.
+    /// </summary>
+    class ShardedMemoryStorage : public IOfflineStorage
+    {
+
+    public:
+        ShardedMemoryStorage(ILogManager& logManager, IRuntimeConfig& runtimeConfig);
+
+        virtual void Initialize(IOfflineStorageObserver& observer) override;
+
+        virtual void Shutdown() override;
+
+        virtual void Flush() override;
+
+        virtual bool StoreRecord(StorageRecord const& record) override;
+
+        virtual bool StoreRecord(StorageRecord&& record) override;
+
+        virtual size_t StoreRecords(std::vector<StorageRecord> & records) override;
+
+        virtual bool GetAndReserveRecords(std::function<bool(StorageRecord&&)> const& consumer, unsigned leaseTimeMs,
+            EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
+
+        virtual bool IsLastReadFromMemory() override;
+
+        virtual unsigned LastReadRecordCount() override;
+
+        virtual void DeleteAllRecords() override;
+
+        virtual void DeleteRecords(const std::map<std::string, std::string> & whereFilter = {}) override;
+
+        virtual void DeleteRecords(std::vector<StorageRecordId> const& ids, HttpHeaders headers, bool& fromMemory) override;
+
+        virtual void ReleaseRecords(std::vector<StorageRecordId> const& ids, bool incrementRetryCount, HttpHeaders headers, bool& fromMemory) override;
+
+        virtual void ReleaseAllRecords() override;
+
+        virtual bool StoreSetting(std::string const& name, std::string const& value) override;
+
+        virtual std::string GetSetting(std::string const& name) override;
+
+        virtual bool DeleteSetting(std::string const& name) override;
+
+        virtual size_t GetSize() override;
+
+        virtual size_t GetRecordCount(EventLatency latency = EventLatency_Unspecified) const override;
+
+        virtual size_t GetReservedCount();
+
+        virtual std::vector<StorageRecord> GetRecords(bool shutdown = false, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0) override;
+
+        virtual bool ResizeDb() override;
+
+        virtual ~ShardedMemoryStorage() override;
+
+    protected:
+
+        /// <summary>
+        /// Records of one latency. Producers always append at the back,
+        /// consumers take from the front (FIFO) or from the back (LIFO).
+        /// </summary>
+        struct Shard
+        {
+            mutable std::mutex          lock;
+            std::deque<StorageRecord>   records;
+            std::atomic<size_t>         count { 0 };
+            bool                        fifo = false;
+        };
+
+        bool popRecord(Shard& shard, StorageRecord& record);
+
+        void returnRecords(std::vector<StorageRecord>& records);
+
+        void subtractSize(size_t size);
+
+        IOfflineStorageObserver*    m_observer;
+        IRuntimeConfig&             m_config;
+        ILogManager&                m_logManager;
+
+        Shard                       m_shards[EventLatency_Max + 1];
+
+        /// <summary>
+        /// Contains reserved (aka in-flight) records, indexed by StorageRecordId.
+        /// Their blobs are shared with the records handed out to the uploader.
+        /// </summary>
+        std::mutex                  m_reserved_lock;
+        std::unordered_map<StorageRecordId, StorageRecord> m_reserved_records;
+
+        std::atomic<size_t>         m_size;
+        std::atomic<unsigned>       m_lastReadCount;
+
+        MATSDK_LOG_DECL_COMPONENT_CLASS();
+    };
+
+} MAT_NS_END
+#endif
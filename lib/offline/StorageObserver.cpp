@@ -33,7 +33,14 @@ namespace MAT_NS_BEGIN {
     bool StorageObserver::handleStoreRecord(IncomingEventContextPtr const& ctx)
     {
         ctx->record.timestamp = PAL::getUtcSystemTimeMs();
-        if (!m_offlineStorage.StoreRecord(ctx->record)) {
+        ctx->blobSize = ctx->record.blob.size();
+
+        // Move the serialized event into the storage, the routes that follow
+        // only need the metadata and the size kept in the context
+        StorageRecord record(ctx->record.id, ctx->record.tenantToken, ctx->record.latency, ctx->record.persistence,
+            ctx->record.timestamp, std::move(ctx->record.blob), ctx->record.retryCount, ctx->record.reservedUntil);
+        ctx->record.blob.clear();
+        if (!m_offlineStorage.StoreRecord(std::move(record))) {
             // stats implementation must trigger a failure notification
             storeRecordFailed(ctx);
             return false;
@@ -45,7 +52,7 @@ namespace MAT_NS_BEGIN {
     {
         auto consumer = [&ctx, this](StorageRecord&& record) -> bool {
             bool wantMore = true;
-            retrievedEvent(ctx, std::move(record), wantMore);
+            retrievedEvent(ctx, record, wantMore);
             return wantMore;
         };
 
@@ -69,12 +76,7 @@ namespace MAT_NS_BEGIN {
         {
             headers = ctx->httpResponse->GetHeaders();
         }
-        std::vector<StorageRecordId> recordIds;
-        for (const auto& item : ctx->recordIdsAndTenantIds)
-        {
-            recordIds.push_back(item.first);
-        }
-        m_offlineStorage.DeleteRecords(recordIds, headers, ctx->fromMemory);
+        m_offlineStorage.DeleteRecords(ctx->records.ids, headers, ctx->fromMemory);
         return true;
     }
 
@@ -88,12 +90,7 @@ namespace MAT_NS_BEGIN {
         {
             headers = ctx->httpResponse->GetHeaders();
         }
-        std::vector<StorageRecordId> recordIds;
-        for (const auto& item : ctx->recordIdsAndTenantIds)
-        {
-            recordIds.push_back(item.first);
-        }
-        m_offlineStorage.ReleaseRecords(recordIds, false, headers, ctx->fromMemory);
+        m_offlineStorage.ReleaseRecords(ctx->records.ids, false, headers, ctx->fromMemory);
         return true;
     }
 
@@ -105,13 +102,8 @@ namespace MAT_NS_BEGIN {
         {
             headers = ctx->httpResponse->GetHeaders();
         }
-        std::vector<StorageRecordId> recordIds;
-        for (const auto& item : ctx->recordIdsAndTenantIds)
-        {
-            recordIds.push_back(item.first);
-        }
 
-        m_offlineStorage.ReleaseRecords(recordIds, true, headers, ctx->fromMemory);
+        m_offlineStorage.ReleaseRecords(ctx->records.ids, true, headers, ctx->fromMemory);
         return true;
     }
 
@@ -69,7 +69,7 @@ namespace MAT_NS_BEGIN {
         RoutePassThrough<StorageObserver, IncomingEventContextPtr const&>        storeRecord{ this, &StorageObserver::handleStoreRecord };
 
         RouteSink<StorageObserver, EventsUploadContextPtr const&>                retrieveEvents{ this, &StorageObserver::handleRetrieveEvents };
-        RouteSource<EventsUploadContextPtr const&, StorageRecord const&, bool&>  retrievedEvent;
+        RouteSource<EventsUploadContextPtr const&, StorageRecord&, bool&>        retrievedEvent;
         RouteSource<EventsUploadContextPtr const&>                               retrievalFinished;
         RouteSource<EventsUploadContextPtr const&>                               retrievalFailed;
 
@@ -12,51 +12,75 @@ namespace MAT_NS_BEGIN {
 
 size_t BondSplicer::addTenantToken(std::string const& tenantToken)
 {
-    size_t begin = m_buffer.size();
-
     m_overheadEstimate += 8 + tenantToken.size();
 
-    m_packages.push_back(PackageInfo { tenantToken, Span{begin, size_t{0}}, {} });
+    m_packages.push_back(PackageInfo { tenantToken, {} });
     return m_packages.size() - 1;
 }
 
 void BondSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob)
+{
+    addRecord(dataPackageIndex, std::vector<uint8_t>(recordBlob));
+}
+
+void BondSplicer::addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob)
 {
     assert(dataPackageIndex < m_packages.size());
     assert(!recordBlob.empty() && recordBlob.back() == bond_lite::BT_STOP);
 
-    m_packages[dataPackageIndex].records.push_back(Span{m_buffer.size(), recordBlob.size()});
-    m_buffer.insert(m_buffer.end(), recordBlob.begin(), recordBlob.end());
+    m_packages[dataPackageIndex].records.push_back(m_records.size());
+    m_dataSize += recordBlob.size();
+    m_records.push_back(RecordInfo { std::move(recordBlob), nullptr });
+}
+
+void BondSplicer::addRecord(size_t dataPackageIndex, std::shared_ptr<std::vector<uint8_t> const> recordBlob)
+{
+    assert(dataPackageIndex < m_packages.size());
+    assert(recordBlob && !recordBlob->empty() && recordBlob->back() == bond_lite::BT_STOP);
+
+    m_packages[dataPackageIndex].records.push_back(m_records.size());
+    m_dataSize += recordBlob->size();
+    m_records.push_back(RecordInfo { {}, std::move(recordBlob) });
 }
 
 size_t BondSplicer::getSizeEstimate() const
 {
-    return m_buffer.size() + m_overheadEstimate + 8 /*DataPackages*/;
+    return m_dataSize + m_overheadEstimate + 8 /*DataPackages*/;
 }
 
 std::vector<uint8_t> BondSplicer::splice() const
 {
     std::vector<uint8_t> output;
+    output.reserve(m_dataSize);
     bond_lite::CompactBinaryProtocolWriter writer(output);
 
-    if (!m_packages.empty()) {
-        for (PackageInfo const& package : m_packages) {
-            if (!package.records.empty()) {
-                for (Span const& record : package.records) {
-                    writer.WriteBlob(m_buffer.data() + record.offset, record.length);
-                }
-            } 
-        }
-    } 
+    splice([&writer](uint8_t const* data, size_t size) {
+        writer.WriteBlob(data, size);
+        return true;
+    });
 
     return output;
 }
 
+bool BondSplicer::splice(SpliceSink const& sink) const
+{
+    for (PackageInfo const& package : m_packages) {
+        for (size_t record : package.records) {
+            std::vector<uint8_t> const& blob = m_records[record].data();
+            if (!sink(blob.data(), blob.size())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 void BondSplicer::clear()
 {
     // Swap with empty instead of clear() to release memory
-    std::vector<uint8_t>().swap(m_buffer);
+    std::vector<RecordInfo>().swap(m_records);
     std::vector<PackageInfo>().swap(m_packages);
+    m_dataSize = 0;
     m_overheadEstimate = 0;
 }
 
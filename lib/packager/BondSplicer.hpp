@@ -9,7 +9,8 @@
 #include "DataPackage.hpp"
 #include "ISplicer.hpp"
 
-#include <list>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace MAT_NS_BEGIN {
@@ -18,9 +19,27 @@ namespace MAT_NS_BEGIN {
 class BondSplicer : public ISplicer
 {
   protected:
-    std::vector<uint8_t>     m_buffer;
-    std::vector<PackageInfo> m_packages;
-    size_t                   m_overheadEstimate {};
+    struct PackageInfo {
+        std::string         tenantToken;
+        std::vector<size_t> records;
+    };
+
+    // Record blob, either owned or shared with the storage that keeps
+    // the record reserved while it is being uploaded
+    struct RecordInfo {
+        std::vector<uint8_t>                        blob;
+        std::shared_ptr<std::vector<uint8_t> const> sharedBlob;
+
+        std::vector<uint8_t> const& data() const { return sharedBlob ? *sharedBlob : blob; }
+    };
+
+    // Record blobs are kept exactly as handed over (moved in from storage
+    // whenever possible), the only copy is made when splicing them into
+    // the upload buffer, which is allocated once at its final size.
+    std::vector<RecordInfo>           m_records;
+    std::vector<PackageInfo>          m_packages;
+    size_t                            m_dataSize {};
+    size_t                            m_overheadEstimate {};
 
   public:
     BondSplicer() noexcept = default;
@@ -29,9 +48,12 @@ class BondSplicer : public ISplicer
 
     size_t addTenantToken(std::string const& tenantToken) override;
     void addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob) override;
+    void addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob) override;
+    void addRecord(size_t dataPackageIndex, std::shared_ptr<std::vector<uint8_t> const> recordBlob) override;
 
     size_t getSizeEstimate() const override;
     std::vector<uint8_t> splice() const override;
+    bool splice(SpliceSink const& sink) const override;
 
     void clear() override;
 };
@@ -8,33 +8,44 @@
 #include "pal/PAL.hpp"
 #include "DataPackage.hpp"
 
-#include <list>
+#include <functional>
+#include <memory>
 #include <vector>
 
 namespace MAT_NS_BEGIN {
 
 class ISplicer
 {
-  protected:
-    struct Span {
-        size_t offset, length;
-    };
-
-    struct PackageInfo {
-        std::string     tenantToken;
-        Span            header;
-        std::list<Span> records;
-    };
-
   public:
+    /// <summary>
+    /// Receives consecutive chunks of the spliced output. Returning false stops splicing.
+    /// </summary>
+    using SpliceSink = std::function<bool(uint8_t const* data, size_t size)>;
+
     virtual ~ISplicer() noexcept = default;
 
     virtual size_t addTenantToken(std::string const& tenantToken) = 0;
     virtual void addRecord(size_t dataPackageIndex, std::vector<uint8_t> const& recordBlob) = 0;
 
+    /// <summary>
+    /// Add a record taking ownership of its blob, without copying it.
+    /// </summary>
+    virtual void addRecord(size_t dataPackageIndex, std::vector<uint8_t>&& recordBlob) = 0;
+
+    /// <summary>
+    /// Add a record whose blob is shared with the storage, without copying it.
+    /// </summary>
+    virtual void addRecord(size_t dataPackageIndex, std::shared_ptr<std::vector<uint8_t> const> recordBlob) = 0;
+
     virtual size_t getSizeEstimate() const = 0;
     virtual std::vector<uint8_t> splice() const = 0;
 
+    /// <summary>
+    /// Emit the spliced output in chunks instead of materializing it as one buffer.
+    /// </summary>
+    /// <returns>false if the sink has stopped the splicing</returns>
+    virtual bool splice(SpliceSink const& sink) const = 0;
+
     virtual void clear() = 0;
 };
 
@@ -17,20 +17,23 @@ namespace MAT_NS_BEGIN {
         if (forcedTenantToken != nullptr)
         {
             m_forcedTenantToken = forcedTenantToken;
+            m_forcedTenantId = TenantRegistry::Intern(m_forcedTenantToken);
         }
     }
 
-    void Packager::handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord const& record, bool& wantMore)
+    void Packager::handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord& record, bool& wantMore)
     {
+        // Records reserved in the ram queue share their blob with the storage
+        size_t blobSize = record.getBlob().size();
         try {
             if (ctx->maxUploadSize == 0) {
                 ctx->maxUploadSize = m_config.GetMaximumUploadSizeBytes();
             }
-            if (ctx->splicer->getSizeEstimate() + record.blob.size() > ctx->maxUploadSize) {
+            if (ctx->splicer->getSizeEstimate() + blobSize > ctx->maxUploadSize) {
                 wantMore = false;
-                if (!ctx->recordIdsAndTenantIds.empty()) {
+                if (!ctx->records.empty()) {
                     LOG_TRACE("Maximum upload size %u bytes exceeded, not adding the next event (ID %s, size %u bytes)",
-                        ctx->maxUploadSize, record.id.c_str(), static_cast<unsigned>(record.blob.size()));
+                        ctx->maxUploadSize, record.id.c_str(), static_cast<unsigned>(blobSize));
                     return;
                 }
                 else {
@@ -46,24 +49,30 @@ namespace MAT_NS_BEGIN {
             }
 
             LOG_TRACE("Adding event %s:%s, size %u bytes",
-                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str(), static_cast<unsigned>(record.blob.size()));
+                tenantTokenToId(record.tenantToken).c_str(), record.id.c_str(), static_cast<unsigned>(blobSize));
 
-            std::string const& tenantToken = m_forcedTenantToken.empty() ? record.tenantToken : m_forcedTenantToken;
-            auto it = ctx->packageIds.lower_bound(tenantToken);
-            if (it == ctx->packageIds.end() || it->first != tenantToken)
+            TenantId tenantId = TenantRegistry::Intern(record.tenantToken);
+            TenantId packageTenantId = m_forcedTenantToken.empty() ? tenantId : m_forcedTenantId;
+            auto it = ctx->packageIds.lower_bound(packageTenantId);
+            if (it == ctx->packageIds.end() || it->first != packageTenantId)
             {
-                it = ctx->packageIds.insert(it, { tenantToken, ctx->splicer->addTenantToken(tenantToken) });
+                it = ctx->packageIds.insert(it, { packageTenantId, ctx->splicer->addTenantToken(TenantRegistry::GetToken(packageTenantId)) });
             }
 
-            ctx->splicer->addRecord(it->second, record.blob);
+            // The record is not used after packaging, hand its blob over to the splicer
+            if (record.sharedBlob) {
+                ctx->splicer->addRecord(it->second, std::move(record.sharedBlob));
+            }
+            else {
+                ctx->splicer->addRecord(it->second, std::move(record.blob));
+            }
 
-            ctx->recordIdsAndTenantIds[record.id] = record.tenantToken;
-            ctx->recordTimestamps.push_back(record.timestamp);
+            ctx->records.add(record.id, tenantId, record.timestamp);
             ctx->maxRetryCountSeen = std::max<int>(ctx->maxRetryCountSeen, record.retryCount);
         }
         catch (const std::bad_alloc&) {
             wantMore = false;
-            LOG_ERROR("Failed to add new record to package: record.blob.size=%zu", record.blob.size());
+            LOG_ERROR("Failed to add new record to package: record.blob.size=%zu", blobSize);
         }
     }
 
@@ -74,8 +83,22 @@ namespace MAT_NS_BEGIN {
             return;
         }
 
-        ctx->body = ctx->splicer->splice();
-        ctx->splicer->clear();
+        // With streaming compression the records stay in the splicer and get
+        // deflated straight from there, so that no contiguous copy of the
+        // uncompressed body is made. The record blobs themselves are still held
+        // until the whole request has been compressed, as the package headers
+        // precede them in the output. Only builds with zlib route packages
+        // through the compression step that splices them.
+#ifdef HAVE_MAT_ZLIB
+        bool streamingCompression = m_config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION_STREAMING];
+        if (streamingCompression && m_config.IsHttpRequestCompressionEnabled()) {
+            ctx->bodyInSplicer = true;
+        } else
+#endif
+        {
+            ctx->body = ctx->splicer->splice();
+            ctx->splicer->clear();
+        }
 
         packagedEvents(ctx);
     }
@@ -16,15 +16,16 @@ namespace MAT_NS_BEGIN {
         Packager(IRuntimeConfig& runtimeConfig);
 
     protected:
-        void handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord const& record, bool& wantMore);
+        void handleAddEventToPackage(EventsUploadContextPtr const& ctx, StorageRecord& record, bool& wantMore);
         void handleFinalizePackage(EventsUploadContextPtr const& ctx);
 
     protected:
         IRuntimeConfig & m_config;
         std::string      m_forcedTenantToken;
+        TenantId         m_forcedTenantId = NoTenant;
 
     public:
-        RouteSink<Packager, EventsUploadContextPtr const&, StorageRecord const&, bool&> addEventToPackage{ this, &Packager::handleAddEventToPackage };
+        RouteSink<Packager, EventsUploadContextPtr const&, StorageRecord&, bool&>       addEventToPackage{ this, &Packager::handleAddEventToPackage };
         RouteSink<Packager, EventsUploadContextPtr const&>                              finalizePackage{ this, &Packager::handleFinalizePackage };
 
         RouteSource<EventsUploadContextPtr const&>                                      emptyPackage;
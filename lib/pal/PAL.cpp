@@ -283,7 +283,7 @@ namespace PAL_NS_BEGIN {
         {
             // Default implementation of task dispatcher is a single-threaded worker thread task queue
             LOG_TRACE("Initializing PAL worker thread");
-            m_taskDispatcher = PAL::WorkerThreadFactory::Create();
+            m_taskDispatcher = PAL::WorkerThreadFactory::Create(m_taskScheduler);
         }
         return m_taskDispatcher;
     }
@@ -301,28 +301,7 @@ namespace PAL_NS_BEGIN {
         UNREFERENCED_PARAMETER(hr);
         return MAT::to_string(uuid);
 #else
-        static std::once_flag flag;
-        std::call_once(flag, [](){
-            auto now = std::chrono::high_resolution_clock::now();
-            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-            std::srand(static_cast<unsigned int>(std::time(0) ^ nanos));
-        });
-
-        GUID_t uuid;
-        uuid.Data1 = (static_cast<uint16_t>(std::rand()) << 16) | static_cast<uint16_t>(std::rand());
-        uuid.Data2 = static_cast<uint16_t>(std::rand());
-        uuid.Data3 = static_cast<uint16_t>(std::rand());
-        for (size_t i = 0; i < sizeof(uuid.Data4); i++)
-            uuid.Data4[i] = static_cast<uint8_t>(std::rand());
-
-        // TODO: [MG] - replace this sprintf by more robust GUID to string converter
-        char buf[40] = { 0 };
-        sprintf(buf,
-            "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-            uuid.Data1, uuid.Data2, uuid.Data3,
-            uuid.Data4[0], uuid.Data4[1], uuid.Data4[2], uuid.Data4[3],
-            uuid.Data4[4], uuid.Data4[5], uuid.Data4[6], uuid.Data4[7]);
-        return buf;
+        return UuidGenerator::generateString();
 #endif
     }
 #ifdef _MSC_VER
@@ -516,6 +495,8 @@ namespace PAL_NS_BEGIN {
             m_SystemInformation = SystemInformationImpl::Create(configuration);
             m_DeviceInformation = DeviceInformationImpl::Create(configuration);
             m_NetworkInformation = NetworkInformationImpl::Create(configuration);
+            int32_t taskScheduler = configuration[CFG_INT_TASK_SCHEDULER];
+            m_taskScheduler = static_cast<TaskSchedulerType>(taskScheduler);
             LOG_INFO("Initialized");
         }
         else
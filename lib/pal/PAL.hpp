@@ -59,6 +59,7 @@
 
 #include "typename.hpp"
 #include "WorkerThread.hpp"
+#include "UuidGenerator.hpp"
 
 namespace MAT_NS_BEGIN
 {
@@ -113,6 +114,7 @@ namespace PAL_NS_BEGIN
     private:
         volatile std::atomic<long> m_palStarted { 0 };
         std::shared_ptr<ITaskDispatcher> m_taskDispatcher;
+        MAT::TaskSchedulerType m_taskScheduler { MAT::TaskScheduler_List };
         std::shared_ptr<ISystemInformation> m_SystemInformation;
         std::shared_ptr<INetworkInformation> m_NetworkInformation;
         std::shared_ptr<IDeviceInformation> m_DeviceInformation;
@@ -142,14 +144,44 @@ namespace PAL_NS_BEGIN
     }
 
     /**
-     * Returns a new random UUID in a lowercase hexadecimal format with dashes,
-     * but without curly braces, e.g. "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+     * Whether generated UUID strings use uppercase hexadecimal digits: on Windows they
+     * come from CoCreateGuid and are formatted in uppercase, lowercase elsewhere.
+     */
+#ifdef _WIN32
+    static constexpr bool UuidUpperCase = true;
+#else
+    static constexpr bool UuidUpperCase = false;
+#endif
+
+    /**
+     * Returns a new random UUID in a hexadecimal format with dashes, but without
+     * curly braces, e.g. "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx". The case of the
+     * digits is given by UuidUpperCase.
      */
     inline std::string generateUuidString()
     {
         return GetPAL().generateUuidString();
     }
 
+    /**
+     * Writes a new random UUID in the same format as generateUuidString() into the
+     * first 36 characters of the buffer, without a terminating zero and without
+     * allocating.
+     */
+    inline void generateUuidString(char* buffer)
+    {
+        UuidGenerator::generateString(buffer, UuidUpperCase);
+    }
+
+    /**
+     * Generates a new random UUID as 16 bytes in RFC 4122 byte order, for keying
+     * records without a string ID.
+     */
+    inline void generateUuid(uint8_t (&uuid)[UuidGenerator::BinarySize])
+    {
+        UuidGenerator::generate(uuid);
+    }
+
     /**
      * Return the monotonic system clock time in milliseconds (since unspecified point).
      */
@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef UUIDGENERATOR_HPP
+#define UUIDGENERATOR_HPP
+
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace PAL_NS_BEGIN
+{
+    /// <summary>
+    /// Random (RFC 4122 version 4) UUID generator for event and session IDs.
+    /// Each thread owns a xoshiro256** state, so generating an ID takes no locks,
+    /// and formatting uses a lookup table instead of sprintf. A forked child process
+    /// reseeds its state, so it does not repeat the IDs of its parent.
+    /// Not suitable for anything that has to be unpredictable (not cryptographic).
+    /// </summary>
+    class UuidGenerator
+    {
+    public:
+        /// <summary>Size of a binary UUID in bytes</summary>
+        static constexpr size_t BinarySize = 16;
+
+        /// <summary>Length of a formatted UUID "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"</summary>
+        static constexpr size_t StringSize = 36;
+
+        /// <summary>
+        /// Generate a new UUID in binary form, bytes in RFC 4122 (network) order.
+        /// </summary>
+        static void generate(uint8_t (&uuid)[BinarySize]) noexcept
+        {
+            State& state = threadState();
+            uint64_t hi = state.next();
+            uint64_t lo = state.next();
+            for (size_t i = 0; i < 8; i++)
+            {
+                uuid[i] = static_cast<uint8_t>(hi >> (56 - 8 * i));
+                uuid[8 + i] = static_cast<uint8_t>(lo >> (56 - 8 * i));
+            }
+            uuid[6] = static_cast<uint8_t>((uuid[6] & 0x0F) | 0x40); // version 4
+            uuid[8] = static_cast<uint8_t>((uuid[8] & 0x3F) | 0x80); // variant 10xx
+        }
+
+        /// <summary>
+        /// Format a binary UUID as hex with dashes into exactly StringSize characters
+        /// of the caller's buffer. No terminating zero is written.
+        /// </summary>
+        static void format(uint8_t const (&uuid)[BinarySize], char* buffer, bool upperCase = false) noexcept
+        {
+            char const* digits = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+            char* out = buffer;
+            for (size_t i = 0; i < BinarySize; i++)
+            {
+                if (i == 4 || i == 6 || i == 8 || i == 10)
+                {
+                    *out++ = '-';
+                }
+                *out++ = digits[uuid[i] >> 4];
+                *out++ = digits[uuid[i] & 0x0F];
+            }
+        }
+
+        /// <summary>
+        /// Generate a new UUID into exactly StringSize characters of the caller's
+        /// buffer. No terminating zero is written.
+        /// </summary>
+        static void generateString(char* buffer, bool upperCase = false) noexcept
+        {
+            uint8_t uuid[BinarySize];
+            generate(uuid);
+            format(uuid, buffer, upperCase);
+        }
+
+        /// <summary>
+        /// Generate a new UUID as a string.
+        /// </summary>
+        static std::string generateString(bool upperCase = false)
+        {
+            char buffer[StringSize];
+            generateString(buffer, upperCase);
+            return std::string(buffer, StringSize);
+        }
+
+    protected:
+        struct State
+        {
+            uint64_t s[4];
+            // Value of forkCount() when the state was seeded
+            uint64_t forks;
+
+            State() noexcept
+            {
+                reseed();
+            }
+
+            void reseed() noexcept
+            {
+                // Mix the clock, a process-wide counter and thread and process identity, so that
+                // threads started at the same instant and forked children get distinct sequences.
+                static std::atomic<uint64_t> instances(0);
+                forks = forkCount().load(std::memory_order_relaxed);
+                uint64_t seed = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+                seed ^= static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) << 1;
+                seed ^= static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) << 17;
+                seed ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this));
+#ifndef _WIN32
+                seed ^= static_cast<uint64_t>(getpid()) << 40;
+#endif
+                seed += (instances.fetch_add(1) + 1) * 0x9E3779B97F4A7C15ull;
+                for (uint64_t& word : s)
+                {
+                    word = splitmix64(seed);
+                }
+            }
+
+            // xoshiro256** 1.0, public domain, by D. Blackman and S. Vigna
+            uint64_t next() noexcept
+            {
+                uint64_t const result = rotl(s[1] * 5, 7) * 9;
+                uint64_t const t = s[1] << 17;
+                s[2] ^= s[0];
+                s[3] ^= s[1];
+                s[1] ^= s[2];
+                s[0] ^= s[3];
+                s[2] ^= t;
+                s[3] = rotl(s[3], 45);
+                return result;
+            }
+
+            static uint64_t rotl(uint64_t x, int k) noexcept
+            {
+                return (x << k) | (x >> (64 - k));
+            }
+
+            static uint64_t splitmix64(uint64_t& x) noexcept
+            {
+                uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                return z ^ (z >> 31);
+            }
+        };
+
+        /// <summary>
+        /// Number of times this process has been forked into a child so far. In the child,
+        /// the thread state copied from the parent no longer matches it and gets reseeded.
+        /// </summary>
+        static std::atomic<uint64_t>& forkCount() noexcept
+        {
+            static std::atomic<uint64_t> count(0);
+            return count;
+        }
+
+#ifndef _WIN32
+        static void onForkChild() noexcept
+        {
+            forkCount().fetch_add(1);
+        }
+#endif
+
+        static State& threadState() noexcept
+        {
+#ifndef _WIN32
+            static int const forkHandler = pthread_atfork(nullptr, nullptr, &UuidGenerator::onForkChild);
+            (void)forkHandler;
+#endif
+            static thread_local State state;
+            if (state.forks != forkCount().load(std::memory_order_relaxed))
+            {
+                state.reseed();
+            }
+            return state;
+        }
+    };
+
+} PAL_NS_END
+
+#endif
@@ -6,6 +6,9 @@
 #include "pal/WorkerThread.hpp"
 #include "pal/PAL.hpp"
 
+#include <cstdint>
+#include <vector>
+
 #if defined(MATSDK_PAL_CPP11) || defined(MATSDK_PAL_WIN32)
 
 /* Maximum scheduler interval for SDK is 1 hour required for clamping in case of monotonic clock drift */
@@ -23,6 +26,247 @@ namespace PAL_NS_BEGIN {
         }
     };
 
+    /// <summary>
+    /// Timer queue kept as a list sorted by target time: O(n) insert and cancel.
+    /// </summary>
+    class ListTimerQueue
+    {
+    public:
+        bool empty() const { return m_items.empty(); }
+
+        MAT::Task* front() const { return m_items.front(); }
+
+        void pop_front() { m_items.pop_front(); }
+
+        void push(MAT::Task* item)
+        {
+            auto it = m_items.begin();
+            while (it != m_items.end() && (*it)->TargetTime < item->TargetTime) {
+                ++it;
+            }
+            m_items.insert(it, item);
+        }
+
+        bool erase(MAT::Task* item)
+        {
+            auto it = std::find(m_items.begin(), m_items.end(), item);
+            if (it == m_items.end()) {
+                return false;
+            }
+            m_items.erase(it);
+            return true;
+        }
+
+    protected:
+        std::list<MAT::Task*> m_items;
+    };
+
+    /// <summary>
+    /// Positions of the tasks in a HeapTimerQueue, in an open-addressed table with linear
+    /// probing. Cancel passes pointers to tasks which may already have run and been deleted,
+    /// so the position is looked up by pointer value rather than read from the task itself.
+    /// Slots live in a vector which keeps its capacity, adding a task does not allocate.
+    /// </summary>
+    class TaskPositions
+    {
+    public:
+        void set(MAT::Task* task, size_t pos)
+        {
+            if ((m_count + 1) * 2 > m_slots.size()) {
+                grow();
+            }
+            size_t i = slotOf(task);
+            if (m_slots[i].task == nullptr) {
+                m_slots[i].task = task;
+                m_count++;
+            }
+            m_slots[i].pos = pos;
+        }
+
+        bool find(MAT::Task* task, size_t& pos) const
+        {
+            if (m_slots.empty()) {
+                return false;
+            }
+            size_t i = slotOf(task);
+            if (m_slots[i].task == nullptr) {
+                return false;
+            }
+            pos = m_slots[i].pos;
+            return true;
+        }
+
+        void erase(MAT::Task* task)
+        {
+            if (m_slots.empty()) {
+                return;
+            }
+            size_t i = slotOf(task);
+            if (m_slots[i].task == nullptr) {
+                return;
+            }
+            // Shift the following entries of the probe run back instead of leaving a tombstone
+            size_t const mask = m_slots.size() - 1;
+            for (size_t j = (i + 1) & mask; m_slots[j].task != nullptr; j = (j + 1) & mask) {
+                size_t home = hash(m_slots[j].task) & mask;
+                bool stays = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+                if (!stays) {
+                    m_slots[i] = m_slots[j];
+                    i = j;
+                }
+            }
+            m_slots[i].task = nullptr;
+            m_count--;
+        }
+
+    protected:
+        struct Slot
+        {
+            MAT::Task* task = nullptr;
+            size_t     pos = 0;
+        };
+
+        static size_t hash(MAT::Task* task)
+        {
+            uint64_t value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(task));
+            value ^= value >> 29;
+            value *= 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(value >> 32);
+        }
+
+        // Slot holding the task, or the empty slot where it would go
+        size_t slotOf(MAT::Task* task) const
+        {
+            size_t const mask = m_slots.size() - 1;
+            size_t i = hash(task) & mask;
+            while (m_slots[i].task != nullptr && m_slots[i].task != task) {
+                i = (i + 1) & mask;
+            }
+            return i;
+        }
+
+        void grow()
+        {
+            std::vector<Slot> previous(m_slots.empty() ? 16 : m_slots.size() * 2);
+            previous.swap(m_slots);
+            m_count = 0;
+            for (Slot const& slot : previous) {
+                if (slot.task != nullptr) {
+                    m_slots[slotOf(slot.task)] = slot;
+                    m_count++;
+                }
+            }
+        }
+
+        std::vector<Slot> m_slots;
+        size_t            m_count = 0;
+    };
+
+    /// <summary>
+    /// Timer queue kept as an indexed binary min-heap: O(log n) insert and removal,
+    /// O(1) lookup of a task being cancelled. Heap entries and their positions live
+    /// in vectors which keep their capacity, queueing timers does not allocate once
+    /// the queue has grown to its working size. The tasks are allocated by their callers.
+    /// Tasks with equal target time run in the order they were queued.
+    /// </summary>
+    class HeapTimerQueue
+    {
+    public:
+        bool empty() const { return m_heap.empty(); }
+
+        MAT::Task* front() const { return m_heap.front().task; }
+
+        void pop_front() { removeAt(0); }
+
+        void push(MAT::Task* item)
+        {
+            m_heap.push_back({ item->TargetTime, m_nextSeq++, item });
+            m_index.set(item, m_heap.size() - 1);
+            siftUp(m_heap.size() - 1);
+        }
+
+        bool erase(MAT::Task* item)
+        {
+            size_t pos;
+            if (!m_index.find(item, pos)) {
+                return false;
+            }
+            removeAt(pos);
+            return true;
+        }
+
+    protected:
+        struct Node
+        {
+            uint64_t   targetTime;
+            uint64_t   seq;
+            MAT::Task* task;
+        };
+
+        static bool before(Node const& a, Node const& b)
+        {
+            return (a.targetTime != b.targetTime) ? (a.targetTime < b.targetTime) : (a.seq < b.seq);
+        }
+
+        void place(size_t pos, Node const& node)
+        {
+            m_heap[pos] = node;
+            m_index.set(node.task, pos);
+        }
+
+        void removeAt(size_t pos)
+        {
+            m_index.erase(m_heap[pos].task);
+            Node last = m_heap.back();
+            m_heap.pop_back();
+            if (pos < m_heap.size()) {
+                place(pos, last);
+                siftDown(pos);
+                siftUp(pos);
+            }
+        }
+
+        void siftUp(size_t pos)
+        {
+            Node node = m_heap[pos];
+            while (pos > 0) {
+                size_t parent = (pos - 1) / 2;
+                if (!before(node, m_heap[parent])) {
+                    break;
+                }
+                place(pos, m_heap[parent]);
+                pos = parent;
+            }
+            place(pos, node);
+        }
+
+        void siftDown(size_t pos)
+        {
+            Node node = m_heap[pos];
+            size_t count = m_heap.size();
+            for (;;) {
+                size_t child = 2 * pos + 1;
+                if (child >= count) {
+                    break;
+                }
+                if (child + 1 < count && before(m_heap[child + 1], m_heap[child])) {
+                    child++;
+                }
+                if (!before(m_heap[child], node)) {
+                    break;
+                }
+                place(pos, m_heap[child]);
+                pos = child;
+            }
+            place(pos, node);
+        }
+
+        std::vector<Node>                        m_heap;
+        TaskPositions                            m_index;
+        uint64_t                                 m_nextSeq = 0;
+    };
+
+    template <typename TTimerQueue>
     class WorkerThread : public ITaskDispatcher
     {
     protected:
@@ -32,7 +276,7 @@ namespace PAL_NS_BEGIN {
         std::timed_mutex      m_execution_mutex;
 
         std::list<MAT::Task*> m_queue;
-        std::list<MAT::Task*> m_timerQueue;
+        TTimerQueue           m_timerQueue;
         Event                 m_event;
         MAT::Task*            m_itemInProgress;
         int count = 0;
@@ -80,11 +324,7 @@ namespace PAL_NS_BEGIN {
             LOG_INFO("queue item=%p", &item);
             LOCKGUARD(m_lock);
             if (item->Type == MAT::Task::TimedCall) {
-                auto it = m_timerQueue.begin();
-                while (it != m_timerQueue.end() && (*it)->TargetTime < item->TargetTime) {
-                    ++it;
-                }
-                m_timerQueue.insert(it, item);
+                m_timerQueue.push(item);
             }
             else {
                 m_queue.push_back(item);
@@ -151,13 +391,9 @@ namespace PAL_NS_BEGIN {
                 return (m_itemInProgress != item);
             }
 
-            {
-                auto it = std::find(m_timerQueue.begin(), m_timerQueue.end(), item);
-                if (it != m_timerQueue.end()) {
-                    // Still in the queue
-                    m_timerQueue.erase(it);
-                    delete item;
-                }
+            if (m_timerQueue.erase(item)) {
+                // Still in the queue
+                delete item;
             }
 #if 0
             for (;;) {
@@ -254,7 +490,16 @@ namespace PAL_NS_BEGIN {
     namespace WorkerThreadFactory {
         std::shared_ptr<ITaskDispatcher> Create()
         {
-            return std::make_shared<WorkerThread>();
+            return Create(MAT::TaskScheduler_List);
+        }
+
+        std::shared_ptr<ITaskDispatcher> Create(MAT::TaskSchedulerType scheduler)
+        {
+            if (scheduler == MAT::TaskScheduler_Heap)
+            {
+                return std::make_shared<WorkerThread<HeapTimerQueue>>();
+            }
+            return std::make_shared<WorkerThread<ListTimerQueue>>();
         }
     }
 
@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <memory>
 
+#include "Enums.hpp"
 #include "ITaskDispatcher.hpp"
 #include "ctmacros.hpp"
 
@@ -80,6 +81,7 @@ namespace PAL_NS_BEGIN {
 
     namespace WorkerThreadFactory {
         std::shared_ptr<MAT::ITaskDispatcher> Create();
+        std::shared_ptr<MAT::ITaskDispatcher> Create(MAT::TaskSchedulerType scheduler);
     }
 
 } PAL_NS_END
@@ -260,6 +260,15 @@ namespace MAT_NS_BEGIN {
         addCountsPerHttpReturnCodeToRecordFields(record, "pkg_drop_HTTP", packageStats.dropPkgsPerHttpReturnCode);
         addCountsPerHttpReturnCodeToRecordFields(record, "pkg_retr_HTTP", packageStats.retryPkgsPerHttpReturnCode);
         insertNonZero(ext, "bytes", packageStats.totalBandwidthConsumedInBytes);
+        insertNonZero(ext, "pkg_inf_max", packageStats.maxPkgsInFlight);
+
+        // Upload drain rate: records acknowledged per second since the stats interval started
+        insertNonZero(ext, "rec_ok", packageStats.recordsInSuccessPkgs);
+        int64_t intervalMs = PAL::getUtcSystemTimeMs() - telemetryStats.statsStartTimestamp;
+        if (intervalMs > 0)
+        {
+            insertNonZero(ext, "rec_ok_per_sec", static_cast<int64_t>(packageStats.recordsInSuccessPkgs * int64_t { 1000 } / intervalMs));
+        }
 
         // RTT stats
         if (packageStats.successPkgsAcked > 0) {
@@ -410,11 +419,11 @@ namespace MAT_NS_BEGIN {
     /// <summary>
     /// Updates stats on incoming event.
     /// </summary>
-    /// <param name="tenanttoken">The tenanttoken.</param>
+    /// <param name="tenantId">The interned tenant token.</param>
     /// <param name="size">The size.</param>
     /// <param name="latency">The latency.</param>
     /// <param name="metastats">if set to <c>true</c> [metastats].</param>
-    void MetaStats::updateOnEventIncoming(std::string const& tenanttoken, unsigned size, EventLatency latency, bool metastats)
+    void MetaStats::updateOnEventIncoming(TenantId tenantId, unsigned size, EventLatency latency, bool metastats)
     {
         auto updateRecordStats = [&](RecordStats& recordStats)
         {
@@ -427,7 +436,7 @@ namespace MAT_NS_BEGIN {
             recordStats.minOfRecordSizeInBytes = std::min<unsigned>(recordStats.minOfRecordSizeInBytes, size);
             recordStats.totalRecordsSizeInBytes += size;
             if (latency >= 0) {
-                RecordStats& recordStatsPerPriority = m_telemetryTenantStats[tenanttoken].recordStatsPerLatency[latency];
+                RecordStats& recordStatsPerPriority = m_telemetryTenantStats[tenantId].recordStatsPerLatency[latency];
                 recordStatsPerPriority.received++;
                 recordStatsPerPriority.totalRecordsSizeInBytes += size;
             }
@@ -439,11 +448,12 @@ namespace MAT_NS_BEGIN {
         // Per-tenant
         if (m_enableTenantStats)
         {
-            if (m_telemetryTenantStats[tenanttoken].tenantId.empty())
+            TelemetryStats& tenantStats = m_telemetryTenantStats[tenantId];
+            if (tenantStats.tenantId.empty())
             {
-                m_telemetryTenantStats[tenanttoken].tenantId = tenanttoken.substr(0, tenanttoken.find('-'));
+                tenantStats.tenantId = tenantTokenToId(TenantRegistry::GetToken(tenantId));
             }
-            updateRecordStats(m_telemetryTenantStats[tenanttoken].recordStats);
+            updateRecordStats(tenantStats.recordStats);
         }
     }
 
@@ -462,21 +472,33 @@ namespace MAT_NS_BEGIN {
         }
     }
 
+    /// <summary>
+    /// Updates stats on the number of packages in flight when one more is sent.
+    /// </summary>
+    /// <param name="pkgsInFlight">The number of packages in flight, including the new one.</param>
+    void MetaStats::updateOnPackagesInFlight(unsigned pkgsInFlight)
+    {
+        // Cumulative only
+        PackageStats& packageStats = m_telemetryStats.packageStats;
+        packageStats.maxPkgsInFlight = std::max<unsigned>(packageStats.maxPkgsInFlight, pkgsInFlight);
+    }
+
     /// <summary>
     /// Updates stats on successful package send.
     /// </summary>
-    /// <param name="recordIdsAndTenantids">The record ids and tenantids.</param>
+    /// <param name="recordTenantIds">The tenant id of each record in the package.</param>
     /// <param name="eventLatency">The event latency.</param>
     /// <param name="retryFailedTimes">The retry failed times.</param>
     /// <param name="durationMs">The duration ms.</param>
     /// <param name="latencyToSendMs">The latency to send ms.</param>
     /// <param name="metastatsOnly">if set to <c>true</c> [metastats only].</param>
-    void MetaStats::updateOnPackageSentSucceeded(std::map<std::string, std::string> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& /*latencyToSendMs*/, bool metastatsOnly)
+    void MetaStats::updateOnPackageSentSucceeded(std::vector<TenantId> const& recordTenantIds, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& /*latencyToSendMs*/, bool metastatsOnly)
     {
         // Package summary stats
         PackageStats& packageStats = m_telemetryStats.packageStats;
         packageStats.totalPkgsAcked++;
         packageStats.successPkgsAcked++;
+        packageStats.recordsInSuccessPkgs += static_cast<unsigned>(recordTenantIds.size());
         if (metastatsOnly)
         {
             packageStats.totalMetastatsOnlyPkgsAcked++;
@@ -505,9 +527,17 @@ namespace MAT_NS_BEGIN {
         // Per-tenant
         if (m_enableTenantStats)
         {
-            for (const auto& entry : recordIdsAndTenantids)
+            // Records of one tenant are usually packaged next to each other
+            TelemetryStats* tenantStats = nullptr;
+            TenantId lastTenantId = NoTenant;
+            for (TenantId tenantId : recordTenantIds)
             {
-                updatePackageSent(m_telemetryTenantStats[entry.second]);
+                if (tenantStats == nullptr || tenantId != lastTenantId)
+                {
+                    tenantStats = &m_telemetryTenantStats[tenantId];
+                    lastTenantId = tenantId;
+                }
+                updatePackageSent(*tenantStats);
             }
         }
 
@@ -554,7 +584,7 @@ namespace MAT_NS_BEGIN {
             // Per-tenant
             if (m_enableTenantStats)
             {
-                auto& temp = m_telemetryTenantStats[dropcouttenant.first];
+                auto& temp = m_telemetryTenantStats[TenantRegistry::Intern(dropcouttenant.first)];
                 temp.recordStats.droppedByReason[reason] += static_cast<unsigned int>(dropcouttenant.second);
                 temp.recordStats.dropped += static_cast<unsigned int>(dropcouttenant.second);
             }
@@ -577,7 +607,7 @@ namespace MAT_NS_BEGIN {
             // Per-tenant
             if (m_enableTenantStats)
             {
-                auto& temp = m_telemetryTenantStats[overflowntenant.first];
+                auto& temp = m_telemetryTenantStats[TenantRegistry::Intern(overflowntenant.first)];
                 temp.recordStats.overflown += static_cast<unsigned int>(overflowntenant.second);
             }
             overallCount += static_cast<unsigned int>(overflowntenant.second);
@@ -599,7 +629,7 @@ namespace MAT_NS_BEGIN {
             // Per-tenant
             if (m_enableTenantStats)
             {
-                TelemetryStats& temp = m_telemetryTenantStats[rejecttenant.first];
+                TelemetryStats& temp = m_telemetryTenantStats[TenantRegistry::Intern(rejecttenant.first)];
                 temp.recordStats.rejectedByReason[reason] += static_cast<unsigned int>(rejecttenant.second);
                 temp.recordStats.rejected += static_cast<unsigned int>(rejecttenant.second);
             }
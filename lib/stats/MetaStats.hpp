@@ -8,6 +8,7 @@
 #include "pal/PAL.hpp"
 
 #include "api/IRuntimeConfig.hpp"
+#include "system/TenantRegistry.hpp"
 
 #include "Enums.hpp"
 #include "CsProtocol_types.hpp"
@@ -312,6 +313,12 @@ namespace MAT_NS_BEGIN {
         /// the total size of packages
         unsigned int totalBandwidthConsumedInBytes;
 
+        /// the number of records in successful package sends
+        unsigned int recordsInSuccessPkgs;
+
+        /// the maximum number of packages in flight at the same time
+        unsigned int maxPkgsInFlight;
+
         /// reset all members
         void Reset()
         {
@@ -326,6 +333,8 @@ namespace MAT_NS_BEGIN {
             dropPkgsPerHttpReturnCode.clear();
             retryPkgsPerHttpReturnCode.clear();
             totalBandwidthConsumedInBytes = 0;
+            recordsInSuccessPkgs = 0;
+            maxPkgsInFlight = 0;
         }
 
         PackageStats()
@@ -524,9 +533,10 @@ namespace MAT_NS_BEGIN {
 
         std::vector< ::CsProtocol::Record> generateStatsEvent(RollUpKind rollupKind);
 
-        void updateOnEventIncoming(std::string const& tenanttoken, unsigned size, EventLatency latency, bool metastats);
+        void updateOnEventIncoming(TenantId tenantId, unsigned size, EventLatency latency, bool metastats);
         void updateOnPostData(unsigned postDataLength, bool metastatsOnly);
-        void updateOnPackageSentSucceeded(std::map<std::string, std::string> const& recordIdsAndTenantids, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& latencyToSendMs, bool metastatsOnly);
+        void updateOnPackagesInFlight(unsigned pkgsInFlight);
+        void updateOnPackageSentSucceeded(std::vector<TenantId> const& recordTenantIds, EventLatency eventLatency, unsigned retryFailedTimes, unsigned durationMs, std::vector<unsigned> const& latencyToSendMs, bool metastatsOnly);
         void updateOnPackageFailed(int statusCode);
         void updateOnPackageRetry(int statusCode, unsigned retryFailedTimes);
         void updateOnRecordsDropped(EventDroppedReason reason, std::map<std::string, size_t> const& droppedCount);
@@ -583,7 +593,7 @@ namespace MAT_NS_BEGIN {
         /// <summary>
         /// Per-tenant stats
         /// </summary>
-        std::map<std::string, TelemetryStats>  m_telemetryTenantStats;
+        std::map<TenantId, TelemetryStats>     m_telemetryTenantStats;
 
         const std::map<EventLatency, std::string> m_latency_pfx =
         {
@@ -17,6 +17,7 @@ namespace MAT_NS_BEGIN {
         m_iTelemetrySystem(telemetrySystem),
         m_taskDispatcher(taskDispatcher),
         m_config(telemetrySystem.getConfig()),
+        m_metaStatsTenantId(TenantRegistry::Intern(m_config.GetMetaStatsTenantToken())),
         m_logManager(telemetrySystem.getLogManager()),
         m_baseDecorator(m_logManager),
         m_semanticContextDecorator(m_logManager),
@@ -122,10 +123,10 @@ namespace MAT_NS_BEGIN {
 
     bool Statistics::handleOnIncomingEventAccepted(IncomingEventContextPtr const& ctx)
     {
-        bool metastats = (ctx->record.tenantToken == m_config.GetMetaStatsTenantToken());
+        bool metastats = (ctx->tenantId == m_metaStatsTenantId);
         {
             LOCKGUARD(m_metaStats_mtx);
-            m_metaStats.updateOnEventIncoming(ctx->record.tenantToken, static_cast<unsigned>(ctx->record.blob.size()), ctx->record.latency, metastats);
+            m_metaStats.updateOnEventIncoming(ctx->tenantId, static_cast<unsigned>(ctx->blobSize), ctx->record.latency, metastats);
         }
         scheduleSend();
 
@@ -156,18 +157,32 @@ namespace MAT_NS_BEGIN {
         return true;
     }
 
+    /// <summary>
+    /// Events the ingestion queue dropped on overflow, EVT_DROPPED is already dispatched for each
+    /// </summary>
+    bool Statistics::handleOnIncomingEventsDropped(StorageNotificationContext const* ctx)
+    {
+        {
+            LOCKGUARD(m_metaStats_mtx);
+            m_metaStats.updateOnRecordsDropped(DROPPED_REASON_OFFLINE_STORAGE_OVERFLOW, ctx->countonTenant);
+        }
+        scheduleSend();
+        return true;
+    }
+
     bool Statistics::handleOnUploadStarted(EventsUploadContextPtr const& ctx)
     {
-        bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
+        bool metastatsOnly = (ctx->packageIds.count(m_metaStatsTenantId) == ctx->packageIds.size());
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPostData(static_cast<unsigned>(ctx->httpRequest->GetSizeEstimate()), metastatsOnly);
+            m_metaStats.updateOnPackagesInFlight(ctx->uploadsInFlight);
         }
         scheduleSend();
 
         DebugEvent evt;
         evt.type = DebugEventType::EVT_SENDING;
-        evt.param1 = ctx->recordIdsAndTenantIds.size();
+        evt.param1 = ctx->records.size();
         OnDebugEvent(evt);
 
         return true;
@@ -184,16 +199,16 @@ namespace MAT_NS_BEGIN {
     {
         int64_t now = PAL::getUtcSystemTimeMs();
         std::vector<unsigned> latencyToSendMs;
-        latencyToSendMs.reserve(ctx->recordTimestamps.size());
-        for (int64_t ts : ctx->recordTimestamps)
+        latencyToSendMs.reserve(ctx->records.size());
+        for (int64_t ts : ctx->records.timestamps)
         {
             latencyToSendMs.push_back(static_cast<unsigned>(std::max<int64_t>(0, std::min<int64_t>(0xFFFFFFFFu, now - ts))));
         }
 
-        bool metastatsOnly = (ctx->packageIds.count(m_config.GetMetaStatsTenantToken()) == ctx->packageIds.size());
+        bool metastatsOnly = (ctx->packageIds.count(m_metaStatsTenantId) == ctx->packageIds.size());
         {
             LOCKGUARD(m_metaStats_mtx);
-            m_metaStats.updateOnPackageSentSucceeded(ctx->recordIdsAndTenantIds, ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
+            m_metaStats.updateOnPackageSentSucceeded(ctx->records.tenantIds, ctx->latency, ctx->maxRetryCountSeen, ctx->durationMs, latencyToSendMs, metastatsOnly);
         }
         scheduleSend();
         return true;
@@ -205,10 +220,15 @@ namespace MAT_NS_BEGIN {
         {
             LOCKGUARD(m_metaStats_mtx);
             m_metaStats.updateOnPackageFailed(status);
+            std::map<TenantId, size_t> countOnTenantId;
+            for (TenantId tenantId : ctx->records.tenantIds)
+            {
+                countOnTenantId[tenantId]++;
+            }
             std::map<std::string, size_t> countOnTenant;
-            for (const auto& recordAndTenant : ctx->recordIdsAndTenantIds)
+            for (const auto& tenantAndCount : countOnTenantId)
             {
-                countOnTenant[recordAndTenant.second]++;
+                countOnTenant[TenantRegistry::GetToken(tenantAndCount.first)] = tenantAndCount.second;
             }
             m_metaStats.updateOnRecordsRejected(REJECTED_REASON_SERVER_DECLINED, countOnTenant);
         }
@@ -43,6 +43,7 @@ namespace MAT_NS_BEGIN {
         bool handleOnIncomingEventAccepted(IncomingEventContextPtr const& ctx);
         // bool handleOnIncomingEventRejected(DebugEvent &evt); 
         bool handleOnIncomingEventFailed(IncomingEventContextPtr const& ctx);
+        bool handleOnIncomingEventsDropped(StorageNotificationContext const* ctx);
 
         bool handleOnUploadStarted(EventsUploadContextPtr const& ctx);
         bool handleOnPackagingFailed(EventsUploadContextPtr const& ctx);
@@ -62,6 +63,7 @@ namespace MAT_NS_BEGIN {
         ITelemetrySystem&           m_iTelemetrySystem;
         ITaskDispatcher&            m_taskDispatcher;
         IRuntimeConfig&             m_config;
+        TenantId                    m_metaStatsTenantId;
         ILogManager&                m_logManager;
 
         // Both decorators are associated with m_logManager
@@ -121,6 +123,7 @@ namespace MAT_NS_BEGIN {
         RoutePassThrough<Statistics, StorageNotificationContext const*> onStorageTrimmed{ this, &Statistics::handleOnStorageTrimmed };
         RoutePassThrough<Statistics, StorageNotificationContext const*> onStorageRecordsDropped{ this, &Statistics::handleOnStorageRecordsDropped };
         RoutePassThrough<Statistics, StorageNotificationContext const*> onStorageRecordsRejected{ this, &Statistics::handleOnStorageRecordsRejected };
+        RoutePassThrough<Statistics, StorageNotificationContext const*> onIncomingEventsDropped{ this, &Statistics::handleOnIncomingEventsDropped };
 
         virtual void OnDebugEvent(DebugEvent &evt) override;
 
@@ -9,6 +9,7 @@
 #include "packager/ISplicer.hpp"
 #include "packager/BondSplicer.hpp"
 #include "pal/PAL.hpp"
+#include "system/TenantRegistry.hpp"
 #include "utils/Utils.hpp"
 
 #include <map>
@@ -24,18 +25,32 @@ namespace MAT_NS_BEGIN {
         ::CsProtocol::Record*  source;
         StorageRecord          record;
         std::uint64_t          policyBitFlags;
+        // Size of the serialized event, which stays known after the blob is moved into storage
+        std::size_t            blobSize;
+        // Interned record.tenantToken, so that per-event bookkeeping does not hash the token again
+        TenantId               tenantId;
 
     public:
         IncomingEventContext() :
             source(nullptr),
-            policyBitFlags(0)
+            policyBitFlags(0),
+            blobSize(0),
+            tenantId(NoTenant)
         {
         }
 
         IncomingEventContext(std::string const& id, std::string const& tenantToken, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
+            : IncomingEventContext(id, tenantToken, TenantRegistry::Intern(tenantToken), latency, persistence, source)
+        {
+        }
+
+        /// <param name="tenantId">Id of tenantToken, for callers that interned it once up front</param>
+        IncomingEventContext(std::string const& id, std::string const& tenantToken, TenantId tenantId, EventLatency latency, EventPersistence persistence, ::CsProtocol::Record* source)
             : source(source),
             record{ id, tenantToken, latency, persistence },
-	    policyBitFlags(0)
+	    policyBitFlags(0),
+            blobSize(0),
+            tenantId(tenantId)
         {
         }
 
@@ -48,6 +63,35 @@ namespace MAT_NS_BEGIN {
 
     //---
 
+    /// <summary>
+    /// Records added to one upload package, kept as parallel arrays in the
+    /// order they were packaged. Acknowledging the upload walks these arrays
+    /// instead of a per-record map keyed by the record id.
+    /// </summary>
+    struct PackagedRecords
+    {
+        std::vector<StorageRecordId>         ids;
+        std::vector<TenantId>                tenantIds;
+        std::vector<int64_t>                 timestamps;
+
+        void add(StorageRecordId const& id, TenantId tenantId, int64_t timestamp)
+        {
+            ids.push_back(id);
+            tenantIds.push_back(tenantId);
+            timestamps.push_back(timestamp);
+        }
+
+        size_t size() const noexcept
+        {
+            return ids.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return ids.empty();
+        }
+    };
+
     class EventsUploadContext {
 
     private:
@@ -87,14 +131,15 @@ namespace MAT_NS_BEGIN {
         std::unique_ptr<ISplicer>            splicer;
         unsigned                             maxUploadSize = 0;
         EventLatency                         latency = EventLatency_Unspecified;
-        std::map<std::string, size_t>        packageIds;
-        std::map<std::string, std::string>   recordIdsAndTenantIds;
-        std::vector<int64_t>                 recordTimestamps;
+        std::map<TenantId, size_t>           packageIds;
+        PackagedRecords                      records;
         unsigned                             maxRetryCountSeen = 0;
 
         // Encoding
         std::vector<uint8_t>                 body;
         bool                                 compressed = false;
+        // Body has not been spliced yet, records are still held by the splicer
+        bool                                 bodyInSplicer = false;
 
         // Sending
         IHttpRequest*                        httpRequest = nullptr;
@@ -104,6 +149,8 @@ namespace MAT_NS_BEGIN {
         IHttpResponse*                       httpResponse = nullptr;
 
         int                                  durationMs = -1;
+        // Uploads in flight, including this one, when it was started
+        unsigned                             uploadsInFlight = 0;
         bool                                 fromMemory = false;
 
         EventsUploadContext() noexcept : 
@@ -25,6 +25,21 @@ namespace MAT_NS_BEGIN {
 
     const char* const DefaultEventName = "undefined";
 
+    static bool acceptPropertyName(const std::string& name)
+    {
+        EventRejectedReason isValidPropertyName = validatePropertyName(name);
+        if (isValidPropertyName != REJECTED_REASON_OK)
+        {
+            LOG_ERROR("Context name is invalid: %s", name.c_str());
+            DebugEvent evt;
+            evt.type = DebugEventType::EVT_REJECTED;
+            evt.param1 = isValidPropertyName;
+            ILogManager::DispatchEventBroadcast(evt);
+            return false;
+        }
+        return true;
+    }
+
     EventProperties::EventProperties(const std::string& name, const std::map<std::string, EventProperty> &properties) :
         EventProperties(name)
     {
@@ -35,16 +50,14 @@ namespace MAT_NS_BEGIN {
     {
         for (auto &kv : properties)
         {
-            auto key = kv.first;
-            auto val = kv.second;
-            m_storage->properties[key] = val;
+            m_storage->setProperty(kv.first, kv.second);
         }
         return (*this);
     }
 
     EventProperties& EventProperties::operator=(const std::map<std::string, EventProperty> &properties)
     {
-        m_storage->properties.clear();
+        m_storage->clearProperties();
         (*this) += properties;
         return (*this);
     }
@@ -114,15 +127,11 @@ namespace MAT_NS_BEGIN {
     /// </summary>
     EventProperties& EventProperties::operator=(std::initializer_list<std::pair<std::string const, EventProperty> > properties)
     {
-        m_storage->properties.clear();
-        m_storage->propertiesPartB.clear();
+        m_storage->clearProperties();
 
         for (auto &kv : properties)
         {
-            auto key = kv.first;
-            auto val = kv.second;
-
-            m_storage->properties[key] = val;
+            m_storage->setProperty(kv.first, kv.second);
         }
 
         return (*this);
@@ -310,15 +319,14 @@ namespace MAT_NS_BEGIN {
 
     std::tuple<bool, uint8_t> EventProperties::TryGetLevel() const
     {
-        const auto& findResult = GetProperties().find(COMMONFIELDS_EVENT_LEVEL);
-        if (findResult == GetProperties().cend())
+        const auto property = m_storage->properties.find(COMMONFIELDS_EVENT_LEVEL);
+        if (property == nullptr)
             return std::make_tuple<bool, uint8_t>(false, 0);
-        
-        const auto& property = findResult->second;
-        if (property.type != EventProperty::TYPE_INT64)
+
+        if (property->type != EventProperty::TYPE_INT64)
             return std::make_tuple<bool, uint8_t>(false, 0);
 
-        const auto& value = property.as_int64;
+        const auto& value = property->as_int64;
         if (value < 0 || value > UINT8_MAX)
             return std::make_tuple<bool, uint8_t>(false, 0);
         return std::make_tuple<bool, uint8_t>(true, static_cast<uint8_t>(value));
@@ -333,23 +341,30 @@ namespace MAT_NS_BEGIN {
     /// </summary>
     void EventProperties::SetProperty(const string& name, EventProperty prop)
     {
-        EventRejectedReason isValidPropertyName = validatePropertyName(name);
-        if (isValidPropertyName != REJECTED_REASON_OK)
+        if (acceptPropertyName(name))
         {
-            LOG_ERROR("Context name is invalid: %s", name.c_str());
-            DebugEvent evt;
-            evt.type = DebugEventType::EVT_REJECTED;
-            evt.param1 = isValidPropertyName;
-            ILogManager::DispatchEventBroadcast(evt);
-            return;
+            m_storage->setProperty(name, prop);
         }
+    }
 
-        m_storage->properties[name] = prop;
+    // String values are copied straight into the property storage, without a temporary EventProperty
+    void EventProperties::SetProperty(const std::string& name, char const*  value, PiiKind piiKind, DataCategory category)
+    {
+        if (acceptPropertyName(name))
+        {
+            m_storage->setProperty(name, value, piiKind, category);
+        }
+    }
+
+    void EventProperties::SetProperty(const std::string& name, const std::string&  value, PiiKind piiKind, DataCategory category)
+    {
+        if (acceptPropertyName(name))
+        {
+            m_storage->setProperty(name, value.c_str(), piiKind, category);
+        }
     }
 
     //
-    void EventProperties::SetProperty(const std::string& name, char const*  value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
-    void EventProperties::SetProperty(const std::string& name, const std::string&  value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
     void EventProperties::SetProperty(const std::string& name, double       value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
     void EventProperties::SetProperty(const std::string& name, int64_t      value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
     void EventProperties::SetProperty(const std::string& name, bool         value, PiiKind piiKind, DataCategory category) { SetProperty(name, EventProperty(value, piiKind, category)); }
@@ -363,14 +378,7 @@ namespace MAT_NS_BEGIN {
 
     const map<string, EventProperty>& EventProperties::GetProperties(DataCategory category) const
     {
-        if (category == DataCategory_PartC)
-        {
-            return m_storage->properties;
-        }
-        else
-        {
-            return m_storage->propertiesPartB;
-        }
+        return m_storage->GetPropertiesView(category);
     }
 
     /// <summary>
@@ -378,10 +386,7 @@ namespace MAT_NS_BEGIN {
     /// </summary>
     size_t EventProperties::erase(const std::string& key, DataCategory category)
     {
-        size_t result = 0;
-        auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->propertiesPartB;
-        result = props.erase(key);
-        return result;
+        return m_storage->eraseProperty(key, category);
     }
 
     /// <summary>
@@ -391,21 +396,19 @@ namespace MAT_NS_BEGIN {
     const map<string, pair<string, PiiKind> > EventProperties::GetPiiProperties(DataCategory category) const
     {
         std::map<string, pair<string, PiiKind> > pIIExtensions;
-        auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->propertiesPartB;
-        for (const auto &kv : props)
+        auto &props = (category == DataCategory_PartC) ? m_storage->properties : m_storage->getPropertiesPartB();
+        for (const auto &property : props)
         {
-            auto k = kv.first;
-            auto v = kv.second;
-            if (v.piiKind != PiiKind_None)
+            if (property.piiKind != PiiKind_None)
             {
-                pIIExtensions[k] = std::pair<string, PiiKind>(v.to_string(), v.piiKind);
+                pIIExtensions[std::string(property.name, property.nameLength)] = std::pair<string, PiiKind>(property.to_string(), property.piiKind);
             }
         }
         return pIIExtensions;
     }
 
 #ifdef MAT_C_API
-    static inline void cppprop_to_cprop(EventProperty &rhs, evt_prop &lhs)
+    static inline void cppprop_to_cprop(FlatEventProperty const& rhs, evt_prop &lhs)
     {
         switch (rhs.type)
         {
@@ -419,7 +422,7 @@ namespace MAT_NS_BEGIN {
             lhs.value.as_double = rhs.as_double;
             break;
         case TYPE_TIME:
-            lhs.value.as_time = rhs.as_time_ticks.ticks;
+            lhs.value.as_time = rhs.as_ticks;
             break;
         case TYPE_BOOLEAN:
             lhs.value.as_bool = rhs.as_bool;
@@ -448,7 +451,7 @@ namespace MAT_NS_BEGIN {
 
     evt_prop* EventProperties::pack()
     {
-        size_t size = m_storage->properties.size() + m_storage->propertiesPartB.size() + 1;
+        size_t size = m_storage->properties.size() + m_storage->getPropertiesPartB().size() + 1;
         evt_prop * result = static_cast<evt_prop *>(calloc(sizeof(evt_prop), size));
         if (result==nullptr)
         {
@@ -456,15 +459,15 @@ namespace MAT_NS_BEGIN {
             return result;
         };
         size_t i = 0;
-        for(auto &props : { m_storage->properties, m_storage->propertiesPartB })
-            for (auto &kv : props)
+        // Names and string values point into the property storage, which outlives the packed array
+        for (FlatEventPropertyMap const* props : std::initializer_list<FlatEventPropertyMap const*> { &m_storage->properties, &m_storage->getPropertiesPartB() })
+            for (auto const& property : *props)
             {
-                auto k = kv.first;
-                auto v = kv.second;
-                result[i].name = (char *)k.c_str();
-                result[i].type = static_cast<evt_prop_t>(v.type);
-                result[i].piiKind = v.piiKind;
-                cppprop_to_cprop(v, result[i]);
+                result[i].name = (char *)property.name;
+                result[i].type = static_cast<evt_prop_t>(property.type);
+                result[i].piiKind = property.piiKind;
+                cppprop_to_cprop(property, result[i]);
+                i++;
             };
         result[size-1].type = TYPE_NULL;
         return result;
@@ -4,10 +4,13 @@
 //
 #pragma once
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "Enums.hpp"
 #include "EventProperty.hpp"
+#include "FlatEventProperties.hpp"
 #include "ctmacros.hpp"
 
 namespace MAT_NS_BEGIN {
@@ -22,51 +25,144 @@ namespace MAT_NS_BEGIN {
        uint64_t         eventPolicyBitflags = {};
        int64_t          timestampInMillis = {};
 
-       std::map<std::string, EventProperty> properties;
-       std::map<std::string, EventProperty> propertiesPartB;
+       FlatEventPropertyMap properties;
+       // Nothing sets Part B properties through this map, it is only allocated once something does
+       std::unique_ptr<FlatEventPropertyMap> propertiesPartB;
 
        EventPropertiesStorage() noexcept {}
 
-       EventPropertiesStorage(const EventPropertiesStorage& other) noexcept
+       // The std::map views of GetProperties() belong to one object, they are never copied or moved
+       EventPropertiesStorage(const EventPropertiesStorage& other) :
+          eventName(other.eventName),
+          eventType(other.eventType),
+          eventLatency(other.eventLatency),
+          eventPersistence(other.eventPersistence),
+          eventPopSample(other.eventPopSample),
+          eventPolicyBitflags(other.eventPolicyBitflags),
+          timestampInMillis(other.timestampInMillis),
+          properties(other.properties),
+          propertiesPartB(other.propertiesPartB ? new FlatEventPropertyMap(*other.propertiesPartB) : nullptr)
        {
-          eventName = other.eventName;
-          eventType = other.eventType;
-          eventLatency = other.eventLatency;
-          eventPersistence = other.eventPersistence;
-          eventPopSample = other.eventPopSample;
-          eventPolicyBitflags = other.eventPolicyBitflags;
-          timestampInMillis = other.timestampInMillis;
-          properties = other.properties;
-          propertiesPartB = other.propertiesPartB;
        }
 
-       EventPropertiesStorage(EventPropertiesStorage&& other) noexcept 
+       EventPropertiesStorage(EventPropertiesStorage&& other) noexcept :
+          eventName(std::move(other.eventName)),
+          eventType(std::move(other.eventType)),
+          eventLatency(other.eventLatency),
+          eventPersistence(other.eventPersistence),
+          eventPopSample(other.eventPopSample),
+          eventPolicyBitflags(other.eventPolicyBitflags),
+          timestampInMillis(other.timestampInMillis),
+          properties(std::move(other.properties)),
+          propertiesPartB(std::move(other.propertiesPartB))
        {
-          eventName = std::move(other.eventName);
-          eventType = std::move(other.eventType);
-          eventLatency = std::move(other.eventLatency);
-          eventPersistence = std::move(other.eventPersistence);
-          eventPopSample = std::move(other.eventPopSample);
-          eventPolicyBitflags = std::move(other.eventPolicyBitflags);
-          timestampInMillis = std::move(other.timestampInMillis);
-          properties = std::move(other.properties);
-          propertiesPartB = std::move(other.propertiesPartB);
+          other.syncViews();
        }
 
-       EventPropertiesStorage& operator=(const EventPropertiesStorage& other) noexcept
+       EventPropertiesStorage& operator=(const EventPropertiesStorage& other)
        {
+          if (this == &other)
+          {
+             return *this;
+          }
           eventName = other.eventName;
           eventType = other.eventType;
           properties = other.properties;
-          propertiesPartB = other.propertiesPartB;
+          propertiesPartB.reset(other.propertiesPartB ? new FlatEventPropertyMap(*other.propertiesPartB) : nullptr);
           eventLatency = other.eventLatency;
           eventPersistence = other.eventPersistence;
           eventPopSample = other.eventPopSample;
           eventPolicyBitflags = other.eventPolicyBitflags;
           timestampInMillis = other.timestampInMillis;
+          syncViews();
 
           return *this;
        }
+
+       /// <summary>
+       /// Returns the Part B properties, an empty map while none have been allocated.
+       /// </summary>
+       const FlatEventPropertyMap& getPropertiesPartB() const
+       {
+          static const FlatEventPropertyMap empty;
+          return propertiesPartB ? *propertiesPartB : empty;
+       }
+
+       /// <summary>
+       /// Returns the std::map of the properties for the public GetProperties API.
+       /// It is built on the first call, then kept up to date by every change made
+       /// through the methods below, so that the reference stays live as it used to be.
+       /// </summary>
+       const std::map<std::string, EventProperty>& GetPropertiesView(DataCategory category) const
+       {
+          std::call_once(viewsOnce, [this]() {
+             std::unique_ptr<PropertiesViews> created(new PropertiesViews());
+             properties.copyTo(created->properties);
+             getPropertiesPartB().copyTo(created->propertiesPartB);
+             views = std::move(created);
+          });
+          return (category == DataCategory_PartC) ? views->properties : views->propertiesPartB;
+       }
+
+       void setProperty(std::string const& name, EventProperty const& value)
+       {
+          properties.set(name, value);
+          if (views)
+          {
+             views->properties[name] = value;
+          }
+       }
+
+       void setProperty(std::string const& name, char const* value, PiiKind piiKind, DataCategory category)
+       {
+          properties.set(name, value, piiKind, category);
+          if (views)
+          {
+             views->properties[name] = properties.find(name)->to_property();
+          }
+       }
+
+       size_t eraseProperty(std::string const& name, DataCategory category)
+       {
+          bool partC = (category == DataCategory_PartC);
+          size_t result = partC ? properties.erase(name) : (propertiesPartB ? propertiesPartB->erase(name) : 0);
+          if (views)
+          {
+             (partC ? views->properties : views->propertiesPartB).erase(name);
+          }
+          return result;
+       }
+
+       void clearProperties()
+       {
+          properties.clear();
+          propertiesPartB.reset();
+          if (views)
+          {
+             views->properties.clear();
+             views->propertiesPartB.clear();
+          }
+       }
+
+    protected:
+       struct PropertiesViews
+       {
+          std::map<std::string, EventProperty> properties;
+          std::map<std::string, EventProperty> propertiesPartB;
+       };
+
+       void syncViews()
+       {
+          if (views)
+          {
+             properties.copyTo(views->properties);
+             getPropertiesPartB().copyTo(views->propertiesPartB);
+          }
+       }
+
+       // Allocated on the first GetProperties() call only
+       mutable std::once_flag                   viewsOnce;
+       mutable std::unique_ptr<PropertiesViews> views;
     };
 
 } MAT_NS_END
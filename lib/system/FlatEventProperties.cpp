@@ -0,0 +1,389 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "FlatEventProperties.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MAT_NS_BEGIN {
+
+    PropertyArena::PropertyArena() noexcept :
+        m_inlineUsed(0),
+        m_blockUsed(0),
+        m_blockSize(0),
+        m_allocated(0)
+    {
+    }
+
+    char* PropertyArena::allocate(size_t size)
+    {
+        m_allocated += size;
+        if (m_inlineUsed + size <= InlineSize)
+        {
+            char* result = m_inline + m_inlineUsed;
+            m_inlineUsed += size;
+            return result;
+        }
+
+        if (m_blocks.empty() || m_blockUsed + size > m_blockSize)
+        {
+            // Each block is twice the previous one, so a large event needs only a few of them
+            size_t blockSize = (std::max)(static_cast<size_t>(MinBlockSize), (std::max)(m_blockSize * 2, size));
+            m_blocks.emplace_back(new char[blockSize]);
+            m_blockSize = blockSize;
+            m_blockUsed = 0;
+        }
+        char* result = m_blocks.back().get() + m_blockUsed;
+        m_blockUsed += size;
+        return result;
+    }
+
+    void PropertyArena::clear() noexcept
+    {
+        m_blocks.clear();
+        m_inlineUsed = 0;
+        m_blockUsed = 0;
+        m_blockSize = 0;
+        m_allocated = 0;
+    }
+
+    void PropertyArena::takeFrom(PropertyArena& other) noexcept
+    {
+        memcpy(m_inline, other.m_inline, other.m_inlineUsed);
+        m_inlineUsed = other.m_inlineUsed;
+        m_blocks = std::move(other.m_blocks);
+        m_blockUsed = other.m_blockUsed;
+        m_blockSize = other.m_blockSize;
+        m_allocated = other.m_allocated;
+        other.clear();
+    }
+
+    char* PropertyArena::relocate(char const* pointer, PropertyArena const& other) noexcept
+    {
+        if (pointer >= other.m_inline && pointer < other.m_inline + InlineSize)
+        {
+            return m_inline + (pointer - other.m_inline);
+        }
+        return const_cast<char*>(pointer);
+    }
+
+    std::string FlatEventProperty::to_string() const
+    {
+        switch (type)
+        {
+        case EventProperty::TYPE_STRING:
+            return std::string(as_string, stringLength);
+        case EventProperty::TYPE_INT64:
+            return std::to_string(as_int64);
+        case EventProperty::TYPE_DOUBLE:
+            return std::to_string(as_double);
+        case EventProperty::TYPE_TIME:
+            // Note that we do not format time as time, we return it as raw number of .NET ticks
+            return std::to_string(as_ticks);
+        case EventProperty::TYPE_BOOLEAN:
+            return (as_bool) ? "true" : "false";
+        default:
+            return (boxed != nullptr) ? boxed->to_string() : std::string();
+        }
+    }
+
+    EventProperty FlatEventProperty::to_property() const
+    {
+        switch (type)
+        {
+        case EventProperty::TYPE_STRING:
+            return EventProperty(as_string, piiKind, dataCategory);
+        case EventProperty::TYPE_INT64:
+            return EventProperty(as_int64, piiKind, dataCategory);
+        case EventProperty::TYPE_DOUBLE:
+            return EventProperty(as_double, piiKind, dataCategory);
+        case EventProperty::TYPE_TIME:
+            return EventProperty(time_ticks_t(as_ticks), piiKind, dataCategory);
+        case EventProperty::TYPE_BOOLEAN:
+            return EventProperty(as_bool, piiKind, dataCategory);
+        default:
+            return (boxed != nullptr) ? EventProperty(*boxed) : EventProperty();
+        }
+    }
+
+    namespace {
+
+        // Same ordering as std::string::compare, so that views built from the map are in the same order
+        bool nameLess(FlatEventProperty const& property, std::string const& name)
+        {
+            int result = memcmp(property.name, name.data(), (std::min)(property.nameLength, name.size()));
+            return (result < 0) || (result == 0 && property.nameLength < name.size());
+        }
+
+        bool nameEquals(FlatEventProperty const& property, std::string const& name)
+        {
+            return property.nameLength == name.size() && memcmp(property.name, name.data(), name.size()) == 0;
+        }
+
+        // Compact the arena once the bytes orphaned by overwritten and erased properties dominate it
+        const size_t MaxWastedBytes = 4096;
+
+        // Room for a typical event before the vector has to grow
+        const size_t InitialCapacity = 16;
+
+    }
+
+    FlatEventPropertyMap::FlatEventPropertyMap() noexcept :
+        m_wasted(0),
+        m_version(0)
+    {
+    }
+
+    FlatEventPropertyMap::FlatEventPropertyMap(FlatEventPropertyMap const& other) :
+        FlatEventPropertyMap()
+    {
+        *this = other;
+    }
+
+    FlatEventPropertyMap& FlatEventPropertyMap::operator=(FlatEventPropertyMap const& other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        clear();
+        m_properties.reserve(other.m_properties.size());
+        for (FlatEventProperty const& source : other.m_properties)
+        {
+            FlatEventProperty property = source;
+            char* name = m_arena.allocate(source.nameLength + 1);
+            memcpy(name, source.name, source.nameLength + 1);
+            property.name = name;
+            property.as_string = nullptr;
+            property.stringCapacity = 0;
+            if (source.type == EventProperty::TYPE_STRING)
+            {
+                assignString(property, source.as_string, source.stringLength);
+            }
+            if (source.boxed != nullptr)
+            {
+                property.boxed = new EventProperty(*source.boxed);
+            }
+            m_properties.push_back(property);
+        }
+        return *this;
+    }
+
+    FlatEventPropertyMap::FlatEventPropertyMap(FlatEventPropertyMap&& other) noexcept :
+        FlatEventPropertyMap()
+    {
+        *this = std::move(other);
+    }
+
+    FlatEventPropertyMap& FlatEventPropertyMap::operator=(FlatEventPropertyMap&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        // Heap blocks and boxed values change owner, only names and values
+        // in the embedded arena block of the source are copied
+        clear();
+        m_arena.takeFrom(other.m_arena);
+        m_properties = std::move(other.m_properties);
+        other.m_properties.clear();
+        for (FlatEventProperty& property : m_properties)
+        {
+            property.name = m_arena.relocate(property.name, other.m_arena);
+            if (property.as_string != nullptr)
+            {
+                property.as_string = m_arena.relocate(property.as_string, other.m_arena);
+            }
+        }
+        m_wasted = other.m_wasted;
+        other.m_wasted = 0;
+        other.m_version++;
+        return *this;
+    }
+
+    FlatEventPropertyMap::~FlatEventPropertyMap()
+    {
+        for (FlatEventProperty& property : m_properties)
+        {
+            release(property);
+        }
+    }
+
+    void FlatEventPropertyMap::release(FlatEventProperty& property)
+    {
+        delete property.boxed;
+        property.boxed = nullptr;
+    }
+
+    FlatEventProperty& FlatEventPropertyMap::slot(std::string const& name)
+    {
+        if (m_properties.empty())
+        {
+            m_properties.reserve(InitialCapacity);
+        }
+
+        auto it = std::lower_bound(m_properties.begin(), m_properties.end(), name, nameLess);
+        if (it != m_properties.end() && nameEquals(*it, name))
+        {
+            release(*it);
+            return *it;
+        }
+
+        FlatEventProperty property {};
+        char* copy = m_arena.allocate(name.size() + 1);
+        memcpy(copy, name.c_str(), name.size() + 1);
+        property.name = copy;
+        property.nameLength = name.size();
+        return *m_properties.insert(it, property);
+    }
+
+    void FlatEventPropertyMap::assignString(FlatEventProperty& property, char const* value, size_t length)
+    {
+        // Reuse the previous buffer of the property when the new value fits
+        if (property.as_string == nullptr || property.stringCapacity < length + 1)
+        {
+            m_wasted += property.stringCapacity;
+            property.as_string = m_arena.allocate(length + 1);
+            property.stringCapacity = length + 1;
+        }
+        memcpy(property.as_string, value, length);
+        property.as_string[length] = 0;
+        property.stringLength = length;
+    }
+
+    void FlatEventPropertyMap::set(std::string const& name, EventProperty const& value)
+    {
+        if (value.type == EventProperty::TYPE_STRING)
+        {
+            set(name, value.as_string, value.piiKind, value.dataCategory);
+            return;
+        }
+
+        FlatEventProperty& property = slot(name);
+        property.type = value.type;
+        property.piiKind = value.piiKind;
+        property.dataCategory = value.dataCategory;
+        switch (value.type)
+        {
+        case EventProperty::TYPE_INT64:
+            property.as_int64 = value.as_int64;
+            break;
+        case EventProperty::TYPE_DOUBLE:
+            property.as_double = value.as_double;
+            break;
+        case EventProperty::TYPE_TIME:
+            property.as_ticks = value.as_time_ticks.ticks;
+            break;
+        case EventProperty::TYPE_BOOLEAN:
+            property.as_bool = value.as_bool;
+            break;
+        default:
+            property.boxed = new EventProperty(value);
+            break;
+        }
+        m_version++;
+    }
+
+    void FlatEventPropertyMap::set(std::string const& name, char const* value, PiiKind piiKind, DataCategory category)
+    {
+        FlatEventProperty& property = slot(name);
+        property.type = EventProperty::TYPE_STRING;
+        property.piiKind = piiKind;
+        property.dataCategory = category;
+        assignString(property, (value != nullptr) ? value : "", (value != nullptr) ? strlen(value) : 0);
+        m_version++;
+        if (m_wasted > MaxWastedBytes && m_wasted > m_arena.size() / 2)
+        {
+            compact();
+        }
+    }
+
+    size_t FlatEventPropertyMap::erase(std::string const& name)
+    {
+        auto it = std::lower_bound(m_properties.begin(), m_properties.end(), name, nameLess);
+        if (it == m_properties.end() || !nameEquals(*it, name))
+        {
+            return 0;
+        }
+
+        m_wasted += it->nameLength + 1 + it->stringCapacity;
+        release(*it);
+        m_properties.erase(it);
+        m_version++;
+        if (m_properties.empty())
+        {
+            m_arena.clear();
+            m_wasted = 0;
+        }
+        else if (m_wasted > MaxWastedBytes && m_wasted > m_arena.size() / 2)
+        {
+            compact();
+        }
+        return 1;
+    }
+
+    void FlatEventPropertyMap::clear()
+    {
+        for (FlatEventProperty& property : m_properties)
+        {
+            release(property);
+        }
+        m_properties.clear();
+        m_arena.clear();
+        m_wasted = 0;
+        m_version++;
+    }
+
+    FlatEventProperty const* FlatEventPropertyMap::find(std::string const& name) const
+    {
+        auto it = std::lower_bound(m_properties.begin(), m_properties.end(), name, nameLess);
+        if (it == m_properties.end() || !nameEquals(*it, name))
+        {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    void FlatEventPropertyMap::copyTo(std::map<std::string, EventProperty>& properties) const
+    {
+        properties.clear();
+        for (FlatEventProperty const& property : m_properties)
+        {
+            properties.emplace_hint(properties.end(), std::string(property.name, property.nameLength), property.to_property());
+        }
+    }
+
+    void FlatEventPropertyMap::compact()
+    {
+        std::vector<std::string> names;
+        std::vector<std::string> values;
+        names.reserve(m_properties.size());
+        values.reserve(m_properties.size());
+        for (FlatEventProperty const& property : m_properties)
+        {
+            names.emplace_back(property.name, property.nameLength);
+            values.emplace_back((property.type == EventProperty::TYPE_STRING) ? std::string(property.as_string, property.stringLength) : std::string());
+        }
+
+        m_arena.clear();
+        m_wasted = 0;
+        for (size_t i = 0; i < m_properties.size(); i++)
+        {
+            FlatEventProperty& property = m_properties[i];
+            char* name = m_arena.allocate(names[i].size() + 1);
+            memcpy(name, names[i].c_str(), names[i].size() + 1);
+            property.name = name;
+            property.as_string = nullptr;
+            property.stringCapacity = 0;
+            if (property.type == EventProperty::TYPE_STRING)
+            {
+                assignString(property, values[i].data(), values[i].size());
+            }
+        }
+    }
+
+} MAT_NS_END
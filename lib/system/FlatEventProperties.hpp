@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef FLATEVENTPROPERTIES_HPP
+#define FLATEVENTPROPERTIES_HPP
+
+#include "ctmacros.hpp"
+#include "EventProperty.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Bump allocator for the names and string values of one event.
+    /// The first block is embedded in the owner, further blocks are allocated
+    /// on demand and all memory is released at once by clear().
+    /// </summary>
+    class PropertyArena
+    {
+    public:
+        PropertyArena() noexcept;
+        PropertyArena(PropertyArena const&) = delete;
+        PropertyArena& operator=(PropertyArena const&) = delete;
+
+        /// <summary>
+        /// Allocate size bytes with no particular alignment.
+        /// </summary>
+        char* allocate(size_t size);
+
+        /// <summary>
+        /// Release everything allocated from the arena.
+        /// </summary>
+        void clear() noexcept;
+
+        /// <summary>
+        /// Take over the memory of another arena, leaving it empty. Heap blocks change
+        /// owner as they are, the used part of the embedded block is copied.
+        /// </summary>
+        void takeFrom(PropertyArena& other) noexcept;
+
+        /// <summary>
+        /// Returns where memory of the other arena lives after takeFrom(other).
+        /// </summary>
+        char* relocate(char const* pointer, PropertyArena const& other) noexcept;
+
+        /// <summary>
+        /// Number of bytes handed out since the last clear().
+        /// </summary>
+        size_t size() const noexcept
+        {
+            return m_allocated;
+        }
+
+    protected:
+        enum { InlineSize = 256, MinBlockSize = 2048 };
+
+        char                                 m_inline[InlineSize];
+        size_t                               m_inlineUsed;
+        std::vector<std::unique_ptr<char[]>> m_blocks;
+        size_t                               m_blockUsed;
+        size_t                               m_blockSize;
+        size_t                               m_allocated;
+    };
+
+    /// <summary>
+    /// One property of a FlatEventPropertyMap. Names and string values live in the
+    /// arena of the map, GUID and array values are kept in a heap EventProperty.
+    /// </summary>
+    struct FlatEventProperty
+    {
+        char const*   name;
+        size_t        nameLength;
+        decltype(EventProperty::type) type;
+        PiiKind       piiKind;
+        DataCategory  dataCategory;
+
+        char*         as_string;
+        size_t        stringLength;
+        size_t        stringCapacity;
+        union
+        {
+            int64_t   as_int64;
+            double    as_double;
+            bool      as_bool;
+            uint64_t  as_ticks;
+        };
+        EventProperty* boxed;
+
+        /// <summary>Returns the value formatted the same way as EventProperty::to_string</summary>
+        std::string to_string() const;
+
+        /// <summary>Returns the value as a standalone EventProperty</summary>
+        EventProperty to_property() const;
+    };
+
+    /// <summary>
+    /// Event property bag kept as a vector sorted by name, with names and string values
+    /// stored in a per-event arena. Setting a string property costs no heap allocation
+    /// until the arena outgrows its embedded block.
+    /// </summary>
+    class FlatEventPropertyMap
+    {
+    public:
+        typedef std::vector<FlatEventProperty>::const_iterator const_iterator;
+
+        FlatEventPropertyMap() noexcept;
+        FlatEventPropertyMap(FlatEventPropertyMap const& other);
+        FlatEventPropertyMap(FlatEventPropertyMap&& other) noexcept;
+        FlatEventPropertyMap& operator=(FlatEventPropertyMap const& other);
+        FlatEventPropertyMap& operator=(FlatEventPropertyMap&& other) noexcept;
+        ~FlatEventPropertyMap();
+
+        /// <summary>
+        /// Create or overwrite a property with a copy of the value.
+        /// </summary>
+        void set(std::string const& name, EventProperty const& value);
+
+        /// <summary>
+        /// Create or overwrite a string property without building an EventProperty first.
+        /// A null value is stored as an empty string.
+        /// </summary>
+        void set(std::string const& name, char const* value, PiiKind piiKind, DataCategory category);
+
+        size_t erase(std::string const& name);
+        void clear();
+
+        FlatEventProperty const* find(std::string const& name) const;
+
+        const_iterator begin() const { return m_properties.begin(); }
+        const_iterator end() const { return m_properties.end(); }
+        size_t size() const { return m_properties.size(); }
+        bool empty() const { return m_properties.empty(); }
+
+        /// <summary>
+        /// Incremented on every modification, lets callers cache views of the map.
+        /// </summary>
+        uint64_t version() const { return m_version; }
+
+        /// <summary>
+        /// Replace the contents of a std::map with the properties.
+        /// </summary>
+        void copyTo(std::map<std::string, EventProperty>& properties) const;
+
+    protected:
+        FlatEventProperty& slot(std::string const& name);
+        void assignString(FlatEventProperty& property, char const* value, size_t length);
+        static void release(FlatEventProperty& property);
+        void compact();
+
+        std::vector<FlatEventProperty> m_properties;
+        PropertyArena                  m_arena;
+        size_t                         m_wasted;
+        uint64_t                       m_version;
+    };
+
+} MAT_NS_END
+
+#endif
@@ -13,6 +13,9 @@
 
 #include "api/IRuntimeConfig.hpp"
 
+#include <map>
+#include <string>
+
 namespace MAT_NS_BEGIN {
 
     class DebugEventDispatcher;
@@ -47,6 +50,9 @@ namespace MAT_NS_BEGIN {
         // Core sendEvent
         virtual void sendEvent(IncomingEventContextPtr const& event) = 0;
 
+        // Events dropped before sendEvent, counted by tenant token
+        virtual void eventsDropped(std::map<std::string, size_t> const& countOnTenant) = 0;
+
     protected:
         virtual void handleFlushTaskDispatcher() = 0;
         virtual void signalDone() = 0;
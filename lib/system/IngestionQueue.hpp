@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef INGESTIONQUEUE_HPP
+#define INGESTIONQUEUE_HPP
+
+#include "system/Contexts.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Bounded lock-free queue with one sequence number per slot (D. Vyukov's design).
+    /// Any number of producers may push. The drain side is owned by a single consumer
+    /// thread, but TryPop is also safe from producers, which is used to evict the
+    /// oldest element when the queue is full.
+    /// </summary>
+    template <typename T>
+    class IngestionQueue
+    {
+    public:
+
+        /// <summary>
+        /// Create queue with capacity rounded up to the next power of two (minimum 2).
+        /// </summary>
+        explicit IngestionQueue(size_t capacity) :
+            m_mask(roundUpToPowerOfTwo(capacity) - 1),
+            m_slots(m_mask + 1),
+            m_enqueuePos(0),
+            m_dequeuePos(0)
+        {
+            for (size_t i = 0; i < m_slots.size(); i++)
+            {
+                m_slots[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        IngestionQueue(IngestionQueue const&) = delete;
+        IngestionQueue& operator=(IngestionQueue const&) = delete;
+
+        size_t Capacity() const
+        {
+            return m_mask + 1;
+        }
+
+        /// <summary>
+        /// Approximate number of queued elements.
+        /// </summary>
+        size_t Size() const
+        {
+            size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+            size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+            return (enqueuePos > dequeuePos) ? (enqueuePos - dequeuePos) : 0;
+        }
+
+        /// <summary>
+        /// Push an element. Returns false (and leaves value untouched) if the queue is full.
+        /// </summary>
+        bool TryPush(T& value)
+        {
+            Slot* slot;
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                slot = &m_slots[pos & m_mask];
+                size_t seq = slot->seq.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = std::move(value);
+            slot->seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// Pop the oldest element. Returns false if the queue is empty.
+        /// </summary>
+        bool TryPop(T& value)
+        {
+            Slot* slot;
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                slot = &m_slots[pos & m_mask];
+                size_t seq = slot->seq.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(slot->value);
+            slot->seq.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+    protected:
+
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 2;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        struct Slot
+        {
+            std::atomic<size_t> seq;
+            T                   value;
+        };
+
+        const size_t             m_mask;
+        std::vector<Slot>        m_slots;
+        // Keep producer and consumer cursors on separate cache lines
+        char                     m_pad0[64];
+        std::atomic<size_t>      m_enqueuePos;
+        char                     m_pad1[64];
+        std::atomic<size_t>      m_dequeuePos;
+    };
+
+    /// <summary>
+    /// Incoming event that owns its source record, so that it can outlive the
+    /// Logger call that produced it while waiting in the ingestion queue.
+    /// </summary>
+    class QueuedEventContext : public IncomingEventContext
+    {
+    public:
+        ::CsProtocol::Record sourceRecord;
+
+        QueuedEventContext(IncomingEventContext const& event) :
+            IncomingEventContext(event.record.id, event.record.tenantToken, event.tenantId, event.record.latency, event.record.persistence, nullptr),
+            sourceRecord(*event.source)
+        {
+            policyBitFlags = event.policyBitFlags;
+            source = &sourceRecord;
+        }
+    };
+
+    using QueuedEventContextPtr = std::unique_ptr<QueuedEventContext>;
+
+} MAT_NS_END
+
+#endif
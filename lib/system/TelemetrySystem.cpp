@@ -118,6 +118,14 @@ namespace MAT_NS_BEGIN {
             LOG_WARN("stop    = %lld ms", stopTimes[2]);
             LOG_WARN("worker  = %lld ms", stopTimes[3]);
             LOG_WARN("storage = %lld ms", stopTimes[4]);
+            HttpClientManager::Metrics httpMetrics = hcm.getMetrics();
+            LOG_WARN("http    = %llu requests, latency %llu ms avg %llu ms max, queued %llu ms avg %llu ms max",
+                static_cast<unsigned long long>(httpMetrics.completed),
+                static_cast<unsigned long long>(httpMetrics.completed ? httpMetrics.totalLatencyMs / httpMetrics.completed : 0),
+                static_cast<unsigned long long>(httpMetrics.maxLatencyMs),
+                static_cast<unsigned long long>(httpMetrics.completed ? httpMetrics.totalQueueTimeMs / httpMetrics.completed : 0),
+                static_cast<unsigned long long>(httpMetrics.maxQueueTimeMs));
+            UNREFERENCED_PARAMETER(httpMetrics);
 #endif
 
             return result;
@@ -41,6 +41,8 @@ namespace MAT_NS_BEGIN {
             onPause  = []() { return true; };
             onResume = []() { return true; };
             onCleanup  = []() { return true; };
+
+            droppedEvents >> stats.onIncomingEventsDropped;
         };
         
         /// <summary>
@@ -139,6 +141,13 @@ namespace MAT_NS_BEGIN {
             sending(event);
         }
 
+        void eventsDropped(std::map<std::string, size_t> const& countOnTenant) override
+        {
+            StorageNotificationContext ctx;
+            ctx.countonTenant = countOnTenant;
+            droppedEvents(&ctx);
+        }
+
         /// <summary>
         /// Gets the log manager.
         /// </summary>
@@ -192,6 +201,7 @@ namespace MAT_NS_BEGIN {
     public:
         RouteSource<IncomingEventContextPtr const&>                sending;
         RouteSource<IncomingEventContextPtr const&>                preparedIncomingEvent;
+        RouteSource<StorageNotificationContext const*>             droppedEvents;
 
     };
 
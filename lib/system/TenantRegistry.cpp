@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "TenantRegistry.hpp"
+#include "utils/PublishedSnapshot.hpp"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    namespace {
+
+        /// <summary>
+        /// Tokens are looked up for every event, registered only a handful of times.
+        /// Lookups read an immutable snapshot without taking a lock, registering a token
+        /// copies the snapshot under m_lock and publishes the copy.
+        /// </summary>
+        class TenantRegistryImpl
+        {
+        public:
+            TenantRegistryImpl() :
+                m_snapshot(createFirst(m_tokens))
+            {
+            }
+
+            TenantId intern(std::string const& tenantToken)
+            {
+                TenantId tenantId;
+                if (find(tenantToken, tenantId))
+                {
+                    return tenantId;
+                }
+
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    Snapshot const* current = m_snapshot.get();
+                    auto it = current->ids.find(tenantToken);
+                    if (it != current->ids.end())
+                    {
+                        return it->second;
+                    }
+                    tenantId = static_cast<TenantId>(m_tokens.size());
+                    // A deque never moves its elements when growing at the end
+                    m_tokens.push_back(tenantToken);
+                    std::unique_ptr<Snapshot> next(new Snapshot(*current));
+                    next->ids[tenantToken] = tenantId;
+                    next->tokens.push_back(&m_tokens.back());
+                    m_snapshot.publish(next.release());
+                }
+                // Frees the replaced snapshot once lookups that started before are done
+                m_snapshot.synchronize();
+                return tenantId;
+            }
+
+            bool find(std::string const& tenantToken, TenantId& tenantId)
+            {
+                SnapshotReader snapshot(m_snapshot);
+                auto it = snapshot->ids.find(tenantToken);
+                if (it == snapshot->ids.end())
+                {
+                    return false;
+                }
+                tenantId = it->second;
+                return true;
+            }
+
+            std::string const& getToken(TenantId tenantId)
+            {
+                // Tokens live in m_tokens, the reference outlives the snapshot
+                SnapshotReader snapshot(m_snapshot);
+                return *snapshot->tokens[(tenantId < snapshot->tokens.size()) ? tenantId : NoTenant];
+            }
+
+            size_t count()
+            {
+                SnapshotReader snapshot(m_snapshot);
+                return snapshot->tokens.size() - 1;
+            }
+
+        private:
+            struct Snapshot
+            {
+                std::unordered_map<std::string, TenantId> ids;
+                // Point into m_tokens, which is only ever appended to
+                std::vector<std::string const*>           tokens;
+            };
+
+            typedef PublishedSnapshot<Snapshot>::Reader SnapshotReader;
+
+            static Snapshot const* createFirst(std::deque<std::string>& tokens)
+            {
+                // Id 0 is the empty token
+                tokens.emplace_back();
+                Snapshot* first = new Snapshot();
+                first->ids[tokens.back()] = NoTenant;
+                first->tokens.push_back(&tokens.back());
+                return first;
+            }
+
+            std::mutex                                m_lock;
+            std::deque<std::string>                   m_tokens;
+            PublishedSnapshot<Snapshot>               m_snapshot;
+        };
+
+        TenantRegistryImpl& registry()
+        {
+            // Leaked on purpose: ids and token references are used until the very end of the process
+            static TenantRegistryImpl* instance = new TenantRegistryImpl();
+            return *instance;
+        }
+
+    }
+
+    TenantId TenantRegistry::Intern(std::string const& tenantToken)
+    {
+        return registry().intern(tenantToken);
+    }
+
+    bool TenantRegistry::Find(std::string const& tenantToken, TenantId& tenantId)
+    {
+        return registry().find(tenantToken, tenantId);
+    }
+
+    std::string const& TenantRegistry::GetToken(TenantId tenantId)
+    {
+        return registry().getToken(tenantId);
+    }
+
+    size_t TenantRegistry::GetCount()
+    {
+        return registry().count();
+    }
+
+} MAT_NS_END
@@ -0,0 +1,49 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef TENANTREGISTRY_HPP
+#define TENANTREGISTRY_HPP
+
+#include "pal/PAL.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Small integer standing for a tenant token within this process.
+    /// Not to be confused with the tenant ID string, the prefix of the token returned by tenantTokenToId().
+    /// </summary>
+    typedef uint32_t TenantId;
+
+    /// <summary>Id of the empty tenant token.</summary>
+    static constexpr TenantId NoTenant = 0;
+
+    /// <summary>
+    /// Process-wide interning of tenant tokens, so that the upload pipeline, the stats and
+    /// the kill switch keep and compare small ids instead of copies of ~74 character tokens.
+    /// Tokens are never removed: an application only ever uses a handful of tenants.
+    /// Looking up a registered token does not take a lock, only registering a new one does.
+    /// </summary>
+    class TenantRegistry
+    {
+    public:
+        /// <summary>Gets the id of a tenant token, registering it on first use.</summary>
+        static TenantId Intern(std::string const& tenantToken);
+
+        /// <summary>Gets the id of a tenant token already registered, without registering it.</summary>
+        /// <returns>false if the token has never been interned.</returns>
+        static bool Find(std::string const& tenantToken, TenantId& tenantId);
+
+        /// <summary>Gets the token of an id returned by Intern(), or an empty string for an unknown id.</summary>
+        /// <remarks>The reference stays valid until the process exits.</remarks>
+        static std::string const& GetToken(TenantId tenantId);
+
+        /// <summary>Number of tenant tokens interned so far.</summary>
+        static size_t GetCount();
+    };
+
+} MAT_NS_END
+#endif
@@ -363,16 +363,20 @@ namespace MAT_NS_BEGIN {
     void TransmissionPolicyManager::handleEventsUploadSuccessful(EventsUploadContextPtr const& ctx)
     {
         resetBackoff();
+        updateUploadWindow(ctx, true);
         finishUpload(ctx, std::chrono::milliseconds{});
+        fillUploadWindow(ctx->requestedMinLatency);
     }
 
     void TransmissionPolicyManager::handleEventsUploadRejected(EventsUploadContextPtr const& ctx)
     {
+        updateUploadWindow(ctx, false);
         finishUpload(ctx, increaseBackoff());
     }
 
     void TransmissionPolicyManager::handleEventsUploadFailed(EventsUploadContextPtr const& ctx)
     {
+        updateUploadWindow(ctx, false);
         finishUpload(ctx, increaseBackoff());
     }
 
@@ -381,10 +385,106 @@ namespace MAT_NS_BEGIN {
         finishUpload(ctx, std::chrono::milliseconds{ -1 });
     }
 
+    void TransmissionPolicyManager::updateUploadWindow(EventsUploadContextPtr const& ctx, bool succeeded)
+    {
+        if (!static_cast<bool>(m_config[CFG_BOOL_TPM_ADAPTIVE_UPLOADS]))
+        {
+            return;
+        }
+
+        size_t maxWindow = std::max<size_t>(1, static_cast<uint32_t>(m_config[CFG_INT_MAX_PENDING_REQ]));
+        LOCKGUARD(m_activeUploads_lock);
+        if (!succeeded)
+        {
+            // Multiplicative decrease, the backoff delays the next upload
+            m_uploadWindow = std::max<size_t>(1, m_uploadWindow / 2);
+            m_uploadWindowSuccesses = 0;
+        }
+        else if (ctx->durationMs >= 0)
+        {
+            if (m_fastestUploadMs < 0 || ctx->durationMs < m_fastestUploadMs)
+            {
+                m_fastestUploadMs = ctx->durationMs;
+            }
+
+            if (ctx->durationMs > 2 * m_fastestUploadMs + UploadWindowSlowMarginMs)
+            {
+                // Collector or link slows down: hold the window
+                m_uploadWindowSuccesses = 0;
+            }
+            else if (++m_uploadWindowSuccesses >= m_uploadWindow)
+            {
+                // Additive increase, by one batch per window of successful uploads
+                m_uploadWindow++;
+                m_uploadWindowSuccesses = 0;
+            }
+        }
+        m_uploadWindow = std::min(m_uploadWindow, maxWindow);
+        LOG_TRACE("Upload window %u after %s upload of %d ms", static_cast<unsigned>(m_uploadWindow), succeeded ? "successful" : "failed", ctx->durationMs);
+    }
+
+    void TransmissionPolicyManager::fillUploadWindow(EventLatency latency)
+    {
+        if (!static_cast<bool>(m_config[CFG_BOOL_TPM_ADAPTIVE_UPLOADS]))
+        {
+            return;
+        }
+
+        // Each upload reserves its own records, so concurrent batches never overlap.
+        // An upload that finds nothing to send finishes right away without adding to the count.
+        size_t window = uploadWindow();
+        for (size_t started = 0; started < window; started++)
+        {
+            {
+                // Same checks as scheduleUpload and uploadAsync: the profile or a pause may change between batches
+                LOCKGUARD(m_scheduledUploadMutex);
+                if ((m_isPaused) || (m_scheduledUploadAborted))
+                {
+                    LOG_TRACE("Paused or upload aborted, no more batches.");
+                    return;
+                }
+                updateTimersIfNecessary();
+                // m_timerdelay follows a profile change only when the next event arrives
+                if (m_timerdelay.count() < 0 || m_timers[1] < 0)
+                {
+                    LOG_TRACE("Negative m_timerdelay(%d) or timer(%d), no more batches", m_timerdelay.count(), m_timers[1]);
+                    return;
+                }
+                if (m_timers[0] < 0)
+                {
+                    latency = std::max(latency, EventLatency_RealTime); // low priority disabled by profile
+                }
+            }
+
+            size_t pending = uploadCount() + (m_isUploadScheduled ? 1 : 0);
+            if (pending >= window)
+            {
+                return;
+            }
+
+            auto ctx = m_system.createEventsUploadContext();
+            ctx->requestedMinLatency = latency;
+            addUpload(ctx);
+            initiateUpload(ctx);
+            if (uploadCount() + (m_isUploadScheduled ? 1 : 0) <= pending)
+            {
+                // Nothing left to upload
+                return;
+            }
+        }
+    }
+
+    size_t TransmissionPolicyManager::uploadWindow() const noexcept
+    {
+        LOCKGUARD(m_activeUploads_lock);
+        return m_uploadWindow;
+    }
+
     void TransmissionPolicyManager::addUpload(EventsUploadContextPtr const& ctx)
     {
         LOCKGUARD(m_activeUploads_lock);
         m_activeUploads.insert(ctx);
+        ctx->uploadsInFlight = static_cast<unsigned>(m_activeUploads.size());
     }
 
     bool TransmissionPolicyManager::removeUpload(EventsUploadContextPtr const& ctx)
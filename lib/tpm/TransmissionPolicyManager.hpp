@@ -42,6 +42,10 @@ constexpr std::chrono::milliseconds DefaultTaskCancelTime { 500 };
 
 constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
 
+// Adaptive uploads: a successful upload slower than twice the fastest one seen,
+// plus this margin, is taken as a sign of congestion and does not grow the window.
+constexpr int UploadWindowSlowMarginMs = 200;
+
     class TransmissionPolicyManager
     {
 
@@ -77,6 +81,19 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
 
         EventLatency calculateNewPriority();
 
+        /// <summary>
+        /// Adaptive uploads: grows the window by one batch after a full window of fast
+        /// successful uploads, halves it on a failed or rejected upload.
+        /// </summary>
+        void updateUploadWindow(EventsUploadContextPtr const& ctx, bool succeeded);
+
+        /// <summary>
+        /// Adaptive uploads: starts batches until the window is full or nothing is left to upload.
+        /// </summary>
+        void fillUploadWindow(EventLatency latency);
+
+        size_t uploadWindow() const noexcept;
+
         std::mutex                       m_lock;
 
         ITelemetrySystem&                m_system;
@@ -98,6 +115,11 @@ constexpr const char* const DefaultBackoffConfig = "E,3000,300000,2,1";
 
         mutable std::mutex               m_activeUploads_lock;
         std::set<EventsUploadContextPtr> m_activeUploads;
+
+        // Adaptive uploads window, guarded by m_activeUploads_lock
+        size_t                           m_uploadWindow { 1 };
+        size_t                           m_uploadWindowSuccesses { 0 };
+        int                              m_fastestUploadMs { -1 };
         
         /// <summary>
         /// Thread-safe method to add the upload to active uploads.
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef PUBLISHEDSNAPSHOT_HPP
+#define PUBLISHEDSNAPSHOT_HPP
+
+#include "ctmacros.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace MAT_NS_BEGIN {
+
+    /// <summary>
+    /// Immutable value read on hot paths and replaced rarely. Readers take no lock: they
+    /// announce themselves in one of two counters picked by the current epoch, then load
+    /// the pointer. A replaced value is only freed by synchronize(), which moves the epoch
+    /// on and waits until the counter of the previous epoch drains.
+    /// Unlike std::atomic_load on a std::shared_ptr, which goes through the global mutex
+    /// pool of the standard library, readers only touch atomics of this object.
+    /// </summary>
+    template<typename T>
+    class PublishedSnapshot
+    {
+    public:
+        explicit PublishedSnapshot(T const* initial) :
+            m_current(initial),
+            m_epoch(0),
+            m_waiters(0)
+        {
+            m_readers[0] = 0;
+            m_readers[1] = 0;
+        }
+
+        PublishedSnapshot(PublishedSnapshot const&) = delete;
+        PublishedSnapshot& operator=(PublishedSnapshot const&) = delete;
+
+        /// <summary>No reader may be left when the snapshot goes away.</summary>
+        ~PublishedSnapshot()
+        {
+            for (T const* value : m_retired)
+            {
+                delete value;
+            }
+            delete m_current.load();
+        }
+
+        /// <summary>
+        /// Access to the published value for as long as the reader lives. While a thread
+        /// holds a reader, it must not call synchronize() on the same snapshot.
+        /// </summary>
+        class Reader
+        {
+        public:
+            explicit Reader(PublishedSnapshot const& owner) :
+                m_owner(&owner)
+            {
+                for (;;)
+                {
+                    unsigned epoch = owner.m_epoch.load();
+                    m_slot = epoch & 1;
+                    owner.m_readers[m_slot].fetch_add(1);
+                    // Seeing the same epoch after announcing means synchronize() waits for this reader
+                    if (owner.m_epoch.load() == epoch)
+                    {
+                        break;
+                    }
+                    owner.leave(m_slot);
+                }
+                m_value = owner.m_current.load();
+            }
+
+            Reader(Reader&& other) noexcept :
+                m_owner(other.m_owner),
+                m_slot(other.m_slot),
+                m_value(other.m_value)
+            {
+                other.m_owner = nullptr;
+            }
+
+            ~Reader()
+            {
+                if (m_owner != nullptr)
+                {
+                    m_owner->leave(m_slot);
+                }
+            }
+
+            Reader(Reader const&) = delete;
+            Reader& operator=(Reader const&) = delete;
+            Reader& operator=(Reader&&) = delete;
+
+            T const& operator*() const { return *m_value; }
+            T const* operator->() const { return m_value; }
+
+        private:
+            PublishedSnapshot const* m_owner;
+            unsigned                 m_slot;
+            T const*                 m_value;
+        };
+
+        /// <summary>
+        /// Latest published value, for writers that serialize their publish() calls.
+        /// </summary>
+        T const* get() const
+        {
+            return m_current.load();
+        }
+
+        /// <summary>
+        /// Replaces the value. Readers still using the previous one keep it until
+        /// synchronize() frees it, so publishing never waits.
+        /// </summary>
+        void publish(T const* next)
+        {
+            T const* previous = m_current.exchange(next);
+            std::lock_guard<std::mutex> guard(m_retiredLock);
+            m_retired.push_back(previous);
+        }
+
+        /// <summary>
+        /// Waits until no reader can still use a value replaced before the call, then frees them.
+        /// </summary>
+        void synchronize()
+        {
+            std::lock_guard<std::mutex> syncGuard(m_syncLock);
+            std::vector<T const*> retired;
+            {
+                std::lock_guard<std::mutex> guard(m_retiredLock);
+                retired.swap(m_retired);
+            }
+            if (retired.empty())
+            {
+                return;
+            }
+
+            // Readers announced under earlier epochs were waited for by earlier calls
+            unsigned epoch = m_epoch.load();
+            m_epoch.store(epoch + 1);
+            unsigned slot = epoch & 1;
+            if (m_readers[slot].load() != 0)
+            {
+                std::unique_lock<std::mutex> guard(m_waitLock);
+                m_waiters++;
+                while (m_readers[slot].load() != 0)
+                {
+                    // Re-checks every few milliseconds in case a reader left as the wait started
+                    m_readersLeft.wait_for(guard, std::chrono::milliseconds(10));
+                }
+                m_waiters--;
+            }
+
+            for (T const* value : retired)
+            {
+                delete value;
+            }
+        }
+
+    private:
+        void leave(unsigned slot) const
+        {
+            if (m_readers[slot].fetch_sub(1) == 1 && m_waiters.load() != 0)
+            {
+                std::lock_guard<std::mutex> guard(m_waitLock);
+                m_readersLeft.notify_all();
+            }
+        }
+
+        std::atomic<T const*>           m_current;
+        std::atomic<unsigned>           m_epoch;
+        mutable std::atomic<unsigned>   m_readers[2];
+
+        std::mutex                      m_retiredLock;
+        std::vector<T const*>           m_retired;
+
+        std::mutex                      m_syncLock;
+        mutable std::mutex              m_waitLock;
+        mutable std::condition_variable m_readersLeft;
+        std::atomic<unsigned>           m_waiters;
+    };
+
+} MAT_NS_END
+
+#endif
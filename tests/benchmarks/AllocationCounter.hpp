@@ -0,0 +1,27 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+// The benchmarks executable replaces the global operator new to count every heap
+// allocation of the process, so that benchmarks can report allocations per item
+// next to their timings.
+struct AllocationCounter
+{
+    uint64_t allocations;
+    uint64_t bytes;
+
+    /// <summary>Totals since the start of the process</summary>
+    static AllocationCounter now();
+
+    AllocationCounter operator-(AllocationCounter const& other) const
+    {
+        return AllocationCounter { allocations - other.allocations, bytes - other.bytes };
+    }
+};
+
+#endif
@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "mat/config.h"
+#ifdef HAVE_MAT_DEFAULT_HTTP_CLIENT
+
+#include "common/Common.hpp"
+#include "common/HttpServer.hpp"
+#include "api/LogManagerFactory.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    /// <summary>
+    /// Local collector which accepts everything it receives.
+    /// </summary>
+    class AcceptingCollector : public HttpServer::Callback
+    {
+    public:
+        AcceptingCollector()
+        {
+            int port = m_server.addListeningPort(0);
+            std::ostringstream os;
+            os << "localhost:" << port;
+            m_url = "http://" + os.str() + "/collector/";
+            m_server.setServerName(os.str());
+            m_server.addHandler("/collector/", *this);
+            m_server.start();
+        }
+
+        ~AcceptingCollector()
+        {
+            m_server.stop();
+        }
+
+        std::string const& url() const
+        {
+            return m_url;
+        }
+
+        virtual int onHttpRequest(HttpServer::Request const& request, HttpServer::Response& response) override
+        {
+            UNREFERENCED_PARAMETER(request);
+            response.headers["Content-Type"] = "text/plain";
+            response.content = "{ \"status\": \"0\" }";
+            return 200;
+        }
+
+    protected:
+        HttpServer  m_server;
+        std::string m_url;
+    };
+
+    /// <summary>
+    /// Counts events handed to HTTP and requests acknowledged by the collector.
+    /// </summary>
+    class UploadTracker : public DebugEventListener
+    {
+    public:
+        virtual void OnDebugEvent(DebugEvent& evt) override
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            switch (evt.type)
+            {
+            case EVT_SENDING:
+                m_eventsSending += evt.param1;
+                m_requestsSent++;
+                break;
+            case EVT_HTTP_OK:
+                m_requestsAcked++;
+                break;
+            default:
+                return;
+            }
+            m_changed.notify_all();
+        }
+
+        /// <summary>
+        /// Wait until at least <paramref name="events"/> events since the last call
+        /// went out and every request carrying them was acknowledged.
+        /// </summary>
+        bool waitForUploaded(size_t events, std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            bool done = m_changed.wait_for(guard, timeout, [this, events]() {
+                return m_eventsSending >= events && m_requestsAcked == m_requestsSent;
+            });
+            m_eventsSending = 0;
+            return done;
+        }
+
+    protected:
+        std::mutex              m_lock;
+        std::condition_variable m_changed;
+        size_t                  m_eventsSending = 0;
+        size_t                  m_requestsSent = 0;
+        size_t                  m_requestsAcked = 0;
+    };
+
+    double percentile(std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+}
+
+// LogEvent to collector acknowledgement: ingestion, storage, packaging, compression,
+// HTTP upload to a local collector and response handling. Reports per-batch latency percentiles.
+static void BM_EndToEnd_LogAndUpload(benchmark::State& state)
+{
+    size_t const events = static_cast<size_t>(state.range(0));
+    AcceptingCollector collector;
+    UploadTracker tracker;
+
+    std::string const cacheFilePath = GetUniqueDBFileName();
+    ILogConfiguration config;
+    config[CFG_STR_CACHE_FILE_PATH] = cacheFilePath;
+    config[CFG_STR_COLLECTOR_URL] = collector.url();
+    config[CFG_INT_MAX_TEARDOWN_TIME] = 0;
+    config[CFG_MAP_METASTATS_CONFIG][CFG_INT_METASTATS_INTERVAL] = 0;
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = (state.range(1) != 0);
+
+    std::unique_ptr<ILogManager> logManager(LogManagerFactory::Create(config));
+    logManager->AddEventListener(EVT_SENDING, tracker);
+    logManager->AddEventListener(EVT_HTTP_OK, tracker);
+    ILogger* logger = logManager->GetLogger("benchmarktoken-00000000000000000000000000000000-0000-0000-0000-000000000000-0000");
+    EventProperties event = CreateSampleEvent("benchmark_event", EventPriority_Normal);
+
+    std::vector<double> latenciesMs;
+    for (auto _ : state)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < events; i++)
+        {
+            logger->LogEvent(event);
+        }
+        logManager->GetLogController()->UploadNow();
+        if (!tracker.waitForUploaded(events, std::chrono::seconds(30)))
+        {
+            state.SkipWithError("Timed out waiting for the collector to acknowledge all events");
+            break;
+        }
+        latenciesMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    state.SetItemsProcessed(state.iterations() * events);
+    state.counters["p50_ms"] = percentile(latenciesMs, 0.50);
+    state.counters["p90_ms"] = percentile(latenciesMs, 0.90);
+    state.counters["p99_ms"] = percentile(latenciesMs, 0.99);
+
+    logManager->RemoveEventListener(EVT_SENDING, tracker);
+    logManager->RemoveEventListener(EVT_HTTP_OK, tracker);
+    logManager.reset();
+    ::remove(cacheFilePath.c_str());
+}
+BENCHMARK(BM_EndToEnd_LogAndUpload)
+    ->ArgNames({ "events", "compression" })
+    ->Args({ 100, 0 })
+    ->Args({ 100, 1 })
+    ->Args({ 1000, 1 })
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+#endif // HAVE_MAT_DEFAULT_HTTP_CLIENT
@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "decorators/EventPropertiesDecorator.hpp"
+#include "NullObjects.hpp"
+#include "AllocationCounter.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    // Typical instrumented event: 30 properties, mostly short strings
+    void fillEvent(EventProperties& event)
+    {
+        static char const* const names[] = {
+            "AppSessionGuid", "ActivityName", "ActivityStatus", "ActivityDuration", "ClientVersion",
+            "CorrelationId", "DeviceClass", "DocumentId", "ErrorCode", "ErrorMessage",
+            "FeatureName", "FlightIds", "Host", "IsFirstRun", "Language",
+            "LicenseType", "ModuleName", "NetworkType", "Platform", "ProcessName",
+            "RequestCount", "ResultCode", "Ring", "ScenarioId", "SessionLength",
+            "Source", "TenantGroup", "ThreadCount", "UiMode", "Workload" };
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+        {
+            if (i % 3 == 1)
+            {
+                event.SetProperty(names[i], static_cast<int64_t>(i * 1000));
+            }
+            else
+            {
+                event.SetProperty(names[i], "value-of-property");
+            }
+        }
+    }
+}
+
+static void BM_EventProperties_SetProperties(benchmark::State& state)
+{
+    uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        AllocationCounter before = AllocationCounter::now();
+        EventProperties event("benchmark_event");
+        fillEvent(event);
+        allocations += (AllocationCounter::now() - before).allocations;
+        benchmark::DoNotOptimize(&event);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs_per_event"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_EventProperties_SetProperties);
+
+// Building the properties and converting them into a CsProtocol record, which is
+// what Logger::LogEvent does before the record is handed to the pipeline.
+static void BM_EventProperties_Decorate(benchmark::State& state)
+{
+    NullLogManager logManager;
+    EventPropertiesDecorator decorator(logManager);
+    uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        AllocationCounter before = AllocationCounter::now();
+        EventProperties event("benchmark_event");
+        fillEvent(event);
+        ::CsProtocol::Record record;
+        EventLatency latency = EventLatency_Normal;
+        decorator.decorate(record, latency, event);
+        allocations += (AllocationCounter::now() - before).allocations;
+        benchmark::DoNotOptimize(&record);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs_per_event"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_EventProperties_Decorate);
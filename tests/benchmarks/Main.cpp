@@ -0,0 +1,24 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <benchmark/benchmark.h>
+
+#ifdef _MSC_VER
+#define MAIN_CDECL __cdecl
+#else
+#define MAIN_CDECL
+#endif
+
+// Run e.g. with --benchmark_out=Benchmarks.json --benchmark_out_format=json
+// to get a machine-readable report for comparing SDK drops.
+int MAIN_CDECL main(int argc, char** argv)
+{
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,374 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+
+#include "api/LogManagerFactory.hpp"
+#include "bond/BondSerializer.hpp"
+#include "compression/HttpDeflateCompression.hpp"
+#include "packager/BondSplicer.hpp"
+#include "packager/Packager.hpp"
+#include "stats/MetaStats.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    // Typical customer event: a handful of Part A extensions and ~20 custom properties
+    ::CsProtocol::Record makeSourceRecord()
+    {
+        ::CsProtocol::Record record;
+        record.ver = "3.0";
+        record.name = "benchmark_event";
+        record.time = PAL::getUtcSystemTimeMs();
+        record.iKey = "o:7c8b1796cbc44bd5a03803c01c2b9d61";
+        record.extProtocol.push_back(::CsProtocol::Protocol());
+        record.extUser.push_back(::CsProtocol::User());
+        record.extUser[0].localId = "c:0f67c3ce-89e7-47db-9090-1b9998a100a0";
+        record.extOs.push_back(::CsProtocol::Os());
+        record.extOs[0].name = "Linux";
+        record.extOs[0].ver = "5.4.0";
+        record.extApp.push_back(::CsProtocol::App());
+        record.extApp[0].id = "benchmarks";
+        record.data.push_back(::CsProtocol::Data());
+        for (int i = 0; i < 20; i++)
+        {
+            ::CsProtocol::Value value;
+            if (i % 2)
+            {
+                value.type = ::CsProtocol::ValueKind::ValueInt64;
+                value.longValue = 1000 + i;
+            }
+            else
+            {
+                value.stringValue = "value of property number " + std::to_string(i);
+            }
+            record.data[0].properties["property_" + std::to_string(i)] = value;
+        }
+        return record;
+    }
+
+    std::vector<uint8_t> serialize(::CsProtocol::Record const& record)
+    {
+        std::vector<uint8_t> blob;
+        bond_lite::CompactBinaryProtocolWriter writer(blob);
+        bond_lite::Serialize(writer, record);
+        return blob;
+    }
+
+    void fillSplicer(ISplicer& splicer, size_t records, size_t tenants)
+    {
+        std::vector<uint8_t> blob = serialize(makeSourceRecord());
+        std::vector<size_t> packages;
+        for (size_t t = 0; t < tenants; t++)
+        {
+            packages.push_back(splicer.addTenantToken("tenant-" + std::to_string(t)));
+        }
+        for (size_t i = 0; i < records; i++)
+        {
+            splicer.addRecord(packages[i % tenants], blob);
+        }
+    }
+}
+
+// Public API entry point: decoration, filtering, serialization and handover to storage.
+// Uploads are paused so that only the ingestion path is measured.
+static void BM_Logger_LogEvent(benchmark::State& state)
+{
+    std::string const cacheFilePath = GetUniqueDBFileName();
+    ILogConfiguration config;
+    config[CFG_STR_CACHE_FILE_PATH] = cacheFilePath;
+    config[CFG_STR_COLLECTOR_URL] = "http://127.0.0.1:1/";
+    config[CFG_INT_MAX_TEARDOWN_TIME] = 0;
+    config[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ASYNC] = (state.range(0) != 0);
+    std::unique_ptr<ILogManager> logManager(LogManagerFactory::Create(config));
+    logManager->GetLogController()->PauseTransmission();
+    ILogger* logger = logManager->GetLogger("benchmarktoken-00000000000000000000000000000000-0000-0000-0000-000000000000-0000");
+    EventProperties event = CreateSampleEvent("benchmark_event", EventPriority_Normal);
+
+    for (auto _ : state)
+    {
+        logger->LogEvent(event);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(state.range(0) ? "async" : "sync");
+    logManager.reset();
+    ::remove(cacheFilePath.c_str());
+}
+BENCHMARK(BM_Logger_LogEvent)->ArgName("async")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_BondSerializer_Serialize(benchmark::State& state)
+{
+    BondSerializer serializer;
+    ::CsProtocol::Record source = makeSourceRecord();
+    IncomingEventContext event("id", "tenant", EventLatency_Normal, EventPersistence_Normal, &source);
+
+    for (auto _ : state)
+    {
+        // Each event gets a new blob, which is then moved to storage
+        std::vector<uint8_t>().swap(event.record.blob);
+        serializer.serialize(&event);
+        benchmark::DoNotOptimize(event.record.blob.data());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * event.record.blob.size());
+}
+BENCHMARK(BM_BondSerializer_Serialize);
+
+enum BondWriterKind
+{
+    BondWriter_Vector = 0,
+    BondWriter_TwoPass = 1,
+    BondWriter_Buffer = 2
+};
+
+// Compact binary writers on the same record: appending to a new vector, two-pass
+// (size, then write into an exactly sized vector) and writing into a reused buffer.
+static void BM_Bond_SerializeRecord(benchmark::State& state)
+{
+    ::CsProtocol::Record record = makeSourceRecord();
+    std::vector<uint8_t> buffer(serialize(record).size());
+    size_t size = 0;
+
+    for (auto _ : state)
+    {
+        switch (state.range(0))
+        {
+        case BondWriter_Vector:
+        {
+            std::vector<uint8_t> blob;
+            bond_lite::CompactBinaryProtocolWriter writer(blob);
+            bond_lite::Serialize(writer, record);
+            size = blob.size();
+            benchmark::DoNotOptimize(blob.data());
+            break;
+        }
+        case BondWriter_TwoPass:
+        {
+            std::vector<uint8_t> blob;
+            bond_lite::SerializeToBuffer(blob, record);
+            size = blob.size();
+            benchmark::DoNotOptimize(blob.data());
+            break;
+        }
+        default:
+        {
+            bond_lite::CompactBinaryProtocolBufferWriter writer(buffer.data(), buffer.size());
+            bond_lite::Serialize(writer, record);
+            size = writer.getSize();
+            benchmark::DoNotOptimize(buffer.data());
+            break;
+        }
+        }
+    }
+
+    state.SetLabel((state.range(0) == BondWriter_Vector) ? "vector" : (state.range(0) == BondWriter_TwoPass) ? "two-pass" : "buffer");
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_Bond_SerializeRecord)
+    ->ArgName("writer")
+    ->Arg(BondWriter_Vector)
+    ->Arg(BondWriter_TwoPass)
+    ->Arg(BondWriter_Buffer);
+
+// Decoding path of PayloadDecoder and the data viewer
+static void BM_Bond_DeserializeRecord(benchmark::State& state)
+{
+    std::vector<uint8_t> blob = serialize(makeSourceRecord());
+
+    for (auto _ : state)
+    {
+        ::CsProtocol::Record record;
+        bond_lite::CompactBinaryProtocolReader reader(blob);
+        benchmark::DoNotOptimize(bond_lite::Deserialize(reader, record));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * blob.size());
+}
+BENCHMARK(BM_Bond_DeserializeRecord);
+
+static void BM_BondSplicer_Splice(benchmark::State& state)
+{
+    BondSplicer splicer;
+    fillSplicer(splicer, static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)));
+    size_t bytes = 0;
+
+    for (auto _ : state)
+    {
+        std::vector<uint8_t> body = splicer.splice();
+        bytes = body.size();
+        benchmark::DoNotOptimize(body.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_BondSplicer_Splice)
+    ->ArgNames({ "records", "tenants" })
+    ->Args({ 100, 1 })
+    ->Args({ 1000, 1 })
+    ->Args({ 1000, 4 });
+
+// Packaging of reserved records spread over the given number of tenants, with the
+// bookkeeping of record ids and tenants that the upload keeps until it is acknowledged.
+static void BM_Packager_AddEventToPackage(benchmark::State& state)
+{
+    size_t const recordsPerUpload = 500;
+    size_t const tenants = static_cast<size_t>(state.range(0));
+    ILogConfiguration logConfig;
+    RuntimeConfig_Default config(logConfig);
+    Packager packager(config);
+
+    std::vector<std::string> tokens;
+    for (size_t t = 0; t < tenants; t++)
+    {
+        char prefix[16];
+        snprintf(prefix, sizeof(prefix), "%08x%02x", 0x7c8b1796u, static_cast<unsigned>(t));
+        tokens.push_back(std::string(prefix) + "bd5a03803c01c2b9d61-1b9998a1-00a0-47db-9090-0f67c3ce89e7-7029");
+    }
+    std::vector<uint8_t> const blob = serialize(makeSourceRecord());
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::vector<StorageRecord> records;
+        records.reserve(recordsPerUpload);
+        for (size_t i = 0; i < recordsPerUpload; i++)
+        {
+            records.emplace_back(PAL::generateUuidString(), tokens[i % tenants], EventLatency_Normal, EventPersistence_Normal, 1, StorageBlob(blob));
+        }
+        EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+        state.ResumeTiming();
+
+        AllocationCounter before = AllocationCounter::now();
+        bool wantMore = true;
+        for (auto& record : records)
+        {
+            packager.addEventToPackage(ctx, record, wantMore);
+        }
+        AllocationCounter used = AllocationCounter::now() - before;
+        allocations += used.allocations;
+        bytes += used.bytes;
+
+        state.PauseTiming();
+        ctx.reset();
+        records.clear();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * recordsPerUpload);
+    state.counters["allocs_per_record"] = benchmark::Counter(static_cast<double>(allocations) / recordsPerUpload, benchmark::Counter::kAvgIterations);
+    state.counters["bytes_per_record"] = benchmark::Counter(static_cast<double>(bytes) / recordsPerUpload, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Packager_AddEventToPackage)->ArgName("tenants")->Arg(1)->Arg(50);
+
+// Per-tenant meta-stats update for an acknowledged upload of ~5k small events,
+// walking the tenant of each record packaged into it.
+static void BM_MetaStats_UpdateOnPackageSentSucceeded(benchmark::State& state)
+{
+    size_t const recordsPerUpload = 5000;
+    size_t const tenants = static_cast<size_t>(state.range(0));
+    ILogConfiguration logConfig;
+    RuntimeConfig_Default config(logConfig);
+    config[CFG_MAP_METASTATS_CONFIG]["split"] = true;
+    MetaStats stats(config);
+
+    PackagedRecords records;
+    for (size_t i = 0; i < recordsPerUpload; i++)
+    {
+        char token[32];
+        snprintf(token, sizeof(token), "benchmark-tenant-%u", static_cast<unsigned>(i % tenants));
+        records.add(PAL::generateUuidString(), TenantRegistry::Intern(token), 1);
+    }
+    std::vector<unsigned> const latencyToSendMs(recordsPerUpload, 100);
+
+    for (auto _ : state)
+    {
+        stats.updateOnPackageSentSucceeded(records.tenantIds, EventLatency_Normal, 0, 100, latencyToSendMs, false);
+    }
+
+    state.SetItemsProcessed(state.iterations() * recordsPerUpload);
+}
+BENCHMARK(BM_MetaStats_UpdateOnPackageSentSucceeded)->ArgName("tenants")->Arg(1)->Arg(50);
+
+// Debug event dispatch from several logging threads to one listener, as done for every LogEvent
+static void BM_DebugEventSource_DispatchEvent(benchmark::State& state)
+{
+    class CountingListener : public DebugEventListener
+    {
+    public:
+        std::atomic<uint64_t> count { 0 };
+        void OnDebugEvent(DebugEvent&) override { count++; }
+    };
+    static DebugEventSource source;
+    static CountingListener listener;
+    if (state.thread_index() == 0)
+    {
+        source.AddEventListener(EVT_LOG_EVENT, listener);
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT }));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+    {
+        source.RemoveEventListener(EVT_LOG_EVENT, listener);
+    }
+}
+BENCHMARK(BM_DebugEventSource_DispatchEvent)->Threads(1)->Threads(4);
+
+// Compress a ~500 KB upload body at the given zlib level
+static void BM_HttpDeflateCompression_Compress(benchmark::State& state)
+{
+    ILogConfiguration logConfig;
+    RuntimeConfig_Default config(logConfig);
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = static_cast<int>(state.range(0));
+    HttpDeflateCompression compression(config);
+
+    BondSplicer splicer;
+    fillSplicer(splicer, 1000, 1);
+    std::vector<uint8_t> const body = splicer.splice();
+    size_t compressedSize = 0;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
+        ctx->body = body;
+        state.ResumeTiming();
+
+        compression.compress(ctx);
+        compressedSize = ctx->body.size();
+    }
+
+    state.SetBytesProcessed(state.iterations() * body.size());
+    state.counters["ratio"] = body.empty() ? 0.0 : static_cast<double>(compressedSize) / body.size();
+}
+BENCHMARK(BM_HttpDeflateCompression_Compress)
+    ->ArgName("level")
+    ->Arg(-1)
+    ->Arg(1)
+    ->Arg(9)
+    ->Unit(benchmark::kMicrosecond);
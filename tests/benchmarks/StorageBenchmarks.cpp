@@ -0,0 +1,355 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "common/MockIRuntimeConfig.hpp"
+#include "common/MockIOfflineStorageObserver.hpp"
+#include "offline/MemoryStorage.hpp"
+#include "offline/OfflineStorage_SQLite.hpp"
+#include "offline/ShardedMemoryStorage.hpp"
+#include "NullObjects.hpp"
+#include "AllocationCounter.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    enum StorageKind
+    {
+        Storage_SQLite = 0,
+        Storage_Memory = 1,
+        Storage_ShardedMemory = 2
+    };
+
+    // Storage instance on a fresh database, with no size limit unless given, so
+    // that benchmarks measure the store and retrieve paths and not trimming.
+    class StorageFixture
+    {
+    public:
+        NiceMock<MockIRuntimeConfig>          configMock;
+        NiceMock<MockIOfflineStorageObserver> observerMock;
+        NullLogManager                        nullLogManager;
+        std::unique_ptr<IOfflineStorage>      storage;
+        std::string                           path;
+        size_t                                nextId = 0;
+
+        explicit StorageFixture(StorageKind kind, unsigned maxSizeBytes = UINT_MAX)
+        {
+            ON_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillByDefault(Return(maxSizeBytes));
+            ON_CALL(configMock, GetMaximumRetryCount()).WillByDefault(Return(5));
+            if (kind == Storage_SQLite)
+            {
+                path = GetTempDirectory() + "StorageBenchmarks.db";
+                ::remove(path.c_str());
+                configMock[CFG_STR_CACHE_FILE_PATH] = path;
+                storage.reset(new OfflineStorage_SQLite(nullLogManager, configMock));
+            }
+            else if (kind == Storage_ShardedMemory)
+            {
+                configMock[CFG_INT_RAM_QUEUE_FIFO_LATENCIES] = 0;
+                storage.reset(new ShardedMemoryStorage(nullLogManager, configMock));
+            }
+            else
+            {
+                storage.reset(new MemoryStorage(nullLogManager, configMock));
+            }
+            storage->Initialize(observerMock);
+        }
+
+        ~StorageFixture()
+        {
+            storage->Shutdown();
+            if (!path.empty())
+            {
+                ::remove(path.c_str());
+            }
+        }
+
+        StorageRecord makeRecord(size_t size, EventLatency latency = EventLatency_Normal)
+        {
+            return StorageRecord("Record-" + std::to_string(nextId++), "benchmark-token",
+                latency, EventPersistence_Normal, PAL::getUtcSystemTimeMs(), StorageBlob(size, 0x5A));
+        }
+
+        // Normal latency events of 128 bytes, stored in batches like the ram queue flushes them
+        void storeBacklog(size_t count)
+        {
+            for (size_t stored = 0; stored < count; stored += 10000)
+            {
+                StorageRecordVector records;
+                for (size_t i = stored; i < std::min(count, stored + 10000); i++)
+                {
+                    records.push_back(makeRecord(128));
+                }
+                storage->StoreRecords(records);
+            }
+        }
+
+        void deleteAll()
+        {
+            auto records = storage->GetRecords(true, EventLatency_Unspecified, 0);
+            std::vector<std::string> ids;
+            ids.reserve(records.size());
+            for (auto& record : records)
+            {
+                ids.push_back(std::move(record.id));
+            }
+            HttpHeaders headers;
+            bool fromMemory = false;
+            storage->DeleteRecords(ids, headers, fromMemory);
+        }
+    };
+
+    char const* storageName(int64_t kind)
+    {
+        return (kind == Storage_SQLite) ? "SQLite" : (kind == Storage_ShardedMemory) ? "ShardedMemory" : "Memory";
+    }
+}
+
+static void BM_Storage_StoreRecord(benchmark::State& state)
+{
+    StorageFixture fixture(static_cast<StorageKind>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StorageRecord record = fixture.makeRecord(static_cast<size_t>(state.range(1)));
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(fixture.storage->StoreRecord(record));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(storageName(state.range(0)));
+}
+BENCHMARK(BM_Storage_StoreRecord)
+    ->ArgNames({ "storage", "blobSize" })
+    ->Args({ Storage_SQLite, 128 })
+    ->Args({ Storage_Memory, 128 })
+    ->Args({ Storage_ShardedMemory, 128 })
+    ->Unit(benchmark::kMicrosecond);
+
+// Batched flush path used by OfflineStorageHandler when moving events from RAM to disk
+static void BM_Storage_StoreRecords(benchmark::State& state)
+{
+    StorageFixture fixture(static_cast<StorageKind>(state.range(0)));
+    size_t const batchSize = static_cast<size_t>(state.range(1));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StorageRecordVector records;
+        records.reserve(batchSize);
+        for (size_t i = 0; i < batchSize; i++)
+        {
+            records.push_back(fixture.makeRecord(128));
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(fixture.storage->StoreRecords(records));
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(storageName(state.range(0)));
+}
+BENCHMARK(BM_Storage_StoreRecords)
+    ->ArgNames({ "storage", "batch" })
+    ->Args({ Storage_SQLite, 1000 })
+    ->Args({ Storage_SQLite, 10000 })
+    ->Args({ Storage_SQLite, 100000 })
+    ->Args({ Storage_Memory, 1000 })
+    ->Args({ Storage_ShardedMemory, 1000 })
+    ->Unit(benchmark::kMillisecond);
+
+// Reserve a batch for upload and delete it as if the upload succeeded
+static void BM_Storage_ReserveAndDelete(benchmark::State& state)
+{
+    StorageFixture fixture(static_cast<StorageKind>(state.range(0)));
+    size_t const batchSize = static_cast<size_t>(state.range(1));
+    std::vector<std::string> ids;
+    ids.reserve(batchSize);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StorageRecordVector records;
+        for (size_t i = 0; i < batchSize; i++)
+        {
+            records.push_back(fixture.makeRecord(128));
+        }
+        fixture.storage->StoreRecords(records);
+        ids.clear();
+        state.ResumeTiming();
+
+        fixture.storage->GetAndReserveRecords([&ids](StorageRecord&& record) {
+            ids.push_back(std::move(record.id));
+            return true;
+        }, 120000, EventLatency_Normal, 0);
+        HttpHeaders headers;
+        bool fromMemory = false;
+        fixture.storage->DeleteRecords(ids, headers, fromMemory);
+    }
+    fixture.deleteAll();
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.SetLabel(storageName(state.range(0)));
+}
+BENCHMARK(BM_Storage_ReserveAndDelete)
+    ->ArgNames({ "storage", "batch" })
+    ->Args({ Storage_SQLite, 500 })
+    ->Args({ Storage_Memory, 500 })
+    ->Args({ Storage_ShardedMemory, 500 })
+    ->Unit(benchmark::kMillisecond);
+
+// Reserve and delete an upload batch while the database holds an offline backlog
+// of the given number of rows, which the batch has to be found among.
+static void BM_Storage_SQLiteReserveAndDeleteWithBacklog(benchmark::State& state)
+{
+    StorageFixture fixture(Storage_SQLite);
+    size_t const batchSize = 500;
+    fixture.storeBacklog(static_cast<size_t>(state.range(0)));
+
+    std::vector<std::string> ids;
+    ids.reserve(batchSize);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StorageRecordVector records;
+        for (size_t i = 0; i < batchSize; i++)
+        {
+            records.push_back(fixture.makeRecord(128, EventLatency_RealTime));
+        }
+        fixture.storage->StoreRecords(records);
+        ids.clear();
+        state.ResumeTiming();
+
+        fixture.storage->GetAndReserveRecords([&ids](StorageRecord&& record) {
+            ids.push_back(std::move(record.id));
+            return true;
+        }, 120000, EventLatency_RealTime, static_cast<unsigned>(batchSize));
+        HttpHeaders headers;
+        bool fromMemory = false;
+        fixture.storage->DeleteRecords(ids, headers, fromMemory);
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_Storage_SQLiteReserveAndDeleteWithBacklog)
+    ->ArgNames({ "backlog" })
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Total record count polled by the shutdown loop while uploads drain the backlog
+static void BM_Storage_SQLiteGetRecordCountWithBacklog(benchmark::State& state)
+{
+    StorageFixture fixture(Storage_SQLite);
+    fixture.storeBacklog(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(fixture.storage->GetRecordCount(EventLatency_Unspecified));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Storage_SQLiteGetRecordCountWithBacklog)
+    ->ArgNames({ "backlog" })
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Batches stored by the ram queue flush while the database is over its size limit,
+// with storage full dropping enabled and a background thread trimming the database
+// like the task dispatcher does. Reports the longest time a batch took to store.
+static void BM_Storage_SQLiteStoreRecordsWhileTrimming(benchmark::State& state)
+{
+    unsigned const maxSizeBytes = static_cast<unsigned>(state.range(0)) * 1024 * 1024;
+    StorageFixture fixture(Storage_SQLite, maxSizeBytes);
+    fixture.storeBacklog(maxSizeBytes / 128);
+    fixture.configMock[CFG_BOOL_ENABLE_DB_DROP_IF_FULL] = true;
+
+    std::atomic<bool> stop(false);
+    std::thread trimmer([&fixture, &stop]() {
+        while (!stop) {
+            if (!fixture.storage->ResizeDb()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    });
+
+    std::chrono::steady_clock::duration longest {};
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StorageRecordVector records;
+        for (size_t i = 0; i < 100; i++)
+        {
+            records.push_back(fixture.makeRecord(128));
+        }
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        fixture.storage->StoreRecords(records);
+        longest = std::max(longest, std::chrono::steady_clock::now() - start);
+    }
+    stop = true;
+    trimmer.join();
+    state.SetItemsProcessed(state.iterations() * 100);
+    state.counters["longest_ms"] = std::chrono::duration<double, std::milli>(longest).count();
+}
+BENCHMARK(BM_Storage_SQLiteStoreRecordsWhileTrimming)
+    ->ArgNames({ "limitMB" })
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(benchmark::kMicrosecond);
+
+// Ram queue hot path: an event is stored, reserved for upload with its blob kept
+// by the uploader, and deleted once the upload succeeded. Reports heap bytes
+// allocated per record on top of the initial serialization of the blob.
+static void BM_Storage_MemoryStoreReserveDelete(benchmark::State& state)
+{
+    StorageFixture fixture(Storage_Memory);
+    size_t const blobSize = static_cast<size_t>(state.range(0));
+    size_t const batchSize = 100;
+    std::vector<StorageRecord> uploaded;
+    std::vector<std::string> ids;
+    uploaded.reserve(batchSize);
+    ids.reserve(batchSize);
+    uint64_t bytes = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        StorageRecordVector records;
+        records.reserve(batchSize);
+        for (size_t i = 0; i < batchSize; i++)
+        {
+            records.push_back(fixture.makeRecord(blobSize));
+        }
+        uploaded.clear();
+        ids.clear();
+        state.ResumeTiming();
+
+        AllocationCounter before = AllocationCounter::now();
+        for (auto& record : records)
+        {
+            fixture.storage->StoreRecord(std::move(record));
+        }
+        fixture.storage->GetAndReserveRecords([&uploaded, &ids](StorageRecord&& record) {
+            ids.push_back(record.id);
+            uploaded.push_back(std::move(record));
+            return true;
+        }, 120000, EventLatency_Normal, 0);
+        HttpHeaders headers;
+        bool fromMemory = true;
+        fixture.storage->DeleteRecords(ids, headers, fromMemory);
+        bytes += (AllocationCounter::now() - before).bytes;
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    state.counters["bytes_allocated_per_record"] = benchmark::Counter(static_cast<double>(bytes) / batchSize, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Storage_MemoryStoreReserveDelete)
+    ->ArgNames({ "blobSize" })
+    ->Arg(1024)
+    ->Arg(64 * 1024)
+    ->Unit(benchmark::kMicrosecond);
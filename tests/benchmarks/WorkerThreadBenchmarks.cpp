@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/PAL.hpp"
+#include "pal/TaskDispatcher.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace MAT;
+
+namespace
+{
+    class Nothing
+    {
+    public:
+        void run() {}
+    };
+}
+
+// Schedule and then cancel a batch of future timers, which is what the TPM,
+// storage and stats timers do on every reschedule.
+static void BM_WorkerThread_ScheduleAndCancelTimers(benchmark::State& state)
+{
+    auto scheduler = static_cast<TaskSchedulerType>(state.range(0));
+    size_t const timers = static_cast<size_t>(state.range(1));
+    auto workerThread = PAL::WorkerThreadFactory::Create(scheduler);
+    Nothing nothing;
+    std::vector<PAL::DeferredCallbackHandle> handles;
+    handles.reserve(timers);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < timers; i++)
+        {
+            // Spread target times so that inserts land all over the queue
+            unsigned delayMs = static_cast<unsigned>(60000 + ((i * 7919) % timers));
+            handles.push_back(PAL::scheduleTask(workerThread.get(), delayMs, &nothing, &Nothing::run));
+        }
+        for (auto& handle : handles)
+        {
+            handle.Cancel();
+        }
+        handles.clear();
+    }
+    workerThread->Join();
+
+    state.SetItemsProcessed(state.iterations() * timers);
+    state.SetLabel(scheduler == TaskScheduler_Heap ? "heap" : "list");
+}
+BENCHMARK(BM_WorkerThread_ScheduleAndCancelTimers)
+    ->ArgNames({ "scheduler", "timers" })
+    ->Args({ TaskScheduler_List, 1000 })
+    ->Args({ TaskScheduler_Heap, 1000 })
+    ->Args({ TaskScheduler_List, 10000 })
+    ->Args({ TaskScheduler_Heap, 10000 })
+    ->Unit(benchmark::kMicrosecond);
@@ -52,6 +52,10 @@ namespace testing {
         MOCK_METHOD0(getContext, ISemanticContext&());
         MOCK_METHOD1(DispatchEvent, bool(DebugEvent evt));
         MOCK_METHOD1(sendEvent, void(IncomingEventContextPtr const& event));
+
+        void eventsDropped(std::map<std::string, size_t> const&) override
+        {
+        }
         MOCK_METHOD0(startAsync, void());
         MOCK_METHOD0(stopAsync, void());
         MOCK_METHOD0(handleFlushTaskDispatcher, void());
@@ -404,9 +404,11 @@ TEST(APITest, LogManager_Initialize_DebugEventListener)
         EXPECT_EQ(debugListener.storageFullPct.load(), 0u);
 
     }
-    debugListener.numCached = 0;
-    debugListener.numSent   = 0;
-    debugListener.numLogged = 0;
+    // Reopening the full storage above trims it, which reports the trimmed events as dropped
+    debugListener.numCached  = 0;
+    debugListener.numSent    = 0;
+    debugListener.numLogged  = 0;
+    debugListener.numDropped = 0;
 
     CleanStorage();
     ILogger *result = LogManager::Initialize(TEST_TOKEN, configuration);
@@ -740,6 +742,87 @@ TEST(APITest, C_API_Test)
     ASSERT_EQ(capi_get_client(handle), nullptr);
 }
 
+TEST(APITest, C_API_LogBatch_Test)
+{
+    TestDebugEventListener debugListener;
+
+    const char* config = JSON_CONFIG(
+        {
+            "cacheFilePath": "MyOfflineStorage.db",
+            "config" : {
+                "host": "*"
+            },
+            "stats" : {
+                "interval": 0
+            },
+            "name" : "C-API-Client-Batch",
+            "version" : "1.0.0",
+            "primaryToken" : "7c8b1796cbc44bd5a03803c01c2b9d61-b6e370dd-28d9-4a52-9556-762543cf7aa7-6991",
+            "maxTeardownUploadTimeInSec" : 0,
+            "hostMode" : false,
+            "minimumTraceLevel" : 0,
+            "sdkmode" : 0
+        }
+    );
+
+    evt_prop eventA[] = TELEMETRY_EVENT
+    (
+        _STR(COMMONFIELDS_EVENT_NAME, "Event.Name.Batch.A"),
+        _STR(COMMONFIELDS_IKEY, TEST_TOKEN),
+        _STR("strKey", "valueA")
+    );
+    evt_prop eventB[] = TELEMETRY_EVENT
+    (
+        _STR(COMMONFIELDS_EVENT_NAME, "Event.Name.Batch.B"),
+        _STR(COMMONFIELDS_IKEY, TEST_TOKEN),
+        _STR(COMMONFIELDS_EVENT_SOURCE, "batchSource"),
+        _STR("strKey", "valueB")
+    );
+
+    std::map<std::string, unsigned> eventsByName;
+    debugListener.OnLogX = [&](::CsProtocol::Record & record)
+    {
+        eventsByName[record.name]++;
+        ASSERT_STREQ(record.data[0].properties["strKey"].stringValue.c_str(),
+            (record.name == "Event.Name.Batch.A") ? "valueA" : "valueB");
+    };
+
+    evt_handle_t handle = evt_open(config);
+    ASSERT_NE(handle, 0);
+
+    capi_client *client = capi_get_client(handle);
+    ASSERT_NE(client, nullptr);
+    ASSERT_NE(client->logmanager, nullptr);
+    client->logmanager->AddEventListener(EVT_LOG_EVENT, debugListener);
+
+    // Two runs of events per (token, source) pair, plus a switch back to the first pair
+    evt_prop* batch[] = { eventA, eventA, eventA, eventB, eventB, eventA };
+    EXPECT_EQ(evt_log_batch(handle, 6, batch), EOK);
+    EXPECT_EQ(eventsByName["Event.Name.Batch.A"], 4u);
+    EXPECT_EQ(eventsByName["Event.Name.Batch.B"], 2u);
+
+    // Single events reuse the loggers resolved by the batch
+    EXPECT_EQ(evt_log(handle, eventB), EOK);
+    EXPECT_EQ(eventsByName["Event.Name.Batch.B"], 3u);
+    EXPECT_EQ(client->loggers.size(), 2u);
+
+    // Empty batch is a no-op, a missing batch is a bad address
+    EXPECT_EQ(evt_log_batch(handle, 0, nullptr), EOK);
+    EXPECT_EQ(evt_log_batch(handle, 1, nullptr), EFAULT);
+
+    // A missing event is reported and does not stop the rest of the batch
+    evt_prop* holes[] = { eventA, nullptr, eventB };
+    EXPECT_EQ(evt_log_batch(handle, 3, holes), EFAULT);
+    EXPECT_EQ(eventsByName["Event.Name.Batch.A"], 5u);
+    EXPECT_EQ(eventsByName["Event.Name.Batch.B"], 4u);
+    EXPECT_EQ(client->loggers.size(), 2u);
+
+    client->logmanager->RemoveEventListener(EVT_LOG_EVENT, debugListener);
+    evt_close(handle);
+    ASSERT_EQ(capi_get_client(handle), nullptr);
+    EXPECT_EQ(evt_log_batch(handle, 6, batch), ENOENT);
+}
+
 #ifdef HAVE_MAT_JSONHPP
 #if defined(_WIN32)
 TEST(APITest, UTC_Callback_Test)
@@ -99,9 +99,10 @@ class MultipleLogManagersTests : public ::testing::Test,
 
     void waitForRequests(unsigned timeout, unsigned expectedCount = 1)
     {
-        auto sz = receivedRequests.size();
+        // Uploads may complete before the test starts waiting,
+        // so count all requests received by this fixture.
         auto start = PAL::getUtcSystemTimeMs();
-        while (receivedRequests.size() - sz < expectedCount)
+        while (receivedRequests.size() < expectedCount)
         {
             if (PAL::getUtcSystemTimeMs() - start >= timeout)
             {
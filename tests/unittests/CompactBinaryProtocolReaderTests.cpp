@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+
+using namespace testing;
+
+class CompactBinaryProtocolReaderTests : public Test
+{
+  protected:
+    // Pads the input so that the reader takes its unchecked path, or not
+    static std::vector<uint8_t> makeInput(std::vector<uint8_t> input, bool padded)
+    {
+        if (padded)
+        {
+            input.resize(input.size() + 16, 0xFF);
+        }
+        return input;
+    }
+};
+
+TEST_F(CompactBinaryProtocolReaderTests, Varints_DecodeTheSameWithAndWithoutBoundsChecks)
+{
+    for (uint64_t value : { uint64_t { 0 }, uint64_t { 127 }, uint64_t { 128 }, uint64_t { 300 }, uint64_t { UINT32_MAX }, uint64_t { 1 } << 42, UINT64_MAX })
+    {
+        std::vector<uint8_t> encoded;
+        bond_lite::CompactBinaryProtocolWriter writer(encoded);
+        writer.WriteUInt64(value);
+        for (bool padded : { false, true })
+        {
+            std::vector<uint8_t> input = makeInput(encoded, padded);
+            bond_lite::CompactBinaryProtocolReader reader(input);
+            uint64_t result = 0;
+            EXPECT_TRUE(reader.ReadUInt64(result));
+            EXPECT_THAT(result, Eq(value));
+            EXPECT_THAT(reader.getSize(), Eq(encoded.size()));
+        }
+    }
+}
+
+TEST_F(CompactBinaryProtocolReaderTests, Varints_RejectTruncatedAndOverlongInput)
+{
+    for (bool padded : { false, true })
+    {
+        // Six bytes with the continuation bit set do not fit in 32 bits, eleven not in 64
+        std::vector<uint8_t> input32 = makeInput(std::vector<uint8_t>(6, 0x80), padded);
+        std::vector<uint8_t> input64 = makeInput(std::vector<uint8_t>(11, 0x80), padded);
+        bond_lite::CompactBinaryProtocolReader reader32(input32);
+        bond_lite::CompactBinaryProtocolReader reader64(input64);
+        uint32_t value32 = 0;
+        uint64_t value64 = 0;
+        EXPECT_FALSE(reader32.ReadUInt32(value32));
+        EXPECT_FALSE(reader64.ReadUInt64(value64));
+    }
+
+    std::vector<uint8_t> truncated { 0x80, 0x80 };
+    bond_lite::CompactBinaryProtocolReader reader(truncated);
+    uint32_t value = 0;
+    EXPECT_FALSE(reader.ReadUInt32(value));
+}
+
+TEST_F(CompactBinaryProtocolReaderTests, Maps_AreReadBackInOrder)
+{
+    ::CsProtocol::Record record;
+    record.data.push_back(::CsProtocol::Data());
+    for (int i = 0; i < 50; i++)
+    {
+        record.data[0].properties["key_" + std::to_string(i)].stringValue = std::to_string(i);
+        record.tags["tag_" + std::to_string(i)] = std::to_string(i);
+    }
+    std::vector<uint8_t> blob;
+    bond_lite::SerializeToBuffer(blob, record);
+
+    ::CsProtocol::Record result;
+    bond_lite::CompactBinaryProtocolReader reader(blob);
+    ASSERT_TRUE(bond_lite::Deserialize(reader, result));
+    EXPECT_THAT(result.tags, Eq(record.tags));
+    ASSERT_THAT(result.data, SizeIs(1u));
+    EXPECT_THAT(result.data[0].properties, Eq(record.data[0].properties));
+}
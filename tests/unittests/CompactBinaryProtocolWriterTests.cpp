@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "common/Common.hpp"
+#include "bond/All.hpp"
+#include "bond/generated/CsProtocol_writers.hpp"
+#include "bond/generated/CsProtocol_readers.hpp"
+
+using namespace testing;
+
+class CompactBinaryProtocolWriterTests : public Test
+{
+  protected:
+    static ::CsProtocol::Record makeRecord()
+    {
+        ::CsProtocol::Record record;
+        record.ver = "3.0";
+        record.name = "writer_test";
+        record.time = 0x08D7E2B3C4D5E6F7;
+        record.popSample = 100.0;
+        record.flags = -1;
+        record.extApp.push_back(::CsProtocol::App());
+        record.extApp[0].id = "app";
+        record.data.push_back(::CsProtocol::Data());
+        for (int i = 0; i < 20; i++)
+        {
+            ::CsProtocol::Value value;
+            if (i % 2)
+            {
+                value.type = ::CsProtocol::ValueKind::ValueInt64;
+                value.longValue = -(int64_t { 1 } << (3 * i));
+            }
+            else
+            {
+                value.stringValue = std::string(static_cast<size_t>(i * 10), 'x');
+            }
+            record.data[0].properties["property_" + std::to_string(i)] = value;
+        }
+        return record;
+    }
+
+    // Reference encoding, one byte at a time
+    static std::vector<uint8_t> referenceVarint(uint64_t value)
+    {
+        std::vector<uint8_t> result;
+        while (value > 127)
+        {
+            result.push_back(static_cast<uint8_t>((value & 127) | 128));
+            value >>= 7;
+        }
+        result.push_back(static_cast<uint8_t>(value));
+        return result;
+    }
+};
+
+TEST_F(CompactBinaryProtocolWriterTests, Varints_MatchReferenceEncodingAtEveryLength)
+{
+    for (unsigned bits = 0; bits <= 64; bits++)
+    {
+        uint64_t value = (bits == 64) ? UINT64_MAX : (uint64_t { 1 } << bits) - 1;
+        for (uint64_t v : { value, value + 1 })
+        {
+            uint8_t buffer[bond_lite::MaxVarintSize];
+            size_t size = bond_lite::EncodeVarint(v, buffer);
+            EXPECT_THAT(std::vector<uint8_t>(buffer, buffer + size), Eq(referenceVarint(v))) << "value " << v;
+            EXPECT_THAT(bond_lite::VarintSize(v), Eq(size));
+        }
+    }
+
+    uint8_t buffer[bond_lite::MaxVarintSize];
+    EXPECT_THAT(bond_lite::EncodeVarint(uint32_t { UINT32_MAX }, buffer), Eq(5u));
+    EXPECT_THAT(bond_lite::EncodeVarint(uint16_t { UINT16_MAX }, buffer), Eq(3u));
+}
+
+TEST_F(CompactBinaryProtocolWriterTests, AllWriters_ProduceTheSameBytes)
+{
+    ::CsProtocol::Record record = makeRecord();
+
+    std::vector<uint8_t> expected;
+    bond_lite::CompactBinaryProtocolWriter writer(expected);
+    bond_lite::Serialize(writer, record);
+    EXPECT_THAT(writer.getSize(), Eq(expected.size()));
+
+    bond_lite::CompactBinaryProtocolSizer sizer;
+    bond_lite::Serialize(sizer, record);
+    EXPECT_THAT(sizer.getSize(), Eq(expected.size()));
+
+    std::vector<uint8_t> buffer(expected.size());
+    bond_lite::CompactBinaryProtocolBufferWriter bufferWriter(buffer.data(), buffer.size());
+    bond_lite::Serialize(bufferWriter, record);
+    EXPECT_THAT(bufferWriter.hasOverflowed(), false);
+    EXPECT_THAT(buffer, Eq(expected));
+
+    std::vector<uint8_t> blob { 0xAA };
+    bond_lite::SerializeToBuffer(blob, record);
+    ASSERT_THAT(blob.size(), Eq(expected.size() + 1));
+    EXPECT_THAT(blob.front(), Eq(0xAA));
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), blob.begin() + 1));
+}
+
+TEST_F(CompactBinaryProtocolWriterTests, SerializeToBuffer_RoundTrips)
+{
+    ::CsProtocol::Record record = makeRecord();
+    std::vector<uint8_t> blob;
+    bond_lite::SerializeToBuffer(blob, record);
+
+    ::CsProtocol::Record result;
+    bond_lite::CompactBinaryProtocolReader reader(blob);
+    ASSERT_TRUE(bond_lite::Deserialize(reader, result));
+    EXPECT_THAT(reader.getSize(), Eq(blob.size()));
+    EXPECT_THAT(result.name, Eq(record.name));
+    EXPECT_THAT(result.time, Eq(record.time));
+    EXPECT_THAT(result.flags, Eq(record.flags));
+    ASSERT_THAT(result.data, SizeIs(1u));
+    EXPECT_THAT(result.data[0].properties["property_18"].stringValue, Eq(std::string(180, 'x')));
+    EXPECT_THAT(result.data[0].properties["property_19"].longValue, Eq(-(int64_t { 1 } << 57)));
+}
+
+TEST_F(CompactBinaryProtocolWriterTests, BufferWriter_FlagsOverflowAndNeverWritesPastTheEnd)
+{
+    ::CsProtocol::Record record = makeRecord();
+    bond_lite::CompactBinaryProtocolSizer sizer;
+    bond_lite::Serialize(sizer, record);
+
+    std::vector<uint8_t> buffer(sizer.getSize() + 8, 0xCD);
+    size_t const size = sizer.getSize() / 2;
+    bond_lite::CompactBinaryProtocolBufferWriter writer(buffer.data(), size);
+    bond_lite::Serialize(writer, record);
+    EXPECT_THAT(writer.hasOverflowed(), true);
+    EXPECT_THAT(writer.getSize(), Le(size));
+    EXPECT_THAT(std::count(buffer.begin() + size, buffer.end(), 0xCD), Eq(static_cast<std::ptrdiff_t>(buffer.size() - size)));
+}
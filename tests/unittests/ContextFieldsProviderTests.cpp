@@ -180,3 +180,117 @@ TEST(ContextFieldsProviderTests, SetEventExperimentIds_EmptyExperimentIdsRemoves
 	provider.SetEventExperimentIds("Rodgers", "");
 	EXPECT_THAT(provider.GetCommonContextEventToConfigIds().size(), 0);
 }
+
+TEST(ContextFieldsProviderTests, Generation_GrowsWithOwnAndParentChanges)
+{
+    ContextFieldsProvider ctx(nullptr);
+    ContextFieldsProvider loggerCtx(&ctx);
+
+    uint64_t generation = loggerCtx.GetGeneration();
+    loggerCtx.SetCustomField("child", "value");
+    EXPECT_THAT(loggerCtx.GetGeneration(), Gt(generation));
+
+    generation = loggerCtx.GetGeneration();
+    ctx.SetAppId("appId");
+    EXPECT_THAT(loggerCtx.GetGeneration(), Gt(generation));
+
+    generation = loggerCtx.GetGeneration();
+    ::CsProtocol::Record record;
+    loggerCtx.writeToRecord(record);
+    EXPECT_THAT(loggerCtx.GetGeneration(), Eq(generation));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_ReflectsChangesAfterSnapshot)
+{
+    ContextFieldsProvider ctx(nullptr);
+    ContextFieldsProvider loggerCtx(&ctx);
+    ctx.SetAppId("appId");
+    ctx.SetCustomField("parent", "first");
+    loggerCtx.SetCustomField("child", "first");
+
+    ::CsProtocol::Record record;
+    loggerCtx.writeToRecord(record);
+    EXPECT_THAT(record.extApp[0].id, Eq("appId"));
+    EXPECT_THAT(record.data[0].properties["parent"].stringValue, Eq("first"));
+    EXPECT_THAT(record.data[0].properties["child"].stringValue, Eq("first"));
+
+    ctx.SetAppId("otherAppId");
+    ctx.SetCustomField("parent", "second");
+    loggerCtx.SetCustomField("child", "second");
+    loggerCtx.SetUserId("userId");
+
+    ::CsProtocol::Record record1;
+    loggerCtx.writeToRecord(record1);
+    EXPECT_THAT(record1.extApp[0].id, Eq("otherAppId"));
+    EXPECT_THAT(record1.extUser[0].localId, Eq("userId"));
+    EXPECT_THAT(record1.data[0].properties["parent"].stringValue, Eq("second"));
+    EXPECT_THAT(record1.data[0].properties["child"].stringValue, Eq("second"));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_ReflectsChangesThroughFieldReferences)
+{
+    ContextFieldsProvider ctx(nullptr);
+    ContextFieldsProvider loggerCtx(&ctx);
+    auto& parentFields = ctx.GetCustomFields();
+    parentFields["parent"] = EventProperty("first");
+
+    ::CsProtocol::Record record;
+    loggerCtx.writeToRecord(record);
+    EXPECT_THAT(record.data[0].properties["parent"].stringValue, Eq("first"));
+
+    // Changed after the child context rendered its fields, without any setter call
+    parentFields["parent"] = EventProperty("second");
+
+    ::CsProtocol::Record record1;
+    loggerCtx.writeToRecord(record1);
+    EXPECT_THAT(record1.data[0].properties["parent"].stringValue, Eq("second"));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_SnapshotMatchesFieldByFieldPath)
+{
+    ContextFieldsProvider ctx(nullptr);
+    ContextFieldsProvider loggerCtx(&ctx);
+    ctx.SetDeviceId("deviceId");
+    ctx.SetDeviceMake("deviceMake");
+    ctx.SetCustomField("parent", "value");
+    loggerCtx.SetTicket(TicketType_MSA_Device, "ticket");
+
+    // Empty record takes the snapshot, one with ext structs of its own is decorated field by field
+    ::CsProtocol::Record fromSnapshot;
+    loggerCtx.writeToRecord(fromSnapshot);
+    ::CsProtocol::Record fieldByField;
+    fieldByField.extProtocol.push_back(::CsProtocol::Protocol());
+    loggerCtx.writeToRecord(fieldByField);
+
+    EXPECT_THAT(fromSnapshot.extDevice[0].localId, Eq(fieldByField.extDevice[0].localId));
+    EXPECT_THAT(fromSnapshot.extProtocol[0].devMake, Eq("deviceMake"));
+    EXPECT_THAT(fieldByField.extProtocol[0].devMake, Eq("deviceMake"));
+    ASSERT_THAT(fromSnapshot.extProtocol.size(), Eq(fieldByField.extProtocol.size()));
+    EXPECT_THAT(fromSnapshot.extProtocol[1].ticketKeys, Eq(fieldByField.extProtocol[1].ticketKeys));
+    EXPECT_THAT(fromSnapshot.data[0].properties.size(), Eq(fieldByField.data[0].properties.size()));
+}
+
+TEST(ContextFieldsProviderTests, WriteToRecord_EventExperimentIdsApplyPerEvent)
+{
+    ContextFieldsProvider ctx(nullptr);
+    ContextFieldsProvider loggerCtx(&ctx);
+    ctx.SetAppExperimentIds("common");
+    ctx.SetEventExperimentIds("special", "eventSpecific");
+
+    ::CsProtocol::Record special;
+    special.name = "special";
+    loggerCtx.writeToRecord(special);
+    EXPECT_THAT(special.extApp[0].expId, Eq("eventSpecific"));
+
+    ::CsProtocol::Record other;
+    other.name = "other";
+    loggerCtx.writeToRecord(other);
+    EXPECT_THAT(other.extApp[0].expId, Eq("common"));
+
+    // Experiment ids of the innermost context win
+    loggerCtx.SetAppExperimentIds("logger");
+    ::CsProtocol::Record special1;
+    special1.name = "special";
+    loggerCtx.writeToRecord(special1);
+    EXPECT_THAT(special1.extApp[0].expId, Eq("logger"));
+}
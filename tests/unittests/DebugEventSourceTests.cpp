@@ -6,6 +6,10 @@
 #include "common/Common.hpp"
 #include <DebugEvents.hpp>
 #include <functional>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace testing;
 using namespace MAT;
@@ -218,3 +222,175 @@ TEST(DebugEventSourceTests, DispatchEvent_OneEventToCascadedAndToSource_Listener
 }
 
 
+
+TEST(DebugEventSourceTests, DispatchEvent_TypeWithoutListeners_NotInsertedIntoListeners)
+{
+   TestDebugEventSource source;
+   TestDebugEventListener listener;
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+
+   source.DispatchEvent(DebugEvent { EVT_LOG_LIFECYCLE });
+   ASSERT_EQ(source.listeners.size(), size_t { 1 });
+   ASSERT_EQ(source.listeners.count(EVT_LOG_LIFECYCLE), size_t { 0 });
+}
+
+TEST(DebugEventSourceTests, SetAsyncDispatch_EventsDeliveredInOrderOnAnotherThreadWithoutData)
+{
+   TestDebugEventSource source;
+   TestDebugEventSource anotherSource;
+   TestDebugEventListener listener;
+   std::vector<uint64_t> sequence;
+   std::atomic<bool> onCallerThread { false };
+   std::atomic<bool> hadData { false };
+   std::thread::id caller = std::this_thread::get_id();
+   listener.OnDebugEventOverride = [&](DebugEvent& debugEvent) {
+      sequence.push_back(debugEvent.seq);
+      onCallerThread = onCallerThread || std::this_thread::get_id() == caller;
+      hadData = hadData || debugEvent.data != nullptr;
+   };
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+   anotherSource.AddEventListener(EVT_LOG_FAILURE, listener);
+   source.AttachEventSource(anotherSource);
+   source.SetAsyncDispatch(100);
+
+   int payload = 0;
+   EXPECT_TRUE(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT, 0, 0, &payload, sizeof(payload) }));
+   EXPECT_TRUE(source.DispatchEvent(DebugEvent { EVT_LOG_EVENT }));
+   EXPECT_FALSE(source.DispatchEvent(DebugEvent { EVT_LOG_FAILURE }));
+   source.FlushAsyncDispatch();
+
+   EXPECT_EQ(sequence, (std::vector<uint64_t> { 1, 2, 3 }));
+   EXPECT_FALSE(onCallerThread);
+   EXPECT_FALSE(hadData);
+   EXPECT_EQ(source.GetDroppedEventCount(), uint64_t { 0 });
+
+   // Back to synchronous delivery
+   source.SetAsyncDispatch(0);
+   source.DispatchEvent(DebugEvent { EVT_LOG_EVENT, 0, 0, &payload, sizeof(payload) });
+   EXPECT_EQ(sequence.size(), size_t { 4 });
+   EXPECT_TRUE(hadData);
+}
+
+TEST(DebugEventSourceTests, SetAsyncDispatch_QueueFull_EventsDroppedAndCounted)
+{
+   TestDebugEventSource source;
+   TestDebugEventListener listener;
+   std::mutex lock;
+   std::condition_variable cv;
+   bool blocked = false;
+   bool released = false;
+   std::atomic<unsigned> delivered { 0 };
+   listener.OnDebugEventOverride = [&](DebugEvent&) {
+      std::unique_lock<std::mutex> guard(lock);
+      blocked = true;
+      cv.notify_all();
+      cv.wait(guard, [&released]() { return released; });
+      delivered++;
+   };
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+   source.SetAsyncDispatch(2);
+
+   // First event blocks the delivery thread, the next two fill the queue
+   source.DispatchEvent(DebugEvent { EVT_LOG_EVENT });
+   {
+      std::unique_lock<std::mutex> guard(lock);
+      cv.wait(guard, [&blocked]() { return blocked; });
+   }
+   for (int i = 0; i < 5; i++)
+   {
+      source.DispatchEvent(DebugEvent { EVT_LOG_EVENT });
+   }
+   EXPECT_EQ(source.GetDroppedEventCount(), uint64_t { 3 });
+
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      released = true;
+   }
+   cv.notify_all();
+   source.FlushAsyncDispatch();
+   EXPECT_EQ(delivered, 3u);
+}
+
+TEST(DebugEventSourceTests, RemoveEventListener_WhileOtherThreadsDispatch_ListenerNotCalledAfterRemove)
+{
+   TestDebugEventSource source;
+   std::atomic<bool> stop { false };
+   std::vector<std::thread> threads;
+   for (int i = 0; i < 4; i++)
+   {
+      threads.emplace_back([&source, &stop]() {
+         while (!stop)
+         {
+            source.DispatchEvent(DebugEvent { EVT_LOG_EVENT });
+         }
+      });
+   }
+
+   for (int i = 0; i < 200; i++)
+   {
+      std::atomic<bool> removed { false };
+      std::atomic<bool> calledAfterRemove { false };
+      TestDebugEventListener listener;
+      listener.OnDebugEventOverride = [&removed, &calledAfterRemove](DebugEvent&) {
+         if (removed)
+            calledAfterRemove = true;
+      };
+      source.AddEventListener(EVT_LOG_EVENT, listener);
+      std::this_thread::yield();
+      source.RemoveEventListener(EVT_LOG_EVENT, listener);
+      removed = true;
+      std::this_thread::yield();
+      EXPECT_FALSE(calledAfterRemove);
+   }
+
+   stop = true;
+   for (auto& thread : threads)
+   {
+      thread.join();
+   }
+   EXPECT_GT(source.seq.load(), uint64_t { 0 });
+}
+
+TEST(DebugEventSourceTests, RemoveEventListener_ListenerBlockedInCallback_ReturnsAfterCallbackReleased)
+{
+   TestDebugEventSource source;
+   std::mutex lock;
+   std::condition_variable changed;
+   bool entered = false;
+   bool released = false;
+   std::atomic<bool> callbackDone { false };
+   TestDebugEventListener listener;
+   listener.OnDebugEventOverride = [&](DebugEvent&) {
+      std::unique_lock<std::mutex> guard(lock);
+      entered = true;
+      changed.notify_all();
+      changed.wait(guard, [&released]() { return released; });
+      callbackDone = true;
+   };
+   source.AddEventListener(EVT_LOG_EVENT, listener);
+
+   std::thread dispatcher([&source]() { source.DispatchEvent(DebugEvent { EVT_LOG_EVENT }); });
+   {
+      std::unique_lock<std::mutex> guard(lock);
+      changed.wait(guard, [&entered]() { return entered; });
+   }
+
+   std::atomic<bool> removeReturned { false };
+   std::thread remover([&]() {
+      source.RemoveEventListener(EVT_LOG_EVENT, listener);
+      EXPECT_TRUE(callbackDone);
+      removeReturned = true;
+   });
+   std::this_thread::sleep_for(std::chrono::milliseconds(100));
+   EXPECT_FALSE(removeReturned);
+
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      released = true;
+      changed.notify_all();
+   }
+   remover.join();
+   dispatcher.join();
+   EXPECT_TRUE(removeReturned);
+   EXPECT_TRUE(callbackDone);
+}
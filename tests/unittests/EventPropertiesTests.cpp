@@ -114,6 +114,27 @@ TEST(EventPropertiesTests, Properties)
     EXPECT_THAT(ep.GetPiiProperties(), IsEmpty());
 }
 
+TEST(EventPropertiesTests, Properties_ReferenceReflectsLaterChanges)
+{
+    EventProperties ep("test");
+    auto const& properties = ep.GetProperties();
+    EXPECT_THAT(properties, SizeIs(1));
+
+    ep.SetProperty("one", "two");
+    ep.SetProperty("three", 3);
+    EXPECT_THAT(properties, SizeIs(3));
+    EXPECT_THAT(properties, Contains(Pair("one", EventProperty("two"))));
+
+    ep.SetProperty("one", "four");
+    ep.erase("three");
+    EXPECT_THAT(properties, SizeIs(2));
+    EXPECT_THAT(properties, Contains(Pair("one", EventProperty("four"))));
+
+    ep = EventProperties("other");
+    EXPECT_THAT(properties, SizeIs(1));
+    EXPECT_EQ(&properties, &ep.GetProperties());
+}
+
 TEST(EventPropertiesTests, NumericProperties)
 {
     EventProperties ep("test");
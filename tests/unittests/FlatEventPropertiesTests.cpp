@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "system/FlatEventProperties.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+TEST(FlatEventPropertiesTests, Set_KeepsPropertiesSortedByName)
+{
+    FlatEventPropertyMap properties;
+    properties.set("zulu", "last", PiiKind_None, DataCategory_PartC);
+    properties.set("alpha", EventProperty(int64_t(1)));
+    properties.set("mike", EventProperty(true));
+    properties.set("alphabet", EventProperty(2.5));
+
+    std::vector<std::string> names;
+    for (auto const& property : properties)
+    {
+        names.push_back(std::string(property.name, property.nameLength));
+    }
+    EXPECT_THAT(names, ElementsAre("alpha", "alphabet", "mike", "zulu"));
+}
+
+TEST(FlatEventPropertiesTests, Set_OverwritesExistingValueAndType)
+{
+    FlatEventPropertyMap properties;
+    properties.set("key", "a fairly long initial string value", PiiKind_None, DataCategory_PartC);
+    properties.set("key", "short", PiiKind_Identity, DataCategory_PartB);
+    ASSERT_THAT(properties.size(), Eq(size_t { 1 }));
+
+    auto property = properties.find("key");
+    ASSERT_THAT(property, NotNull());
+    EXPECT_THAT(property->to_string(), Eq("short"));
+    EXPECT_THAT(property->piiKind, Eq(PiiKind_Identity));
+    EXPECT_THAT(property->dataCategory, Eq(DataCategory_PartB));
+
+    properties.set("key", EventProperty(int64_t(42)));
+    property = properties.find("key");
+    EXPECT_THAT(property->type, Eq(EventProperty::TYPE_INT64));
+    EXPECT_THAT(property->as_int64, Eq(42));
+}
+
+TEST(FlatEventPropertiesTests, ToProperty_RoundTripsAllTypes)
+{
+    std::vector<int64_t> longs { 1, 2, 3 };
+    std::vector<std::string> strings { "a", "b" };
+    GUID_t guid("{01020304-0506-0708-090a-0b0c0d0e0f00}");
+
+    std::map<std::string, EventProperty> expected {
+        { "string",  EventProperty("value", PiiKind_GenericData) },
+        { "int64",   EventProperty(int64_t(-5)) },
+        { "double",  EventProperty(3.25) },
+        { "time",    EventProperty(time_ticks_t(uint64_t(123456789))) },
+        { "bool",    EventProperty(false) },
+        { "guid",    EventProperty(guid) },
+        { "longs",   EventProperty(longs) },
+        { "strings", EventProperty(strings) }
+    };
+
+    FlatEventPropertyMap properties;
+    for (auto const& kv : expected)
+    {
+        properties.set(kv.first, kv.second);
+    }
+
+    std::map<std::string, EventProperty> actual;
+    properties.copyTo(actual);
+    EXPECT_THAT(actual, Eq(expected));
+    for (auto const& property : properties)
+    {
+        std::string name(property.name, property.nameLength);
+        EXPECT_THAT(property.to_string(), Eq(expected[name].to_string()));
+    }
+}
+
+TEST(FlatEventPropertiesTests, Erase_RemovesOnlyNamedProperty)
+{
+    FlatEventPropertyMap properties;
+    properties.set("one", "1", PiiKind_None, DataCategory_PartC);
+    properties.set("two", "2", PiiKind_None, DataCategory_PartC);
+
+    EXPECT_THAT(properties.erase("three"), Eq(size_t { 0 }));
+    EXPECT_THAT(properties.erase("one"), Eq(size_t { 1 }));
+    EXPECT_THAT(properties.find("one"), IsNull());
+    ASSERT_THAT(properties.find("two"), NotNull());
+    EXPECT_THAT(properties.find("two")->to_string(), Eq("2"));
+}
+
+TEST(FlatEventPropertiesTests, Copy_IsIndependentOfSource)
+{
+    std::vector<std::string> array { "x" };
+    FlatEventPropertyMap source;
+    source.set("name", "value", PiiKind_None, DataCategory_PartC);
+    source.set("array", EventProperty(array));
+
+    FlatEventPropertyMap copy(source);
+    source.set("name", "changed", PiiKind_None, DataCategory_PartC);
+    source.clear();
+
+    ASSERT_THAT(copy.size(), Eq(size_t { 2 }));
+    EXPECT_THAT(copy.find("name")->to_string(), Eq("value"));
+    EXPECT_THAT(copy.find("array")->to_string(), Eq("x"));
+}
+
+TEST(FlatEventPropertiesTests, Move_RelocatesEmbeddedAndHeapValues)
+{
+    std::vector<std::string> array { "x" };
+    std::string large(4000, 'y');
+    FlatEventPropertyMap source;
+    source.set("small", "inline", PiiKind_None, DataCategory_PartC);
+    source.set("large", large.c_str(), PiiKind_None, DataCategory_PartC);
+    source.set("array", EventProperty(array));
+
+    FlatEventPropertyMap moved(std::move(source));
+    EXPECT_THAT(source.empty(), Eq(true));
+    source.set("small", "reused", PiiKind_None, DataCategory_PartC);
+
+    ASSERT_THAT(moved.size(), Eq(size_t { 3 }));
+    EXPECT_THAT(moved.find("small")->to_string(), Eq("inline"));
+    EXPECT_THAT(moved.find("large")->to_string(), Eq(large));
+    EXPECT_THAT(moved.find("array")->to_string(), Eq("x"));
+
+    FlatEventPropertyMap assigned;
+    assigned.set("old", "gone", PiiKind_None, DataCategory_PartC);
+    assigned = std::move(moved);
+    EXPECT_THAT(assigned.find("old"), IsNull());
+    EXPECT_THAT(assigned.find("small")->to_string(), Eq("inline"));
+    EXPECT_THAT(assigned.find("large")->to_string(), Eq(large));
+}
+
+TEST(FlatEventPropertiesTests, ManyOverwritesAndErases_CompactionKeepsValues)
+{
+    FlatEventPropertyMap properties;
+    properties.set("stable", "kept", PiiKind_None, DataCategory_PartC);
+    for (int i = 0; i < 10000; i++)
+    {
+        // Alternate lengths and erase/re-add so the old buffers cannot simply be reused
+        properties.set("value", std::string(static_cast<size_t>(10 + i % 100), 'x').c_str(), PiiKind_None, DataCategory_PartC);
+        properties.erase("temporary");
+        properties.set("temporary", std::to_string(i).c_str(), PiiKind_None, DataCategory_PartC);
+    }
+
+    EXPECT_THAT(properties.find("stable")->to_string(), Eq("kept"));
+    EXPECT_THAT(properties.find("temporary")->to_string(), Eq("9999"));
+    EXPECT_THAT(properties.find("value")->to_string(), Eq(std::string(10 + 9999 % 100, 'x')));
+}
+
+TEST(FlatEventPropertiesTests, EventProperties_GetPropertiesViewFollowsChanges)
+{
+    EventProperties event("view");
+    event.SetProperty("first", "1");
+    EXPECT_THAT(event.GetProperties(), Contains(Pair("first", EventProperty("1"))));
+
+    event.SetProperty("second", int64_t(2));
+    event.erase("first");
+    EXPECT_THAT(event.GetProperties(), Not(Contains(Key("first"))));
+    EXPECT_THAT(event.GetProperties(), Contains(Pair("second", EventProperty(int64_t(2)))));
+}
@@ -7,6 +7,8 @@
 #include "NullObjects.hpp"
 #include "ILogManager.hpp"
 
+#include <thread>
+
 using namespace testing;
 using namespace MAT;
 
@@ -50,9 +52,9 @@ TEST_F(HttpClientManagerTests, HandlesRequestFlow)
     auto ctx = std::make_shared<EventsUploadContext>();
     ctx->httpRequestId = req->GetId();
     ctx->httpRequest = req;
-    ctx->recordIdsAndTenantIds["r1"] = "t1"; ctx->recordIdsAndTenantIds["r2"] = "t1";
+    ctx->records.add("r1", TenantRegistry::Intern("t1"), 0); ctx->records.add("r2", TenantRegistry::Intern("t1"), 0);
     ctx->latency = EventLatency_Normal;
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[TenantRegistry::Intern("tenant1-token")] = 0;
 
     IHttpResponseCallback* callback = nullptr;
     EXPECT_CALL(httpClientMock, SendRequestAsync(ctx->httpRequest, _))
@@ -74,3 +76,49 @@ TEST_F(HttpClientManagerTests, HandlesRequestFlow)
     EXPECT_THAT(ctx->httpResponse, rspRef);
     EXPECT_THAT(ctx->durationMs, Gt(199));
 }
+
+TEST_F(HttpClientManagerTests, CompletedRequestsReleaseTheirSlotAndUpdateMetrics)
+{
+    std::vector<EventsUploadContextPtr> contexts;
+    std::vector<IHttpResponseCallback*> callbacks;
+    EXPECT_CALL(httpClientMock, SendRequestAsync(_, _))
+        .WillRepeatedly(Invoke([&callbacks](IHttpRequest*, IHttpResponseCallback* callback) { callbacks.push_back(callback); }));
+    for (int i = 0; i < 3; i++)
+    {
+        auto ctx = std::make_shared<EventsUploadContext>();
+        ctx->httpRequest = new SimpleHttpRequest("HttpClientManagerTests" + std::to_string(i));
+        ctx->httpRequestId = ctx->httpRequest->GetId();
+        contexts.push_back(ctx);
+    }
+
+    hcm.sendRequest(contexts[0]);
+    hcm.sendRequest(contexts[1]);
+    ASSERT_THAT(callbacks, SizeIs(2));
+    EXPECT_THAT(callbacks[0], Ne(callbacks[1]));
+    EXPECT_THAT(hcm.requestCount(), 2u);
+
+    // Completed out of order
+    EXPECT_CALL(*this, resultRequestDone(_)).Times(2);
+    callbacks[1]->OnHttpResponse(new SimpleHttpResponse("HttpClientManagerTests1"));
+    EXPECT_THAT(hcm.requestCount(), 1u);
+    callbacks[0]->OnHttpResponse(new SimpleHttpResponse("HttpClientManagerTests0"));
+    EXPECT_THAT(hcm.requestCount(), 0u);
+
+    HttpClientManager::Metrics metrics = hcm.getMetrics();
+    EXPECT_THAT(metrics.inFlight, 0u);
+    EXPECT_THAT(metrics.completed, 2u);
+
+    // The callback of a completed request is reused
+    hcm.sendRequest(contexts[2]);
+    ASSERT_THAT(callbacks, SizeIs(3));
+    EXPECT_THAT(callbacks[2], AnyOf(callbacks[0], callbacks[1]));
+
+    EXPECT_CALL(*this, resultRequestDone(contexts[2]));
+    std::thread responder([&callbacks]() {
+        PAL::sleep(50);
+        callbacks[2]->OnHttpResponse(new SimpleHttpResponse("HttpClientManagerTests2"));
+    });
+    hcm.cancelAllRequests();
+    EXPECT_THAT(hcm.requestCount(), 0u);
+    responder.join();
+}
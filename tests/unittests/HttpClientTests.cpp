@@ -2,6 +2,7 @@
 // Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
 // SPDX-License-Identifier: Apache-2.0
 //
+#include "mat/config.h"
 #ifdef HAVE_MAT_DEFAULT_HTTP_CLIENT
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
@@ -9,6 +10,9 @@
 #include "common/Common.hpp"
 #include "common/HttpServer.hpp"
 #include "http/HttpClientFactory.hpp"
+#if defined(MATSDK_PAL_CPP11) && !defined(__APPLE__) && !defined(ANDROID)
+#include <curl/curl.h>
+#endif
 
 using namespace testing;
 using namespace MAT;
@@ -29,6 +33,8 @@ class HttpClientTests : public ::testing::Test,
     enum RequestState { Planned, Sent, Processed, Done };
     std::vector<RequestState>            _countedRequests;
     std::mutex                           _lock;
+    std::vector<long>                    _newConnections;
+    std::vector<HttpStateEvent>          _states;
 
   public:
     HttpClientTests()
@@ -42,6 +48,8 @@ class HttpClientTests : public ::testing::Test,
             delete v;
         _responses.clear();
         _countedRequests.clear();
+        _newConnections.clear();
+        _states.clear();
     }
 
     bool responseReceived()
@@ -121,6 +129,27 @@ class HttpClientTests : public ::testing::Test,
         _responses.push_back(clone(inResponse));
     }
 
+    virtual void OnHttpStateEvent(HttpStateEvent state, void* data, size_t size) override
+    {
+        UNREFERENCED_PARAMETER(size);
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _states.push_back(state);
+        }
+#if defined(MATSDK_PAL_CPP11) && !defined(__APPLE__) && !defined(ANDROID)
+        if (state == OnResponse && data != nullptr) {
+            // Number of new connections curl had to open for this transfer
+            long connects = -1;
+            curl_easy_getinfo(static_cast<CURL*>(data), CURLINFO_NUM_CONNECTS, &connects);
+            std::lock_guard<std::mutex> lock(_lock);
+            _newConnections.push_back(connects);
+        }
+#else
+        UNREFERENCED_PARAMETER(state);
+        UNREFERENCED_PARAMETER(data);
+#endif
+    }
+
 };
 
 std::vector<uint8_t> Binary(std::string const& str)
@@ -149,6 +178,12 @@ TEST_F(HttpClientTests, HandlesSimpleRequest)
     EXPECT_THAT(_response->GetHeaders().get("Host"), _hostname);
     EXPECT_THAT(_response->GetBody(), Eq(Binary("It works!")));
     _response.release();
+#if defined(MATSDK_PAL_CPP11) && !defined(__APPLE__) && !defined(ANDROID)
+    EXPECT_THAT(_states, Contains(OnConnecting));
+    EXPECT_THAT(_states, Contains(OnSending));
+    EXPECT_THAT(_states, Contains(OnResponse));
+    EXPECT_THAT(_states, Not(Contains(OnConnectFailed)));
+#endif
 }
 
 TEST_F(HttpClientTests, HandlesErrorRequest)
@@ -254,6 +289,11 @@ TEST_F(HttpClientTests, HandlesConnectionError)
     EXPECT_THAT(_response->GetId(), requestId);
     EXPECT_THAT(_response->GetResult(), HttpResult_NetworkFailure);
     _response.release();
+#if defined(MATSDK_PAL_CPP11) && !defined(__APPLE__) && !defined(ANDROID)
+    EXPECT_THAT(_states, Contains(OnConnecting));
+    EXPECT_THAT(_states, Contains(OnConnectFailed));
+    EXPECT_THAT(_states, Not(Contains(OnSendFailed)));
+#endif
 }
 
 TEST_F(HttpClientTests, HandlesCancellation)
@@ -304,6 +344,29 @@ TEST_F(HttpClientTests, Handles100Continue)
     _response.release();
 }
 
+#if defined(MATSDK_PAL_CPP11) && !defined(__APPLE__) && !defined(ANDROID)
+TEST_F(HttpClientTests, ReusesConnectionForConsecutiveRequests)
+{
+    Clear();
+    for (size_t i = 0; i < 3; i++) {
+        IHttpRequest* request = _client->CreateRequest();
+        request->SetUrl("http://" + _hostname + "/simple/200");
+        _client->SendRequestAsync(request, this);
+        while (_responses.size() <= i) {
+            PAL::sleep(10);
+        }
+        EXPECT_THAT(_responses[i]->GetStatusCode(), 200u);
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    ASSERT_THAT(_newConnections, SizeIs(3));
+    EXPECT_THAT(_newConnections[0], 1);
+    // Keep-alive connection of the first request is picked up from the connection cache
+    EXPECT_THAT(_newConnections[1], 0);
+    EXPECT_THAT(_newConnections[2], 0);
+}
+#endif
+
 TEST_F(HttpClientTests, SurvivesManyRequests)
 {
     Clear();
@@ -175,3 +175,100 @@ TEST_F(HttpDeflateCompressionTests, CompressesGzipCorrectly)
     EXPECT_THAT(event->compressed, true);
     config[CFG_MAP_HTTP]["contentEncoding"] = "deflate";
 }
+
+static void addSplicedRecords(EventsUploadContextPtr const& event, std::vector<uint8_t>& expected)
+{
+    size_t package = event->splicer->addTenantToken("tenant");
+    for (uint8_t i = 0; i < 100; i++) {
+        std::vector<uint8_t> record(64, i);
+        record.back() = 0; // BT_STOP
+        event->splicer->addRecord(package, record);
+    }
+    expected = event->splicer->splice();
+    event->bodyInSplicer = true;
+}
+
+TEST_F(HttpDeflateCompressionTests, CompressesStreamedSplicerOutput)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    std::vector<uint8_t> expected;
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    addSplicedRecords(event, expected);
+
+    EXPECT_CALL(*this, resultSucceeded(event)).Times(1);
+    input(event);
+
+    std::vector<uint8_t> inflated;
+    ZlibUtils::InflateVector(event->body, inflated, false);
+    EXPECT_THAT(inflated, Eq(expected));
+    EXPECT_THAT(event->compressed, true);
+    EXPECT_THAT(event->bodyInSplicer, false);
+    EXPECT_THAT(event->splicer->getSizeEstimate(), Lt(expected.size()));
+}
+
+TEST_F(HttpDeflateCompressionTests, SplicesStreamedBodyWhenTurnedOff)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = false;
+    std::vector<uint8_t> expected;
+    EventsUploadContextPtr event = std::make_shared<EventsUploadContext>();
+    addSplicedRecords(event, expected);
+
+    EXPECT_CALL(*this, resultSucceeded(event)).Times(1);
+    input(event);
+
+    EXPECT_THAT(event->body, Eq(expected));
+    EXPECT_THAT(event->compressed, false);
+    EXPECT_THAT(event->bodyInSplicer, false);
+}
+
+TEST_F(HttpDeflateCompressionTests, ReusesStreamForBodyAndSplicerInput)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    for (int i = 0; i < 3; i++) {
+        std::vector<uint8_t> expected;
+        EventsUploadContextPtr streamed = std::make_shared<EventsUploadContext>();
+        addSplicedRecords(streamed, expected);
+        EventsUploadContextPtr buffered = std::make_shared<EventsUploadContext>();
+        buffered->body = expected;
+
+        EXPECT_CALL(*this, resultSucceeded(streamed)).Times(1);
+        input(streamed);
+        EXPECT_CALL(*this, resultSucceeded(buffered)).Times(1);
+        input(buffered);
+
+        // Same deflate parameters, same input: identical output regardless of how it was fed
+        EXPECT_THAT(streamed->body, Eq(buffered->body));
+    }
+}
+
+TEST_F(HttpDeflateCompressionTests, HonorsConfiguredCompressionLevel)
+{
+    config[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION] = true;
+    std::vector<uint8_t> payload;
+    for (int i = 0; i < 4096; i++) {
+        payload.push_back(static_cast<uint8_t>(i % 7));
+    }
+
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 0;
+    HttpDeflateCompression storeOnly(config);
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = 9;
+    HttpDeflateCompression best(config);
+    config[CFG_MAP_HTTP][CFG_INT_HTTP_COMPRESSION_LEVEL] = -1;
+
+    EventsUploadContextPtr stored = std::make_shared<EventsUploadContext>();
+    stored->body = payload;
+    storeOnly.compress(stored);
+    EventsUploadContextPtr compressed = std::make_shared<EventsUploadContext>();
+    compressed->body = payload;
+    best.compress(compressed);
+
+    // Level 0 only wraps the input into stored blocks
+    EXPECT_THAT(stored->body.size(), Gt(payload.size()));
+    EXPECT_THAT(compressed->body.size(), Lt(payload.size() / 10));
+    for (auto const& event : { stored, compressed }) {
+        std::vector<uint8_t> inflated;
+        ZlibUtils::InflateVector(event->body, inflated, false);
+        EXPECT_THAT(inflated, Eq(payload));
+        EXPECT_THAT(event->compressed, true);
+    }
+}
@@ -55,7 +55,7 @@ TEST_F(HttpRequestEncoderTests, SetsAllParameters)
     EventsUploadContextPtr ctx = std::make_shared<EventsUploadContext>();
     ctx->compressed = false;
     ctx->body = { 1, 127, 255 };
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[TenantRegistry::Intern("tenant1-token")] = 0;
     ctx->latency = EventLatency_RealTime;
 
     encoder.encode(ctx);
@@ -101,14 +101,14 @@ TEST_F(HttpRequestEncoderTests, BuildsApiKeyCorrectly)
     SimpleHttpRequest const* req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
     EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "")));
 
-    ctx->packageIds["tenant1-token"] = 0;
+    ctx->packageIds[TenantRegistry::Intern("tenant1-token")] = 0;
     encoder.encode(ctx);
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
     EXPECT_THAT(req->m_headers, Contains(Pair("APIKey", "tenant1-token")));
 
-    ctx->packageIds["tenant2-token"] = 1;
-    ctx->packageIds["tenant3-token"] = 2;
+    ctx->packageIds[TenantRegistry::Intern("tenant2-token")] = 1;
+    ctx->packageIds[TenantRegistry::Intern("tenant3-token")] = 2;
     encoder.encode(ctx);
     ASSERT_THAT(ctx->httpRequestId, Eq("HttpRequestEncoderTests"));
     req = static_cast<SimpleHttpRequest*>(ctx->httpRequest);
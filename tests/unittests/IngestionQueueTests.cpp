@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "system/IngestionQueue.hpp"
+
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+TEST(IngestionQueueTests, Constructor_CapacityIsRoundedUpToPowerOfTwo)
+{
+    EXPECT_EQ(IngestionQueue<int>(0).Capacity(), size_t { 2 });
+    EXPECT_EQ(IngestionQueue<int>(3).Capacity(), size_t { 4 });
+    EXPECT_EQ(IngestionQueue<int>(4096).Capacity(), size_t { 4096 });
+}
+
+TEST(IngestionQueueTests, TryPop_Empty_ReturnsFalse)
+{
+    IngestionQueue<int> queue(4);
+    int value = 0;
+    EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(IngestionQueueTests, TryPushTryPop_PreservesFifoOrder)
+{
+    IngestionQueue<int> queue(4);
+    for (int i = 0; i < 4; i++)
+    {
+        int value = i;
+        ASSERT_TRUE(queue.TryPush(value));
+    }
+    EXPECT_EQ(queue.Size(), size_t { 4 });
+
+    for (int i = 0; i < 4; i++)
+    {
+        int value = -1;
+        ASSERT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(queue.Size(), size_t { 0 });
+}
+
+TEST(IngestionQueueTests, TryPush_Full_ReturnsFalseAndKeepsValue)
+{
+    IngestionQueue<std::unique_ptr<int>> queue(2);
+    for (int i = 0; i < 2; i++)
+    {
+        std::unique_ptr<int> value(new int(i));
+        ASSERT_TRUE(queue.TryPush(value));
+        EXPECT_EQ(value, nullptr);
+    }
+
+    std::unique_ptr<int> overflow(new int(42));
+    EXPECT_FALSE(queue.TryPush(overflow));
+    ASSERT_NE(overflow, nullptr);
+    EXPECT_EQ(*overflow, 42);
+
+    // Evict the oldest to make room
+    std::unique_ptr<int> oldest;
+    ASSERT_TRUE(queue.TryPop(oldest));
+    EXPECT_EQ(*oldest, 0);
+    EXPECT_TRUE(queue.TryPush(overflow));
+}
+
+TEST(IngestionQueueTests, MultipleProducers_SingleConsumer_DeliversEveryElementOnce)
+{
+    const int producers = 4;
+    const int perProducer = 10000;
+    IngestionQueue<int> queue(64);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; i++)
+            {
+                int value = p * perProducer + i;
+                while (!queue.TryPush(value))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> seen(producers * perProducer, 0);
+    std::vector<int> lastSeen(producers, -1);
+    int received = 0;
+    while (received < producers * perProducer)
+    {
+        int value;
+        if (!queue.TryPop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        seen[value]++;
+        // Elements from the same producer come out in the order they went in
+        EXPECT_GT(value % perProducer, lastSeen[value / perProducer]);
+        lastSeen[value / perProducer] = value % perProducer;
+        received++;
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int count : seen)
+    {
+        ASSERT_EQ(count, 1);
+    }
+    int value;
+    EXPECT_FALSE(queue.TryPop(value));
+}
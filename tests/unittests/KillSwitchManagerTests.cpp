@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "offline/KillSwitchManager.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+TEST(KillSwitchManagerTests, NothingKilled_NotActiveAndNoTokenBlocked)
+{
+    KillSwitchManager manager;
+    EXPECT_FALSE(manager.isActive());
+    EXPECT_FALSE(manager.isTokenBlocked("tenant"));
+    EXPECT_THAT(manager.getTokensList(), IsEmpty());
+}
+
+TEST(KillSwitchManagerTests, HandleResponse_KillsTokensUntilRemoved)
+{
+    KillSwitchManager manager;
+    HttpHeaders headers;
+    headers.add("kill-tokens", "tenant1:all");
+    headers.add("kill-tokens", "tenant2");
+    headers.add("kill-duration", "3600");
+    EXPECT_TRUE(manager.handleResponse(headers));
+
+    EXPECT_TRUE(manager.isActive());
+    EXPECT_TRUE(manager.isTokenBlocked("tenant1"));
+    EXPECT_TRUE(manager.isTokenBlocked("tenant2"));
+    EXPECT_FALSE(manager.isTokenBlocked("tenant3"));
+    EXPECT_THAT(manager.getTokensList(), ElementsAre("tenant1", "tenant2"));
+
+    manager.removeToken("tenant1");
+    manager.removeToken("tenant2");
+    EXPECT_FALSE(manager.isActive());
+    EXPECT_FALSE(manager.isTokenBlocked("tenant1"));
+}
+
+TEST(KillSwitchManagerTests, ExpiredToken_IsNoLongerBlockedAndDropped)
+{
+    KillSwitchManager manager;
+    manager.addToken("tenant", 1);
+    EXPECT_TRUE(manager.isTokenBlocked("tenant"));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_FALSE(manager.isTokenBlocked("tenant"));
+    EXPECT_FALSE(manager.isActive());
+    EXPECT_THAT(manager.getTokensList(), IsEmpty());
+}
+
+TEST(KillSwitchManagerTests, RetryAfter_BlocksAllTokensWhileActive)
+{
+    KillSwitchManager manager;
+    HttpHeaders headers;
+    headers.add("Retry-After", "3600");
+    EXPECT_FALSE(manager.handleResponse(headers));
+    EXPECT_TRUE(manager.isRetryAfterActive());
+    EXPECT_TRUE(manager.isTokenBlocked("any"));
+}
+
+TEST(KillSwitchManagerTests, ConcurrentChecksAndUpdates_SeeConsistentState)
+{
+    KillSwitchManager manager;
+    std::atomic<bool> stop { false };
+    std::atomic<bool> otherBlocked { false };
+    std::thread reader([&manager, &stop, &otherBlocked]() {
+        while (!stop)
+        {
+            if (manager.isActive() && manager.isTokenBlocked("other"))
+            {
+                otherBlocked = true;
+            }
+        }
+    });
+
+    for (int i = 0; i < 1000; i++)
+    {
+        manager.addToken("tenant", 3600);
+        manager.removeToken("tenant");
+    }
+    stop = true;
+    reader.join();
+    EXPECT_FALSE(otherBlocked);
+    EXPECT_FALSE(manager.isActive());
+}
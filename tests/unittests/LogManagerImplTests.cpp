@@ -4,6 +4,7 @@
 //
 #include "api/LogManagerImpl.hpp"
 #include "common/Common.hpp"
+#include "pal/WorkerThread.hpp"
 
 using namespace testing;
 using namespace MAT;
@@ -21,6 +22,7 @@ class TestLogManagerImpl : public LogManagerImpl
     }
 
     using LogManagerImpl::m_httpClient;
+    using LogManagerImpl::m_offlineStorage;
     // using LogManagerImpl::m_ownHttpClient;
     using LogManagerImpl::InitializeModules;
     using LogManagerImpl::m_modules;
@@ -153,3 +155,138 @@ TEST(LogManagerImplTests, Constructor_DataViewerCollectionIsNotNullptr_DataViewe
     ASSERT_NO_THROW(logManager.GetDataViewerCollection());
 }
 
+
+class IngestionOverflowListener : public DebugEventListener
+{
+   public:
+    std::atomic<size_t> overflowCount{0};
+    std::atomic<size_t> droppedCount{0};
+    std::vector<StorageRecord> droppedRecords;
+    virtual void OnDebugEvent(DebugEvent& evt) override
+    {
+        if (evt.type == EVT_INGESTION_OVERFLOW)
+        {
+            overflowCount++;
+            droppedCount += evt.param2;
+        }
+        else if (evt.type == EVT_DROPPED && evt.data != nullptr)
+        {
+            StorageRecord const& record = *static_cast<StorageRecord const*>(evt.data);
+            EXPECT_EQ(evt.param2, size_t(record.latency));
+            droppedRecords.push_back(record);
+        }
+    }
+};
+
+class WorkerThreadBlocker
+{
+   public:
+    PAL::Event released;
+    void Block()
+    {
+        released.wait();
+    }
+};
+
+TEST(LogManagerImplTests, AsyncIngestion_QueueFullDropNewest_ReportsOverflowAndStoresQueuedEvents)
+{
+    ILogConfiguration configuration;
+    auto httpClient = std::make_shared<TestHttpClient>();
+    configuration.AddModule(CFG_MODULE_HTTP_CLIENT, httpClient);
+    auto taskDispatcher = PAL::WorkerThreadFactory::Create();
+    configuration.AddModule(CFG_MODULE_TASK_DISPATCHER, taskDispatcher);
+    configuration[CFG_MAP_METASTATS_CONFIG][CFG_INT_METASTATS_INTERVAL] = 0;
+    configuration[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ASYNC] = true;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_QUEUE_SIZE] = 2;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_OVERFLOW_POLICY] = IngestionOverflow_DropNewest;
+
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    IngestionOverflowListener listener;
+    logManager.AddEventListener(EVT_INGESTION_OVERFLOW, listener);
+    logManager.AddEventListener(EVT_DROPPED, listener);
+    size_t recordsOnEntry = logManager.m_offlineStorage->GetRecordCount();
+
+    // Keep the worker thread busy, so that nothing drains the ingestion queue
+    WorkerThreadBlocker blocker;
+    PAL::dispatchTask(taskDispatcher.get(), &blocker, &WorkerThreadBlocker::Block);
+
+    auto logger = logManager.GetLogger("ingestion");
+    logger->LogEvent("first");
+    logger->LogEvent("second");
+    EXPECT_EQ(listener.overflowCount, size_t{0});
+    logger->LogEvent("third");
+    EXPECT_EQ(listener.overflowCount, size_t{1});
+    EXPECT_EQ(listener.droppedCount, size_t{1});
+    ASSERT_EQ(listener.droppedRecords.size(), size_t{1});
+    EXPECT_EQ(listener.droppedRecords[0].tenantToken, "ingestion");
+    EXPECT_EQ(listener.droppedRecords[0].latency, EventLatency_Normal);
+
+    blocker.released.post();
+    logManager.Flush();
+    EXPECT_EQ(logManager.m_offlineStorage->GetRecordCount(), recordsOnEntry + 2);
+
+    logManager.RemoveEventListener(EVT_DROPPED, listener);
+    logManager.RemoveEventListener(EVT_INGESTION_OVERFLOW, listener);
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, AsyncIngestion_QueueFullBlock_DropsEventAfterTimeout)
+{
+    ILogConfiguration configuration;
+    auto httpClient = std::make_shared<TestHttpClient>();
+    configuration.AddModule(CFG_MODULE_HTTP_CLIENT, httpClient);
+    auto taskDispatcher = PAL::WorkerThreadFactory::Create();
+    configuration.AddModule(CFG_MODULE_TASK_DISPATCHER, taskDispatcher);
+    configuration[CFG_MAP_METASTATS_CONFIG][CFG_INT_METASTATS_INTERVAL] = 0;
+    configuration[CFG_MAP_INGESTION][CFG_BOOL_INGESTION_ASYNC] = true;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_QUEUE_SIZE] = 2;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_OVERFLOW_POLICY] = IngestionOverflow_Block;
+    configuration[CFG_MAP_INGESTION][CFG_INT_INGESTION_BLOCK_TIMEOUT] = 50;
+
+    TestLogManagerImpl logManager{configuration};
+    logManager.PauseTransmission();
+    IngestionOverflowListener listener;
+    logManager.AddEventListener(EVT_INGESTION_OVERFLOW, listener);
+    logManager.AddEventListener(EVT_DROPPED, listener);
+
+    WorkerThreadBlocker blocker;
+    PAL::dispatchTask(taskDispatcher.get(), &blocker, &WorkerThreadBlocker::Block);
+
+    auto logger = logManager.GetLogger("ingestion");
+    logger->LogEvent("first");
+    logger->LogEvent("second");
+    auto start = PAL::getMonotonicTimeMs();
+    logger->LogEvent("third");
+    EXPECT_GE(PAL::getMonotonicTimeMs() - start, 50);
+    EXPECT_EQ(listener.droppedCount, size_t{1});
+    ASSERT_EQ(listener.droppedRecords.size(), size_t{1});
+    EXPECT_EQ(listener.droppedRecords[0].tenantToken, "ingestion");
+
+    blocker.released.post();
+    logManager.RemoveEventListener(EVT_DROPPED, listener);
+    logManager.RemoveEventListener(EVT_INGESTION_OVERFLOW, listener);
+    logManager.FlushAndTeardown();
+}
+
+TEST(LogManagerImplTests, DiagLevelFilter_RangeAndSetArePublishedAsOneSnapshot)
+{
+    DiagLevelFilter filter;
+    EXPECT_FALSE(filter.IsLevelFilterEnabled());
+    EXPECT_TRUE(filter.IsLevelEnabled(DIAG_LEVEL_DEFAULT_MIN));
+
+    filter.SetFilter(2, 1, 3);
+    EXPECT_TRUE(filter.IsLevelFilterEnabled());
+    auto levels = filter.GetLevels();
+    EXPECT_THAT(levels.level, 2);
+    EXPECT_TRUE(filter.IsLevelEnabled(1));
+    EXPECT_TRUE(filter.IsLevelEnabled(3));
+    EXPECT_FALSE(filter.IsLevelEnabled(4));
+
+    // The set takes precedence over the range, earlier copies are unchanged
+    filter.SetFilter(5, std::set<uint8_t> { 5, 7 });
+    EXPECT_THAT(filter.GetDefaultLevel(), 5);
+    EXPECT_TRUE(filter.IsLevelEnabled(7));
+    EXPECT_FALSE(filter.IsLevelEnabled(2));
+    EXPECT_TRUE(levels.IsAllowed(2));
+}
@@ -270,6 +270,83 @@ TEST(MemoryStorageTests, GetAndReserveSome)
     EXPECT_EQ(totalCount - howMany, storage.GetRecordCount());
 }
 
+TEST(MemoryStorageTests, StoreRecordByMoveKeepsBlobBuffer)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    StorageRecord record{ "id", "token", EventLatency_Normal, EventPersistence_Normal, 1, StorageBlob(1024, 7) };
+    uint8_t const* data = record.blob.data();
+
+    EXPECT_THAT(storage.StoreRecord(std::move(record)), true);
+    EXPECT_THAT(storage.GetSize(), 1024 + sizeof(StorageRecord));
+
+    // Unreserved retrieval hands the very same buffer over to the consumer
+    auto records = storage.GetRecords();
+    ASSERT_THAT(records.size(), 1u);
+    EXPECT_THAT(static_cast<uint8_t const*>(records[0].blob.data()), data);
+    EXPECT_THAT(records[0].sharedBlob, IsNull());
+}
+
+TEST(MemoryStorageTests, ReservedRecordsShareBlobWithConsumer)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    StorageRecord record{ "id", "token", EventLatency_Normal, EventPersistence_Normal, 1, StorageBlob(1024, 7) };
+    uint8_t const* data = record.blob.data();
+    storage.StoreRecord(std::move(record));
+
+    std::vector<StorageRecord> records;
+    storage.GetAndReserveRecords([&records](StorageRecord&& r) -> bool {
+        records.push_back(std::move(r));
+        return true;
+    }, 1500);
+    ASSERT_THAT(records.size(), 1u);
+    ASSERT_THAT(records[0].sharedBlob, NotNull());
+    EXPECT_THAT(records[0].blob, IsEmpty());
+    EXPECT_THAT(records[0].sharedBlob->data(), data);
+    EXPECT_THAT(records[0].sharedBlob.use_count(), 2); // consumer and reserved record
+    EXPECT_THAT(storage.GetReservedCount(), 1u);
+
+    // A failed upload puts the record back into the queue without copying it either
+    std::vector<StorageRecordId> ids { "id" };
+    HttpHeaders headers;
+    bool fromMemory = true;
+    storage.ReleaseRecords(ids, true, headers, fromMemory);
+    records.clear();
+    EXPECT_THAT(storage.GetSize(), 1024 + sizeof(StorageRecord));
+
+    storage.GetAndReserveRecords([&records](StorageRecord&& r) -> bool {
+        records.push_back(std::move(r));
+        return true;
+    }, 1500);
+    ASSERT_THAT(records.size(), 1u);
+    EXPECT_THAT(records[0].sharedBlob->data(), data);
+    EXPECT_THAT(records[0].retryCount, 1);
+
+    // Deleting the reserved record leaves the consumer as the only owner
+    storage.DeleteRecords(ids, headers, fromMemory);
+    EXPECT_THAT(storage.GetReservedCount(), 0u);
+    EXPECT_THAT(records[0].sharedBlob.use_count(), 1);
+}
+
+TEST(MemoryStorageTests, DeclinedRecordStaysQueued)
+{
+    MemoryStorage storage(testLogManager, testConfig);
+    storage.StoreRecord(StorageRecord{ "id", "token", EventLatency_Normal, EventPersistence_Normal, 1, { 1, 2, 3 } });
+
+    for (unsigned leaseTimeMs : { 0u, 1500u })
+    {
+        storage.GetAndReserveRecords([](StorageRecord&&) -> bool {
+            return false;
+        }, leaseTimeMs);
+        EXPECT_THAT(storage.GetRecordCount(), 1u);
+        EXPECT_THAT(storage.GetReservedCount(), 0u);
+    }
+
+    auto records = storage.GetRecords();
+    ASSERT_THAT(records.size(), 1u);
+    EXPECT_THAT(records[0].id, Eq("id"));
+    EXPECT_THAT(records[0].blob, ElementsAre(1, 2, 3));
+}
+
 // This method is not implemented for RAM storage
 TEST(MemoryStorageTests, StoreSetting)
 {
@@ -45,12 +45,11 @@ TEST_F(MetaStatsTests, GenerateStartEvent)
     stats.updateOnStorageOpened("MyStorage/Normal");
     stats.updateOnPostData(postDataLength, false);
 
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Normal,        0,   333, std::vector<unsigned>{ 1333 },          false);
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Normal,     1,   444, std::vector<unsigned>{ 1444, 2444 },    false);
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime,       3,  5555, std::vector<unsigned>{ 15, 255, 3555 }, false);
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_Max,  0,   666, std::vector<unsigned>{ 666 },           false);
+    std::vector<TenantId> recordTenantIds{ TenantRegistry::Intern("t") };
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_Normal,        0,   333, std::vector<unsigned>{ 1333 },          false);
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_Normal,     1,   444, std::vector<unsigned>{ 1444, 2444 },    false);
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_RealTime,       3,  5555, std::vector<unsigned>{ 15, 255, 3555 }, false);
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_Max,  0,   666, std::vector<unsigned>{ 666 },           false);
     stats.updateOnPackageFailed(500);
     stats.updateOnPackageFailed(500);
     stats.updateOnPackageRetry(500, 2);
@@ -73,9 +72,8 @@ TEST_F(MetaStatsTests, GenerateStopEvent)
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsSendIntervalSec()).WillRepeatedly(Return(0));
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsTenantToken()).WillRepeatedly(Return("metastats-tenant-token"));
     stats.updateOnPostData(16, false);
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime, 1, 99, std::vector<unsigned>{ 100, 101, 102, 103, 104, 105, 106 }, false);
+    std::vector<TenantId> recordTenantIds{ TenantRegistry::Intern("t") };
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_RealTime, 1, 99, std::vector<unsigned>{ 100, 101, 102, 103, 104, 105, 106 }, false);
     stats.updateOnPackageFailed(501);
     stats.updateOnPackageFailed(403);
     stats.updateOnPackageRetry(505, 2);
@@ -84,6 +82,23 @@ TEST_F(MetaStatsTests, GenerateStopEvent)
     ASSERT_THAT(events, SizeIs(1));
 }
 
+TEST_F(MetaStatsTests, StopEventReportsPackagesInFlightAndRecordsAcknowledged)
+{
+    EXPECT_CALL(runtimeConfigMock, GetMetaStatsSendIntervalSec()).WillRepeatedly(Return(0));
+    EXPECT_CALL(runtimeConfigMock, GetMetaStatsTenantToken()).WillRepeatedly(Return("metastats-tenant-token"));
+    stats.updateOnPostData(16, false);
+    stats.updateOnPackagesInFlight(3);
+    stats.updateOnPackagesInFlight(1);
+    std::vector<TenantId> recordTenantIds{ TenantRegistry::Intern("t"), TenantRegistry::Intern("t") };
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_Normal, 0, 99, std::vector<unsigned>{ 100, 101 }, false);
+
+    auto events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_STOP);
+    ASSERT_THAT(events, SizeIs(1));
+    auto& ext = events[0].data[0].properties;
+    EXPECT_THAT(ext["pkg_inf_max"].stringValue, Eq("3"));
+    EXPECT_THAT(ext["rec_ok"].stringValue, Eq("2"));
+}
+
 TEST_F(MetaStatsTests, NoNewDataOrMetastatsOnlyGenerateNoEvents)
 {
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsSendIntervalSec())
@@ -91,7 +106,7 @@ TEST_F(MetaStatsTests, NoNewDataOrMetastatsOnlyGenerateNoEvents)
     EXPECT_CALL(runtimeConfigMock, GetMetaStatsTenantToken()).WillRepeatedly(Return("metastats-tenant-token"));
 
     // Send one normal event first to verify that stats are reset on generation.
-    stats.updateOnEventIncoming("t1", 123, EventLatency_RealTime, false);
+    stats.updateOnEventIncoming(TenantRegistry::Intern("t1"), 123, EventLatency_RealTime, false);
     auto events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
     EXPECT_THAT(events, SizeIs(1));
 
@@ -103,21 +118,20 @@ TEST_F(MetaStatsTests, NoNewDataOrMetastatsOnlyGenerateNoEvents)
     EXPECT_THAT(events, SizeIs(0));
 
     // Simulate logging and uploading some metastats events only. Nothing should be generated either.
-    stats.updateOnEventIncoming("s",123, EventLatency_RealTime, true);
-    stats.updateOnEventIncoming("s",123, EventLatency_Normal, true);
+    stats.updateOnEventIncoming(TenantRegistry::Intern("s"), 123, EventLatency_RealTime, true);
+    stats.updateOnEventIncoming(TenantRegistry::Intern("s"), 123, EventLatency_Normal, true);
     stats.updateOnPostData(123, true);
-    std::map<std::string, std::string> recordIdAndTenantid;
-    recordIdAndTenantid["r"] = "t";
-    stats.updateOnPackageSentSucceeded(recordIdAndTenantid, EventLatency_RealTime, 0, 123, std::vector<unsigned>{ 1234 }, true);
+    std::vector<TenantId> recordTenantIds{ TenantRegistry::Intern("t") };
+    stats.updateOnPackageSentSucceeded(recordTenantIds, EventLatency_RealTime, 0, 123, std::vector<unsigned>{ 1234 }, true);
     events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
     //EXPECT_THAT(events, SizeIs(0));
     events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
     //EXPECT_THAT(events, SizeIs(0));
 
     // Verify events are generated again once some normal event arrives.
-    stats.updateOnEventIncoming("t1",123, EventLatency_RealTime, false);
+    stats.updateOnEventIncoming(TenantRegistry::Intern("t1"), 123, EventLatency_RealTime, false);
     // Even if the last record is metastats.
-    stats.updateOnEventIncoming("t1",123, EventLatency_RealTime, true);
+    stats.updateOnEventIncoming(TenantRegistry::Intern("t1"), 123, EventLatency_RealTime, true);
     events = stats.generateStatsEvent(ACT_STATS_ROLLUP_KIND_ONGOING);
     //EXPECT_THAT(events, SizeIs(1));
     //EXPECT_THAT(events[0].Extension, Contains(Pair("records_received_count",   "4")));
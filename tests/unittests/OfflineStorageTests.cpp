@@ -13,7 +13,7 @@ protected:
     StorageObserver         offlineStorage;
 
     RouteSink<OfflineStorageTests, IncomingEventContextPtr const&>                             storeRecordFailed{ this, &OfflineStorageTests::resultStoreRecordFailed };
-    RouteSink<OfflineStorageTests, EventsUploadContextPtr const&, StorageRecord const&, bool&> retrievedEvent{ this, &OfflineStorageTests::resultRetrievedEvent };
+    RouteSink<OfflineStorageTests, EventsUploadContextPtr const&, StorageRecord&, bool&>       retrievedEvent{ this, &OfflineStorageTests::resultRetrievedEvent };
     RouteSink<OfflineStorageTests, EventsUploadContextPtr const&>                              retrievalFinished{ this, &OfflineStorageTests::resultRetrievalFinished };
     RouteSink<OfflineStorageTests, EventsUploadContextPtr const&>                              retrievalFailed{ this, &OfflineStorageTests::resultRetrievalFailed };
 
@@ -38,7 +38,7 @@ protected:
     }
 
     MOCK_METHOD1(resultStoreRecordFailed, void(IncomingEventContextPtr const &));
-    MOCK_METHOD3(resultRetrievedEvent, void(EventsUploadContextPtr const &, StorageRecord const &, bool&));
+    MOCK_METHOD3(resultRetrievedEvent, void(EventsUploadContextPtr const &, StorageRecord &, bool&));
     MOCK_METHOD1(resultRetrievalFinished, void(EventsUploadContextPtr const &));
     MOCK_METHOD1(resultRetrievalFailed, void(EventsUploadContextPtr const &));
 
@@ -65,18 +65,26 @@ TEST_F(OfflineStorageTests, StopShutsDown)
 
 TEST_F(OfflineStorageTests, StoreRecordIsForwarded)
 {
-    auto ctx = new IncomingEventContext();
+    auto ctx = new IncomingEventContext("guid", "token", EventLatency_Normal, EventPersistence_Normal, nullptr);
+    ctx->record.blob = { 1, 2, 3 };
 
-    EXPECT_CALL(offlineStorageMock, StoreRecord(Ref(ctx->record)))
+    // The blob is moved into the storage, the metadata and blob size stay in the context
+    EXPECT_CALL(offlineStorageMock, StoreRecord(AllOf(
+            Field(&StorageRecord::id, Eq("guid")),
+            Field(&StorageRecord::blob, ElementsAre(1, 2, 3)))))
         .WillOnce(Return(true));
     EXPECT_THAT(offlineStorage.storeRecord(ctx), true);
     EXPECT_THAT(ctx->record.timestamp, Near(PAL::getUtcSystemTimeMs(), 1000));
+    EXPECT_THAT(ctx->record.tenantToken, Eq("token"));
+    EXPECT_THAT(ctx->record.blob, IsEmpty());
+    EXPECT_THAT(ctx->blobSize, Eq(3u));
 
-    EXPECT_CALL(offlineStorageMock, StoreRecord(Ref(ctx->record)))
+    EXPECT_CALL(offlineStorageMock, StoreRecord(Field(&StorageRecord::id, Eq("guid"))))
         .WillOnce(Return(false));
     EXPECT_CALL(*this, resultStoreRecordFailed(ctx))
         .WillOnce(Return());
     EXPECT_THAT(offlineStorage.storeRecord(ctx), false);
+    delete ctx;
 }
 
 TEST_F(OfflineStorageTests, RetrieveEventsPassesRecordsThrough)
@@ -133,11 +141,9 @@ TEST_F(OfflineStorageTests, DeleteRecordsIsForwarded)
     auto ctx = std::make_shared<EventsUploadContext>();
     HttpHeaders test;
     bool fromMemory = false;
-    std::vector<std::string> recordIds;
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
+    ctx->records.add("r1", TenantRegistry::Intern("t1"), 1234567890);
+    ctx->records.add("r2", TenantRegistry::Intern("t1"), 1234567891);
+    std::vector<std::string> recordIds{ "r1", "r2" };
     ctx->fromMemory = fromMemory;
     EXPECT_CALL(offlineStorageMock, DeleteRecords(recordIds, test, fromMemory)).WillOnce(Return());
     EXPECT_THAT(offlineStorage.deleteRecords(ctx), true);
@@ -148,11 +154,9 @@ TEST_F(OfflineStorageTests, ReleaseRecordsIsForwarded)
     auto ctx = std::make_shared<EventsUploadContext>();
     HttpHeaders test;
     bool fromMemory = false;
-    std::vector<std::string> recordIds;
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
+    ctx->records.add("r1", TenantRegistry::Intern("t1"), 1234567890);
+    ctx->records.add("r2", TenantRegistry::Intern("t1"), 1234567891);
+    std::vector<std::string> recordIds{ "r1", "r2" };
     ctx->fromMemory = fromMemory;
     EXPECT_CALL(offlineStorageMock, ReleaseRecords(recordIds, false, test, fromMemory))
         .WillOnce(Return());
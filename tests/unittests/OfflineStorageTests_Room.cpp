@@ -93,6 +93,14 @@ public:
         offlineStorage->Shutdown();
     }
 
+    // Opening the storage does not trim it, the database file is shared by all the tests
+    void TrimToLimit() {
+        size_t passes = 0;
+        while (offlineStorage->ResizeDb() && passes < 100) {
+            passes += 1;
+        }
+    }
+
     void DeleteAllRecords() {
         auto records = offlineStorage->GetRecords(true, EventLatency_Unspecified, 0);
         if (records.empty()) {
@@ -211,7 +219,7 @@ TEST_P(OfflineStorageTestsRoom, TestStoreRecords)
                 now,
                 StorageBlob {1, 2, 3});
     }
-    offlineStorage->StoreRecords(records);
+    EXPECT_EQ(10u, offlineStorage->StoreRecords(records));
     EXPECT_EQ(10, offlineStorage->GetRecordCount(EventLatency_Normal));
     EXPECT_EQ(10, offlineStorage->GetRecordCount(EventLatency_Unspecified));
     auto found = offlineStorage->GetRecords(true, EventLatency_Unspecified, 0);
@@ -296,7 +304,7 @@ TEST_P(OfflineStorageTestsRoom, TestGetAndReserveAcceptAll)
         EXPECT_EQ(EventLatency_Normal, found[i].latency);
     }
     for (auto const & record : found) {
-        VerifyBlob(record.blob);
+        VerifyBlob(record.getBlob());
     }
 }
 
@@ -543,6 +551,7 @@ TEST_P(OfflineStorageTestsRoom, ResizeDB)
 
     auto now = PAL::getUtcSystemTimeMs();
 
+    TrimToLimit();
     StorageRecord record(
             "",
             "TenantFred",
@@ -618,4 +627,3 @@ INSTANTIATE_TEST_CASE_P(Storage,
     s << info.param;
     return s.str();
 });
-
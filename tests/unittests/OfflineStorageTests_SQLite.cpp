@@ -2,18 +2,22 @@
 // Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
 // SPDX-License-Identifier: Apache-2.0
 //
-#if 0
 #include "common/Common.hpp"
 #include "common/MockIOfflineStorageObserver.hpp"
 #include "common/MockIRuntimeConfig.hpp"
 #include "offline/OfflineStorage_SQLite.hpp"
+#include "sqlite3.h"
 #include <stdio.h>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 
 #include "NullObjects.hpp"
 
 using namespace testing;
 using namespace MAT;
+
+#if 0
 using namespace PAL;
 
 char const* const TEST_STORAGE_FILENAME = "OfflineStorageTests_SQLite.db";
@@ -637,3 +641,309 @@ TEST_F(OfflineStorageTests_SQLite, TrimmingAlwaysDropsAtLeastOneEvent)
 }
 #endif
 
+
+// Storage on a fresh file of its own, limited to 32 pages of 4 KiB
+class OfflineStorageTests_SQLiteFile : public Test
+{
+  public:
+    StrictMock<MockIRuntimeConfig>           configMock;
+    StrictMock<MockIOfflineStorageObserver>  observerMock;
+    NullLogManager                           nullLogManager;
+    std::unique_ptr<OfflineStorage_SQLite>   offlineStorage;
+    std::string                              path;
+
+    virtual void SetUp() override
+    {
+        std::ostringstream name;
+        name << GetTempDirectory() << "OfflineStorageTestsSQLiteFile.db";
+        path = name.str();
+        ::remove(path.c_str());
+
+        EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillRepeatedly(Return(32 * 4096));
+        EXPECT_CALL(configMock, GetMaximumRetryCount()).WillRepeatedly(Return(5));
+        configMock[CFG_STR_CACHE_FILE_PATH] = path;
+        offlineStorage.reset(new OfflineStorage_SQLite(nullLogManager, configMock));
+        EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default")).RetiresOnSaturation();
+        offlineStorage->Initialize(observerMock);
+    }
+
+    virtual void TearDown() override
+    {
+        offlineStorage->Shutdown();
+        ::remove(path.c_str());
+    }
+};
+
+TEST_F(OfflineStorageTests_SQLiteFile, RecordCountFollowsStoresAndDeletes)
+{
+    auto now = PAL::getUtcSystemTimeMs();
+    StorageRecordVector records;
+    for (size_t i = 0; i < 10; ++i) {
+        records.emplace_back(
+                "Fred-" + std::to_string(i),
+                "Fred-Token",
+                (i < 4) ? EventLatency_RealTime : EventLatency_Normal,
+                EventPersistence_Normal,
+                now,
+                StorageBlob {1, 2, 3});
+    }
+    EXPECT_EQ(10u, offlineStorage->StoreRecords(records));
+    EXPECT_EQ(10, offlineStorage->GetRecordCount(EventLatency_Unspecified));
+
+    // Storing a record again replaces it
+    EXPECT_TRUE(offlineStorage->StoreRecord(records[9]));
+    EXPECT_EQ(10, offlineStorage->GetRecordCount(EventLatency_Unspecified));
+
+    HttpHeaders headers;
+    bool fromMemory = false;
+    offlineStorage->DeleteRecords({ "Fred-8", "Fred-9", "Fred-unknown" }, headers, fromMemory);
+    EXPECT_EQ(8, offlineStorage->GetRecordCount(EventLatency_Unspecified));
+
+    offlineStorage->DeleteRecords({ { "latency", std::to_string(static_cast<int>(EventLatency_RealTime)) } });
+    EXPECT_EQ(4, offlineStorage->GetRecordCount(EventLatency_Unspecified));
+    EXPECT_EQ(4, offlineStorage->GetRecordCount(EventLatency_Normal));
+}
+
+TEST_F(OfflineStorageTests_SQLiteFile, TestStoreRecordsSkipsInvalidRecords)
+{
+    auto now = PAL::getUtcSystemTimeMs();
+    StorageRecordVector records;
+    for (size_t i = 0; i < 10; ++i) {
+        records.emplace_back(
+                (i == 5) ? std::string() : "Fred-" + std::to_string(i),
+                "Fred-Token",
+                EventLatency_Normal,
+                EventPersistence_Normal,
+                now,
+                StorageBlob {1, 2, 3});
+    }
+    EXPECT_CALL(observerMock, OnStorageFailed("Invalid parameters")).Times(1);
+    EXPECT_EQ(9u, offlineStorage->StoreRecords(records));
+    EXPECT_EQ(9, offlineStorage->GetRecordCount(EventLatency_Unspecified));
+}
+
+TEST(OfflineStorageTests_SQLiteSchema, Version1DatabaseIsMigratedWithItsEvents)
+{
+    std::ostringstream name;
+    name << GetTempDirectory() << "OfflineStorageTestsSQLiteV1.db";
+    std::string const path = name.str();
+    ::remove(path.c_str());
+
+    // Version 1 schema, with the tenant token in every event
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    char const* const v1 =
+        "PRAGMA user_version=1;"
+        "CREATE TABLE events (record_id TEXT, tenant_token TEXT NOT NULL, latency INTEGER, persistence INTEGER,"
+        " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB);"
+        "INSERT INTO events (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES"
+        " ('r1','tenant-a',2,1,1000,x'010203'), ('r2','tenant-b',2,1,1001,x'04'), ('r3','tenant-a',3,1,1002,x'05');";
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, v1, nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    StrictMock<MockIRuntimeConfig> configMock;
+    StrictMock<MockIOfflineStorageObserver> observerMock;
+    NullLogManager nullLogManager;
+    EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillRepeatedly(Return(32 * 4096));
+    configMock[CFG_STR_CACHE_FILE_PATH] = path;
+    OfflineStorage_SQLite storage(nullLogManager, configMock);
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default")).RetiresOnSaturation();
+    storage.Initialize(observerMock);
+
+    auto records = storage.GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(3u, records.size());
+    EXPECT_EQ("r3", records[0].id);
+    EXPECT_EQ("tenant-a", records[0].tenantToken);
+    EXPECT_EQ("r1", records[1].id);
+    EXPECT_EQ("tenant-a", records[1].tenantToken);
+    EXPECT_EQ((StorageBlob { 1, 2, 3 }), records[1].blob);
+    EXPECT_EQ("tenant-b", records[2].tenantToken);
+
+    // New events of a migrated tenant share its id
+    storage.StoreRecord(StorageRecord("r4", "tenant-b", EventLatency_Normal, EventPersistence_Normal, 1003, StorageBlob { 6 }));
+    storage.DeleteRecords({ { "tenant_token", "tenant-b" } });
+    EXPECT_EQ(2u, storage.GetRecordCount(EventLatency_Unspecified));
+    storage.Shutdown();
+    ::remove(path.c_str());
+}
+
+TEST(OfflineStorageTests_SQLiteSchema, Version1DatabaseIsMigratedKeepingLastDuplicate)
+{
+    std::ostringstream name;
+    name << GetTempDirectory() << "OfflineStorageTestsSQLiteV1Duplicates.db";
+    std::string const path = name.str();
+    ::remove(path.c_str());
+
+    // Version 1 schema, where nothing kept a record id from being stored twice
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    char const* const v1 =
+        "PRAGMA user_version=1;"
+        "CREATE TABLE events (record_id TEXT, tenant_token TEXT NOT NULL, latency INTEGER, persistence INTEGER,"
+        " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB);"
+        "INSERT INTO events (record_id,tenant_token,latency,persistence,timestamp,payload) VALUES"
+        " ('r1','tenant-a',2,1,1000,x'01'), ('r2','tenant-a',2,1,1001,x'02'), ('r1','tenant-a',2,1,1002,x'03');";
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, v1, nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    StrictMock<MockIRuntimeConfig> configMock;
+    StrictMock<MockIOfflineStorageObserver> observerMock;
+    NullLogManager nullLogManager;
+    EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillRepeatedly(Return(32 * 4096));
+    configMock[CFG_STR_CACHE_FILE_PATH] = path;
+    OfflineStorage_SQLite storage(nullLogManager, configMock);
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default")).RetiresOnSaturation();
+    storage.Initialize(observerMock);
+
+    auto records = storage.GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ("r2", records[0].id);
+    EXPECT_EQ("r1", records[1].id);
+    EXPECT_EQ((StorageBlob { 3 }), records[1].blob);
+    EXPECT_EQ("tenant-a", records[1].tenantToken);
+
+    // Storing a record id again replaces the stored event
+    storage.StoreRecord(StorageRecord("r2", "tenant-a", EventLatency_Normal, EventPersistence_Normal, 1003, StorageBlob { 4 }));
+    EXPECT_EQ(2u, storage.GetRecordCount(EventLatency_Unspecified));
+    storage.Shutdown();
+    ::remove(path.c_str());
+}
+
+TEST_F(OfflineStorageTests_SQLiteFile, MigratedTablesStillTaggedVersion1AreKept)
+{
+    offlineStorage->StoreRecord(StorageRecord("r1", "tenant-a", EventLatency_Normal, EventPersistence_Normal, 1000, StorageBlob { 1 }));
+    offlineStorage->StoreRecord(StorageRecord("r2", "tenant-b", EventLatency_Normal, EventPersistence_Normal, 1001, StorageBlob { 2 }));
+    offlineStorage->Shutdown();
+
+    // Builds storing the version after the upgrade committed could stop in between
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "PRAGMA user_version=1", nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    offlineStorage.reset(new OfflineStorage_SQLite(nullLogManager, configMock));
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default")).RetiresOnSaturation();
+    offlineStorage->Initialize(observerMock);
+
+    auto records = offlineStorage->GetRecords(true, EventLatency_Unspecified, 0);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ("r1", records[0].id);
+    EXPECT_EQ("tenant-a", records[0].tenantToken);
+    EXPECT_EQ("r2", records[1].id);
+    EXPECT_EQ("tenant-b", records[1].tenantToken);
+
+    int version = 0;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, nullptr));
+    ASSERT_EQ(SQLITE_ROW, sqlite3_step(stmt));
+    version = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    EXPECT_EQ(3, version);
+}
+
+TEST_F(OfflineStorageTests_SQLiteFile, ResizeDbTrimsNormalPersistenceFirst)
+{
+    auto now = PAL::getUtcSystemTimeMs();
+    StorageRecordVector records;
+    for (size_t i = 0; i < 100; ++i) {
+        records.emplace_back("Critical-" + std::to_string(i), "TenantFred", EventLatency_Normal, EventPersistence_Critical, now, StorageBlob(100));
+    }
+    offlineStorage->StoreRecords(records);
+    StorageRecord record("", "TenantFred", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob(100));
+    size_t index = 1;
+    while (offlineStorage->GetSize() <= configMock.GetOfflineStorageMaximumSizeBytes()) {
+        record.id = "Normal-" + std::to_string(index);
+        offlineStorage->StoreRecord(record);
+        index += 1;
+    }
+
+    // Every pass is bounded, keep trimming until the storage is back under its limit
+    size_t passes = 0;
+    while (offlineStorage->ResizeDb() && passes < 100) {
+        passes += 1;
+    }
+    EXPECT_GT(passes, 0u);
+    EXPECT_LE(offlineStorage->GetSize(), configMock.GetOfflineStorageMaximumSizeBytes());
+
+    auto found = offlineStorage->GetRecords(true, EventLatency_Unspecified, 0);
+    EXPECT_EQ(found.size(), offlineStorage->GetRecordCount(EventLatency_Unspecified));
+    size_t critical = std::count_if(found.begin(), found.end(), [](StorageRecord const& r) {
+        return r.id.compare(0, 9, "Critical-") == 0;
+    });
+    EXPECT_EQ(100u, critical);
+    EXPECT_LT(found.size(), 100 + index - 1);
+}
+
+TEST(OfflineStorageTests_SQLiteSchema, FileNotInIncrementalModeIsTrimmedWithoutVacuum)
+{
+    std::ostringstream name;
+    name << GetTempDirectory() << "OfflineStorageTestsSQLiteNoVacuum.db";
+    std::string const path = name.str();
+    ::remove(path.c_str());
+
+    // A file created before incremental vacuum, which opening it does not convert
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path.c_str(), &db));
+    char const* const v1 =
+        "PRAGMA auto_vacuum=NONE;"
+        "PRAGMA user_version=1;"
+        "CREATE TABLE events (record_id TEXT, tenant_token TEXT NOT NULL, latency INTEGER, persistence INTEGER,"
+        " timestamp INTEGER, retry_count INTEGER DEFAULT 0, reserved_until INTEGER DEFAULT 0, payload BLOB);";
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, v1, nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    StrictMock<MockIRuntimeConfig> configMock;
+    StrictMock<MockIOfflineStorageObserver> observerMock;
+    NullLogManager nullLogManager;
+    EXPECT_CALL(configMock, GetOfflineStorageMaximumSizeBytes()).WillRepeatedly(Return(32 * 4096));
+    configMock[CFG_STR_CACHE_FILE_PATH] = path;
+    OfflineStorage_SQLite storage(nullLogManager, configMock);
+    EXPECT_CALL(observerMock, OnStorageOpened("SQLite/Default")).RetiresOnSaturation();
+    storage.Initialize(observerMock);
+
+    auto now = PAL::getUtcSystemTimeMs();
+    StorageRecord record("", "TenantFred", EventLatency_Normal, EventPersistence_Normal, now, StorageBlob(100));
+    size_t index = 1;
+    while (storage.GetSize() <= configMock.GetOfflineStorageMaximumSizeBytes()) {
+        record.id = std::to_string(index++);
+        storage.StoreRecord(record);
+    }
+    size_t stored = storage.GetRecordCount(EventLatency_Unspecified);
+
+    // Passes stop once the pages in use fit, although the free pages stay in the file
+    size_t passes = 0;
+    while (storage.ResizeDb() && passes < 100) {
+        passes += 1;
+    }
+    EXPECT_GT(passes, 0u);
+    EXPECT_LT(passes, 100u);
+    EXPECT_LT(storage.GetRecordCount(EventLatency_Unspecified), stored);
+    EXPECT_LE(storage.GetSize(), configMock.GetOfflineStorageMaximumSizeBytes());
+    EXPECT_FALSE(storage.ResizeDb());
+
+    auto filePages = [&path]() {
+        int pages = 0;
+        sqlite3* file = nullptr;
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_open(path.c_str(), &file) == SQLITE_OK &&
+            sqlite3_prepare_v2(file, "PRAGMA page_count", -1, &stmt, nullptr) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW) {
+            pages = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_close(file);
+        return pages;
+    };
+
+    // The next events reuse the free pages instead of growing the file
+    int pages = filePages();
+    for (size_t i = 0; i < 50; i++) {
+        record.id = std::to_string(index++);
+        storage.StoreRecord(record);
+    }
+    EXPECT_EQ(pages, filePages());
+    storage.Shutdown();
+    ::remove(path.c_str());
+}
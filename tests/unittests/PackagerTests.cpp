@@ -57,15 +57,11 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     packager.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->body, Not(IsEmpty()));
-    EXPECT_THAT(ctx->recordIdsAndTenantIds, SizeIs(1));
-    std::vector<std::string> recordIds;
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
-    EXPECT_THAT(recordIds, Contains("r1"));
+    EXPECT_THAT(ctx->records.ids, ElementsAre("r1"));
+    EXPECT_THAT(ctx->records.tenantIds, ElementsAre(TenantRegistry::Intern("tenant1-token")));
+    EXPECT_THAT(ctx->records.timestamps, ElementsAre(1234567890));
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Intern("tenant1-token"))));
 
 
     ctx = std::make_shared<EventsUploadContext>();
@@ -73,7 +69,9 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
         .WillOnce(Return(100000))
         .RetiresOnSaturation();
 
+    // The packager takes ownership of the record blob, so package a fresh copy
     wantMore = true;
+    record1 = StorageRecord("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
     packager.addEventToPackage(ctx, record1, wantMore);
     StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{2, 2, 2, 0});
     packager.addEventToPackage(ctx, record2, wantMore);
@@ -83,18 +81,82 @@ TEST_F(PackagerTests, PackagesEventsByTenant)
     packager.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->body, Not(IsEmpty()));
-    EXPECT_THAT(ctx->recordIdsAndTenantIds, SizeIs(2));
-
-    recordIds.clear();
-    for (const auto& element : ctx->recordIdsAndTenantIds)
-    {
-        recordIds.push_back(element.first);
-    }
-    EXPECT_THAT(recordIds, Contains("r1"));
-    EXPECT_THAT(recordIds, Contains("r2"));
+    EXPECT_THAT(ctx->records.ids, ElementsAre("r1", "r2"));
+    EXPECT_THAT(ctx->records.tenantIds, ElementsAre(TenantRegistry::Intern("tenant1-token"), TenantRegistry::Intern("tenant2-token")));
+    EXPECT_THAT(ctx->records.timestamps, ElementsAre(1234567890, 1234567891));
     EXPECT_THAT(ctx->packageIds, SizeIs(2));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant1-token")));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("tenant2-token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Intern("tenant1-token"))));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Intern("tenant2-token"))));
+}
+
+TEST_F(PackagerTests, TakesOverRecordBlobs)
+{
+    auto ctx = std::make_shared<EventsUploadContext>();
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+
+    std::vector<uint8_t> blob1{1, 1, 1, 0};
+    std::vector<uint8_t> blob2{2, 2, 0};
+    std::vector<uint8_t> blob3{3, 0};
+    StorageRecord record1("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>(blob1));
+    StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>(blob2));
+    StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>(blob3));
+    uint8_t const* data = record1.blob.data();
+
+    bool wantMore = true;
+    packager.addEventToPackage(ctx, record1, wantMore);
+    packager.addEventToPackage(ctx, record2, wantMore);
+    packager.addEventToPackage(ctx, record3, wantMore);
+    EXPECT_THAT(record1.blob, IsEmpty());
+    EXPECT_THAT(record1.id, Eq("r1"));
+
+    // Records of the same tenant end up next to each other, in insertion order
+    std::vector<uint8_t> expected(blob1);
+    expected.insert(expected.end(), blob3.begin(), blob3.end());
+    expected.insert(expected.end(), blob2.begin(), blob2.end());
+    bool sawFirstBlobInPlace = false;
+    ctx->splicer->splice([&](uint8_t const* chunk, size_t) {
+        sawFirstBlobInPlace |= (chunk == data);
+        return true;
+    });
+    EXPECT_THAT(sawFirstBlobInPlace, true);
+
+    EXPECT_CALL(*this, resultPackagedEvents(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+    EXPECT_THAT(ctx->body, Eq(expected));
+}
+
+TEST_F(PackagerTests, SplicesSharedRecordBlobsInPlace)
+{
+    auto ctx = std::make_shared<EventsUploadContext>();
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+
+    // Reserved records of the ram queue come with the blob shared with the storage
+    auto shared = std::make_shared<StorageBlob const>(StorageBlob{1, 1, 0});
+    StorageRecord record("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal);
+    record.sharedBlob = shared;
+
+    bool wantMore = true;
+    packager.addEventToPackage(ctx, record, wantMore);
+    EXPECT_THAT(record.sharedBlob, IsNull());
+    EXPECT_THAT(shared.use_count(), Eq(2));
+    EXPECT_THAT(ctx->splicer->getSizeEstimate(), Gt(shared->size()));
+
+    bool sawBlobInPlace = false;
+    ctx->splicer->splice([&](uint8_t const* chunk, size_t) {
+        sawBlobInPlace |= (chunk == shared->data());
+        return true;
+    });
+    EXPECT_THAT(sawBlobInPlace, true);
+
+    EXPECT_CALL(*this, resultPackagedEvents(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+    EXPECT_THAT(ctx->body, Eq(*shared));
 }
 
 TEST_F(PackagerTests, UsesPriorityOfTheFirstEvent)
@@ -173,7 +235,7 @@ TEST_F(PackagerTests, SetsRequestBondFieldsCorrectly)
     StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
     packager.addEventToPackage(ctx, record2, wantMore);
     StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
-    packager.addEventToPackage(ctx, record1, wantMore);
+    packager.addEventToPackage(ctx, record3, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
         .WillOnce(Return());
@@ -219,14 +281,14 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
     StorageRecord record2("r2", "tenant2-token", EventLatency_Normal, EventPersistence_Normal, 1234567891, std::vector<uint8_t>{0});
     packagerF.addEventToPackage(ctx, record2, wantMore);
     StorageRecord record3("r3", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567892, std::vector<uint8_t>{0});
-    packagerF.addEventToPackage(ctx, record1, wantMore);
+    packagerF.addEventToPackage(ctx, record3, wantMore);
 
     EXPECT_CALL(*this, resultPackagedEvents(ctx))
         .WillOnce(Return());
     packagerF.finalizePackage(ctx);
 
     EXPECT_THAT(ctx->packageIds, SizeIs(1));
-    EXPECT_THAT(ctx->packageIds, Contains(Key("forced-Tenant-Token")));
+    EXPECT_THAT(ctx->packageIds, Contains(Key(TenantRegistry::Intern("forced-Tenant-Token"))));
 /*
     AriaProtocol::ClientToCollectorRequest r;
     bond_lite::CompactBinaryProtocolReader reader(ctx->body);
@@ -238,3 +300,28 @@ TEST_F(PackagerTests, ForcedTenantIsForced)
     ASSERT_THAT(r.TokenToDataPackagesMap["forced-tenant-token"][0].Records, SizeIs(3));
 */
 }
+
+TEST_F(PackagerTests, LeavesBodyInSplicerForStreamingCompression)
+{
+    runtimeConfigMock[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION_STREAMING] = true;
+    auto ctx = std::make_shared<EventsUploadContext>();
+    EXPECT_CALL(runtimeConfigMock, GetMaximumUploadSizeBytes())
+        .WillOnce(Return(100000))
+        .RetiresOnSaturation();
+    EXPECT_CALL(runtimeConfigMock, IsHttpRequestCompressionEnabled())
+        .WillOnce(Return(true))
+        .RetiresOnSaturation();
+
+    StorageRecord record("r1", "tenant1-token", EventLatency_Normal, EventPersistence_Normal, 1234567890, std::vector<uint8_t>{1, 1, 1, 0});
+    bool wantMore = true;
+    packager.addEventToPackage(ctx, record, wantMore);
+
+    EXPECT_CALL(*this, resultPackagedEvents(ctx))
+        .WillOnce(Return());
+    packager.finalizePackage(ctx);
+    runtimeConfigMock[CFG_MAP_HTTP][CFG_BOOL_HTTP_COMPRESSION_STREAMING] = false;
+
+    EXPECT_THAT(ctx->body, IsEmpty());
+    EXPECT_THAT(ctx->bodyInSplicer, true);
+    EXPECT_THAT(ctx->splicer->splice(), Eq(std::vector<uint8_t>{1, 1, 1, 0}));
+}
@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "utils/PublishedSnapshot.hpp"
+
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+namespace {
+
+    struct CountedValue
+    {
+        CountedValue(int value, std::atomic<int>& live) :
+            value(value),
+            live(live)
+        {
+            live++;
+        }
+
+        ~CountedValue()
+        {
+            live--;
+        }
+
+        int               value;
+        std::atomic<int>& live;
+    };
+
+}
+
+TEST(PublishedSnapshotTests, Publish_ReadersSeeLatestValue)
+{
+    std::atomic<int> live { 0 };
+    {
+        PublishedSnapshot<CountedValue> snapshot(new CountedValue(1, live));
+        {
+            PublishedSnapshot<CountedValue>::Reader reader(snapshot);
+            EXPECT_THAT(reader->value, Eq(1));
+        }
+
+        snapshot.publish(new CountedValue(2, live));
+        PublishedSnapshot<CountedValue>::Reader reader(snapshot);
+        EXPECT_THAT(reader->value, Eq(2));
+        EXPECT_THAT(snapshot.get()->value, Eq(2));
+    }
+    EXPECT_THAT(live.load(), Eq(0));
+}
+
+TEST(PublishedSnapshotTests, Synchronize_FreesReplacedValueOnceReaderIsDone)
+{
+    std::atomic<int> live { 0 };
+    PublishedSnapshot<CountedValue> snapshot(new CountedValue(1, live));
+
+    std::atomic<bool> reading { false };
+    std::atomic<bool> release { false };
+    std::atomic<int> seen { 0 };
+    std::thread reader([&]() {
+        PublishedSnapshot<CountedValue>::Reader current(snapshot);
+        reading = true;
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+        // Still the value published when the read started
+        seen = current->value;
+    });
+    while (!reading)
+    {
+        std::this_thread::yield();
+    }
+
+    snapshot.publish(new CountedValue(2, live));
+    EXPECT_THAT(live.load(), Eq(2));
+
+    std::atomic<bool> synchronized { false };
+    std::thread writer([&]() {
+        snapshot.synchronize();
+        synchronized = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(synchronized);
+    EXPECT_THAT(live.load(), Eq(2));
+
+    release = true;
+    reader.join();
+    writer.join();
+    EXPECT_THAT(seen.load(), Eq(1));
+    EXPECT_THAT(live.load(), Eq(1));
+}
+
+TEST(PublishedSnapshotTests, ConcurrentReadersAndWriters_NeverSeeFreedValues)
+{
+    std::atomic<int> live { 0 };
+    PublishedSnapshot<CountedValue> snapshot(new CountedValue(0, live));
+
+    constexpr int writes = 200;
+    std::atomic<bool> done { false };
+    std::atomic<int> invalid { 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+    {
+        readers.emplace_back([&]() {
+            int last = 0;
+            while (!done)
+            {
+                PublishedSnapshot<CountedValue>::Reader current(snapshot);
+                // Values only ever grow, a freed value would show up as garbage or going back
+                if (current->value < last || current->value > writes)
+                {
+                    invalid++;
+                }
+                last = current->value;
+            }
+        });
+    }
+
+    for (int i = 1; i <= writes; i++)
+    {
+        snapshot.publish(new CountedValue(i, live));
+        snapshot.synchronize();
+    }
+    done = true;
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+
+    EXPECT_THAT(invalid.load(), Eq(0));
+    EXPECT_THAT(live.load(), Eq(1));
+}
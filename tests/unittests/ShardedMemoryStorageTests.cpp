@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+
+#include "offline/ShardedMemoryStorage.hpp"
+#include "config/RuntimeConfig_Default.hpp"
+#include "NullObjects.hpp"
+
+#include "common/MockIOfflineStorageObserver.hpp"
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+class ShardedMemoryStorageTests : public ::testing::Test
+{
+protected:
+    NullLogManager                        logManager;
+    ILogConfiguration                     configuration;
+    std::unique_ptr<RuntimeConfig_Default> config;
+    NiceMock<MockIOfflineStorageObserver> observer;
+
+    std::unique_ptr<ShardedMemoryStorage> createStorage(uint32_t fifoLatencies = 0)
+    {
+        configuration[CFG_INT_RAM_QUEUE_FIFO_LATENCIES] = fifoLatencies;
+        config.reset(new RuntimeConfig_Default(configuration));
+        std::unique_ptr<ShardedMemoryStorage> storage(new ShardedMemoryStorage(logManager, *config));
+        storage->Initialize(observer);
+        return storage;
+    }
+
+    static StorageRecord makeRecord(std::string const& id, EventLatency latency, int64_t timestamp, size_t size = 16)
+    {
+        return StorageRecord(id, "token", latency, EventPersistence_Normal, timestamp, StorageBlob(size, 1));
+    }
+
+    static std::vector<std::string> takeIds(ShardedMemoryStorage& storage, unsigned leaseTimeMs, EventLatency minLatency = EventLatency_Unspecified, unsigned maxCount = 0)
+    {
+        std::vector<std::string> ids;
+        storage.GetAndReserveRecords([&ids](StorageRecord&& record) -> bool {
+            ids.push_back(record.id);
+            return true;
+        }, leaseTimeMs, minLatency, maxCount);
+        return ids;
+    }
+};
+
+TEST_F(ShardedMemoryStorageTests, StoreRecord_CountsSizeAndRecordsPerLatency)
+{
+    auto storage = createStorage();
+    EXPECT_THAT(storage->StoreRecord(makeRecord("off", EventLatency_Off, 1)), false);
+    EXPECT_THAT(storage->StoreRecord(makeRecord("n1", EventLatency_Normal, 1, 100)), true);
+    EXPECT_THAT(storage->StoreRecord(makeRecord("n2", EventLatency_Normal, 2, 100)), true);
+    EXPECT_THAT(storage->StoreRecord(makeRecord("rt", EventLatency_RealTime, 3, 100)), true);
+
+    EXPECT_THAT(storage->GetRecordCount(), 3u);
+    EXPECT_THAT(storage->GetRecordCount(EventLatency_Normal), 2u);
+    EXPECT_THAT(storage->GetRecordCount(EventLatency_RealTime), 1u);
+    EXPECT_THAT(storage->GetSize(), 3 * (100 + sizeof(StorageRecord)));
+    EXPECT_THAT(storage->GetRecordCount(static_cast<EventLatency>(EventLatency_Max + 1)), 0u);
+}
+
+TEST_F(ShardedMemoryStorageTests, StoreRecords_MovesBlobsIn)
+{
+    auto storage = createStorage();
+    std::vector<StorageRecord> records { makeRecord("a", EventLatency_Normal, 1, 100), makeRecord("b", EventLatency_Off, 2, 100) };
+    EXPECT_THAT(storage->StoreRecords(records), 1u);
+    EXPECT_THAT(records[0].blob, IsEmpty());
+    EXPECT_THAT(records[1].blob, SizeIs(100u));
+    EXPECT_THAT(storage->GetSize(), 100 + sizeof(StorageRecord));
+}
+
+TEST_F(ShardedMemoryStorageTests, GetAndReserveRecords_ServesHighestLatencyFirstInConfiguredOrder)
+{
+    // FIFO for Normal only, RealTime stays LIFO
+    auto storage = createStorage(1u << EventLatency_Normal);
+    for (int i = 1; i <= 3; i++)
+    {
+        storage->StoreRecord(makeRecord("n" + std::to_string(i), EventLatency_Normal, i));
+        storage->StoreRecord(makeRecord("rt" + std::to_string(i), EventLatency_RealTime, i));
+    }
+
+    EXPECT_THAT(takeIds(*storage, 0), ElementsAre("rt3", "rt2", "rt1", "n1", "n2", "n3"));
+    EXPECT_THAT(storage->GetRecordCount(), 0u);
+    EXPECT_THAT(storage->GetSize(), 0u);
+    EXPECT_THAT(storage->LastReadRecordCount(), 6u);
+}
+
+TEST_F(ShardedMemoryStorageTests, GetAndReserveRecords_HonorsMinLatencyAndMaxCount)
+{
+    auto storage = createStorage();
+    storage->StoreRecord(makeRecord("n", EventLatency_Normal, 1));
+    storage->StoreRecord(makeRecord("rt1", EventLatency_RealTime, 2));
+    storage->StoreRecord(makeRecord("rt2", EventLatency_RealTime, 3));
+
+    EXPECT_THAT(takeIds(*storage, 0, EventLatency_RealTime, 1), ElementsAre("rt2"));
+    EXPECT_THAT(takeIds(*storage, 0, EventLatency_RealTime), ElementsAre("rt1"));
+    EXPECT_THAT(storage->GetRecordCount(), 1u);
+}
+
+TEST_F(ShardedMemoryStorageTests, DeclinedRecordIsServedAgainFirst)
+{
+    for (uint32_t fifo : { 0u, 0xFFu })
+    {
+        auto storage = createStorage(fifo);
+        storage->StoreRecord(makeRecord("a", EventLatency_Normal, 1));
+        storage->StoreRecord(makeRecord("b", EventLatency_Normal, 2));
+        size_t size = storage->GetSize();
+
+        std::string declined;
+        storage->GetAndReserveRecords([&declined](StorageRecord&& record) -> bool {
+            declined = record.id;
+            return false;
+        }, 1000);
+        EXPECT_THAT(storage->GetReservedCount(), 0u);
+        EXPECT_THAT(storage->GetRecordCount(), 2u);
+        EXPECT_THAT(storage->GetSize(), size);
+        EXPECT_THAT(takeIds(*storage, 0, EventLatency_Unspecified, 1), ElementsAre(declined));
+    }
+}
+
+TEST_F(ShardedMemoryStorageTests, ReservedRecords_AreDeletedOrReleasedById)
+{
+    auto storage = createStorage(1u << EventLatency_Normal);
+    for (int i = 1; i <= 4; i++)
+    {
+        storage->StoreRecord(makeRecord("r" + std::to_string(i), EventLatency_Normal, i));
+    }
+    size_t size = storage->GetSize();
+
+    std::vector<StorageRecord> uploaded;
+    storage->GetAndReserveRecords([&uploaded](StorageRecord&& record) -> bool {
+        uploaded.push_back(std::move(record));
+        return true;
+    }, 1000, EventLatency_Unspecified, 3);
+    ASSERT_THAT(uploaded.size(), 3u);
+    EXPECT_THAT(uploaded[0].sharedBlob, NotNull());
+    EXPECT_THAT(uploaded[0].reservedUntil, Gt(0));
+    EXPECT_THAT(storage->GetReservedCount(), 3u);
+    EXPECT_THAT(storage->GetRecordCount(), 1u);
+
+    HttpHeaders headers;
+    bool fromMemory = true;
+    storage->DeleteRecords(std::vector<StorageRecordId>{ "r1" }, headers, fromMemory);
+    EXPECT_THAT(storage->GetReservedCount(), 2u);
+
+    // Released records go back in front of the FIFO queue, oldest first
+    storage->ReleaseRecords(std::vector<StorageRecordId>{ "r3", "r2" }, true, headers, fromMemory);
+    EXPECT_THAT(storage->GetReservedCount(), 0u);
+    EXPECT_THAT(storage->GetSize(), size - (16 + sizeof(StorageRecord)));
+
+    std::vector<StorageRecord> retried;
+    storage->GetAndReserveRecords([&retried](StorageRecord&& record) -> bool {
+        retried.push_back(std::move(record));
+        return true;
+    }, 0);
+    ASSERT_THAT(retried.size(), 3u);
+    EXPECT_THAT(retried[0].id, Eq("r2"));
+    EXPECT_THAT(retried[0].retryCount, 1);
+    EXPECT_THAT(retried[0].blob, SizeIs(16u));
+    EXPECT_THAT(retried[1].id, Eq("r3"));
+    EXPECT_THAT(retried[2].id, Eq("r4"));
+}
+
+TEST_F(ShardedMemoryStorageTests, RecordHandedToConsumer_IsReservedWhileItRuns)
+{
+    auto storage = createStorage(1u << EventLatency_Normal);
+    for (int i = 1; i <= 3; i++)
+    {
+        storage->StoreRecord(makeRecord("r" + std::to_string(i), EventLatency_Normal, i));
+    }
+
+    // The uploader gets the first record acknowledged and the second released before it is done
+    HttpHeaders headers;
+    bool fromMemory = true;
+    std::vector<size_t> reservedCounts;
+    storage->GetAndReserveRecords([&](StorageRecord&& record) -> bool {
+        reservedCounts.push_back(storage->GetReservedCount());
+        if (record.id == "r1")
+        {
+            storage->DeleteRecords(std::vector<StorageRecordId>{ record.id }, headers, fromMemory);
+            return true;
+        }
+        storage->ReleaseRecords(std::vector<StorageRecordId>{ record.id }, false, headers, fromMemory);
+        return false;
+    }, 1000);
+    EXPECT_THAT(reservedCounts, ElementsAre(1u, 1u));
+    EXPECT_THAT(storage->GetReservedCount(), 0u);
+    EXPECT_THAT(storage->GetRecordCount(), 2u);
+    EXPECT_THAT(storage->GetSize(), 2 * (16 + sizeof(StorageRecord)));
+    EXPECT_THAT(takeIds(*storage, 0), ElementsAre("r2", "r3"));
+}
+
+TEST_F(ShardedMemoryStorageTests, DeleteRecordsByFilterAndDeleteAll)
+{
+    auto storage = createStorage();
+    storage->StoreRecord(makeRecord("a", EventLatency_Normal, 1));
+    storage->StoreRecord(StorageRecord("b", "other", EventLatency_RealTime, EventPersistence_Normal, 2, StorageBlob(16, 1)));
+    takeIds(*storage, 1000, EventLatency_RealTime);
+    storage->StoreRecord(StorageRecord("c", "other", EventLatency_Normal, EventPersistence_Normal, 3, StorageBlob(16, 1)));
+
+    storage->DeleteRecords({ { "tenant_token", "other" } });
+    EXPECT_THAT(storage->GetReservedCount(), 0u);
+    EXPECT_THAT(storage->GetRecordCount(), 1u);
+    EXPECT_THAT(storage->GetSize(), 16 + sizeof(StorageRecord));
+
+    storage->DeleteAllRecords();
+    EXPECT_THAT(storage->GetRecordCount(), 0u);
+    EXPECT_THAT(storage->GetSize(), 0u);
+}
+
+TEST_F(ShardedMemoryStorageTests, ConcurrentProducersAndUploader_NoRecordLostOrDuplicated)
+{
+    auto storage = createStorage();
+    constexpr int producers = 4;
+    constexpr int perProducer = 2000;
+    std::atomic<int> finished(0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&storage, &finished, p]() {
+            for (int i = 0; i < perProducer; i++)
+            {
+                EventLatency latency = (i % 2) ? EventLatency_Normal : EventLatency_RealTime;
+                storage->StoreRecord(makeRecord(std::to_string(p) + "-" + std::to_string(i), latency, i));
+            }
+            finished++;
+        });
+    }
+
+    std::set<std::string> seen;
+    HttpHeaders headers;
+    bool fromMemory = true;
+    while (finished < producers || storage->GetRecordCount() > 0)
+    {
+        std::vector<StorageRecordId> ids;
+        storage->GetAndReserveRecords([&ids, &seen](StorageRecord&& record) -> bool {
+            if (ids.size() >= 50)
+            {
+                return false;
+            }
+            EXPECT_THAT(seen.insert(record.id).second, true);
+            ids.push_back(record.id);
+            return true;
+        }, 1000);
+        storage->DeleteRecords(ids, headers, fromMemory);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_THAT(seen.size(), size_t { producers * perProducer });
+    EXPECT_THAT(storage->GetReservedCount(), 0u);
+    EXPECT_THAT(storage->GetSize(), 0u);
+}
@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "system/TenantRegistry.hpp"
+
+#include <thread>
+
+using namespace testing;
+using namespace MAT;
+
+TEST(TenantRegistryTests, Intern_ReturnsOneIdPerToken)
+{
+    TenantId first = TenantRegistry::Intern("registry-test-token-1");
+    TenantId second = TenantRegistry::Intern("registry-test-token-2");
+    EXPECT_THAT(first, Ne(NoTenant));
+    EXPECT_THAT(second, Ne(first));
+    EXPECT_THAT(TenantRegistry::Intern("registry-test-token-1"), Eq(first));
+    EXPECT_THAT(TenantRegistry::GetToken(first), Eq("registry-test-token-1"));
+    EXPECT_THAT(TenantRegistry::GetToken(second), Eq("registry-test-token-2"));
+}
+
+TEST(TenantRegistryTests, EmptyAndUnknownTokens)
+{
+    EXPECT_THAT(TenantRegistry::Intern(""), Eq(NoTenant));
+    EXPECT_THAT(TenantRegistry::GetToken(NoTenant), Eq(""));
+    EXPECT_THAT(TenantRegistry::GetToken(static_cast<TenantId>(-1)), Eq(""));
+
+    TenantId tenantId = NoTenant;
+    size_t count = TenantRegistry::GetCount();
+    EXPECT_THAT(TenantRegistry::Find("registry-test-never-interned", tenantId), false);
+    EXPECT_THAT(TenantRegistry::GetCount(), Eq(count));
+    EXPECT_THAT(TenantRegistry::Find(TenantRegistry::GetToken(TenantRegistry::Intern("registry-test-found")), tenantId), true);
+    EXPECT_THAT(TenantRegistry::GetToken(tenantId), Eq("registry-test-found"));
+}
+
+TEST(TenantRegistryTests, ConcurrentInterning_GivesEveryThreadTheSameIds)
+{
+    constexpr int threadCount = 4;
+    constexpr int tokenCount = 50;
+    std::vector<std::vector<TenantId>> ids(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&ids, t]() {
+            for (int i = 0; i < tokenCount; i++)
+            {
+                ids[t].push_back(TenantRegistry::Intern("registry-test-concurrent-" + std::to_string((i + t * 7) % tokenCount)));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int i = 0; i < tokenCount; i++)
+    {
+        std::string const token = "registry-test-concurrent-" + std::to_string(i);
+        TenantId tenantId = TenantRegistry::Intern(token);
+        EXPECT_THAT(TenantRegistry::GetToken(tenantId), Eq(token));
+        for (int t = 0; t < threadCount; t++)
+        {
+            EXPECT_THAT(ids[t][(i - t * 7 % tokenCount + tokenCount) % tokenCount], Eq(tenantId));
+        }
+    }
+}
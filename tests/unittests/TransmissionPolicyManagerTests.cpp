@@ -46,6 +46,7 @@ class TransmissionPolicyManager4Test : public TransmissionPolicyManager {
     using TransmissionPolicyManager::m_timerdelay;
     using TransmissionPolicyManager::m_runningLatency;
     using TransmissionPolicyManager::m_backoffConfig;
+    using TransmissionPolicyManager::uploadWindow;
 
     MOCK_METHOD3(scheduleUpload, void(const std::chrono::milliseconds&, EventLatency,bool));
     MOCK_METHOD1(uploadAsync, void(EventLatency));
@@ -330,6 +331,77 @@ TEST_F(TransmissionPolicyManagerTests, SuccessfulUploadSchedulesNextOneImmediate
     tpm.eventsUploadSuccessful(upload);
 }
 
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_WindowGrowsOnFastSuccessesAndHalvesOnFailure)
+{
+    IRuntimeConfig& config = testing::getSystem().getConfig();
+    config[CFG_BOOL_TPM_ADAPTIVE_UPLOADS] = true;
+    config[CFG_INT_MAX_PENDING_REQ] = 4;
+    tpm.paused(false);
+    EXPECT_CALL(tpm, scheduleUpload(_, _, false)).WillRepeatedly(Return());
+
+    // One success grows the window to 2, both batches are started right away
+    auto upload = tpm.fakeActiveUpload();
+    upload->durationMs = 100;
+    EXPECT_CALL(*this, resultInitiateUpload(_)).Times(2);
+    tpm.eventsUploadSuccessful(upload);
+    EXPECT_THAT(tpm.uploadWindow(), 2u);
+    EXPECT_THAT(tpm.activeUploads(), SizeIs(2));
+
+    // Two more fast successes grow it to 3, a slow one holds it
+    for (int duration : { 120, 80, 1000 })
+    {
+        upload = *tpm.activeUploads().begin();
+        upload->durationMs = duration;
+        EXPECT_CALL(*this, resultInitiateUpload(_)).WillRepeatedly(Return());
+        tpm.eventsUploadSuccessful(upload);
+    }
+    EXPECT_THAT(tpm.uploadWindow(), 3u);
+    EXPECT_THAT(tpm.activeUploads(), SizeIs(3));
+
+    // Failures halve it, down to a single batch
+    tpm.eventsUploadFailed(*tpm.activeUploads().begin());
+    EXPECT_THAT(tpm.uploadWindow(), 1u);
+    tpm.eventsUploadRejected(*tpm.activeUploads().begin());
+    EXPECT_THAT(tpm.uploadWindow(), 1u);
+
+    config[CFG_BOOL_TPM_ADAPTIVE_UPLOADS] = false;
+    tpm.paused(true);
+}
+
+TEST_F(TransmissionPolicyManagerTests, AdaptiveUploads_NoBatchesOnceProfileDisablesUploads)
+{
+    IRuntimeConfig& config = testing::getSystem().getConfig();
+    config[CFG_BOOL_TPM_ADAPTIVE_UPLOADS] = true;
+    config[CFG_INT_MAX_PENDING_REQ] = 4;
+    tpm.paused(false);
+    EXPECT_CALL(tpm, scheduleUpload(_, _, false)).WillRepeatedly(Return());
+
+    std::string customProfile = R"(
+        [
+            {
+                "name": "Fred",
+                "rules": [
+                    {"timers": [ -1, -1, -1 ]}
+                ]
+            }
+        ]
+    )";
+    EXPECT_TRUE(TransmitProfiles::load(customProfile));
+    EXPECT_TRUE(TransmitProfiles::setProfile("Fred"));
+
+    // The success grows the window, but the profile no longer allows any upload
+    auto upload = tpm.fakeActiveUpload();
+    upload->durationMs = 100;
+    EXPECT_CALL(*this, resultInitiateUpload(_)).Times(0);
+    tpm.eventsUploadSuccessful(upload);
+    EXPECT_THAT(tpm.uploadWindow(), 2u);
+    EXPECT_THAT(tpm.activeUploads(), IsEmpty());
+
+    TransmitProfiles::reset();
+    config[CFG_BOOL_TPM_ADAPTIVE_UPLOADS] = false;
+    tpm.paused(true);
+}
+
 #if 0
 TEST_F(TransmissionPolicyManagerTests, RejectedUploadSchedulesNextOneWithLargerDelay)
 {
@@ -0,0 +1,175 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/PAL.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    // Windows formats GUIDs in uppercase, other platforms in lowercase
+    bool isHex(char c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    bool hasUpperCase(std::string const& uuid)
+    {
+        return std::any_of(uuid.begin(), uuid.end(), [](char c) { return std::isupper(static_cast<unsigned char>(c)) != 0; });
+    }
+
+    bool hasLowerCase(std::string const& uuid)
+    {
+        return std::any_of(uuid.begin(), uuid.end(), [](char c) { return std::islower(static_cast<unsigned char>(c)) != 0; });
+    }
+
+    void expectUuidFormat(std::string const& uuid)
+    {
+        ASSERT_EQ(uuid.size(), size_t { 36 });
+        for (size_t i = 0; i < uuid.size(); i++)
+        {
+            if (i == 8 || i == 13 || i == 18 || i == 23)
+            {
+                EXPECT_EQ(uuid[i], '-') << uuid;
+            }
+            else
+            {
+                EXPECT_TRUE(isHex(uuid[i])) << uuid;
+            }
+        }
+        // Version 4, variant 10xx
+        EXPECT_EQ(uuid[14], '4') << uuid;
+        EXPECT_THAT(std::string("89ab"), HasSubstr(std::string(1, uuid[19]))) << uuid;
+    }
+}
+
+TEST(UuidGeneratorTests, GenerateUuidString_IsRandomVersion4)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        expectUuidFormat(PAL::generateUuidString());
+    }
+}
+
+TEST(UuidGeneratorTests, Format_WritesBytesInOrder)
+{
+    uint8_t const uuid[PAL::UuidGenerator::BinarySize] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+    char buffer[40];
+    memset(buffer, 'X', sizeof(buffer));
+    PAL::UuidGenerator::format(uuid, buffer);
+
+    EXPECT_EQ(std::string(buffer, 36), "00112233-4455-6677-8899-aabbccddeeff");
+    EXPECT_EQ(buffer[36], 'X');
+}
+
+TEST(UuidGeneratorTests, GenerateUuidStringIntoBuffer_DoesNotWritePastUuid)
+{
+    char buffer[40];
+    memset(buffer, 'X', sizeof(buffer));
+    PAL::generateUuidString(buffer);
+
+    expectUuidFormat(std::string(buffer, 36));
+    EXPECT_EQ(buffer[36], 'X');
+}
+
+TEST(UuidGeneratorTests, GenerateUuidString_BothOverloadsUseTheSameCase)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        char buffer[36];
+        PAL::generateUuidString(buffer);
+        for (std::string const& uuid : { PAL::generateUuidString(), std::string(buffer, 36) })
+        {
+            EXPECT_FALSE(PAL::UuidUpperCase ? hasLowerCase(uuid) : hasUpperCase(uuid)) << uuid;
+        }
+    }
+}
+
+TEST(UuidGeneratorTests, GenerateUuid_BinaryMatchesFormattedString)
+{
+    uint8_t uuid[PAL::UuidGenerator::BinarySize];
+    PAL::generateUuid(uuid);
+    EXPECT_EQ(uuid[6] & 0xF0, 0x40);
+    EXPECT_EQ(uuid[8] & 0xC0, 0x80);
+
+    char buffer[36];
+    PAL::UuidGenerator::format(uuid, buffer);
+    expectUuidFormat(std::string(buffer, 36));
+}
+
+TEST(UuidGeneratorTests, ConcurrentThreads_GenerateUniqueIds)
+{
+    const int threadCount = 8;
+    const int perThread = 10000;
+    std::vector<std::vector<std::string>> results(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&results, t]() {
+            results[t].reserve(perThread);
+            for (int i = 0; i < perThread; i++)
+            {
+                results[t].push_back(PAL::generateUuidString());
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::set<std::string> unique;
+    for (auto const& ids : results)
+    {
+        unique.insert(ids.begin(), ids.end());
+    }
+    EXPECT_EQ(unique.size(), size_t { threadCount * perThread });
+}
+
+#ifndef _WIN32
+TEST(UuidGeneratorTests, ForkedChild_DoesNotRepeatParentIds)
+{
+    char parentFirst[36];
+    PAL::generateUuidString(parentFirst);
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        // The child starts from a copy of the state of this thread
+        char id[36];
+        PAL::generateUuidString(id);
+        ssize_t written = write(fds[1], id, sizeof(id));
+        _exit((written == static_cast<ssize_t>(sizeof(id))) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    char parentNext[36];
+    PAL::generateUuidString(parentNext);
+    char childId[36];
+    EXPECT_EQ(read(fds[0], childId, sizeof(childId)), static_cast<ssize_t>(sizeof(childId)));
+    close(fds[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    EXPECT_NE(std::string(childId, 36), std::string(parentNext, 36));
+}
+#endif
@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2015-2020 Microsoft Corporation and Contributors.
+// SPDX-License-Identifier: Apache-2.0
+//
+#include "common/Common.hpp"
+#include "pal/PAL.hpp"
+#include "pal/TaskDispatcher.hpp"
+
+using namespace testing;
+using namespace MAT;
+
+namespace
+{
+    class TaskRecorder
+    {
+    public:
+        std::mutex       lock;
+        std::vector<int> order;
+        PAL::Event       done;
+        size_t           expected = 0;
+
+        void run(int id)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(id);
+            if (order.size() == expected)
+            {
+                done.post();
+            }
+        }
+    };
+
+    class WorkerThreadTests : public TestWithParam<TaskSchedulerType>
+    {
+    };
+}
+
+TEST_P(WorkerThreadTests, TimedTasks_RunInTargetTimeOrder)
+{
+    auto workerThread = PAL::WorkerThreadFactory::Create(GetParam());
+    TaskRecorder recorder;
+    recorder.expected = 4;
+
+    PAL::scheduleTask(workerThread.get(), 120, &recorder, &TaskRecorder::run, 4);
+    PAL::scheduleTask(workerThread.get(), 30, &recorder, &TaskRecorder::run, 1);
+    PAL::scheduleTask(workerThread.get(), 90, &recorder, &TaskRecorder::run, 3);
+    PAL::scheduleTask(workerThread.get(), 60, &recorder, &TaskRecorder::run, 2);
+
+    ASSERT_TRUE(recorder.done.wait(5000));
+    EXPECT_THAT(recorder.order, ElementsAre(1, 2, 3, 4));
+    workerThread->Join();
+}
+
+TEST_P(WorkerThreadTests, Cancel_PendingTimedTask_DoesNotRun)
+{
+    auto workerThread = PAL::WorkerThreadFactory::Create(GetParam());
+    TaskRecorder recorder;
+    recorder.expected = 2;
+
+    auto cancelled = PAL::scheduleTask(workerThread.get(), 50, &recorder, &TaskRecorder::run, 1);
+    PAL::scheduleTask(workerThread.get(), 50, &recorder, &TaskRecorder::run, 2);
+    PAL::scheduleTask(workerThread.get(), 100, &recorder, &TaskRecorder::run, 3);
+    EXPECT_TRUE(cancelled.Cancel());
+
+    ASSERT_TRUE(recorder.done.wait(5000));
+    EXPECT_THAT(recorder.order, ElementsAre(2, 3));
+    workerThread->Join();
+}
+
+TEST_P(WorkerThreadTests, Cancel_ManyTimedTasks_RunsTheRestInOrder)
+{
+    auto workerThread = PAL::WorkerThreadFactory::Create(GetParam());
+    TaskRecorder recorder;
+    constexpr int tasks = 64;
+    recorder.expected = tasks / 2;
+
+    // Distinct delays queued out of order, every other task is cancelled
+    std::vector<PAL::DeferredCallbackHandle> handles;
+    std::vector<int> expected;
+    for (int i = 0; i < tasks; i++)
+    {
+        int delay = (i * 37) % tasks;
+        handles.push_back(PAL::scheduleTask(workerThread.get(), 50 + delay, &recorder, &TaskRecorder::run, delay));
+    }
+    for (int i = tasks - 1; i >= 0; i--)
+    {
+        int delay = (i * 37) % tasks;
+        if (delay % 2 != 0)
+        {
+            EXPECT_TRUE(handles[i].Cancel());
+        }
+    }
+    for (int delay = 0; delay < tasks; delay += 2)
+    {
+        expected.push_back(delay);
+    }
+
+    ASSERT_TRUE(recorder.done.wait(5000));
+    EXPECT_THAT(recorder.order, ElementsAreArray(expected));
+    workerThread->Join();
+}
+
+INSTANTIATE_TEST_CASE_P(Schedulers, WorkerThreadTests, Values(TaskScheduler_List, TaskScheduler_Heap));
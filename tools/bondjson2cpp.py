@@ -263,6 +263,16 @@ def write_types(self, declarations):
         while len(cur_ns) > 0:
             self.wl(0, '}} // namespace {}', cur_ns.pop())
 
+    def format_field_header(self, bt, ordinal):
+        """Return C++ code writing the compact binary field header for specified type and ordinal,
+        with the encoding chosen here so that the writer doesn't have to branch on the ordinal"""
+        if ordinal <= 5:
+            return 'writer.WriteFieldHeader({} | ({} << 5));'.format(bt, ordinal)
+        elif ordinal <= 0xff:
+            return 'writer.WriteFieldHeader({} | (6 << 5), {});'.format(bt, ordinal)
+        else:
+            return 'writer.WriteFieldHeader({} | (7 << 5), {}, {});'.format(bt, ordinal & 0xff, ordinal >> 8)
+
     def write_item_writer(self, ft, var, indent):
         """Construct C++ code for writing specified variable and write it to the output file"""
         if type(ft) is dict:
@@ -297,25 +307,14 @@ def write_field_writer(self, f, var, indent):
 
         if type(ft) is dict and not (ft['type'] == 'user' and ft['declaration']['tag'] == 'Enum'):
             # Composed types
+            # Omitted fields are simply skipped, the compact binary protocol has nothing to write for them
             if ft['type'] == 'user':
-                self.wl(indent, 'writer.WriteFieldBegin({}, {}, nullptr);', self.format_cpp_bt_const(ft), f['fieldOrdinal'])
+                self.wl(indent, self.format_field_header(self.format_cpp_bt_const(ft), f['fieldOrdinal']))
                 self.write_item_writer(ft, var, indent)
-                self.wl(indent, 'writer.WriteFieldEnd();')
-            elif ft['type'] == 'vector':
-                self.wl(indent, 'if (!{}.empty()) {{', var)
-                self.wl(indent + 1, 'writer.WriteFieldBegin({}, {}, nullptr);', self.format_cpp_bt_const(ft), f['fieldOrdinal'])
-                self.write_item_writer(ft, var, indent + 1)
-                self.wl(indent + 1, 'writer.WriteFieldEnd();')
-                self.wl(indent, '}} else {{')
-                self.wl(indent + 1, 'writer.WriteFieldOmitted({}, {}, nullptr);', self.format_cpp_bt_const(ft), f['fieldOrdinal'])
-                self.wl(indent, '}}')
-            elif ft['type'] == 'map':
+            elif ft['type'] == 'vector' or ft['type'] == 'map':
                 self.wl(indent, 'if (!{}.empty()) {{', var)
-                self.wl(indent + 1, 'writer.WriteFieldBegin({}, {}, nullptr);', self.format_cpp_bt_const(ft), f['fieldOrdinal'])
+                self.wl(indent + 1, self.format_field_header(self.format_cpp_bt_const(ft), f['fieldOrdinal']))
                 self.write_item_writer(ft, var, indent + 1)
-                self.wl(indent + 1, 'writer.WriteFieldEnd();')
-                self.wl(indent, '}} else {{')
-                self.wl(indent + 1, 'writer.WriteFieldOmitted({}, {}, nullptr);', self.format_cpp_bt_const(ft), f['fieldOrdinal'])
                 self.wl(indent, '}}')
             else:
                 raise RuntimeError('Unsupported fieldType {}'.format(ft['type']))
@@ -333,11 +332,8 @@ def write_field_writer(self, f, var, indent):
         else:
             isset = self.get_basic_type_info(ft)['isset'].format(var)
         self.wl(indent, 'if ({}) {{', isset)
-        self.wl(indent + 1, 'writer.WriteFieldBegin({}, {}, nullptr);', bt, f['fieldOrdinal'])
+        self.wl(indent + 1, self.format_field_header(bt, f['fieldOrdinal']))
         self.write_item_writer(ft, var, indent + 1)
-        self.wl(indent + 1, 'writer.WriteFieldEnd();')
-        self.wl(indent, '}} else {{')
-        self.wl(indent + 1, 'writer.WriteFieldOmitted({}, {}, nullptr);', bt, f['fieldOrdinal'])
         self.wl(indent, '}}')
 
     def write_writers(self, declarations):
@@ -411,10 +407,12 @@ def write_item_reader(self, ft, var, indent):
                 self.wl(indent, 'if (keyType{0} != {1} || valueType{0} != {2}) {{', indent, self.format_cpp_bt_const(ft['key']), self.format_cpp_bt_const(ft['element']))
                 self.wl(indent + 1, 'return false;')
                 self.wl(indent, '}}')
+                # Maps are written in key order, so each entry goes at the end: constant time with the hint
                 self.wl(indent, 'for (unsigned i{0} = 0; i{0} < size{0}; i{0}++) {{', indent)
                 self.wl(indent + 1, '{} key{};', self.format_cpp_type(ft['key']), indent)
                 self.write_item_reader(ft['key'], 'key{}'.format(indent), indent + 1)
-                self.write_item_reader(ft['element'], '{}[key{}]'.format(var, indent), indent + 1)
+                self.wl(indent + 1, 'auto& item{0} = {1}.emplace_hint({1}.end(), std::move(key{0}), {2}())->second;', indent, var, self.format_cpp_type(ft['element']))
+                self.write_item_reader(ft['element'], 'item{}'.format(indent), indent + 1)
                 self.wl(indent, '}}')
                 self.wl(indent, 'if (!reader.ReadContainerEnd()) {{')
                 self.wl(indent + 1, 'return false;')